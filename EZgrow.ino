@@ -10,7 +10,7 @@ void setup() {
   // Hardware + config + Wi-Fi + LittleFS init
   initHardware();
 
-  // Load persisted 7-day history (if available on LittleFS)
+  // Load persisted history (if available on LittleFS)
   initHistoryStorage();
 
   // Start HTTP server, Web UI, APIs (including /api/history)
@@ -25,10 +25,13 @@ void loop() {
   updateControlLogic();
   updateDisplay();
 
-  // Keeps the in-RAM 7-day ring buffer filled
+  // Keeps the in-RAM history tiers filled
   logHistorySample();
 
-  // Periodically flush history ring buffer to LittleFS (for reboot persistence)
+  // Append new history samples to the LittleFS journal (for reboot persistence)
   historyStorageLoop();
+
+  // Coalesced config writes and the flash write budget
+  updatePersistence();
 }
 
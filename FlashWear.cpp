@@ -0,0 +1,203 @@
+#include "FlashWear.h"
+
+#include <string.h>
+
+static const uint32_t SECONDS_PER_DAY = 86400UL;
+
+static FlashWearCounters sCounters[FLASH_WEAR_SUBSYSTEM_COUNT];
+static uint8_t           sPoolOf[FLASH_WEAR_SUBSYSTEM_COUNT];
+static uint32_t          sPoolSize[FLASH_WEAR_POOL_COUNT];
+static uint64_t          sPoolErases[FLASH_WEAR_POOL_COUNT];     // since boot
+static uint64_t          sPoolRestored[FLASH_WEAR_POOL_COUNT];   // before this boot
+static uint32_t          sPoolLogCarry[FLASH_WEAR_POOL_COUNT];   // log bytes not yet charged an erase
+
+// Bucket level in byte-seconds (bytes * SECONDS_PER_DAY), so the refill of
+// budget / 86400 bytes per second needs no rounding
+static uint32_t sBudget         = FLASH_WEAR_DAILY_BUDGET_BYTES;
+static int64_t  sCredit         = 0;
+static uint32_t sBootSec        = 0;
+static uint32_t sLastTickSec    = 0;
+static uint32_t sDay            = 0;
+static uint32_t sBytesToday     = 0;
+static uint32_t sBytesYesterday = 0;
+
+static int64_t creditCap() {
+  return (int64_t)sBudget / 4 * SECONDS_PER_DAY;
+}
+
+void flashWearReset(uint32_t budgetBytesPerDay, uint32_t uptimeSec) {
+  memset(sCounters, 0, sizeof(sCounters));
+  memset(sPoolSize, 0, sizeof(sPoolSize));
+  memset(sPoolErases, 0, sizeof(sPoolErases));
+  memset(sPoolRestored, 0, sizeof(sPoolRestored));
+  memset(sPoolLogCarry, 0, sizeof(sPoolLogCarry));
+  sPoolOf[FLASH_WEAR_HISTORY_JOURNAL] = FLASH_WEAR_POOL_FS;
+  sPoolOf[FLASH_WEAR_HISTORY_HOURLY]  = FLASH_WEAR_POOL_FS;
+  sPoolOf[FLASH_WEAR_CONFIG]          = FLASH_WEAR_POOL_NVS;
+  sPoolOf[FLASH_WEAR_GROW_PROFILES]   = FLASH_WEAR_POOL_NVS;
+  sPoolOf[FLASH_WEAR_CREDENTIALS]     = FLASH_WEAR_POOL_NVS;
+
+  sBudget         = budgetBytesPerDay;
+  sCredit         = creditCap();
+  sBootSec        = uptimeSec;
+  sLastTickSec    = uptimeSec;
+  sDay            = 0;
+  sBytesToday     = 0;
+  sBytesYesterday = 0;
+}
+
+void flashWearSetPool(FlashWearSubsystem sub, FlashWearPool pool) {
+  if (sub < FLASH_WEAR_SUBSYSTEM_COUNT && pool < FLASH_WEAR_POOL_COUNT) sPoolOf[sub] = pool;
+}
+
+void flashWearSetPoolSize(FlashWearPool pool, uint32_t bytes) {
+  if (pool < FLASH_WEAR_POOL_COUNT) sPoolSize[pool] = bytes;
+}
+
+void flashWearRestoreErases(FlashWearPool pool, uint64_t erases) {
+  if (pool < FLASH_WEAR_POOL_COUNT) sPoolRestored[pool] = erases;
+}
+
+bool flashWearTick(uint32_t uptimeSec) {
+  sCredit += (int64_t)(uptimeSec - sLastTickSec) * sBudget;
+  if (sCredit > creditCap()) sCredit = creditCap();
+  sLastTickSec = uptimeSec;
+
+  const uint32_t day = (uptimeSec - sBootSec) / SECONDS_PER_DAY;
+  if (day == sDay) return false;
+  sBytesYesterday = (day == sDay + 1) ? sBytesToday : 0;
+  sBytesToday     = 0;
+  sDay            = day;
+  return true;
+}
+
+bool flashWearAllows(uint32_t bytes) {
+  return sCredit >= (int64_t)bytes * SECONDS_PER_DAY;
+}
+
+void flashWearDefer(FlashWearSubsystem sub) {
+  if (sub < FLASH_WEAR_SUBSYSTEM_COUNT) sCounters[sub].deferred++;
+}
+
+void flashWearCharge(FlashWearSubsystem sub, const FlashWearCost& cost) {
+  if (sub >= FLASH_WEAR_SUBSYSTEM_COUNT) return;
+  const uint8_t pool = sPoolOf[sub];
+  sPoolLogCarry[pool] += cost.logBytes;
+  const uint32_t erases = cost.erases + sPoolLogCarry[pool] / FLASH_WEAR_SECTOR_BYTES;
+  sPoolLogCarry[pool] %= FLASH_WEAR_SECTOR_BYTES;
+
+  FlashWearCounters& c = sCounters[sub];
+  c.writes++;
+  c.bytes  += cost.bytes;
+  c.erases += erases;
+  sPoolErases[pool] += erases;
+  sCredit     -= (int64_t)cost.bytes * SECONDS_PER_DAY;
+  sBytesToday += cost.bytes;
+}
+
+// ===== Cost estimates =====
+
+// NVS is a log of 32-byte entries (strings take a header entry plus their
+// data rounded up to entries); a 4 KB page is erased for every page of
+// entries once the log wraps.
+void flashWearAddNvsPut(FlashWearCost& cost, size_t stringBytes) {
+  uint32_t bytes = FLASH_WEAR_NVS_ENTRY_BYTES;
+  if (stringBytes > 0) {
+    bytes += (uint32_t)((stringBytes + FLASH_WEAR_NVS_ENTRY_BYTES - 1) / FLASH_WEAR_NVS_ENTRY_BYTES) *
+             FLASH_WEAR_NVS_ENTRY_BYTES;
+  }
+  cost.bytes    += bytes;
+  cost.logBytes += bytes;
+}
+
+// LittleFS never rewrites a block in place: the block holding the write
+// position is copied up to that position into a freshly erased block, and
+// closing the file copies everything after the written range as well.
+void flashWearAddFsWrite(FlashWearCost& cost, uint32_t fileSize, uint32_t offset, uint32_t len) {
+  const uint32_t start = offset - offset % FLASH_WEAR_SECTOR_BYTES;
+  const uint32_t end   = (offset + len > fileSize) ? offset + len : fileSize;
+  const uint32_t bytes = end - start;
+  cost.bytes  += bytes;
+  cost.erases += (bytes + FLASH_WEAR_SECTOR_BYTES - 1) / FLASH_WEAR_SECTOR_BYTES;
+}
+
+// Metadata pairs are logs too
+void flashWearAddFsCommit(FlashWearCost& cost) {
+  cost.bytes    += FLASH_WEAR_FS_COMMIT_BYTES;
+  cost.logBytes += FLASH_WEAR_FS_COMMIT_BYTES;
+}
+
+// ===== Reporting =====
+
+const FlashWearCounters& flashWearCounters(FlashWearSubsystem sub) {
+  return sCounters[sub < FLASH_WEAR_SUBSYSTEM_COUNT ? sub : 0];
+}
+
+const char* flashWearSubsystemName(FlashWearSubsystem sub) {
+  switch (sub) {
+    case FLASH_WEAR_HISTORY_JOURNAL: return "history_journal";
+    case FLASH_WEAR_HISTORY_HOURLY:  return "history_hourly";
+    case FLASH_WEAR_CONFIG:          return "config";
+    case FLASH_WEAR_GROW_PROFILES:   return "grow_profiles";
+    case FLASH_WEAR_CREDENTIALS:     return "credentials";
+    default:                         return "";
+  }
+}
+
+const char* flashWearPoolName(FlashWearPool pool) {
+  switch (pool) {
+    case FLASH_WEAR_POOL_NVS:       return "nvs";
+    case FLASH_WEAR_POOL_FS:        return "littlefs";
+    case FLASH_WEAR_POOL_PARTITION: return "history_partition";
+    default:                        return "";
+  }
+}
+
+uint32_t flashWearPoolSize(FlashWearPool pool) {
+  return pool < FLASH_WEAR_POOL_COUNT ? sPoolSize[pool] : 0;
+}
+
+uint64_t flashWearPoolErases(FlashWearPool pool) {
+  return pool < FLASH_WEAR_POOL_COUNT ? sPoolRestored[pool] + sPoolErases[pool] : 0;
+}
+
+uint32_t flashWearBudget() {
+  return sBudget;
+}
+
+int32_t flashWearTokens() {
+  return (int32_t)(sCredit / SECONDS_PER_DAY);
+}
+
+uint32_t flashWearBytesToday() {
+  return sBytesToday;
+}
+
+uint32_t flashWearBytesYesterday() {
+  return sBytesYesterday;
+}
+
+uint32_t flashWearLifetimeDays(FlashWearPool pool, uint32_t uptimeSec) {
+  if (pool >= FLASH_WEAR_POOL_COUNT) return FLASH_WEAR_LIFETIME_UNKNOWN;
+  const uint32_t elapsed = uptimeSec - sBootSec;
+  const uint64_t sectors = sPoolSize[pool] / FLASH_WEAR_SECTOR_BYTES;
+  if (elapsed < FLASH_WEAR_MIN_PROJECTION_SEC || sectors == 0 || sPoolErases[pool] == 0) {
+    return FLASH_WEAR_LIFETIME_UNKNOWN;
+  }
+
+  const uint64_t rated = sectors * FLASH_WEAR_ENDURANCE_CYCLES;
+  const uint64_t used  = sPoolRestored[pool] + sPoolErases[pool];
+  if (used >= rated) return 0;
+  // remaining erases / (erases per day)
+  const uint64_t days = (rated - used) * elapsed / (sPoolErases[pool] * SECONDS_PER_DAY);
+  return days >= FLASH_WEAR_LIFETIME_UNKNOWN ? FLASH_WEAR_LIFETIME_UNKNOWN - 1 : (uint32_t)days;
+}
+
+uint32_t flashWearLifetimeDays(uint32_t uptimeSec) {
+  uint32_t shortest = FLASH_WEAR_LIFETIME_UNKNOWN;
+  for (int p = 0; p < FLASH_WEAR_POOL_COUNT; ++p) {
+    const uint32_t days = flashWearLifetimeDays((FlashWearPool)p, uptimeSec);
+    if (days < shortest) shortest = days;
+  }
+  return shortest;
+}
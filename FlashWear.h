@@ -0,0 +1,104 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Flash wear accounting and daily write budget (no Arduino dependencies, see
+// test/host/flashWear_test.cpp).
+//
+// Every persistence path reports the bytes it programs and the 4 KB sectors
+// it erases, per subsystem. Subsystems map onto pools (NVS, LittleFS, the raw
+// history partition); the projected lifetime of a pool is its sectors times
+// the rated erase cycles, divided by the erase rate seen so far, which
+// assumes the store spreads wear over the whole pool. Erase totals from
+// before this boot can be restored so the projection covers the unit's life.
+//
+// The budget is a token bucket: FLASH_WEAR_DAILY_BUDGET_BYTES accrue evenly
+// over the day, up to a quarter of a day's worth. Deferrable writers
+// (coalesced config saves, journal batches) check flashWearAllows() with
+// their estimated cost and retry later; writes that must not wait are
+// charged anyway and may drive the bucket negative.
+//
+// Neither NVS nor LittleFS reports what reaches the flash, so callers charge
+// an estimate: flashWearAddNvsPut() for one NVS entry, flashWearAddFsWrite()
+// for a LittleFS write, which copies the block holding the write position and
+// everything after it in the file to fresh blocks (copy-on-write).
+
+enum FlashWearSubsystem : uint8_t {
+  FLASH_WEAR_HISTORY_JOURNAL = 0,  // 10-minute journal (LittleFS segments or partition)
+  FLASH_WEAR_HISTORY_HOURLY  = 1,  // hourly segment journal
+  FLASH_WEAR_CONFIG          = 2,  // gh_cfg
+  FLASH_WEAR_GROW_PROFILES   = 3,  // gh_profiles
+  FLASH_WEAR_CREDENTIALS     = 4,  // gh_wifi, gh_auth
+  FLASH_WEAR_SUBSYSTEM_COUNT
+};
+
+enum FlashWearPool : uint8_t {
+  FLASH_WEAR_POOL_NVS       = 0,
+  FLASH_WEAR_POOL_FS        = 1,
+  FLASH_WEAR_POOL_PARTITION = 2,
+  FLASH_WEAR_POOL_COUNT
+};
+
+#ifndef FLASH_WEAR_DAILY_BUDGET_BYTES
+#define FLASH_WEAR_DAILY_BUDGET_BYTES (2UL * 1024UL * 1024UL)
+#endif
+#ifndef FLASH_WEAR_ENDURANCE_CYCLES
+#define FLASH_WEAR_ENDURANCE_CYCLES 100000UL  // rated erase cycles per sector
+#endif
+
+static const uint32_t FLASH_WEAR_SECTOR_BYTES    = 4096;
+static const uint32_t FLASH_WEAR_NVS_ENTRY_BYTES = 32;
+static const uint32_t FLASH_WEAR_FS_COMMIT_BYTES = 64;     // metadata commit per file close
+static const uint32_t FLASH_WEAR_MIN_PROJECTION_SEC = 3600; // rate needs an hour of uptime
+static const uint32_t FLASH_WEAR_LIFETIME_UNKNOWN   = 0xFFFFFFFFUL;
+
+struct FlashWearCounters {
+  uint32_t writes;    // write operations charged
+  uint32_t deferred;  // writes postponed because the budget was spent
+  uint64_t bytes;     // bytes programmed since boot (estimated for NVS/LittleFS)
+  uint32_t erases;    // sector erases since boot (estimated for NVS/LittleFS)
+};
+
+// Estimated flash cost of one write operation
+struct FlashWearCost {
+  uint32_t bytes;     // bytes programmed
+  uint32_t erases;    // sector erases caused directly
+  uint32_t logBytes;  // part of bytes appended to a log that erases one sector per sector written
+};
+
+// Clears all counters; uptimeSec is the time base for flashWearTick().
+void flashWearReset(uint32_t budgetBytesPerDay, uint32_t uptimeSec);
+
+void flashWearSetPool(FlashWearSubsystem sub, FlashWearPool pool);
+void flashWearSetPoolSize(FlashWearPool pool, uint32_t bytes);
+// Erases charged to the pool before this boot
+void flashWearRestoreErases(FlashWearPool pool, uint64_t erases);
+
+// Refills the bucket; returns true when a new uptime day started.
+bool flashWearTick(uint32_t uptimeSec);
+
+bool flashWearAllows(uint32_t bytes);
+void flashWearDefer(FlashWearSubsystem sub);
+void flashWearCharge(FlashWearSubsystem sub, const FlashWearCost& cost);
+
+// Cost estimates (added to cost)
+void flashWearAddNvsPut(FlashWearCost& cost, size_t stringBytes = 0);  // incl. NUL; 0: scalar entry
+void flashWearAddFsWrite(FlashWearCost& cost, uint32_t fileSize, uint32_t offset, uint32_t len);
+void flashWearAddFsCommit(FlashWearCost& cost);
+
+const FlashWearCounters& flashWearCounters(FlashWearSubsystem sub);
+const char* flashWearSubsystemName(FlashWearSubsystem sub);
+const char* flashWearPoolName(FlashWearPool pool);
+uint32_t    flashWearPoolSize(FlashWearPool pool);
+uint64_t    flashWearPoolErases(FlashWearPool pool);  // including restored erases
+
+uint32_t flashWearBudget();
+int32_t  flashWearTokens();
+uint32_t flashWearBytesToday();
+uint32_t flashWearBytesYesterday();
+
+// Days until the pool reaches its rated erase cycles at the rate seen since
+// boot; FLASH_WEAR_LIFETIME_UNKNOWN before an hour of uptime or without erases.
+uint32_t flashWearLifetimeDays(FlashWearPool pool, uint32_t uptimeSec);
+// Shortest lifetime of all pools
+uint32_t flashWearLifetimeDays(uint32_t uptimeSec);
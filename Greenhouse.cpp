@@ -1,9 +1,14 @@
 #include "Greenhouse.h"
+#include "HistoryTiers.h"
+#include "HistoryStorage.h"
+#include "FlashWear.h"
 
 #include <WiFi.h>
 #include <Wire.h>
 #include <LittleFS.h>
 #include <Preferences.h>
+#include <esp_partition.h>
+#include <esp_timer.h>
 #include <Adafruit_SHT4x.h>
 #include <Adafruit_Sensor.h>
 #include <U8g2lib.h>
@@ -69,9 +74,9 @@ static unsigned long sLastStaAttemptMs     = 0;
 static unsigned long sDisconnectedSinceMs  = 0;
 static wl_status_t   sLastWifiStatus       = WL_DISCONNECTED;
 
-HistorySample gHistoryBuf[HISTORY_SIZE];
-size_t        gHistoryIndex = 0;
-bool          gHistoryFull  = false;
+uint32_t      gHistorySeq   = 0;
+uint32_t      gSensorSeq    = 0;
+uint32_t      gConfigSeq    = 0;
 
 static unsigned long lastSensorUpdateMs  = 0;
 static const unsigned long SENSOR_PERIOD = 2000; // 2 seconds
@@ -157,6 +162,15 @@ static const unsigned long TIME_UPDATE_INTERVAL_MS = 60000; // 60 s
 // Preferences for config persistence
 static Preferences prefs;
 
+// Config and grow profile saves are coalesced (see updatePersistence())
+static const unsigned long PERSIST_COALESCE_MS = 2000;  // quiet time before writing
+static bool          sConfigDirty     = false;
+static bool          sConfigDeferred  = false;
+static unsigned long sConfigDirtyMs   = 0;
+static bool          sProfilesDirty   = false;
+static bool          sProfilesDeferred = false;
+static unsigned long sProfilesDirtyMs = 0;
+
 // Sensors / display
 static Adafruit_SHT4x sht4;
 // WE-DA-361: 0.91" 128x32 SSD1306 I2C
@@ -168,7 +182,7 @@ static void applyRelay(int pin, bool logicalOn) {
   digitalWrite(pin, logicalOn ? RELAY_ACTIVE_LEVEL : RELAY_INACTIVE_LEVEL);
 }
 
-static void syncRelays() {
+void syncRelays() {
   applyRelay(RELAY_LIGHT1_PIN, gRelays.light1);
   applyRelay(RELAY_LIGHT2_PIN, gRelays.light2);
   applyRelay(RELAY_FAN_PIN,    gRelays.fan);
@@ -286,6 +300,49 @@ size_t greenhouseTimezoneCount() {
   return TZ_COUNT;
 }
 
+// NVS skips values that did not change; compare first so only the entries
+// that reach flash are charged to the wear ledger (FlashWear.h).
+class NvsWriter {
+ public:
+  explicit NvsWriter(Preferences &p) : cost(), _p(p) {}
+
+  void putInt(const char* key, int32_t v) {
+    if (_p.isKey(key) && _p.getInt(key, ~v) == v) return;
+    _p.putInt(key, v);
+    flashWearAddNvsPut(cost);
+  }
+  void putULong(const char* key, uint32_t v) {
+    if (_p.isKey(key) && _p.getULong(key, ~v) == v) return;
+    _p.putULong(key, v);
+    flashWearAddNvsPut(cost);
+  }
+  void putULong64(const char* key, uint64_t v) {
+    if (_p.isKey(key) && _p.getULong64(key, ~v) == v) return;
+    _p.putULong64(key, v);
+    flashWearAddNvsPut(cost);
+  }
+  void putFloat(const char* key, float v) {
+    if (_p.isKey(key) && _p.getFloat(key, NAN) == v) return;
+    _p.putFloat(key, v);
+    flashWearAddNvsPut(cost);
+  }
+  void putBool(const char* key, bool v) {
+    if (_p.isKey(key) && _p.getBool(key, !v) == v) return;
+    _p.putBool(key, v);
+    flashWearAddNvsPut(cost);
+  }
+  void putString(const char* key, const String &v) {
+    if (_p.isKey(key) && _p.getString(key, "") == v) return;
+    _p.putString(key, v);
+    flashWearAddNvsPut(cost, v.length() + 1);
+  }
+
+  FlashWearCost cost;
+
+ private:
+  Preferences &_p;
+};
+
 // ================= Wi-Fi credentials (NVS) =================
 
 void loadWifiCredentials(String &ssidOut, String &passOut, bool logSsid) {
@@ -320,9 +377,11 @@ void saveWifiCredentials(const String &ssid, const String &password) {
     return;
   }
 
-  prefs.putString("ssid", ssid);
-  prefs.putString("pass", password);
+  NvsWriter nvs(prefs);
+  nvs.putString("ssid", ssid);
+  nvs.putString("pass", password);
   prefs.end();
+  flashWearCharge(FLASH_WEAR_CREDENTIALS, nvs.cost);
 
   Serial.print("[WiFiCFG] Saved SSID: ");
   Serial.println(ssid);
@@ -365,9 +424,11 @@ void saveWebAuthConfig(const String &user, const String &pass) {
     return;
   }
 
-  prefs.putString("user", user);
-  prefs.putString("pass", pass);
+  NvsWriter nvs(prefs);
+  nvs.putString("user", user);
+  nvs.putString("pass", pass);
   prefs.end();
+  flashWearCharge(FLASH_WEAR_CREDENTIALS, nvs.cost);
 
   Serial.print("[AUTH] Saved web auth user: ");
   Serial.println(user.length() ? user : String("<disabled>"));
@@ -534,48 +595,51 @@ void loadConfig() {
   }
 }
 
-void saveConfig() {
+static void writeConfig() {
   if (!prefs.begin("gh_cfg", false)) {
     Serial.println("[CFG] Preferences begin failed (write)");
     return;
   }
 
-  prefs.putFloat("fanOn",    gConfig.env.fanOnTemp);
-  prefs.putFloat("fanOff",   gConfig.env.fanOffTemp);
-  prefs.putInt  ("fanHumOn", gConfig.env.fanHumOn);
-  prefs.putInt  ("fanHumOff",gConfig.env.fanHumOff);
-  prefs.putULong("pumpOff",  gConfig.env.pumpMinOffSec);
-  prefs.putULong("pumpOn",   gConfig.env.pumpMaxOnSec);
+  NvsWriter nvs(prefs);
 
-  prefs.putString("c1Name", gConfig.chamber1.name);
-  prefs.putInt   ("c1Dry",  gConfig.chamber1.soilDryThreshold);
-  prefs.putInt   ("c1Wet",  gConfig.chamber1.soilWetThreshold);
-  prefs.putInt   ("c1Prof", gConfig.chamber1.profileId);
+  nvs.putFloat("fanOn",    gConfig.env.fanOnTemp);
+  nvs.putFloat("fanOff",   gConfig.env.fanOffTemp);
+  nvs.putInt  ("fanHumOn", gConfig.env.fanHumOn);
+  nvs.putInt  ("fanHumOff",gConfig.env.fanHumOff);
+  nvs.putULong("pumpOff",  gConfig.env.pumpMinOffSec);
+  nvs.putULong("pumpOn",   gConfig.env.pumpMaxOnSec);
 
-  prefs.putString("c2Name", gConfig.chamber2.name);
-  prefs.putInt   ("c2Dry",  gConfig.chamber2.soilDryThreshold);
-  prefs.putInt   ("c2Wet",  gConfig.chamber2.soilWetThreshold);
-  prefs.putInt   ("c2Prof", gConfig.chamber2.profileId);
+  nvs.putString("c1Name", gConfig.chamber1.name);
+  nvs.putInt   ("c1Dry",  gConfig.chamber1.soilDryThreshold);
+  nvs.putInt   ("c1Wet",  gConfig.chamber1.soilWetThreshold);
+  nvs.putInt   ("c1Prof", gConfig.chamber1.profileId);
 
-  prefs.putInt ("l1OnMin", gConfig.light1.onMinutes);
-  prefs.putInt ("l1OffMin",gConfig.light1.offMinutes);
-  prefs.putBool("l1Auto",  gConfig.light1.enabled);
+  nvs.putString("c2Name", gConfig.chamber2.name);
+  nvs.putInt   ("c2Dry",  gConfig.chamber2.soilDryThreshold);
+  nvs.putInt   ("c2Wet",  gConfig.chamber2.soilWetThreshold);
+  nvs.putInt   ("c2Prof", gConfig.chamber2.profileId);
 
-  prefs.putInt ("l2OnMin", gConfig.light2.onMinutes);
-  prefs.putInt ("l2OffMin",gConfig.light2.offMinutes);
-  prefs.putBool("l2Auto",  gConfig.light2.enabled);
+  nvs.putInt ("l1OnMin", gConfig.light1.onMinutes);
+  nvs.putInt ("l1OffMin",gConfig.light1.offMinutes);
+  nvs.putBool("l1Auto",  gConfig.light1.enabled);
+
+  nvs.putInt ("l2OnMin", gConfig.light2.onMinutes);
+  nvs.putInt ("l2OffMin",gConfig.light2.offMinutes);
+  nvs.putBool("l2Auto",  gConfig.light2.enabled);
 
-  prefs.putBool("autoFan",  gConfig.autoFan);
-  prefs.putBool("autoPump", gConfig.autoPump);
+  nvs.putBool("autoFan",  gConfig.autoFan);
+  nvs.putBool("autoPump", gConfig.autoPump);
 
-  prefs.putInt("tzIdx", gConfig.tzIndex);
+  nvs.putInt("tzIdx", gConfig.tzIndex);
 
-  prefs.putFloat("chartTMin", gConfig.charts.tempMinC);
-  prefs.putFloat("chartTMax", gConfig.charts.tempMaxC);
-  prefs.putInt  ("chartHMin", gConfig.charts.humMinPct);
-  prefs.putInt  ("chartHMax", gConfig.charts.humMaxPct);
+  nvs.putFloat("chartTMin", gConfig.charts.tempMinC);
+  nvs.putFloat("chartTMax", gConfig.charts.tempMaxC);
+  nvs.putInt  ("chartHMin", gConfig.charts.humMinPct);
+  nvs.putInt  ("chartHMax", gConfig.charts.humMaxPct);
 
   prefs.end();
+  flashWearCharge(FLASH_WEAR_CONFIG, nvs.cost);
 }
 
 struct GrowProfilePreset {
@@ -767,42 +831,45 @@ static void loadGrowProfiles(){
   prefs.end();
 }
 
-static void saveGrowProfiles(){
+static void writeGrowProfiles() {
   if (!prefs.begin("gh_profiles", false)) {
     Serial.println("[CFG] Preferences begin failed (grow profiles)");
     return;
   }
 
+  NvsWriter nvs(prefs);
+
   for (size_t i = 0; i < kGrowProfileCount; i++) {
     const GrowProfileData &p = gGrowProfiles[i];
-    prefs.putString(profilePrefKey(i, "label").c_str(), p.label);
-
-    prefs.putInt  (profilePrefKey(i, "c1Dry").c_str(),  p.chambers[0].soilDry);
-    prefs.putInt  (profilePrefKey(i, "c1Wet").c_str(),  p.chambers[0].soilWet);
-    prefs.putInt  (profilePrefKey(i, "l1On").c_str(),   p.chambers[0].lightOnMinutes);
-    prefs.putInt  (profilePrefKey(i, "l1Off").c_str(),  p.chambers[0].lightOffMinutes);
-    prefs.putBool (profilePrefKey(i, "l1Auto").c_str(), p.chambers[0].lightAuto);
-
-    prefs.putInt  (profilePrefKey(i, "c2Dry").c_str(),  p.chambers[1].soilDry);
-    prefs.putInt  (profilePrefKey(i, "c2Wet").c_str(),  p.chambers[1].soilWet);
-    prefs.putInt  (profilePrefKey(i, "l2On").c_str(),   p.chambers[1].lightOnMinutes);
-    prefs.putInt  (profilePrefKey(i, "l2Off").c_str(),  p.chambers[1].lightOffMinutes);
-    prefs.putBool (profilePrefKey(i, "l2Auto").c_str(), p.chambers[1].lightAuto);
-
-    prefs.putFloat(profilePrefKey(i, "envFanOn").c_str(),  p.env.fanOnTemp);
-    prefs.putFloat(profilePrefKey(i, "envFanOff").c_str(), p.env.fanOffTemp);
-    prefs.putInt  (profilePrefKey(i, "envHumOn").c_str(),  p.env.fanHumOn);
-    prefs.putInt  (profilePrefKey(i, "envHumOff").c_str(), p.env.fanHumOff);
-    prefs.putULong(profilePrefKey(i, "pumpOff").c_str(),   p.env.pumpMinOffSec);
-    prefs.putULong(profilePrefKey(i, "pumpOn").c_str(),    p.env.pumpMaxOnSec);
-
-    prefs.putBool(profilePrefKey(i, "setAutoFan").c_str(),  p.setAutoFan);
-    prefs.putBool(profilePrefKey(i, "setAutoPump").c_str(), p.setAutoPump);
-    prefs.putBool(profilePrefKey(i, "autoFan").c_str(),     p.autoFan);
-    prefs.putBool(profilePrefKey(i, "autoPump").c_str(),    p.autoPump);
+    nvs.putString(profilePrefKey(i, "label").c_str(), p.label);
+
+    nvs.putInt  (profilePrefKey(i, "c1Dry").c_str(),  p.chambers[0].soilDry);
+    nvs.putInt  (profilePrefKey(i, "c1Wet").c_str(),  p.chambers[0].soilWet);
+    nvs.putInt  (profilePrefKey(i, "l1On").c_str(),   p.chambers[0].lightOnMinutes);
+    nvs.putInt  (profilePrefKey(i, "l1Off").c_str(),  p.chambers[0].lightOffMinutes);
+    nvs.putBool (profilePrefKey(i, "l1Auto").c_str(), p.chambers[0].lightAuto);
+
+    nvs.putInt  (profilePrefKey(i, "c2Dry").c_str(),  p.chambers[1].soilDry);
+    nvs.putInt  (profilePrefKey(i, "c2Wet").c_str(),  p.chambers[1].soilWet);
+    nvs.putInt  (profilePrefKey(i, "l2On").c_str(),   p.chambers[1].lightOnMinutes);
+    nvs.putInt  (profilePrefKey(i, "l2Off").c_str(),  p.chambers[1].lightOffMinutes);
+    nvs.putBool (profilePrefKey(i, "l2Auto").c_str(), p.chambers[1].lightAuto);
+
+    nvs.putFloat(profilePrefKey(i, "envFanOn").c_str(),  p.env.fanOnTemp);
+    nvs.putFloat(profilePrefKey(i, "envFanOff").c_str(), p.env.fanOffTemp);
+    nvs.putInt  (profilePrefKey(i, "envHumOn").c_str(),  p.env.fanHumOn);
+    nvs.putInt  (profilePrefKey(i, "envHumOff").c_str(), p.env.fanHumOff);
+    nvs.putULong(profilePrefKey(i, "pumpOff").c_str(),   p.env.pumpMinOffSec);
+    nvs.putULong(profilePrefKey(i, "pumpOn").c_str(),    p.env.pumpMaxOnSec);
+
+    nvs.putBool(profilePrefKey(i, "setAutoFan").c_str(),  p.setAutoFan);
+    nvs.putBool(profilePrefKey(i, "setAutoPump").c_str(), p.setAutoPump);
+    nvs.putBool(profilePrefKey(i, "autoFan").c_str(),     p.autoFan);
+    nvs.putBool(profilePrefKey(i, "autoPump").c_str(),    p.autoPump);
   }
 
   prefs.end();
+  flashWearCharge(FLASH_WEAR_GROW_PROFILES, nvs.cost);
 }
 
 bool getGrowProfile(size_t idx, GrowProfileData &outProfile) {
@@ -820,7 +887,8 @@ bool updateGrowProfile(size_t idx, const GrowProfileData &data) {
 }
 
 void persistGrowProfiles() {
-  saveGrowProfiles();
+  sProfilesDirty   = true;
+  sProfilesDirtyMs = millis();
 }
 
 bool applyGrowProfileToChamber(int chamberIdx, int profileId, String &appliedName) {
@@ -968,6 +1036,7 @@ void updateSensors() {
   accumulateSample(historyAcc, gSensors);
 
   gSensors = averageFromAccumulator(minuteAcc, gSensors);
+  gSensorSeq++;
 }
 
 // ================= Control logic =================
@@ -1143,35 +1212,111 @@ void updateDisplay() {
 
 void logHistorySample() {
   unsigned long nowMs = millis();
-  if (nowMs - lastHistoryLogMs < HISTORY_INTERVAL_MS) return;
+  if (nowMs - lastHistoryLogMs < HISTORY_RAW_INTERVAL_MS) return;
   lastHistoryLogMs = nowMs;
 
-  HistorySample &s = gHistoryBuf[gHistoryIndex];
-
+  time_t nowSec = 0;
   if (gTimeAvailable) {
-    time_t nowSec;
     time(&nowSec);
-    s.timestamp = nowSec;
-  } else {
-    s.timestamp = 0;
   }
 
   SensorState averaged = averageFromAccumulator(historyAcc, gSensors);
 
-  s.temp   = averaged.temperatureC;
-  s.hum    = averaged.humidityRH;
-  s.soil1  = averaged.soil1Percent;
-  s.soil2  = averaged.soil2Percent;
-  s.light1 = gRelays.light1;
-  s.light2 = gRelays.light2;
-
   resetAccumulator(historyAcc);
   historyWindowStartMs = nowMs;
 
-  gHistoryIndex = (gHistoryIndex + 1) % HISTORY_SIZE;
-  if (gHistoryIndex == 0) gHistoryFull = true;
+  historyTiersAddMinute(nowSec, averaged, gRelays);
 }
 
+// ================= Persistence scheduler =================
+
+uint32_t greenhouseUptimeSec() {
+  return (uint32_t)(esp_timer_get_time() / 1000000LL);
+}
+
+static const char* WEAR_POOL_KEYS[FLASH_WEAR_POOL_COUNT] = { "nvsErase", "fsErase", "partErase" };
+
+// Erase totals survive reboots so the lifetime projection covers the whole
+// life of the unit; written once per uptime day and before a restart.
+static void saveWearTotals() {
+  if (!prefs.begin("gh_wear", false)) {
+    return;
+  }
+  NvsWriter nvs(prefs);
+  for (int p = 0; p < FLASH_WEAR_POOL_COUNT; ++p) {
+    nvs.putULong64(WEAR_POOL_KEYS[p], flashWearPoolErases((FlashWearPool)p));
+  }
+  prefs.end();
+  flashWearCharge(FLASH_WEAR_CONFIG, nvs.cost);
+}
+
+static void initPersistence() {
+  flashWearReset(FLASH_WEAR_DAILY_BUDGET_BYTES, greenhouseUptimeSec());
+
+  const esp_partition_t* nvsPart =
+    esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "nvs");
+  flashWearSetPoolSize(FLASH_WEAR_POOL_NVS, nvsPart ? nvsPart->size : 0);
+  flashWearSetPoolSize(FLASH_WEAR_POOL_FS, (uint32_t)LittleFS.totalBytes());
+
+  if (prefs.begin("gh_wear", true)) {
+    for (int p = 0; p < FLASH_WEAR_POOL_COUNT; ++p) {
+      flashWearRestoreErases((FlashWearPool)p, prefs.getULong64(WEAR_POOL_KEYS[p], 0));
+    }
+    prefs.end();
+  }
+}
+
+void saveConfig() {
+  gConfigSeq++;
+  sConfigDirty   = true;
+  sConfigDirtyMs = millis();
+}
+
+void updatePersistence() {
+  if (flashWearTick(greenhouseUptimeSec())) {
+    const uint32_t days = flashWearLifetimeDays(greenhouseUptimeSec());
+    Serial.printf("[FLASH] %lu bytes written yesterday (budget %lu/day), projected lifetime %s%lu days\n",
+                  (unsigned long)flashWearBytesYesterday(), (unsigned long)flashWearBudget(),
+                  days == FLASH_WEAR_LIFETIME_UNKNOWN ? "> " : "",
+                  (unsigned long)(days == FLASH_WEAR_LIFETIME_UNKNOWN ? 36500UL : days));
+    saveWearTotals();
+  }
+
+  // Config writes are small; they only wait while the bucket is overdrawn
+  const unsigned long now = millis();
+  if (sConfigDirty && now - sConfigDirtyMs >= PERSIST_COALESCE_MS) {
+    if (flashWearAllows(0)) {
+      sConfigDirty = sConfigDeferred = false;
+      writeConfig();
+    } else if (!sConfigDeferred) {
+      sConfigDeferred = true;
+      flashWearDefer(FLASH_WEAR_CONFIG);
+    }
+  }
+  if (sProfilesDirty && now - sProfilesDirtyMs >= PERSIST_COALESCE_MS) {
+    if (flashWearAllows(0)) {
+      sProfilesDirty = sProfilesDeferred = false;
+      writeGrowProfiles();
+    } else if (!sProfilesDeferred) {
+      sProfilesDeferred = true;
+      flashWearDefer(FLASH_WEAR_GROW_PROFILES);
+    }
+  }
+}
+
+void flushPersistence() {
+  if (sConfigDirty) {
+    sConfigDirty = sConfigDeferred = false;
+    writeConfig();
+  }
+  if (sProfilesDirty) {
+    sProfilesDirty = sProfilesDeferred = false;
+    writeGrowProfiles();
+  }
+  historyStorageFlush();
+  saveWearTotals();
+}
+
 // ================= Hardware init (with AP fallback) =================
 
 static void showStaIpOnDisplay() {
@@ -1264,6 +1409,7 @@ void initHardware() {
   } else {
     Serial.println("[FS] LittleFS mounted");
   }
+  initPersistence();
 
   // Config
   loadConfig();
@@ -1,6 +1,8 @@
 #pragma once
 #include <Arduino.h>
 #include <time.h>
+#include "HistorySample.h"
+#include "HistoryBlocks.h"
 
 constexpr const char* DEFAULT_CHAMBER1_NAME = "Chamber 1";
 constexpr const char* DEFAULT_CHAMBER2_NAME = "Chamber 2";
@@ -98,20 +100,35 @@ struct RelayState {
   bool pump;
 };
 
-// History sample for charts
-struct HistorySample {
+// Decoded history sample used by the history APIs
+struct HistoryPoint {
   time_t timestamp; // unix time (seconds), 0 if unknown
-  float  temp;
-  float  hum;
-  int    soil1;
-  int    soil2;
+  float  temp;      // NAN if missing
+  float  hum;       // NAN if missing
+  int    soil1;     // -1 if missing
+  int    soil2;     // -1 if missing
   bool   light1;
   bool   light2;
 };
 
 // History configuration
-constexpr size_t        HISTORY_SIZE        = 1008;             // 7 days @ 10-min interval
+// Tier budgets are fixed at compile time and can be overridden with build
+// flags, e.g. -DHISTORY_RAW_SLOTS=720 -DHISTORY_HOURLY_SLOTS=2160. The
+// 10-minute tier budget (HISTORY_10MIN_SLOTS, HISTORY_10MIN_ARENA_BYTES) is
+// in HistoryBlocks.h.
+#ifndef HISTORY_RAW_SLOTS
+#define HISTORY_RAW_SLOTS    1440   // 24 h @ 1 min, RAM
+#endif
+#ifndef HISTORY_HOURLY_SLOTS
+#define HISTORY_HOURLY_SLOTS 8760   // 365 days @ 1 h min/avg/max, LittleFS
+#endif
+
+constexpr size_t        HISTORY_SIZE        = HISTORY_10MIN_SLOTS;  // 10-minute tier (HistoryBlocks)
 constexpr unsigned long HISTORY_INTERVAL_MS = 10UL * 60UL * 1000UL; // 10 minutes
+constexpr size_t        HISTORY_RAW_SIZE           = HISTORY_RAW_SLOTS;
+constexpr unsigned long HISTORY_RAW_INTERVAL_MS    = 60UL * 1000UL;        // 1 minute
+constexpr size_t        HISTORY_HOURLY_SIZE        = HISTORY_HOURLY_SLOTS;
+constexpr unsigned long HISTORY_HOURLY_INTERVAL_MS = 60UL * 60UL * 1000UL; // 1 hour
 
 // ========== Global config/state (defined in Greenhouse.cpp) ==========
 
@@ -119,9 +136,9 @@ extern GreenhouseConfig gConfig;
 extern SensorState      gSensors;
 extern RelayState       gRelays;
 
-extern HistorySample gHistoryBuf[HISTORY_SIZE];
-extern size_t        gHistoryIndex;
-extern bool          gHistoryFull;
+extern uint32_t      gHistorySeq;   // write sequence of the newest 10-minute sample (0 = none)
+extern uint32_t      gSensorSeq;    // bumped for every averaged gSensors update (/api/events)
+extern uint32_t      gConfigSeq;    // bumped by saveConfig() (/api/events)
 
 // Time state getter
 bool greenhouseGetTime(struct tm &outTime, bool &available);
@@ -130,6 +147,7 @@ const char* greenhouseTimezoneIana();
 const char* greenhouseTimezoneLabelAt(size_t idx);
 const char* greenhouseTimezoneIanaAt(size_t idx);
 size_t greenhouseTimezoneCount();
+uint32_t greenhouseUptimeSec();  // seconds since boot, no millis() wrap
 
 // ========== Hardware / logic API ==========
 
@@ -145,13 +163,25 @@ void updateSensors();
 // Apply automatic control for lights (schedules), fan (temp+humidity), pump (soil)
 void updateControlLogic();
 
+// Drive the relay pins from gRelays (updateControlLogic() ends with it)
+void syncRelays();
+
 // Update WE-DA-361 OLED display
 void updateDisplay();
 
-// Add one point to history ring buffer (for charts)
+// Close the 1-minute history window and cascade it into the history tiers
 void logHistorySample();
 
-// Load / save configuration (env thresholds, pump timings, light schedules)
+// Writes coalesced config/grow profile saves when the flash write budget
+// allows (FlashWear.h), refills the budget and stores the erase totals once
+// per uptime day. flushPersistence() writes everything pending at once,
+// history included; call it before a planned restart.
+void updatePersistence();
+void flushPersistence();
+
+// Load / save configuration (env thresholds, pump timings, light schedules).
+// saveConfig() and persistGrowProfiles() only mark the data dirty; the write
+// happens from updatePersistence() once changes stop for 2 s.
 void loadConfig();
 void saveConfig();
 void applyTimezoneFromConfig();
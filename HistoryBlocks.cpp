@@ -0,0 +1,168 @@
+#include "HistoryBlocks.h"
+#include "HistoryCodec.h"
+
+#include <string.h>
+
+struct SealedBlock {
+  uint16_t offset;  // in sArena
+  uint16_t length;  // encoded bytes
+};
+
+static_assert(HISTORY_10MIN_ARENA_BYTES <= 0xFFFF, "arena offsets are 16-bit");
+
+static uint8_t       sArena[HISTORY_10MIN_ARENA_BYTES];
+static SealedBlock   sBlocks[HISTORY_BLOCK_MAX];   // ring, oldest at sBlockHead
+static HistoryBlockSummary sSummaries[HISTORY_BLOCK_MAX];  // parallel to sBlocks
+static size_t        sBlockHead  = 0;
+static size_t        sBlockCount = 0;
+static uint32_t      sFirstBlockNo = 0;            // number of the oldest sealed block
+
+static HistorySample sOpen[HISTORY_BLOCK_SAMPLES];
+static size_t        sOpenCount = 0;
+static HistoryBlockSummary sOpenSummary;
+
+// Decoded blocks, keyed by block number
+struct DecodedBlock {
+  uint32_t      blockNo;
+  bool          valid;
+  HistorySample samples[HISTORY_BLOCK_SAMPLES];
+};
+static DecodedBlock sCache[2];
+static size_t       sCacheVictim = 0;
+
+static inline SealedBlock& blockAt(size_t k) {
+  return sBlocks[(sBlockHead + k) % HISTORY_BLOCK_MAX];
+}
+
+static inline HistoryBlockSummary& summaryAt(size_t k) {
+  return sSummaries[(sBlockHead + k) % HISTORY_BLOCK_MAX];
+}
+
+static void dropOldestBlock() {
+  sBlockHead = (sBlockHead + 1) % HISTORY_BLOCK_MAX;
+  sBlockCount--;
+  sFirstBlockNo++;
+}
+
+static bool overlaps(const SealedBlock& b, size_t pos, size_t len) {
+  return b.offset < pos + len && pos < (size_t)b.offset + b.length;
+}
+
+// Finds room for len bytes after the newest block, dropping the oldest blocks
+// that are in the way. Blocks never wrap around the end of the arena.
+static size_t reserveArena(size_t len) {
+  if (sBlockCount == 0) return 0;
+
+  const SealedBlock& newest = blockAt(sBlockCount - 1);
+  size_t pos = (size_t)newest.offset + newest.length;
+  if (pos + len > HISTORY_10MIN_ARENA_BYTES) {
+    // Blocks behind the newest one are the oldest; they go first
+    while (sBlockCount > 1 && blockAt(0).offset >= pos) dropOldestBlock();
+    pos = 0;
+  }
+  while (sBlockCount > 0 && overlaps(blockAt(0), pos, len)) dropOldestBlock();
+  return pos;
+}
+
+static void sealOpenBlock() {
+  const size_t n   = sOpenCount;
+  const size_t len = historyBlockEncode(sOpen, n, nullptr, 0);
+  sOpenCount = 0;
+  const HistoryBlockSummary summary = sOpenSummary;
+  historySummaryReset(sOpenSummary);
+  if (len == 0 || len > HISTORY_10MIN_ARENA_BYTES) return;  // cannot happen with sane budgets
+
+  if (sBlockCount == HISTORY_BLOCK_MAX) dropOldestBlock();
+  const size_t pos = reserveArena(len);
+  historyBlockEncode(sOpen, n, sArena + pos, len);
+
+  SealedBlock& b = sBlocks[(sBlockHead + sBlockCount) % HISTORY_BLOCK_MAX];
+  b.offset = (uint16_t)pos;
+  b.length = (uint16_t)len;
+  sSummaries[(sBlockHead + sBlockCount) % HISTORY_BLOCK_MAX] = summary;
+  sBlockCount++;
+}
+
+void historyRingClear() {
+  sBlockHead    = 0;
+  sBlockCount   = 0;
+  sFirstBlockNo = 0;
+  sOpenCount    = 0;
+  historySummaryReset(sOpenSummary);
+  sCache[0].valid = false;
+  sCache[1].valid = false;
+}
+
+void historyRingPush(const HistorySample& s) {
+  sOpen[sOpenCount++] = s;
+  historySummaryAdd(sOpenSummary, s);
+  if (sOpenCount == HISTORY_BLOCK_SAMPLES) sealOpenBlock();
+}
+
+size_t historyRingCount() {
+  return sBlockCount * HISTORY_BLOCK_SAMPLES + sOpenCount;
+}
+
+// Samples of sealed block k (0 = oldest), decoded through the cache
+static const HistorySample* decodedBlock(size_t k) {
+  const uint32_t blockNo = sFirstBlockNo + (uint32_t)k;
+  for (size_t c = 0; c < 2; ++c) {
+    if (sCache[c].valid && sCache[c].blockNo == blockNo) {
+      sCacheVictim = 1 - c;
+      return sCache[c].samples;
+    }
+  }
+
+  DecodedBlock& slot = sCache[sCacheVictim];
+  const SealedBlock& b = blockAt(k);
+  slot.valid = historyBlockDecode(sArena + b.offset, b.length, slot.samples, HISTORY_BLOCK_SAMPLES) ==
+               HISTORY_BLOCK_SAMPLES;
+  if (!slot.valid) return nullptr;
+  slot.blockNo = blockNo;
+  sCacheVictim = 1 - sCacheVictim;
+  return slot.samples;
+}
+
+bool historyRingRead(size_t ordinal, HistorySample& out) {
+  const size_t sealed = sBlockCount * HISTORY_BLOCK_SAMPLES;
+  if (ordinal >= sealed) {
+    if (ordinal - sealed >= sOpenCount) return false;
+    out = sOpen[ordinal - sealed];
+    return true;
+  }
+
+  const HistorySample* samples = decodedBlock(ordinal / HISTORY_BLOCK_SAMPLES);
+  if (!samples) return false;
+  out = samples[ordinal % HISTORY_BLOCK_SAMPLES];
+  return true;
+}
+
+void historyRingStats(uint32_t from, uint32_t to, HistoryStats& out) {
+  historyStatsReset(out);
+  for (size_t k = 0; k <= sBlockCount; ++k) {
+    const bool open = (k == sBlockCount);
+    const HistoryBlockSummary& summary = open ? sOpenSummary : summaryAt(k);
+    if (historySummaryDisjoint(summary, from, to)) continue;
+    if (historySummaryInside(summary, from, to)) {
+      historyStatsMerge(out, summary);
+      continue;
+    }
+
+    // Block straddles an edge of the window: scan its samples
+    const HistorySample* samples = open ? sOpen : decodedBlock(k);
+    const size_t n = open ? sOpenCount : HISTORY_BLOCK_SAMPLES;
+    if (!samples) continue;
+    for (size_t i = 0; i < n; ++i) historyStatsAddSample(out, samples[i], from, to);
+    out.blocksScanned++;
+  }
+}
+
+size_t historyRingSealedBlocks() {
+  return sBlockCount;
+}
+
+size_t historyRingArenaUsed() {
+  size_t used = 0;
+  for (size_t k = 0; k < sBlockCount; ++k) used += blockAt(k).length;
+  return used;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "HistorySample.h"
+#include "HistoryStats.h"
+
+// 10-minute history ring (the former gHistoryBuf), kept as compressed blocks.
+//
+// New samples go into an open block of HISTORY_BLOCK_SAMPLES plain samples.
+// When it fills, the block is sealed with the columnar codec (HistoryCodec.h)
+// into a byte arena; the oldest sealed blocks are dropped when the arena or
+// the HISTORY_10MIN_SLOTS budget is exhausted. Reads decode whole blocks into
+// a two-entry cache, so sequential scans decode each block once. Every block
+// also keeps a HistoryBlockSummary for range aggregates (HistoryStats.h).
+//
+// No Arduino dependencies (host-testable, see test/host/).
+
+#ifndef HISTORY_BLOCK_SAMPLES
+#define HISTORY_BLOCK_SAMPLES      144     // samples per block (1 day @ 10 min)
+#endif
+#ifndef HISTORY_10MIN_SLOTS
+#define HISTORY_10MIN_SLOTS        5184    // 36 days @ 10 min (sealed blocks + open block)
+#endif
+#ifndef HISTORY_10MIN_ARENA_BYTES
+#define HISTORY_10MIN_ARENA_BYTES  18432   // compressed sealed blocks, RAM
+#endif
+
+static const size_t HISTORY_BLOCK_MAX = HISTORY_10MIN_SLOTS / HISTORY_BLOCK_SAMPLES - 1;
+static_assert(HISTORY_10MIN_SLOTS / HISTORY_BLOCK_SAMPLES >= 2, "HISTORY_10MIN_SLOTS must hold at least two blocks");
+
+void   historyRingClear();
+void   historyRingPush(const HistorySample& s);
+size_t historyRingCount();                              // samples currently held
+bool   historyRingRead(size_t ordinal, HistorySample& out);  // 0 = oldest
+
+// Min/max/mean/count per series over samples with timestamps in [from, to]
+void   historyRingStats(uint32_t from, uint32_t to, HistoryStats& out);
+
+// Footprint statistics
+size_t historyRingSealedBlocks();
+size_t historyRingArenaUsed();   // bytes of sealed blocks in the arena
@@ -0,0 +1,232 @@
+#include "HistoryCodec.h"
+
+// ================= Byte streams =================
+
+namespace {
+
+struct ByteSink {
+  uint8_t* out;   // nullptr: size-only pass
+  size_t   cap;
+  size_t   len;
+  bool     overflow;
+
+  void put(uint8_t b) {
+    if (out) {
+      if (len >= cap) { overflow = true; return; }
+      out[len] = b;
+    }
+    len++;
+  }
+
+  void putVarint(uint32_t v) {
+    while (v >= 0x80) {
+      put((uint8_t)(v | 0x80));
+      v >>= 7;
+    }
+    put((uint8_t)v);
+  }
+};
+
+struct ByteSource {
+  const uint8_t* data;
+  size_t         len;
+  size_t         pos;
+  bool           bad;
+
+  uint8_t get() {
+    if (pos >= len) { bad = true; return 0; }
+    return data[pos++];
+  }
+
+  uint32_t getVarint() {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      const uint8_t b = get();
+      v |= (uint32_t)(b & 0x7F) << shift;
+      if (!(b & 0x80)) return v;
+    }
+    bad = true;
+    return 0;
+  }
+};
+
+// Deltas are kept as the two's complement bits of a uint32_t and wrap, so a
+// jump between 0 (before time sync) and an epoch timestamp is not signed
+// overflow
+inline uint32_t zigzag(uint32_t v) {
+  return (v << 1) ^ (0u - (v >> 31));
+}
+
+inline uint32_t unzigzag(uint32_t v) {
+  return (v >> 1) ^ (0u - (v & 1));
+}
+
+// Zigzag varint stream with zero runs: 0 is followed by (run length - 1)
+class DeltaWriter {
+ public:
+  explicit DeltaWriter(ByteSink& sink) : _sink(sink), _zeros(0) {}
+
+  void put(uint32_t delta) {
+    if (delta == 0) {
+      _zeros++;
+      return;
+    }
+    flush();
+    _sink.putVarint(zigzag(delta));
+  }
+
+  void flush() {
+    if (_zeros == 0) return;
+    _sink.put(0);
+    _sink.putVarint(_zeros - 1);
+    _zeros = 0;
+  }
+
+ private:
+  ByteSink& _sink;
+  uint32_t  _zeros;
+};
+
+class DeltaReader {
+ public:
+  explicit DeltaReader(ByteSource& src) : _src(src), _zeros(0) {}
+
+  uint32_t get() {
+    if (_zeros > 0) {
+      _zeros--;
+      return 0;
+    }
+    const uint32_t z = _src.getVarint();
+    if (z == 0) {
+      _zeros = _src.getVarint();
+      return 0;
+    }
+    return unzigzag(z);
+  }
+
+  // A stream must not end in the middle of a zero run
+  bool finished() const { return _zeros == 0; }
+
+ private:
+  ByteSource& _src;
+  uint32_t    _zeros;
+};
+
+template <typename Field>
+void encodeByteColumn(ByteSink& sink, const HistorySample* in, size_t n, Field field) {
+  DeltaWriter w(sink);
+  uint32_t prev = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const uint32_t v = (uint32_t)field(in[i]);
+    w.put(v - prev);
+    prev = v;
+  }
+  w.flush();
+}
+
+}  // namespace
+
+// ================= Encode =================
+
+size_t historyBlockEncode(const HistorySample* in, size_t n, uint8_t* out, size_t cap) {
+  if (n == 0 || n > 0xFFFF) return 0;
+
+  ByteSink sink = { out, cap, 0, false };
+  sink.put(HISTORY_CODEC_VERSION);
+  sink.putVarint((uint32_t)n);
+
+  // Timestamps: first value, first delta, then delta-of-delta
+  sink.putVarint(in[0].timestamp);
+  if (n > 1) {
+    uint32_t prevDelta = in[1].timestamp - in[0].timestamp;
+    sink.putVarint(zigzag(prevDelta));
+    DeltaWriter dod(sink);
+    for (size_t i = 2; i < n; ++i) {
+      const uint32_t delta = in[i].timestamp - in[i - 1].timestamp;
+      dod.put(delta - prevDelta);
+      prevDelta = delta;
+    }
+    dod.flush();
+  }
+
+  encodeByteColumn(sink, in, n, [](const HistorySample& s) { return (int32_t)s.temp; });
+  encodeByteColumn(sink, in, n, [](const HistorySample& s) { return (int32_t)s.hum; });
+  encodeByteColumn(sink, in, n, [](const HistorySample& s) { return (int32_t)s.soil1; });
+  encodeByteColumn(sink, in, n, [](const HistorySample& s) { return (int32_t)s.soil2; });
+
+  // Relay bits: run-length pairs
+  size_t i = 0;
+  while (i < n) {
+    size_t run = 1;
+    while (i + run < n && in[i + run].relays == in[i].relays) run++;
+    sink.put(in[i].relays);
+    sink.putVarint((uint32_t)(run - 1));
+    i += run;
+  }
+
+  if (sink.overflow) return 0;
+  return sink.len;
+}
+
+// ================= Decode =================
+
+size_t historyBlockCount(const uint8_t* data, size_t len) {
+  ByteSource src = { data, len, 0, false };
+  if (src.get() != HISTORY_CODEC_VERSION) return 0;
+  const uint32_t n = src.getVarint();
+  return (src.bad || n > 0xFFFF) ? 0 : (size_t)n;
+}
+
+size_t historyBlockDecode(const uint8_t* data, size_t len, HistorySample* out, size_t cap) {
+  ByteSource src = { data, len, 0, false };
+  if (src.get() != HISTORY_CODEC_VERSION) return 0;
+  const uint32_t n = src.getVarint();
+  if (src.bad || n == 0 || n > cap) return 0;
+
+  out[0].timestamp = src.getVarint();
+  if (n > 1) {
+    uint32_t delta = unzigzag(src.getVarint());
+    out[1].timestamp = out[0].timestamp + delta;
+    DeltaReader dod(src);
+    for (uint32_t i = 2; i < n; ++i) {
+      delta += dod.get();
+      out[i].timestamp = out[i - 1].timestamp + delta;
+    }
+    if (!dod.finished()) return 0;
+  }
+
+  {
+    DeltaReader r(src);
+    uint32_t v = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+      v += r.get();
+      out[i].temp = (int16_t)v;
+    }
+    if (!r.finished()) return 0;
+  }
+
+  uint8_t HistorySample::*bytes[] = { &HistorySample::hum, &HistorySample::soil1, &HistorySample::soil2 };
+  for (size_t c = 0; c < sizeof(bytes) / sizeof(bytes[0]); ++c) {
+    DeltaReader r(src);
+    uint32_t v = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+      v += r.get();
+      out[i].*bytes[c] = (uint8_t)v;
+    }
+    if (!r.finished()) return 0;
+  }
+
+  uint32_t i = 0;
+  while (i < n && !src.bad) {
+    const uint8_t  relays = src.get();
+    const uint32_t run    = src.getVarint() + 1;
+    if (run > n - i) return 0;
+    for (uint32_t k = 0; k < run; ++k) {
+      out[i].relays   = relays;
+      out[i].reserved = 0;
+      i++;
+    }
+  }
+
+  return src.bad ? 0 : (size_t)n;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "HistorySample.h"
+
+// Columnar block codec for the 10-minute tier (no Arduino dependencies, see
+// test/host/ and scripts/bench-history-codec.cpp).
+//
+// A block holds up to 65535 samples, stored column by column:
+//   u8 version, varint count
+//   timestamps  varint first, zigzag first delta, then delta-of-delta stream
+//   temp        zigzag delta stream (0.01 °C, first delta from 0)
+//   hum, soil1, soil2   zigzag delta streams of the byte values
+//   relays      run-length pairs (u8 value, varint run - 1)
+// Delta streams are zigzag LEB128 varints in which a 0 is followed by a
+// varint run length, so constant stretches (regular timestamps, unchanged
+// soil or humidity) cost two bytes per run.
+
+static const uint8_t HISTORY_CODEC_VERSION = 1;
+
+// Encodes n samples. With out == nullptr only the encoded size is computed.
+// Returns the encoded size, or 0 if n is 0 or the block does not fit in cap.
+size_t historyBlockEncode(const HistorySample* in, size_t n, uint8_t* out, size_t cap);
+
+// Number of samples in an encoded block (0 if the header is invalid).
+size_t historyBlockCount(const uint8_t* data, size_t len);
+
+// Decodes a block into out[0..count). Returns the number of samples, or 0 if
+// the block is malformed or holds more than cap samples.
+size_t historyBlockDecode(const uint8_t* data, size_t len, HistorySample* out, size_t cap);
@@ -0,0 +1,54 @@
+#include "HistoryHourlyFile.h"
+
+#include "HistoryJournal.h"
+
+void historyHourlySealSegmentHeader(HistoryHourlySegmentHeader& hdr, uint32_t segment, size_t recordSize) {
+  hdr.magic      = HISTORY_HOURLY_MAGIC;
+  hdr.version    = HISTORY_HOURLY_VERSION;
+  hdr.recordSize = (uint16_t)recordSize;
+  hdr.segment    = segment;
+  hdr.crc        = historyJournalCrc32(&hdr, offsetof(HistoryHourlySegmentHeader, crc));
+}
+
+bool historyHourlySegmentHeaderValid(const HistoryHourlySegmentHeader& hdr, size_t recordSize) {
+  return hdr.magic == HISTORY_HOURLY_MAGIC &&
+         hdr.version == HISTORY_HOURLY_VERSION &&
+         hdr.recordSize == recordSize &&
+         hdr.crc == historyJournalCrc32(&hdr, offsetof(HistoryHourlySegmentHeader, crc));
+}
+
+uint32_t historyHourlySegmentSlotCrc(uint32_t seq, const void* record, size_t recordSize) {
+  return historyJournalCrc32(record, recordSize, historyJournalCrc32(&seq, sizeof(seq)));
+}
+
+bool historyHourlySegmentSlotValid(uint32_t seq, const void* record, size_t recordSize, uint32_t crc) {
+  return seq != 0 && seq != 0xFFFFFFFFUL &&
+         crc == historyHourlySegmentSlotCrc(seq, record, recordSize);
+}
+
+bool historyHourlyFileHeaderValid(const HistoryHourlyFileHeader& hdr,
+                                  size_t recordSize, uint32_t capacity) {
+  return hdr.magic == HISTORY_HOURLY_MAGIC &&
+         hdr.version == HISTORY_HOURLY_VERSION_V2 &&
+         hdr.recordSize == recordSize &&
+         hdr.capacity == capacity &&
+         hdr.head < hdr.capacity &&
+         hdr.count <= hdr.capacity &&
+         hdr.crc == historyJournalCrc32(&hdr, offsetof(HistoryHourlyFileHeader, crc));
+}
+
+int historyHourlyFilePickHeader(const HistoryHourlyFileHeader copies[HISTORY_HOURLY_HEADER_COPIES],
+                                size_t recordSize, uint32_t capacity) {
+  const bool a = historyHourlyFileHeaderValid(copies[0], recordSize, capacity);
+  const bool b = historyHourlyFileHeaderValid(copies[1], recordSize, capacity);
+  if (a && b) {
+    return (int32_t)(copies[1].generation - copies[0].generation) > 0 ? 1 : 0;
+  }
+  if (a) return 0;
+  if (b) return 1;
+  return -1;
+}
+
+uint32_t historyHourlyFileRecordCrc(const void* record, size_t recordSize) {
+  return historyJournalCrc32(record, recordSize);
+}
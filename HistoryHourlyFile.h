@@ -0,0 +1,106 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// On-disk format of the hourly tier (no Arduino dependencies, see
+// test/host/).
+//
+// Version 3: segment journal /histhourly/<segment as 8 hex digits>.log
+//   [HistoryHourlySegmentHeader][slot][slot]...
+// Every slot holds the record's write sequence, the record and a CRC32 of
+// both. Records are only ever appended to the newest segment, so an hourly
+// write copies at most the segment's last block, never the rest of the
+// year; the oldest segment is deleted once the newer ones hold a full ring.
+// A torn slot at the end of a segment fails its CRC and is dropped.
+//
+// Versions 1 and 2 kept the whole year in one fixed-slot ring file,
+// /history_hourly.bin, whose header at offset 0 was rewritten with every
+// record. They are migrated into segments on boot:
+//   v2: [header copy A][header copy B][slot 0]...[slot capacity-1], every
+//       slot a record and its CRC32; the valid copy with the newest
+//       generation is current
+//   v1: [header][record 0]...[record capacity-1]
+// The firmware no longer writes either version; only what migration needs
+// to read them is kept here.
+
+static const uint32_t HISTORY_HOURLY_MAGIC      = 0x485A4748; // 'HZGH'
+static const uint16_t HISTORY_HOURLY_VERSION    = 3;  // segment journal
+static const uint16_t HISTORY_HOURLY_VERSION_V2 = 2;  // ring file, A/B headers, CRC per slot
+static const uint16_t HISTORY_HOURLY_VERSION_V1 = 1;  // ring file, single header, no CRCs
+
+struct HistoryHourlySegmentHeader {
+  uint32_t magic;       // HISTORY_HOURLY_MAGIC
+  uint16_t version;     // HISTORY_HOURLY_VERSION
+  uint16_t recordSize;  // size of one record, without sequence and CRC
+  uint32_t segment;     // segment number, increases with every rotation
+  uint32_t crc;         // CRC32 of the fields above
+};
+
+void historyHourlySealSegmentHeader(HistoryHourlySegmentHeader& hdr, uint32_t segment, size_t recordSize);
+bool historyHourlySegmentHeaderValid(const HistoryHourlySegmentHeader& hdr, size_t recordSize);
+
+// Slot: uint32_t seq, the record, uint32_t CRC32 of both
+inline size_t historyHourlySegmentSlotSize(size_t recordSize) {
+  return sizeof(uint32_t) + recordSize + sizeof(uint32_t);
+}
+
+inline size_t historyHourlySegmentSlotOffset(size_t index, size_t recordSize) {
+  return sizeof(HistoryHourlySegmentHeader) + index * historyHourlySegmentSlotSize(recordSize);
+}
+
+uint32_t historyHourlySegmentSlotCrc(uint32_t seq, const void* record, size_t recordSize);
+// An erased or zero-filled slot never passes
+bool     historyHourlySegmentSlotValid(uint32_t seq, const void* record, size_t recordSize, uint32_t crc);
+
+// Whole slots in a segment file of fileSize bytes
+inline size_t historyHourlySegmentSlots(size_t fileSize, size_t recordSize) {
+  return fileSize > sizeof(HistoryHourlySegmentHeader)
+    ? (fileSize - sizeof(HistoryHourlySegmentHeader)) / historyHourlySegmentSlotSize(recordSize)
+    : 0;
+}
+
+// Version 2 header (two copies at offset 0)
+struct HistoryHourlyFileHeader {
+  uint32_t magic;       // HISTORY_HOURLY_MAGIC
+  uint16_t version;     // HISTORY_HOURLY_VERSION_V2
+  uint16_t recordSize;  // size of one record, without its CRC
+  uint32_t capacity;    // slots in the ring
+  uint32_t head;        // next slot to write
+  uint32_t count;       // valid records
+  uint32_t seq;         // records appended since the file was created
+  uint32_t generation;  // bumped on every header write
+  uint32_t crc;         // CRC32 of the fields above
+};
+
+// Version 1 header (at offset 0, records follow without CRCs)
+struct HistoryHourlyFileHeaderV1 {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t recordSize;
+  uint32_t capacity;
+  uint32_t head;
+  uint32_t count;
+  uint32_t seq;
+};
+
+static const size_t HISTORY_HOURLY_HEADER_COPIES = 2;
+
+inline size_t historyHourlyFileSlotSize(size_t recordSize) {
+  return recordSize + sizeof(uint32_t);
+}
+
+inline size_t historyHourlyFileSlotOffset(size_t slot, size_t recordSize) {
+  return HISTORY_HOURLY_HEADER_COPIES * sizeof(HistoryHourlyFileHeader) +
+         slot * historyHourlyFileSlotSize(recordSize);
+}
+
+bool historyHourlyFileHeaderValid(const HistoryHourlyFileHeader& hdr,
+                                  size_t recordSize, uint32_t capacity);
+
+// Returns the index (0/1) of the valid header copy with the newest
+// generation (wrap-safe), or -1 if neither copy is valid.
+int historyHourlyFilePickHeader(const HistoryHourlyFileHeader copies[HISTORY_HOURLY_HEADER_COPIES],
+                                size_t recordSize, uint32_t capacity);
+
+// CRC32 stored after each version 2 record
+uint32_t historyHourlyFileRecordCrc(const void* record, size_t recordSize);
@@ -0,0 +1,58 @@
+#include "HistoryJournal.h"
+
+#include <string.h>
+
+// Reflected CRC-32 (IEEE 802.3), bitwise to avoid a 1 KB table in DRAM; the
+// journal only checksums 16 bytes per record.
+uint32_t historyJournalCrc32(const void* data, size_t len, uint32_t crc) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  crc = ~crc;
+  while (len--) {
+    crc ^= *p++;
+    for (int k = 0; k < 8; ++k) {
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0U - (crc & 1U)));
+    }
+  }
+  return ~crc;
+}
+
+void historyJournalSealHeader(HistoryJournalSegmentHeader& hdr, uint32_t segment) {
+  hdr.magic      = HISTORY_JOURNAL_MAGIC;
+  hdr.version    = HISTORY_JOURNAL_VERSION;
+  hdr.recordSize = sizeof(HistoryJournalRecord);
+  hdr.segment    = segment;
+  hdr.crc        = historyJournalCrc32(&hdr, offsetof(HistoryJournalSegmentHeader, crc));
+}
+
+bool historyJournalHeaderValid(const HistoryJournalSegmentHeader& hdr) {
+  return hdr.magic == HISTORY_JOURNAL_MAGIC &&
+         (hdr.version == HISTORY_JOURNAL_VERSION || hdr.version == HISTORY_JOURNAL_VERSION_V1) &&
+         hdr.recordSize == sizeof(HistoryJournalRecord) &&
+         hdr.crc == historyJournalCrc32(&hdr, offsetof(HistoryJournalSegmentHeader, crc));
+}
+
+void historyJournalSealRecord(HistoryJournalRecord& rec) {
+  rec.crc = historyJournalCrc32(&rec, offsetof(HistoryJournalRecord, crc));
+}
+
+bool historyJournalRecordValid(const HistoryJournalRecord& rec) {
+  // An erased or zero-filled slot must never pass as a record
+  return rec.seq != 0 && rec.seq != 0xFFFFFFFFUL &&
+         rec.crc == historyJournalCrc32(&rec, offsetof(HistoryJournalRecord, crc));
+}
+
+size_t historyJournalScan(const uint8_t* data, size_t len, uint32_t& lastSeq,
+                          HistoryJournalVisitor visit, void* ctx) {
+  size_t used = 0;
+  while (len - used >= sizeof(HistoryJournalRecord)) {
+    HistoryJournalRecord rec;
+    memcpy(&rec, data + used, sizeof(rec));
+    if (!historyJournalRecordValid(rec)) break;
+
+    used += sizeof(rec);
+    if (rec.seq <= lastSeq) continue;
+    lastSeq = rec.seq;
+    if (visit) visit(rec, ctx);
+  }
+  return used;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Append-only history journal (on-disk format, no Arduino dependencies so the
+// replay logic can be exercised on the host, see test/host/).
+//
+// The 10-minute tier is persisted as a series of segment files. Each segment
+// starts with a HistoryJournalSegmentHeader followed by fixed-size records;
+// every record carries its own write sequence and CRC32, so a power loss while
+// appending can only ever lose the record that was being written.
+
+static const uint32_t HISTORY_JOURNAL_MAGIC      = 0x485A474A; // 'HZGJ'
+static const uint16_t HISTORY_JOURNAL_VERSION    = 2;  // payload is a packed HistorySample
+static const uint16_t HISTORY_JOURNAL_VERSION_V1 = 1;  // HistoryJournalPayloadV1, read-only
+
+struct HistoryJournalSegmentHeader {
+  uint32_t magic;       // HISTORY_JOURNAL_MAGIC
+  uint16_t version;     // HISTORY_JOURNAL_VERSION
+  uint16_t recordSize;  // sizeof(HistoryJournalRecord)
+  uint32_t segment;     // segment number, increases with every rotation
+  uint32_t crc;         // CRC32 of the fields above
+};
+
+// One 10-minute sample (20 bytes)
+struct HistoryJournalRecord {
+  uint32_t seq;          // gHistorySeq of the sample, strictly increasing
+  uint8_t  payload[12];  // v2: HistorySample as kept in RAM; v1: HistoryJournalPayloadV1
+  uint32_t crc;          // CRC32 of the fields above
+};
+
+// Version 1 payload (0.1 °C / 0.1 %RH), still replayed on boot
+struct HistoryJournalPayloadV1 {
+  uint32_t timestamp;  // unix time (seconds), 0 if unknown
+  int16_t  temp;       // 0.1 °C, INT16_MIN if missing
+  uint16_t hum;        // 0.1 %RH, 0xFFFF if missing
+  uint8_t  soil1;      // %, 0xFF if missing
+  uint8_t  soil2;      // %, 0xFF if missing
+  uint8_t  lights;     // bit0 light1, bit1 light2
+  uint8_t  reserved;
+};
+
+uint32_t historyJournalCrc32(const void* data, size_t len, uint32_t crc = 0);
+
+// Headers of both versions validate; check hdr.version before decoding payloads.
+void historyJournalSealHeader(HistoryJournalSegmentHeader& hdr, uint32_t segment);
+bool historyJournalHeaderValid(const HistoryJournalSegmentHeader& hdr);
+
+void historyJournalSealRecord(HistoryJournalRecord& rec);
+bool historyJournalRecordValid(const HistoryJournalRecord& rec);
+
+// Called for every record that is newer than the last one replayed.
+typedef void (*HistoryJournalVisitor)(const HistoryJournalRecord& rec, void* ctx);
+
+// Replays a block of records read from a segment (after its header).
+// Records whose seq is not newer than lastSeq (duplicates left behind by an
+// interrupted compaction) are skipped; lastSeq advances with every record
+// visited. Scanning stops at the first short or corrupt record.
+// Returns the number of bytes holding valid records; anything less than len
+// means the segment has a torn tail.
+size_t historyJournalScan(const uint8_t* data, size_t len, uint32_t& lastSeq,
+                          HistoryJournalVisitor visit, void* ctx);
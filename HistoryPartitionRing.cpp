@@ -0,0 +1,162 @@
+#include "HistoryPartitionRing.h"
+
+#include <string.h>
+
+HistoryPartitionRing::HistoryPartitionRing(HistoryFlash& flash)
+  : _flash(flash), _sectors(0), _head(0), _slot(0), _headSeq(0), _mountReads(0) {}
+
+bool HistoryPartitionRing::readBytes(size_t offset, void* out, size_t len) {
+  const uint8_t* map = _flash.mapped();
+  if (map) {
+    memcpy(out, map + offset, len);
+    return true;
+  }
+  return _flash.read(offset, out, len);
+}
+
+// Sequence of a sector with a valid header, 0 otherwise (erased or torn)
+bool HistoryPartitionRing::readHeader(size_t sector, uint32_t& seq) {
+  HistoryPartitionSectorHeader hdr;
+  _mountReads++;
+  seq = 0;
+  if (!readBytes(sectorOffset(sector), &hdr, sizeof(hdr))) return false;
+  if (hdr.magic != HISTORY_PARTITION_MAGIC ||
+      hdr.version != HISTORY_PARTITION_VERSION ||
+      hdr.recordSize != sizeof(HistoryJournalRecord) ||
+      hdr.sectorSeq == 0 || hdr.sectorSeq == 0xFFFFFFFFUL ||
+      hdr.crc != historyJournalCrc32(&hdr, offsetof(HistoryPartitionSectorHeader, crc))) {
+    return false;
+  }
+  seq = hdr.sectorSeq;
+  return true;
+}
+
+bool HistoryPartitionRing::slotErased(size_t sector, size_t slot) {
+  uint8_t raw[sizeof(HistoryJournalRecord)];
+  _mountReads++;
+  if (!readBytes(slotOffset(sector, slot), raw, sizeof(raw))) return false;
+  for (size_t i = 0; i < sizeof(raw); ++i) {
+    if (raw[i] != 0xFF) return false;
+  }
+  return true;
+}
+
+bool HistoryPartitionRing::mount() {
+  _sectors    = _flash.size() / HISTORY_PARTITION_SECTOR_SIZE;
+  _head       = 0;
+  _slot       = 0;
+  _headSeq    = 0;
+  _mountReads = 0;
+  if (_sectors < 2) return false;
+
+  // Going around the ring from the first valid sector (normally 0, or 1 if
+  // sector 0 was torn while starting it after the last sector), sequences
+  // grow by one per sector up to the head; the sectors after it are older,
+  // erased, or the one torn while starting.
+  size_t   base = 0;
+  uint32_t baseSeq;
+  while (base < 2 && !readHeader(base, baseSeq)) base++;
+  if (base < 2) {
+    size_t lo = base, hi = _sectors - 1;  // invariant: sector lo is at or before the head
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo + 1) / 2;
+      uint32_t seq;
+      if (readHeader(mid, seq) && seq - baseSeq == (uint32_t)(mid - base)) lo = mid;
+      else hi = mid - 1;
+    }
+    _head = lo;
+    readHeader(_head, _headSeq);
+  }
+
+  // Verify: neither of the next two sectors may be newer. A corrupt header
+  // inside the ring breaks the search; fall back to a linear scan then.
+  for (size_t step = 1; _headSeq != 0 && step <= 2 && step < _sectors; ++step) {
+    uint32_t seq;
+    if (readHeader((_head + step) % _sectors, seq) && (int32_t)(seq - _headSeq) > 0) _headSeq = 0;
+  }
+  if (_headSeq == 0) {
+    for (size_t k = 0; k < _sectors; ++k) {
+      uint32_t seq;
+      if (readHeader(k, seq) && (_headSeq == 0 || (int32_t)(seq - _headSeq) > 0)) {
+        _head    = k;
+        _headSeq = seq;
+      }
+    }
+  }
+  if (_headSeq == 0) return true;  // empty ring
+
+  // Slots are programmed in order: find the first erased one
+  size_t lo = 0, hi = HISTORY_PARTITION_SECTOR_RECORDS;
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (slotErased(_head, mid)) hi = mid;
+    else lo = mid + 1;
+  }
+  _slot = lo;
+  return true;
+}
+
+size_t HistoryPartitionRing::replay(uint32_t& lastSeq, HistoryJournalVisitor visit, void* ctx) {
+  if (_headSeq == 0) return 0;
+
+  size_t visited = 0;
+  for (size_t step = 1; step <= _sectors; ++step) {
+    const size_t sector = (_head + step) % _sectors;
+    uint32_t seq;
+    if (!readHeader(sector, seq) || (int32_t)(seq - _headSeq) > 0) continue;
+    // Sectors older than a full lap cannot be in the ring (stale after a format)
+    if ((uint32_t)(_headSeq - seq) >= _sectors) continue;
+
+    const size_t slots = (sector == _head) ? _slot : HISTORY_PARTITION_SECTOR_RECORDS;
+    for (size_t slot = 0; slot < slots; ++slot) {
+      HistoryJournalRecord rec;
+      if (!readBytes(slotOffset(sector, slot), &rec, sizeof(rec))) continue;
+      if (!historyJournalRecordValid(rec) || rec.seq <= lastSeq) continue;
+      lastSeq = rec.seq;
+      if (visit) visit(rec, ctx);
+      visited++;
+    }
+  }
+  return visited;
+}
+
+bool HistoryPartitionRing::startSector(size_t sector, uint32_t seq) {
+  if (!_flash.erase(sectorOffset(sector), HISTORY_PARTITION_SECTOR_SIZE)) return false;
+
+  HistoryPartitionSectorHeader hdr;
+  hdr.magic      = HISTORY_PARTITION_MAGIC;
+  hdr.version    = HISTORY_PARTITION_VERSION;
+  hdr.recordSize = sizeof(HistoryJournalRecord);
+  hdr.sectorSeq  = seq;
+  hdr.crc        = historyJournalCrc32(&hdr, offsetof(HistoryPartitionSectorHeader, crc));
+  if (!_flash.write(sectorOffset(sector), &hdr, sizeof(hdr))) return false;
+
+  _head    = sector;
+  _headSeq = seq;
+  _slot    = 0;
+  return true;
+}
+
+bool HistoryPartitionRing::append(const HistoryJournalRecord& rec) {
+  if (_sectors < 2) return false;
+  if (_headSeq == 0) {
+    if (!startSector(0, 1)) return false;
+  } else if (_slot >= HISTORY_PARTITION_SECTOR_RECORDS) {
+    uint32_t seq = _headSeq + 1;
+    if (seq == 0xFFFFFFFFUL) seq = 1;
+    if (!startSector((_head + 1) % _sectors, seq)) return false;
+  }
+
+  const size_t slot = _slot++;
+  return _flash.write(slotOffset(_head, slot), &rec, sizeof(rec));
+}
+
+bool HistoryPartitionRing::format() {
+  for (size_t k = 0; k < _sectors; ++k) {
+    if (!_flash.erase(sectorOffset(k), HISTORY_PARTITION_SECTOR_SIZE)) return false;
+  }
+  _head    = 0;
+  _slot    = 0;
+  _headSeq = 0;
+  return true;
+}
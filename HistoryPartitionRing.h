@@ -0,0 +1,90 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "HistoryJournal.h"
+
+// Journal backend on a raw data partition (no Arduino dependencies, see
+// test/host/ and scripts/bench-history-partition.cpp).
+//
+// The partition is a ring of 4 KB flash sectors. Each sector starts with a
+// HistoryPartitionSectorHeader carrying a sector sequence number that grows
+// by one per sector, followed by HistoryJournalRecord slots that are
+// programmed once, in order, and never rewritten (NOR flash: erase sets
+// 0xFF, writes only clear bits). Moving to the next sector erases it, so the
+// ring keeps at least (sectors - 1) * HISTORY_PARTITION_SECTOR_RECORDS
+// records and every sector is erased once per lap.
+//
+// mount() finds the head without reading the whole partition: a binary
+// search over sector sequence numbers locates the newest sector, a second
+// one over its slots finds the first erased slot.
+
+// Flash device under the ring
+class HistoryFlash {
+ public:
+  virtual ~HistoryFlash() {}
+  virtual size_t size() const = 0;
+  virtual bool   read(size_t offset, void* out, size_t len) = 0;
+  virtual bool   write(size_t offset, const void* data, size_t len) = 0;
+  virtual bool   erase(size_t offset, size_t len) = 0;  // sector aligned
+  // Read-only memory-mapped view of the whole device, nullptr if unavailable
+  virtual const uint8_t* mapped() { return nullptr; }
+};
+
+static const size_t   HISTORY_PARTITION_SECTOR_SIZE = 4096;
+static const uint32_t HISTORY_PARTITION_MAGIC       = 0x485A4750; // 'HZGP'
+static const uint16_t HISTORY_PARTITION_VERSION     = 1;
+
+struct HistoryPartitionSectorHeader {
+  uint32_t magic;       // HISTORY_PARTITION_MAGIC
+  uint16_t version;     // HISTORY_PARTITION_VERSION
+  uint16_t recordSize;  // sizeof(HistoryJournalRecord)
+  uint32_t sectorSeq;   // 1, 2, 3, ... in write order
+  uint32_t crc;         // CRC32 of the fields above
+};
+
+static const size_t HISTORY_PARTITION_SECTOR_RECORDS =
+  (HISTORY_PARTITION_SECTOR_SIZE - sizeof(HistoryPartitionSectorHeader)) / sizeof(HistoryJournalRecord);
+
+class HistoryPartitionRing {
+ public:
+  explicit HistoryPartitionRing(HistoryFlash& flash);
+
+  // Locates the head; false if the device holds fewer than two sectors.
+  bool mount();
+
+  // Replays every valid record with seq > lastSeq, oldest first (torn or
+  // erased slots are skipped). Returns the number of records visited.
+  size_t replay(uint32_t& lastSeq, HistoryJournalVisitor visit, void* ctx);
+
+  // Programs one record; a failed write still consumes its slot.
+  bool append(const HistoryJournalRecord& rec);
+
+  // Erases the whole partition.
+  bool format();
+
+  size_t   sectors() const { return _sectors; }
+  size_t   capacity() const { return _sectors > 1 ? (_sectors - 1) * HISTORY_PARTITION_SECTOR_RECORDS : 0; }
+  bool     empty() const { return _headSeq == 0; }
+  uint32_t headSeq() const { return _headSeq; }      // sector sequence of the head sector
+  size_t   headSector() const { return _head; }
+  size_t   headSlot() const { return _slot; }        // next slot to program in the head sector
+  size_t   mountReads() const { return _mountReads; } // header/slot probes made by mount()
+
+ private:
+  bool   readHeader(size_t sector, uint32_t& seq);
+  bool   slotErased(size_t sector, size_t slot);
+  bool   readBytes(size_t offset, void* out, size_t len);
+  bool   startSector(size_t sector, uint32_t seq);
+  size_t sectorOffset(size_t sector) const { return sector * HISTORY_PARTITION_SECTOR_SIZE; }
+  size_t slotOffset(size_t sector, size_t slot) const {
+    return sectorOffset(sector) + sizeof(HistoryPartitionSectorHeader) + slot * sizeof(HistoryJournalRecord);
+  }
+
+  HistoryFlash& _flash;
+  size_t        _sectors;
+  size_t        _head;
+  size_t        _slot;
+  uint32_t      _headSeq;  // 0: nothing written yet
+  size_t        _mountReads;
+};
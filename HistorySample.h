@@ -0,0 +1,24 @@
+#pragma once
+#include <stdint.h>
+
+// History sample as stored in RAM and in the history journal (12 bytes).
+// Resolution matches the sensors: 0.01 °C, 1 %RH, 1 % soil moisture.
+// Kept free of Arduino headers so the codec can be built on the host.
+struct HistorySample {
+  uint32_t timestamp; // unix time (seconds), 0 if unknown
+  int16_t  temp;      // 0.01 °C, HISTORY_SAMPLE_TEMP_NONE if missing
+  uint8_t  hum;       // %RH, HISTORY_SAMPLE_NONE if missing
+  uint8_t  soil1;     // %, HISTORY_SAMPLE_NONE if missing
+  uint8_t  soil2;     // %, HISTORY_SAMPLE_NONE if missing
+  uint8_t  relays;    // HISTORY_RELAY_* bits
+  uint16_t reserved;
+};
+static_assert(sizeof(HistorySample) == 12, "HistorySample must stay 12 bytes");
+
+constexpr int16_t HISTORY_SAMPLE_TEMP_NONE = INT16_MIN;
+constexpr uint8_t HISTORY_SAMPLE_NONE      = 0xFF;
+
+constexpr uint8_t HISTORY_RELAY_LIGHT1 = 0x01;
+constexpr uint8_t HISTORY_RELAY_LIGHT2 = 0x02;
+constexpr uint8_t HISTORY_RELAY_FAN    = 0x04;
+constexpr uint8_t HISTORY_RELAY_PUMP   = 0x08;
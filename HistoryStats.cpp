@@ -0,0 +1,97 @@
+#include "HistoryStats.h"
+
+#include <string.h>
+
+bool historyStatsValue(const HistorySample& s, int series, int32_t& out) {
+  switch (series) {
+    case HISTORY_STATS_TEMP:
+      if (s.temp == HISTORY_SAMPLE_TEMP_NONE) return false;
+      out = s.temp;
+      return true;
+    case HISTORY_STATS_HUM:
+      if (s.hum == HISTORY_SAMPLE_NONE) return false;
+      out = s.hum;
+      return true;
+    case HISTORY_STATS_SOIL1:
+      if (s.soil1 == HISTORY_SAMPLE_NONE) return false;
+      out = s.soil1;
+      return true;
+    case HISTORY_STATS_SOIL2:
+      if (s.soil2 == HISTORY_SAMPLE_NONE) return false;
+      out = s.soil2;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// ================= Block summaries =================
+
+void historySummaryReset(HistoryBlockSummary& summary) {
+  memset(&summary, 0, sizeof(summary));
+}
+
+void historySummaryAdd(HistoryBlockSummary& summary, const HistorySample& s) {
+  if (s.timestamp == 0) return;
+  if (summary.firstTs == 0 || s.timestamp < summary.firstTs) summary.firstTs = s.timestamp;
+  if (s.timestamp > summary.lastTs) summary.lastTs = s.timestamp;
+  summary.samples++;
+
+  for (int k = 0; k < HISTORY_STATS_SERIES_COUNT; ++k) {
+    int32_t v;
+    if (!historyStatsValue(s, k, v)) continue;
+    HistorySeriesSummary& a = summary.series[k];
+    if (a.count == 0 || v < a.min) a.min = (int16_t)v;
+    if (a.count == 0 || v > a.max) a.max = (int16_t)v;
+    a.sum += v;
+    a.count++;
+  }
+}
+
+bool historySummaryInside(const HistoryBlockSummary& summary, uint32_t from, uint32_t to) {
+  return summary.firstTs == 0 || (summary.firstTs >= from && summary.lastTs <= to);
+}
+
+bool historySummaryDisjoint(const HistoryBlockSummary& summary, uint32_t from, uint32_t to) {
+  return summary.firstTs == 0 || summary.lastTs < from || summary.firstTs > to;
+}
+
+// ================= Queries =================
+
+void historyStatsReset(HistoryStats& stats) {
+  memset(&stats, 0, sizeof(stats));
+}
+
+static void mergeSeries(HistorySeriesStats& a, int32_t min, int32_t max, int64_t sum, uint32_t count) {
+  if (count == 0) return;
+  if (a.count == 0 || min < a.min) a.min = min;
+  if (a.count == 0 || max > a.max) a.max = max;
+  a.sum   += sum;
+  a.count += count;
+}
+
+static void mergeRange(HistoryStats& stats, uint32_t firstTs, uint32_t lastTs) {
+  if (stats.firstTs == 0 || firstTs < stats.firstTs) stats.firstTs = firstTs;
+  if (lastTs > stats.lastTs) stats.lastTs = lastTs;
+}
+
+void historyStatsAddSample(HistoryStats& stats, const HistorySample& s, uint32_t from, uint32_t to) {
+  if (s.timestamp == 0 || s.timestamp < from || s.timestamp > to) return;
+  mergeRange(stats, s.timestamp, s.timestamp);
+  stats.samples++;
+  for (int k = 0; k < HISTORY_STATS_SERIES_COUNT; ++k) {
+    int32_t v;
+    if (historyStatsValue(s, k, v)) mergeSeries(stats.series[k], v, v, v, 1);
+  }
+}
+
+void historyStatsMerge(HistoryStats& stats, const HistoryBlockSummary& summary) {
+  if (summary.firstTs == 0) return;
+  mergeRange(stats, summary.firstTs, summary.lastTs);
+  stats.samples += summary.samples;
+  for (int k = 0; k < HISTORY_STATS_SERIES_COUNT; ++k) {
+    const HistorySeriesSummary& a = summary.series[k];
+    mergeSeries(stats.series[k], a.min, a.max, a.sum, a.count);
+  }
+  stats.blocksMerged++;
+}
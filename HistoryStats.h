@@ -0,0 +1,72 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "HistorySample.h"
+
+// Range aggregates (min/max/mean/count) over the 10-minute tier (no Arduino
+// dependencies, see test/host/).
+//
+// HistoryBlocks keeps one HistoryBlockSummary per block, updated as samples
+// are pushed. A query merges the summaries of blocks that lie entirely inside
+// the window and only scans the samples of the (at most two) blocks that
+// straddle its edges: O(blocks + block size) instead of O(samples).
+// Samples without a timestamp are not part of any window.
+
+enum HistoryStatsSeries : uint8_t {
+  HISTORY_STATS_TEMP  = 0,  // 0.01 °C
+  HISTORY_STATS_HUM   = 1,  // %RH
+  HISTORY_STATS_SOIL1 = 2,  // %
+  HISTORY_STATS_SOIL2 = 3,  // %
+  HISTORY_STATS_SERIES_COUNT
+};
+
+// Per-block aggregate of one series, in storage units (12 bytes)
+struct HistorySeriesSummary {
+  int16_t  min;
+  int16_t  max;
+  int32_t  sum;
+  uint16_t count;
+  uint16_t reserved;
+};
+
+struct HistoryBlockSummary {
+  uint32_t             firstTs;  // oldest / newest timestamp in the block, 0 if none
+  uint32_t             lastTs;
+  uint16_t             samples;  // timestamped samples
+  uint16_t             reserved;
+  HistorySeriesSummary series[HISTORY_STATS_SERIES_COUNT];
+};
+
+// Query result for one series
+struct HistorySeriesStats {
+  int32_t  min;
+  int32_t  max;
+  int64_t  sum;
+  uint32_t count;   // 0: no valid value in the window (min/max undefined)
+};
+
+struct HistoryStats {
+  uint32_t           firstTs;  // oldest / newest sample in the window, 0 if none
+  uint32_t           lastTs;
+  uint32_t           samples;  // samples in the window
+  HistorySeriesStats series[HISTORY_STATS_SERIES_COUNT];
+  // Work done by the query (for benchmarks and logs)
+  uint16_t           blocksMerged;
+  uint16_t           blocksScanned;
+};
+
+// Value of one series, false if the sample has no reading for it
+bool historyStatsValue(const HistorySample& s, int series, int32_t& out);
+
+void historySummaryReset(HistoryBlockSummary& summary);
+void historySummaryAdd(HistoryBlockSummary& summary, const HistorySample& s);
+
+void historyStatsReset(HistoryStats& stats);
+// Adds one sample if its timestamp lies in [from, to]
+void historyStatsAddSample(HistoryStats& stats, const HistorySample& s, uint32_t from, uint32_t to);
+void historyStatsMerge(HistoryStats& stats, const HistoryBlockSummary& summary);
+
+// Whether every timestamped sample of the block lies in [from, to] / none does
+bool historySummaryInside(const HistoryBlockSummary& summary, uint32_t from, uint32_t to);
+bool historySummaryDisjoint(const HistoryBlockSummary& summary, uint32_t from, uint32_t to);
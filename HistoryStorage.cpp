@@ -4,8 +4,19 @@
 
 #include "Greenhouse.h"
 #include "HistoryStorage.h"
+#include "HistoryTiers.h"
+#include "HistoryJournal.h"
+#include "HistoryHourlyFile.h"
+#include "FlashWear.h"
 
-// Path on LittleFS where the 7-day ring buffer is stored.
+#if HISTORY_JOURNAL_PARTITION
+#include <esp_idf_version.h>
+#include <esp_partition.h>
+#include "HistoryPartitionRing.h"
+#endif
+
+// Legacy single-file snapshot of the 7-day ring buffer (read once, then
+// migrated into the journal and removed).
 static const char* HISTORY_FILE_PATH = "/history.bin";
 
 // Simple header to sanity-check the on-disk layout.
@@ -13,19 +24,165 @@ struct HistoryFileHeader {
   uint32_t magic;            // identifies the file
   uint16_t version;          // layout version
   uint16_t reserved;         // padding / future use
-  uint32_t historySize;      // must match HISTORY_SIZE
+  uint32_t historySize;      // HISTORY_SIZE of the firmware that wrote it
   uint32_t historyIntervalMs; // must match HISTORY_INTERVAL_MS
 };
 
+// Unpacked sample layout of version 1 snapshots
+struct HistorySampleV1 {
+  time_t timestamp;
+  float  temp;
+  float  hum;
+  int    soil1;
+  int    soil2;
+  bool   light1;
+  bool   light2;
+};
+
 // Chosen to be clearly non-accidental in flash.
-static const uint32_t HISTORY_MAGIC   = 0x485A4737; // 'HZG7'
-static const uint16_t HISTORY_VERSION = 1;
+static const uint32_t HISTORY_MAGIC      = 0x485A4737; // 'HZG7'
+static const uint16_t HISTORY_VERSION_V1 = 1;
+static const uint32_t HISTORY_V1_MAX_SIZE = 4096;
+
+// Journal of 10-minute samples: /histlog/<segment as 8 hex digits>.log, one
+// day of records per segment. Only new samples are appended; segments whose
+// records have all left the 10-minute window are deleted (compaction).
+static const char*  HISTORY_JOURNAL_DIR             = "/histlog";
+static const size_t HISTORY_JOURNAL_SEGMENT_RECORDS = 144;
+static const size_t HISTORY_JOURNAL_MAX_SEGMENTS    = HISTORY_SIZE / HISTORY_JOURNAL_SEGMENT_RECORDS + 4;
+static const size_t HISTORY_JOURNAL_READ_RECORDS    = 16;
+static const unsigned long HISTORY_JOURNAL_RETRY_MS = 60UL * 1000UL;
+
+struct JournalSegment {
+  uint32_t id;
+  uint16_t records;   // valid records in the segment
+  uint16_t version;   // HISTORY_JOURNAL_VERSION(_V1)
+};
+
+static JournalSegment sSegments[HISTORY_JOURNAL_MAX_SEGMENTS];
+static size_t         sSegmentCount     = 0;
+static size_t         sJournalRecords   = 0;     // valid records across all segments
+static bool           sActiveWritable   = false; // last segment can take appends
+static uint32_t       sJournaledSeq     = 0;     // newest gHistorySeq on flash
+static unsigned long  sJournalRetryAtMs = 0;
+
+// While the flash write budget is spent, new samples stay in RAM and are
+// appended in one batch (one file copy instead of one per sample), but
+// never more than this many.
+static const uint32_t HISTORY_JOURNAL_MAX_DEFERRED = 36;  // 6 hours
+static bool           sJournalDeferred = false;
 
 static bool         sHistoryStorageReady = false;
-static unsigned long sLastHistorySaveMs  = 0;
 
-// Forward declaration
-static void saveHistoryNow();
+#if HISTORY_JOURNAL_PARTITION
+// Raw partition backend: sector ring read through a memory-mapped view
+static const char* HISTORY_PARTITION_LABEL = "history";
+
+class EspPartitionFlash : public HistoryFlash {
+ public:
+  EspPartitionFlash() : _part(nullptr), _map(nullptr) {}
+
+  bool begin(const char* label) {
+    _part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!_part) return false;
+#if ESP_IDF_VERSION_MAJOR >= 5
+    if (esp_partition_mmap(_part, 0, _part->size, ESP_PARTITION_MMAP_DATA, &_map, &_handle) != ESP_OK) {
+      _map = nullptr;
+    }
+#else
+    if (esp_partition_mmap(_part, 0, _part->size, SPI_FLASH_MMAP_DATA, &_map, &_handle) != ESP_OK) {
+      _map = nullptr;
+    }
+#endif
+    return true;
+  }
+
+  size_t size() const override { return _part ? _part->size : 0; }
+
+  bool read(size_t offset, void* out, size_t len) override {
+    return esp_partition_read(_part, offset, out, len) == ESP_OK;
+  }
+
+  bool write(size_t offset, const void* data, size_t len) override {
+    return esp_partition_write(_part, offset, data, len) == ESP_OK;
+  }
+
+  bool erase(size_t offset, size_t len) override {
+    return esp_partition_erase_range(_part, offset, len) == ESP_OK;
+  }
+
+  const uint8_t* mapped() override { return static_cast<const uint8_t*>(_map); }
+
+ private:
+  const esp_partition_t* _part;
+  const void*            _map;
+#if ESP_IDF_VERSION_MAJOR >= 5
+  esp_partition_mmap_handle_t _handle;
+#else
+  spi_flash_mmap_handle_t     _handle;
+#endif
+};
+
+static EspPartitionFlash    sPartitionFlash;
+static HistoryPartitionRing sPartitionRing(sPartitionFlash);
+static bool                 sUsePartition = false;
+#endif
+
+// Hourly rollup tier: segment journal, one record appended per hour (format
+// in HistoryHourlyFile.h). Segments hold 30 days; the oldest is deleted once
+// the newer ones hold HISTORY_HOURLY_SIZE records. The version 1/2 ring file
+// is migrated on boot.
+static const char*  HISTORY_HOURLY_DIR             = "/histhourly";
+static const char*  HISTORY_HOURLY_PATH            = "/history_hourly.bin";  // v1/v2 ring file
+static const char*  HISTORY_HOURLY_TMP_PATH        = "/history_hourly.tmp";  // interrupted v1 -> v2 migration
+static const size_t HISTORY_HOURLY_SEGMENT_RECORDS = 720;
+static const size_t HISTORY_HOURLY_MAX_SEGMENTS    = HISTORY_HOURLY_SIZE / HISTORY_HOURLY_SEGMENT_RECORDS + 2;
+
+struct __attribute__((packed)) HourlySlot {
+  uint32_t            seq;
+  HistoryHourlyRecord rec;
+  uint32_t            crc;
+};
+static_assert(sizeof(HourlySlot) == sizeof(uint32_t) + sizeof(HistoryHourlyRecord) + sizeof(uint32_t),
+              "HourlySlot must match historyHourlySegmentSlotSize()");
+
+// Version 2 ring file slot
+struct __attribute__((packed)) HourlySlotV2 {
+  HistoryHourlyRecord rec;
+  uint32_t            crc;
+};
+
+static JournalSegment sHourlySegments[HISTORY_HOURLY_MAX_SEGMENTS];
+static size_t         sHourlySegmentCount    = 0;
+static size_t         sHourlyRecords         = 0;      // valid records across all segments
+static uint32_t       sHourlySeq             = 0;      // sequence of the newest record on flash
+static bool           sHourlyActiveWritable  = false;  // last segment can take appends
+static bool           sHistoryHourlyWritable = true;   // false while a ring file awaits migration
+
+// Hourly records whose append failed, retried every HISTORY_HOURLY_RETRY_MS
+static const size_t           HISTORY_HOURLY_MAX_PENDING = 24;
+static const unsigned long    HISTORY_HOURLY_RETRY_MS    = 60UL * 1000UL;
+static HistoryHourlyRecord    sHourlyPending[HISTORY_HOURLY_MAX_PENDING];
+static size_t                 sHourlyPendingCount = 0;
+static unsigned long          sHourlyRetryAtMs    = 0;
+
+// Small read-through cache so sequential scans do not reopen a segment per record
+static const size_t  HOURLY_CACHE_RECORDS = 32;
+static HourlySlot    sHourlyCache[HOURLY_CACHE_RECORDS];
+static uint32_t      sHourlyCacheSegment = 0;
+static size_t        sHourlyCacheFirst   = 0;
+static size_t        sHourlyCacheCount   = 0;
+
+// Forward declarations
+static void initHourlyHistory();
+static void pushReplayedSample(const HistorySample& s);
+static void replayHistoryJournal();
+static bool loadLegacyHistoryFile();
+static void appendHistoryJournal();
+static void flushHourlyPending(bool force);
+#if HISTORY_JOURNAL_PARTITION
+static bool initPartitionJournal();
+#endif
 
 void initHistoryStorage() {
   // Make sure LittleFS is mounted. This is idempotent and will
@@ -36,27 +193,433 @@ void initHistoryStorage() {
   }
 
   sHistoryStorageReady = true;
+  initHourlyHistory();
+
+#if HISTORY_JOURNAL_PARTITION
+  if (initPartitionJournal()) {
+    Serial.printf("[HISTFS] Loaded %u historical samples from the history partition (%u compressed blocks, %u bytes).\n",
+                  (unsigned)historyRingCount(), (unsigned)historyRingSealedBlocks(),
+                  (unsigned)historyRingArenaUsed());
+    return;
+  }
+#endif
+
+  if (!LittleFS.exists(HISTORY_JOURNAL_DIR)) {
+    LittleFS.mkdir(HISTORY_JOURNAL_DIR);
+  }
+  replayHistoryJournal();
+
+  // One-time migration of the old full-snapshot file
+  if (sSegmentCount == 0 && loadLegacyHistoryFile()) {
+    sJournaledSeq = 0;
+    appendHistoryJournal();
+    if (sJournaledSeq == gHistorySeq) {
+      LittleFS.remove(HISTORY_FILE_PATH);
+      Serial.println("[HISTFS] Migrated legacy history file into the journal.");
+    }
+  }
+
+  Serial.printf("[HISTFS] Loaded %u historical samples from LittleFS (%u compressed blocks, %u bytes).\n",
+                (unsigned)historyRingCount(), (unsigned)historyRingSealedBlocks(),
+                (unsigned)historyRingArenaUsed());
+}
+
+// ================= Journal =================
+
+// Segment files of the 10-minute journal and of the hourly tier are named
+// <dir>/<segment as 8 hex digits>.log
+static void segmentPath(char* out, size_t cap, const char* dir, uint32_t id) {
+  snprintf(out, cap, "%s/%08lx.log", dir, (unsigned long)id);
+}
+
+static void journalSegmentPath(char* out, size_t cap, uint32_t id) {
+  segmentPath(out, cap, HISTORY_JOURNAL_DIR, id);
+}
+
+static bool parseJournalSegmentName(const char* name, uint32_t& id) {
+  const char* base = strrchr(name, '/');
+  base = base ? base + 1 : name;
+  if (strlen(base) != 12 || strcmp(base + 8, ".log") != 0) return false;
+  char* end = nullptr;
+  id = strtoul(base, &end, 16);
+  return end == base + 8;
+}
+
+static void removeSegment(const char* dir, uint32_t id) {
+  char path[32];
+  segmentPath(path, sizeof(path), dir, id);
+  LittleFS.remove(path);
+}
+
+static void removeJournalSegment(uint32_t id) {
+  removeSegment(HISTORY_JOURNAL_DIR, id);
+}
+
+// Collects the segment ids in dirPath in ascending order, keeping the newest
+// ones if there are more files than maxSegments.
+static bool listSegmentsOnce(const char* dirPath, JournalSegment* segs, size_t maxSegments, size_t& count) {
+  count        = 0;
+  bool dropped = false;
+
+  File dir = LittleFS.open(dirPath);
+  if (!dir || !dir.isDirectory()) return false;
+
+  for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+    uint32_t id;
+    const bool ok = parseJournalSegmentName(f.name(), id);
+    f.close();
+    if (!ok) continue;
+
+    size_t pos = count;
+    while (pos > 0 && segs[pos - 1].id > id) pos--;
+    if (count == maxSegments) {
+      dropped = true;
+      if (pos == 0) continue;
+      memmove(&segs[0], &segs[1], (pos - 1) * sizeof(JournalSegment));
+      pos--;
+    } else {
+      memmove(&segs[pos + 1], &segs[pos], (count - pos) * sizeof(JournalSegment));
+      count++;
+    }
+    segs[pos].id      = id;
+    segs[pos].records = 0;
+    segs[pos].version = 0;
+  }
+  dir.close();
+  return dropped;
+}
+
+static void listSegments(const char* dirPath, JournalSegment* segs, size_t maxSegments, size_t& count) {
+  if (!listSegmentsOnce(dirPath, segs, maxSegments, count)) return;
+
+  // Remove the surplus (oldest) segments, then list again
+  const uint32_t oldestKept = segs[0].id;
+  File dir = LittleFS.open(dirPath);
+  for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+    uint32_t id;
+    const bool ok = parseJournalSegmentName(f.name(), id);
+    f.close();
+    if (ok && id < oldestKept) removeSegment(dirPath, id);
+  }
+  dir.close();
+  listSegmentsOnce(dirPath, segs, maxSegments, count);
+}
+
+static void pushReplayedSample(const HistorySample& s) {
+  historyRingPush(s);
+}
+
+static void applyJournalRecord(const HistoryJournalRecord& rec, void* ctx) {
+  const uint16_t version = *static_cast<const uint16_t*>(ctx);
+  if (version == HISTORY_JOURNAL_VERSION) {
+    HistorySample s;
+    memcpy(&s, rec.payload, sizeof(s));
+    pushReplayedSample(s);
+    return;
+  }
+
+  // Version 1: 0.1 °C / 0.1 %RH fields, repacked into the current layout
+  HistoryJournalPayloadV1 v1;
+  memcpy(&v1, rec.payload, sizeof(v1));
+  pushReplayedSample(historyPackSample((time_t)v1.timestamp,
+                                       historyDecodeTemp(v1.temp),
+                                       historyDecodeHum(v1.hum),
+                                       historyDecodeSoil(v1.soil1),
+                                       historyDecodeSoil(v1.soil2),
+                                       ((v1.lights & 0x01) ? HISTORY_RELAY_LIGHT1 : 0) |
+                                       ((v1.lights & 0x02) ? HISTORY_RELAY_LIGHT2 : 0)));
+}
+
+// Replays one segment into the ring; returns false if its header is invalid.
+// `torn` reports a short or corrupt record before the end of the file.
+static bool replayJournalSegment(JournalSegment& seg, uint32_t& lastSeq, bool& torn) {
+  char path[32];
+  journalSegmentPath(path, sizeof(path), seg.id);
+  torn = false;
+
+  File f = LittleFS.open(path, "r");
+  if (!f) return false;
+
+  HistoryJournalSegmentHeader hdr;
+  if (f.read(reinterpret_cast<uint8_t*>(&hdr), sizeof(hdr)) != sizeof(hdr) ||
+      !historyJournalHeaderValid(hdr) || hdr.segment != seg.id) {
+    f.close();
+    return false;
+  }
+  seg.version = hdr.version;
+
+  uint8_t block[HISTORY_JOURNAL_READ_RECORDS * sizeof(HistoryJournalRecord)];
+  size_t  records = 0;
+  for (;;) {
+    const size_t got = f.read(block, sizeof(block));
+    if (got == 0) break;
+    const size_t used = historyJournalScan(block, got, lastSeq, applyJournalRecord, &seg.version);
+    records += used / sizeof(HistoryJournalRecord);
+    if (used < got) {
+      torn = true;
+      break;
+    }
+  }
+  f.close();
+
+  seg.records = (uint16_t)min(records, HISTORY_JOURNAL_SEGMENT_RECORDS);
+  return true;
+}
+
+static void replayHistoryJournal() {
+  listSegments(HISTORY_JOURNAL_DIR, sSegments, HISTORY_JOURNAL_MAX_SEGMENTS, sSegmentCount);
+
+  historyRingClear();
+  sJournalRecords = 0;
+
+  uint32_t lastSeq  = 0;
+  bool     lastTorn = false;
+  size_t   kept     = 0;
+  for (size_t i = 0; i < sSegmentCount; ++i) {
+    JournalSegment seg = sSegments[i];
+    bool torn = false;
+    if (!replayJournalSegment(seg, lastSeq, torn)) {
+      Serial.printf("[HISTFS] Dropping journal segment %08lx (bad header).\n", (unsigned long)seg.id);
+      removeJournalSegment(seg.id);
+      continue;
+    }
+    if (torn) {
+      Serial.printf("[HISTFS] Journal segment %08lx has a torn tail after %u records.\n",
+                    (unsigned long)seg.id, (unsigned)seg.records);
+    }
+    sSegments[kept++] = seg;
+    sJournalRecords += seg.records;
+    lastTorn = torn;
+  }
+  sSegmentCount = kept;
+
+  // A torn tail cannot be appended to, and version 1 segments are only read
+  // until compaction removes them; either way the next sample opens a new segment.
+  sActiveWritable = sSegmentCount > 0 && !lastTorn &&
+                    sSegments[sSegmentCount - 1].version == HISTORY_JOURNAL_VERSION &&
+                    sSegments[sSegmentCount - 1].records < HISTORY_JOURNAL_SEGMENT_RECORDS;
+
+  gHistorySeq   = lastSeq;
+  sJournaledSeq = lastSeq;
+}
+
+// Deletes the oldest segments once the newer ones hold a full HISTORY_SIZE window.
+static void compactHistoryJournal() {
+  while (sSegmentCount > 1 &&
+         (sJournalRecords - sSegments[0].records >= HISTORY_SIZE ||
+          sSegmentCount >= HISTORY_JOURNAL_MAX_SEGMENTS)) {
+    removeJournalSegment(sSegments[0].id);
+    sJournalRecords -= sSegments[0].records;
+    memmove(&sSegments[0], &sSegments[1], (sSegmentCount - 1) * sizeof(JournalSegment));
+    sSegmentCount--;
+  }
+}
+
+static bool rotateHistoryJournal() {
+  compactHistoryJournal();
+
+  const uint32_t id = sSegmentCount ? sSegments[sSegmentCount - 1].id + 1 : 1;
+  char path[32];
+  journalSegmentPath(path, sizeof(path), id);
+
+  File f = LittleFS.open(path, "w");
+  if (!f) return false;
+  HistoryJournalSegmentHeader hdr;
+  historyJournalSealHeader(hdr, id);
+  const bool ok = f.write(reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr)) == sizeof(hdr);
+  f.close();
+  if (!ok) {
+    LittleFS.remove(path);
+    return false;
+  }
+
+  FlashWearCost cost = {};
+  flashWearAddFsWrite(cost, 0, 0, sizeof(hdr));
+  flashWearAddFsCommit(cost);
+  flashWearCharge(FLASH_WEAR_HISTORY_JOURNAL, cost);
+
+  sSegments[sSegmentCount].id      = id;
+  sSegments[sSegmentCount].records = 0;
+  sSegments[sSegmentCount].version = HISTORY_JOURNAL_VERSION;
+  sSegmentCount++;
+  sActiveWritable = true;
+  return true;
+}
+
+static_assert(sizeof(HistorySample) == sizeof(((HistoryJournalRecord*)nullptr)->payload),
+              "journal payload must hold one HistorySample");
+
+// Flash cost of appending records to a journal segment that holds `records`
+static FlashWearCost journalAppendCost(size_t records, size_t appended) {
+  FlashWearCost cost = {};
+#if HISTORY_JOURNAL_PARTITION
+  if (sUsePartition) {
+    cost.bytes = (uint32_t)(appended * sizeof(HistoryJournalRecord));
+    return cost;
+  }
+#endif
+  const uint32_t size = (uint32_t)(sizeof(HistoryJournalSegmentHeader) + records * sizeof(HistoryJournalRecord));
+  flashWearAddFsWrite(cost, size, size, (uint32_t)(appended * sizeof(HistoryJournalRecord)));
+  flashWearAddFsCommit(cost);
+  return cost;
+}
+
+static void encodeJournalRecord(const HistorySample& s, uint32_t seq, HistoryJournalRecord& rec) {
+  rec.seq = seq;
+  memcpy(rec.payload, &s, sizeof(s));
+  historyJournalSealRecord(rec);
+}
+
+// Appends every sample newer than sJournaledSeq (normally exactly one).
+static void appendHistoryJournal() {
+  const size_t count = historyRingCount();
+  if (gHistorySeq - sJournaledSeq > count) {
+    sJournaledSeq = gHistorySeq - count;  // older samples already left the ring
+  }
+
+#if HISTORY_JOURNAL_PARTITION
+  if (sUsePartition) {
+    while (sJournaledSeq != gHistorySeq) {
+      const uint32_t seq = sJournaledSeq + 1;
+      HistorySample s;
+      if (historyRingRead(count - (size_t)(gHistorySeq - seq) - 1, s)) {
+        HistoryJournalRecord rec;
+        encodeJournalRecord(s, seq, rec);
+        const bool ok = sPartitionRing.append(rec);
+        FlashWearCost cost = {};
+        cost.bytes = sizeof(rec);
+        if (sPartitionRing.headSlot() == 1) {  // started (erased) a new sector
+          cost.bytes += sizeof(HistoryPartitionSectorHeader);
+          cost.erases = 1;
+        }
+        flashWearCharge(FLASH_WEAR_HISTORY_JOURNAL, cost);
+        if (!ok) {
+          // The slot is used up either way; the next attempt takes the next one
+          Serial.println("[HISTFS] Failed to append history partition record.");
+          sJournalRetryAtMs = millis() + HISTORY_JOURNAL_RETRY_MS;
+          return;
+        }
+      }
+      sJournaledSeq = seq;
+    }
+    return;
+  }
+#endif
+
+  while (sJournaledSeq != gHistorySeq) {
+    if (!sActiveWritable || sSegments[sSegmentCount - 1].records >= HISTORY_JOURNAL_SEGMENT_RECORDS) {
+      if (!rotateHistoryJournal()) {
+        Serial.println("[HISTFS] Failed to start journal segment.");
+        sJournalRetryAtMs = millis() + HISTORY_JOURNAL_RETRY_MS;
+        return;
+      }
+    }
+
+    JournalSegment& seg = sSegments[sSegmentCount - 1];
+    const uint16_t  recordsBefore = seg.records;
+    char path[32];
+    journalSegmentPath(path, sizeof(path), seg.id);
+    File f = LittleFS.open(path, "a");
+    if (!f) {
+      Serial.println("[HISTFS] Failed to open journal segment for append.");
+      sJournalRetryAtMs = millis() + HISTORY_JOURNAL_RETRY_MS;
+      return;
+    }
+
+    while (sJournaledSeq != gHistorySeq && seg.records < HISTORY_JOURNAL_SEGMENT_RECORDS) {
+      const uint32_t seq     = sJournaledSeq + 1;
+      const size_t   ordinal = count - (size_t)(gHistorySeq - seq) - 1;
+
+      HistorySample s;
+      if (!historyRingRead(ordinal, s)) {
+        sJournaledSeq = seq;  // unreadable block; nothing to persist for this sample
+        continue;
+      }
+      HistoryJournalRecord rec;
+      encodeJournalRecord(s, seq, rec);
+      if (f.write(reinterpret_cast<const uint8_t*>(&rec), sizeof(rec)) != sizeof(rec)) {
+        // Whatever reached flash is a torn record now; continue in a new segment
+        Serial.println("[HISTFS] Failed to append journal record.");
+        sActiveWritable   = false;
+        sJournalRetryAtMs = millis() + HISTORY_JOURNAL_RETRY_MS;
+        f.close();
+        return;
+      }
+      seg.records++;
+      sJournalRecords++;
+      sJournaledSeq = seq;
+    }
+    f.close();
+    flashWearCharge(FLASH_WEAR_HISTORY_JOURNAL, journalAppendCost(recordsBefore, seg.records - recordsBefore));
+  }
+}
+
+#if HISTORY_JOURNAL_PARTITION
+// Mounts the history partition and replays it into the ring. An empty
+// partition takes over the LittleFS journal (if any), which is then removed.
+static bool initPartitionJournal() {
+  if (!sPartitionFlash.begin(HISTORY_PARTITION_LABEL) || !sPartitionRing.mount()) {
+    Serial.println("[HISTFS] No usable 'history' partition; using the LittleFS journal.");
+    return false;
+  }
+  flashWearSetPool(FLASH_WEAR_HISTORY_JOURNAL, FLASH_WEAR_POOL_PARTITION);
+  flashWearSetPoolSize(FLASH_WEAR_POOL_PARTITION, (uint32_t)sPartitionFlash.size());
+  if (sPartitionRing.capacity() < HISTORY_SIZE) {
+    Serial.printf("[HISTFS] History partition holds %u of %u samples; older ones are lost on reboot.\n",
+                  (unsigned)sPartitionRing.capacity(), (unsigned)HISTORY_SIZE);
+  }
+
+  const unsigned long startMs = millis();
+  historyRingClear();
+  uint32_t lastSeq = 0;
+  uint16_t version = HISTORY_JOURNAL_VERSION;
+  sPartitionRing.replay(lastSeq, applyJournalRecord, &version);
+  gHistorySeq   = lastSeq;
+  sJournaledSeq = lastSeq;
+  sUsePartition = true;
+  Serial.printf("[HISTFS] History partition: %u sectors, head %u/%u, %u probes, replay %lu ms.\n",
+                (unsigned)sPartitionRing.sectors(), (unsigned)sPartitionRing.headSector(),
+                (unsigned)sPartitionRing.headSlot(), (unsigned)sPartitionRing.mountReads(),
+                millis() - startMs);
 
+  if (sPartitionRing.empty() && LittleFS.exists(HISTORY_JOURNAL_DIR)) {
+    replayHistoryJournal();
+    if (gHistorySeq > 0) {
+      sJournaledSeq = 0;
+      appendHistoryJournal();
+      if (sJournaledSeq == gHistorySeq) {
+        for (size_t i = 0; i < sSegmentCount; ++i) removeJournalSegment(sSegments[i].id);
+        sSegmentCount = 0;
+        Serial.println("[HISTFS] Moved the LittleFS journal into the history partition.");
+      }
+    }
+  }
+  return true;
+}
+#endif
+
+// Reads a version 1 snapshot (unpacked samples, any ring size) into the ring
+// in chronological order; true if samples were loaded.
+static bool loadLegacyHistoryFile() {
   File f = LittleFS.open(HISTORY_FILE_PATH, "r");
   if (!f) {
-    Serial.println("[HISTFS] No existing history file; starting with empty 7-day buffer.");
-    return;
+    return false;
   }
 
   HistoryFileHeader hdr;
   if (f.readBytes(reinterpret_cast<char*>(&hdr), sizeof(hdr)) != sizeof(hdr)) {
     Serial.println("[HISTFS] Failed to read history header; ignoring file.");
     f.close();
-    return;
+    return false;
   }
 
   if (hdr.magic != HISTORY_MAGIC ||
-      hdr.version != HISTORY_VERSION ||
-      hdr.historySize != static_cast<uint32_t>(HISTORY_SIZE) ||
+      hdr.version != HISTORY_VERSION_V1 ||
+      hdr.historySize == 0 || hdr.historySize > HISTORY_V1_MAX_SIZE ||
       hdr.historyIntervalMs != static_cast<uint32_t>(HISTORY_INTERVAL_MS)) {
     Serial.println("[HISTFS] History header mismatch (magic/version/size/interval); ignoring file.");
     f.close();
-    return;
+    return false;
   }
 
   size_t idx  = 0;
@@ -65,105 +628,484 @@ void initHistoryStorage() {
   if (f.readBytes(reinterpret_cast<char*>(&idx), sizeof(idx)) != sizeof(idx)) {
     Serial.println("[HISTFS] Failed to read history index; ignoring file.");
     f.close();
-    return;
+    return false;
   }
 
   if (f.readBytes(reinterpret_cast<char*>(&full), sizeof(full)) != sizeof(full)) {
     Serial.println("[HISTFS] Failed to read history full flag; ignoring file.");
     f.close();
-    return;
+    return false;
   }
 
-  const size_t bufBytes = sizeof(gHistoryBuf);
-  if (f.readBytes(reinterpret_cast<char*>(gHistoryBuf), bufBytes) != static_cast<int>(bufBytes)) {
-    Serial.println("[HISTFS] Failed to read history buffer; ignoring file.");
+  // Basic sanity on metadata
+  const size_t v1Size = hdr.historySize;
+  if (idx > v1Size) {
+    Serial.println("[HISTFS] Stored index out of range; ignoring file.");
     f.close();
-    return;
+    return false;
   }
-
-  // Basic sanity on metadata
-  if (idx > HISTORY_SIZE) {
-    Serial.println("[HISTFS] Stored index out of range; resetting to 0.");
+  if (idx == v1Size) {
     idx  = 0;
-    full = false;
+    full = true;
   }
 
-  gHistoryIndex = idx;
-  gHistoryFull  = full && (gHistoryIndex <= HISTORY_SIZE);
+  const size_t dataOffset = f.position();
+  const size_t count      = full ? v1Size : idx;
+  const size_t first      = full ? idx : 0;
 
-  f.close();
-
-  const size_t count = gHistoryFull ? HISTORY_SIZE : gHistoryIndex;
-  Serial.print("[HISTFS] Loaded ");
-  Serial.print(count);
-  Serial.println(" historical samples from LittleFS.");
+  historyRingClear();
+  for (size_t i = 0; i < count; ++i) {
+    const size_t slot = (first + i) % v1Size;
+    HistorySampleV1 old;
+    if ((i == 0 || slot == 0) && !f.seek(dataOffset + slot * sizeof(HistorySampleV1))) break;
+    if (f.readBytes(reinterpret_cast<char*>(&old), sizeof(old)) != sizeof(old)) {
+      Serial.println("[HISTFS] History file is truncated; keeping the samples read so far.");
+      break;
+    }
+    pushReplayedSample(historyPackSample(old.timestamp, old.temp, old.hum, old.soil1, old.soil2,
+                                         (old.light1 ? HISTORY_RELAY_LIGHT1 : 0) |
+                                         (old.light2 ? HISTORY_RELAY_LIGHT2 : 0)));
+    gHistorySeq = static_cast<uint32_t>(i + 1);
+  }
 
-  // Start save timer from "now" so we do not immediately re-write.
-  sLastHistorySaveMs = millis();
+  f.close();
+  return gHistorySeq > 0;
 }
 
-static void saveHistoryNow() {
+void historyStorageLoop() {
   if (!sHistoryStorageReady) {
     return;
   }
+  flushHourlyPending(false);
 
-  File f = LittleFS.open(HISTORY_FILE_PATH, "w");
-  if (!f) {
-    Serial.println("[HISTFS] Failed to open history file for write.");
+  if (sJournaledSeq == gHistorySeq) {
     return;
   }
 
-  HistoryFileHeader hdr;
-  hdr.magic           = HISTORY_MAGIC;
-  hdr.version         = HISTORY_VERSION;
-  hdr.reserved        = 0;
-  hdr.historySize     = static_cast<uint32_t>(HISTORY_SIZE);
-  hdr.historyIntervalMs = static_cast<uint32_t>(HISTORY_INTERVAL_MS);
+  // Back off after a failed write instead of retrying on every loop()
+  if (sJournalRetryAtMs != 0 && (long)(millis() - sJournalRetryAtMs) < 0) {
+    return;
+  }
 
-  if (f.write(reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr)) != sizeof(hdr)) {
-    Serial.println("[HISTFS] Failed to write history header.");
-    f.close();
+  const uint32_t pending = gHistorySeq - sJournaledSeq;
+  if (pending < HISTORY_JOURNAL_MAX_DEFERRED) {
+    const size_t records = (sActiveWritable && sSegmentCount) ? sSegments[sSegmentCount - 1].records : 0;
+    if (!flashWearAllows(journalAppendCost(records, pending).bytes)) {
+      if (!sJournalDeferred) flashWearDefer(FLASH_WEAR_HISTORY_JOURNAL);
+      sJournalDeferred = true;
+      return;
+    }
+  }
+  sJournalDeferred  = false;
+  sJournalRetryAtMs = 0;
+  appendHistoryJournal();
+}
+
+void historyStorageFlush() {
+  if (!sHistoryStorageReady) {
     return;
   }
+  flushHourlyPending(true);
+  if (sJournaledSeq != gHistorySeq) {
+    appendHistoryJournal();
+  }
+}
+
+// ================= Hourly tier =================
+
+static void hourlySegmentPath(char* out, size_t cap, uint32_t id) {
+  segmentPath(out, cap, HISTORY_HOURLY_DIR, id);
+}
+
+static void sealHourlySlot(HourlySlot& slot, uint32_t seq, const HistoryHourlyRecord& rec) {
+  slot.seq = seq;
+  slot.rec = rec;
+  slot.crc = historyHourlySegmentSlotCrc(seq, &rec, sizeof(rec));
+}
+
+static bool hourlySlotValid(const HourlySlot& slot) {
+  return historyHourlySegmentSlotValid(slot.seq, &slot.rec, sizeof(slot.rec), slot.crc);
+}
+
+// Opens one segment and counts its records from the file size. Appends never
+// touch earlier slots, so only the last one can be torn and only it is
+// checked. Returns false if the header is invalid.
+static bool scanHourlySegment(JournalSegment& seg, uint32_t& lastSeq, bool& torn) {
+  char path[32];
+  hourlySegmentPath(path, sizeof(path), seg.id);
+  torn = false;
 
-  if (f.write(reinterpret_cast<const uint8_t*>(&gHistoryIndex),
-              sizeof(gHistoryIndex)) != sizeof(gHistoryIndex)) {
-    Serial.println("[HISTFS] Failed to write history index.");
+  File f = LittleFS.open(path, "r");
+  if (!f) return false;
+
+  HistoryHourlySegmentHeader hdr;
+  if (f.read(reinterpret_cast<uint8_t*>(&hdr), sizeof(hdr)) != sizeof(hdr) ||
+      !historyHourlySegmentHeaderValid(hdr, sizeof(HistoryHourlyRecord)) || hdr.segment != seg.id) {
     f.close();
-    return;
+    return false;
+  }
+  seg.version = hdr.version;
+
+  const size_t size  = f.size();
+  size_t       slots = historyHourlySegmentSlots(size, sizeof(HistoryHourlyRecord));
+  torn = historyHourlySegmentSlotOffset(slots, sizeof(HistoryHourlyRecord)) != size;
+  if (slots > HISTORY_HOURLY_SEGMENT_RECORDS) {
+    slots = HISTORY_HOURLY_SEGMENT_RECORDS;
+    torn  = true;
+  }
+  while (slots > 0) {
+    HourlySlot last;
+    if (f.seek(historyHourlySegmentSlotOffset(slots - 1, sizeof(HistoryHourlyRecord))) &&
+        f.read(reinterpret_cast<uint8_t*>(&last), sizeof(last)) == sizeof(last) &&
+        hourlySlotValid(last)) {
+      lastSeq = last.seq;
+      break;
+    }
+    slots--;
+    torn = true;
+  }
+  f.close();
+
+  seg.records = (uint16_t)slots;
+  return true;
+}
+
+static void replayHourlySegments() {
+  listSegments(HISTORY_HOURLY_DIR, sHourlySegments, HISTORY_HOURLY_MAX_SEGMENTS, sHourlySegmentCount);
+
+  bool   lastTorn = false;
+  size_t kept     = 0;
+  for (size_t i = 0; i < sHourlySegmentCount; ++i) {
+    JournalSegment seg = sHourlySegments[i];
+    bool torn = false;
+    if (!scanHourlySegment(seg, sHourlySeq, torn)) {
+      Serial.printf("[HISTFS] Dropping hourly segment %08lx (bad header).\n", (unsigned long)seg.id);
+      removeSegment(HISTORY_HOURLY_DIR, seg.id);
+      continue;
+    }
+    if (torn) {
+      Serial.printf("[HISTFS] Hourly segment %08lx has a torn tail after %u records.\n",
+                    (unsigned long)seg.id, (unsigned)seg.records);
+    }
+    sHourlySegments[kept++] = seg;
+    sHourlyRecords += seg.records;
+    lastTorn = torn;
+  }
+  sHourlySegmentCount = kept;
+
+  // A torn tail cannot be appended to; the next record opens a new segment
+  sHourlyActiveWritable = sHourlySegmentCount > 0 && !lastTorn &&
+                          sHourlySegments[sHourlySegmentCount - 1].records < HISTORY_HOURLY_SEGMENT_RECORDS;
+}
+
+// Deletes the oldest segments once the newer ones hold a full HISTORY_HOURLY_SIZE ring.
+static void compactHourlySegments() {
+  while (sHourlySegmentCount > 1 &&
+         (sHourlyRecords - sHourlySegments[0].records >= HISTORY_HOURLY_SIZE ||
+          sHourlySegmentCount >= HISTORY_HOURLY_MAX_SEGMENTS)) {
+    removeSegment(HISTORY_HOURLY_DIR, sHourlySegments[0].id);
+    sHourlyRecords -= sHourlySegments[0].records;
+    memmove(&sHourlySegments[0], &sHourlySegments[1], (sHourlySegmentCount - 1) * sizeof(JournalSegment));
+    sHourlySegmentCount--;
   }
+}
+
+// Creates the next segment with its header and leaves it open in f
+static bool startHourlySegment(File& f) {
+  compactHourlySegments();
+
+  const uint32_t id = sHourlySegmentCount ? sHourlySegments[sHourlySegmentCount - 1].id + 1 : 1;
+  char path[32];
+  hourlySegmentPath(path, sizeof(path), id);
 
-  if (f.write(reinterpret_cast<const uint8_t*>(&gHistoryFull),
-              sizeof(gHistoryFull)) != sizeof(gHistoryFull)) {
-    Serial.println("[HISTFS] Failed to write history full flag.");
+  f = LittleFS.open(path, "w");
+  if (!f) return false;
+  HistoryHourlySegmentHeader hdr;
+  historyHourlySealSegmentHeader(hdr, id, sizeof(HistoryHourlyRecord));
+  if (f.write(reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr)) != sizeof(hdr)) {
     f.close();
+    LittleFS.remove(path);
+    return false;
+  }
+
+  sHourlySegments[sHourlySegmentCount].id      = id;
+  sHourlySegments[sHourlySegmentCount].records = 0;
+  sHourlySegments[sHourlySegmentCount].version = HISTORY_HOURLY_VERSION;
+  sHourlySegmentCount++;
+  sHourlyActiveWritable = true;
+  return true;
+}
+
+// Flash cost of appending records to a segment that holds `records`
+static FlashWearCost hourlyAppendCost(size_t records, size_t appended) {
+  FlashWearCost cost = {};
+  const uint32_t size = (uint32_t)historyHourlySegmentSlotOffset(records, sizeof(HistoryHourlyRecord));
+  flashWearAddFsWrite(cost, size, size, (uint32_t)(appended * sizeof(HourlySlot)));
+  flashWearAddFsCommit(cost);
+  return cost;
+}
+
+// Forgets every hourly segment (and deletes the files when remove is set)
+static void resetHourlySegments(bool remove) {
+  if (remove) {
+    for (size_t i = 0; i < sHourlySegmentCount; ++i) removeSegment(HISTORY_HOURLY_DIR, sHourlySegments[i].id);
+  }
+  sHourlySegmentCount   = 0;
+  sHourlyRecords        = 0;
+  sHourlySeq            = 0;
+  sHourlyActiveWritable = false;
+}
+
+// Copies a version 1 or 2 ring file into segments, oldest record first, and
+// removes it. Torn version 2 slots are left out. A migration cut short leaves
+// the ring file in place and is redone from the start on the next boot.
+static bool migrateHourlyRingFile() {
+  File src = LittleFS.open(HISTORY_HOURLY_PATH, "r");
+  if (!src) return false;
+
+  HistoryHourlyFileHeader copies[HISTORY_HOURLY_HEADER_COPIES];
+  memset(copies, 0, sizeof(copies));
+  src.read(reinterpret_cast<uint8_t*>(copies), sizeof(copies));
+  HistoryHourlyFileHeaderV1 v1;
+  memcpy(&v1, copies, sizeof(v1));
+
+  uint32_t capacity, head, count, seq;
+  size_t   slotsOffset, slotSize;
+  const int pick = historyHourlyFilePickHeader(copies, sizeof(HistoryHourlyRecord),
+                                               static_cast<uint32_t>(HISTORY_HOURLY_SIZE));
+  if (pick >= 0) {
+    capacity    = copies[pick].capacity;
+    head        = copies[pick].head;
+    count       = copies[pick].count;
+    seq         = copies[pick].seq;
+    slotsOffset = historyHourlyFileSlotOffset(0, sizeof(HistoryHourlyRecord));
+    slotSize    = sizeof(HourlySlotV2);
+  } else if (v1.magic == HISTORY_HOURLY_MAGIC &&
+             v1.version == HISTORY_HOURLY_VERSION_V1 &&
+             v1.recordSize == sizeof(HistoryHourlyRecord) &&
+             v1.capacity == static_cast<uint32_t>(HISTORY_HOURLY_SIZE) &&
+             v1.head < v1.capacity &&
+             v1.count <= v1.capacity) {
+    capacity    = v1.capacity;
+    head        = v1.head;
+    count       = v1.count;
+    seq         = v1.seq;
+    slotsOffset = sizeof(v1);
+    slotSize    = sizeof(HistoryHourlyRecord);  // no CRC
+  } else {
+    src.close();
+    Serial.println("[HISTFS] Hourly history header mismatch; starting empty.");
+    return LittleFS.remove(HISTORY_HOURLY_PATH);
+  }
+
+  const uint32_t n     = count < capacity ? count : capacity;
+  const uint32_t first = count < capacity ? 0 : head;
+  uint32_t i = 0;
+  bool     ok = true;
+  while (ok && i < n) {
+    File dst;
+    ok = startHourlySegment(dst);
+    if (!ok) break;
+
+    JournalSegment& seg = sHourlySegments[sHourlySegmentCount - 1];
+    while (ok && i < n && seg.records < HISTORY_HOURLY_SEGMENT_RECORDS) {
+      const uint32_t recordSeq = seq - n + 1 + i;
+      HourlySlotV2 old;
+      ok = src.seek(slotsOffset + ((first + i) % capacity) * slotSize) &&
+           src.read(reinterpret_cast<uint8_t*>(&old), slotSize) == slotSize;
+      i++;
+      if (!ok) break;
+      if (pick >= 0 && old.crc != historyHourlyFileRecordCrc(&old.rec, sizeof(old.rec))) continue;
+
+      HourlySlot slot;
+      sealHourlySlot(slot, recordSeq, old.rec);
+      ok = dst.write(reinterpret_cast<const uint8_t*>(&slot), sizeof(slot)) == sizeof(slot);
+      if (!ok) break;
+      seg.records++;
+      sHourlyRecords++;
+    }
+    dst.close();
+
+    FlashWearCost cost = {};
+    flashWearAddFsWrite(cost, 0, 0, (uint32_t)historyHourlySegmentSlotOffset(seg.records, sizeof(HistoryHourlyRecord)));
+    flashWearAddFsCommit(cost);
+    flashWearCharge(FLASH_WEAR_HISTORY_HOURLY, cost);
+  }
+  src.close();
+
+  if (!ok) return false;
+  sHourlySeq = seq;
+  return LittleFS.remove(HISTORY_HOURLY_PATH);
+}
+
+static void initHourlyHistory() {
+  resetHourlySegments(false);
+  sHourlyCacheCount = 0;
+
+  // Left behind by an interrupted v1 -> v2 migration; the ring file is intact
+  if (LittleFS.exists(HISTORY_HOURLY_TMP_PATH)) {
+    LittleFS.remove(HISTORY_HOURLY_TMP_PATH);
+  }
+  if (!LittleFS.exists(HISTORY_HOURLY_DIR)) {
+    LittleFS.mkdir(HISTORY_HOURLY_DIR);
+  }
+
+  if (LittleFS.exists(HISTORY_HOURLY_PATH)) {
+    // Segments next to the ring file are from a migration that was cut short
+    listSegments(HISTORY_HOURLY_DIR, sHourlySegments, HISTORY_HOURLY_MAX_SEGMENTS, sHourlySegmentCount);
+    resetHourlySegments(true);
+    if (migrateHourlyRingFile()) {
+      if (sHourlyRecords > 0) Serial.printf("[HISTFS] Migrated %u hourly samples from the ring file into %u segments.\n",
+                    (unsigned)sHourlyRecords, (unsigned)sHourlySegmentCount);
+      return;
+    }
+    Serial.println("[HISTFS] Hourly history migration failed; keeping the old file for the next boot.");
+    resetHourlySegments(true);
+    sHistoryHourlyWritable = false;
     return;
   }
 
-  const size_t bufBytes = sizeof(gHistoryBuf);
-  if (f.write(reinterpret_cast<const uint8_t*>(gHistoryBuf), bufBytes) != bufBytes) {
-    Serial.println("[HISTFS] Failed to write history buffer.");
+  replayHourlySegments();
+  Serial.printf("[HISTFS] Loaded %u hourly samples from LittleFS (%u segments).\n",
+                (unsigned)historyHourlyCount(), (unsigned)sHourlySegmentCount);
+}
+
+// Appends the pending records (normally one) to the newest segment
+static bool writeHourlyPending() {
+  size_t written = 0;
+  bool   ok      = true;
+  while (ok && written < sHourlyPendingCount) {
+    if (!sHourlyActiveWritable ||
+        sHourlySegments[sHourlySegmentCount - 1].records >= HISTORY_HOURLY_SEGMENT_RECORDS) {
+      File created;
+      if (!startHourlySegment(created)) {
+        Serial.println("[HISTFS] Failed to start hourly segment.");
+        ok = false;
+        break;
+      }
+      created.close();
+      FlashWearCost cost = {};
+      flashWearAddFsWrite(cost, 0, 0, sizeof(HistoryHourlySegmentHeader));
+      flashWearAddFsCommit(cost);
+      flashWearCharge(FLASH_WEAR_HISTORY_HOURLY, cost);
+    }
+
+    JournalSegment& seg = sHourlySegments[sHourlySegmentCount - 1];
+    const uint16_t  recordsBefore = seg.records;
+    char path[32];
+    hourlySegmentPath(path, sizeof(path), seg.id);
+    File f = LittleFS.open(path, "a");
+    if (!f) {
+      Serial.println("[HISTFS] Failed to open hourly segment for append.");
+      ok = false;
+      break;
+    }
+
+    while (written < sHourlyPendingCount && seg.records < HISTORY_HOURLY_SEGMENT_RECORDS) {
+      HourlySlot slot;
+      sealHourlySlot(slot, sHourlySeq + 1, sHourlyPending[written]);
+      if (f.write(reinterpret_cast<const uint8_t*>(&slot), sizeof(slot)) != sizeof(slot)) {
+        // Whatever reached flash is a torn slot now; continue in a new segment
+        Serial.println("[HISTFS] Failed to append hourly record.");
+        sHourlyActiveWritable = false;
+        ok = false;
+        break;
+      }
+      seg.records++;
+      sHourlyRecords++;
+      sHourlySeq = slot.seq;
+      written++;
+    }
     f.close();
+    flashWearCharge(FLASH_WEAR_HISTORY_HOURLY, hourlyAppendCost(recordsBefore, seg.records - recordsBefore));
+  }
+
+  memmove(&sHourlyPending[0], &sHourlyPending[written], (sHourlyPendingCount - written) * sizeof(HistoryHourlyRecord));
+  sHourlyPendingCount -= written;
+  return ok;
+}
+
+static void flushHourlyPending(bool force) {
+  if (sHourlyPendingCount == 0) {
+    return;
+  }
+  if (!force && sHourlyRetryAtMs != 0 && (long)(millis() - sHourlyRetryAtMs) < 0) {
     return;
   }
 
-  f.close();
-  Serial.println("[HISTFS] History written to LittleFS.");
+  sHourlyRetryAtMs = 0;
+  if (!writeHourlyPending()) {
+    sHourlyRetryAtMs = millis() + HISTORY_HOURLY_RETRY_MS;
+  }
 }
 
-void historyStorageLoop() {
-  if (!sHistoryStorageReady) {
+// Written at once: an append copies at most the last block of the newest
+// segment, so holding records back for the flash budget would save little
+// and lose them on power failure.
+void historyHourlyAppend(const HistoryHourlyRecord &rec) {
+  if (!sHistoryStorageReady || !sHistoryHourlyWritable) {
     return;
   }
 
-  const unsigned long now = millis();
-  const unsigned long intervalMs = HISTORY_INTERVAL_MS; // 10 minutes (for 7-day window)
+  if (sHourlyPendingCount == HISTORY_HOURLY_MAX_PENDING) {
+    // Appends keep failing; drop the oldest pending hour
+    memmove(&sHourlyPending[0], &sHourlyPending[1], (HISTORY_HOURLY_MAX_PENDING - 1) * sizeof(HistoryHourlyRecord));
+    sHourlyPendingCount--;
+  }
+  sHourlyPending[sHourlyPendingCount++] = rec;
+  flushHourlyPending(false);
+}
+
+size_t historyHourlyCount() {
+  return min(sHourlyRecords + sHourlyPendingCount, (size_t)HISTORY_HOURLY_SIZE);
+}
+
+uint32_t historyHourlySeq() {
+  return sHourlySeq + (uint32_t)sHourlyPendingCount;
+}
+
+bool historyHourlyRead(size_t ordinal, HistoryHourlyRecord &out) {
+  if (!sHistoryStorageReady || ordinal >= historyHourlyCount()) return false;
 
-  // Save roughly once per HISTORY_INTERVAL_MS to:
-  // - keep flash wear reasonable (~6 writes/hour)
-  // - ensure at most ~10 minutes of samples are lost on power failure
-  if (sLastHistorySaveMs == 0 || (now - sLastHistorySaveMs) >= intervalMs) {
-    sLastHistorySaveMs = now;
-    saveHistoryNow();
+  // The newest records may still be pending, and the oldest segment may
+  // hold records that have already left the ring
+  const size_t onFlash = historyHourlyCount() - sHourlyPendingCount;
+  if (ordinal >= onFlash) {
+    out = sHourlyPending[ordinal - onFlash];
+    return true;
   }
+  size_t index = ordinal + (sHourlyRecords - onFlash);
+  size_t s     = 0;
+  while (s < sHourlySegmentCount && index >= sHourlySegments[s].records) {
+    index -= sHourlySegments[s].records;
+    s++;
+  }
+  if (s == sHourlySegmentCount) return false;
+  const JournalSegment& seg = sHourlySegments[s];
+
+  if (sHourlyCacheCount == 0 || seg.id != sHourlyCacheSegment ||
+      index < sHourlyCacheFirst || index >= sHourlyCacheFirst + sHourlyCacheCount) {
+    char path[32];
+    hourlySegmentPath(path, sizeof(path), seg.id);
+    File f = LittleFS.open(path, "r");
+    if (!f) return false;
+
+    const size_t want = min(HOURLY_CACHE_RECORDS, (size_t)seg.records - index);
+    size_t got = 0;
+    if (f.seek(historyHourlySegmentSlotOffset(index, sizeof(HistoryHourlyRecord)))) {
+      got = f.read(reinterpret_cast<uint8_t*>(sHourlyCache), want * sizeof(HourlySlot));
+    }
+    f.close();
+
+    sHourlyCacheSegment = seg.id;
+    sHourlyCacheFirst   = index;
+    sHourlyCacheCount   = got / sizeof(HourlySlot);
+    if (sHourlyCacheCount == 0) return false;
+  }
+
+  // A slot torn by power loss reads as missing
+  const HourlySlot& cached = sHourlyCache[index - sHourlyCacheFirst];
+  if (!hourlySlotValid(cached)) return false;
+  out = cached.rec;
+  return true;
 }
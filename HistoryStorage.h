@@ -1,5 +1,15 @@
 #pragma once
 #include <Arduino.h>
+#include "HistoryTiers.h"
+
+// Journal backend for the 10-minute tier:
+//   0 - segment files under /histlog/ on LittleFS (default)
+//   1 - raw "history" data partition (HistoryPartitionRing.h), falling back
+//       to LittleFS if the partition table has no such partition; see
+//       doc/partitions-history.csv
+#ifndef HISTORY_JOURNAL_PARTITION
+#define HISTORY_JOURNAL_PARTITION 0
+#endif
 
 // Initialise history persistence.
 //
@@ -7,24 +17,40 @@
 // - LittleFS is mounted
 // - NTP/time, sensors and initial config are ready
 //
-// If a valid history file exists on LittleFS, this will populate:
-// - gHistoryBuf
-// - gHistoryIndex
-// - gHistoryFull
+// Replays the 10-minute journal (/histlog/*.log) on LittleFS to populate:
+// - the 10-minute ring (HistoryBlocks)
+// - gHistorySeq
 // so that /api/history and the dashboard charts can show data
-// collected before the last reboot.
+// collected before the last reboot. A torn record at the end of a segment
+// (power loss mid-append) is skipped and the journal continues in a new
+// segment. Version 1 journal segments (0.1 °C payload) and a legacy
+// /history.bin snapshot (unpacked samples, any ring size) are migrated to the
+// packed HistorySample layout.
 void initHistoryStorage();
 
 // Periodic persistence hook.
 //
 // Call regularly from loop(), ideally *after* logHistorySample().
-// This function will, at a safe interval aligned with HISTORY_INTERVAL_MS,
-// rewrite a compact binary file with:
-//
-// - a small header (magic, version, size, interval)
-// - gHistoryIndex
-// - gHistoryFull
-// - gHistoryBuf[HISTORY_SIZE]
-//
-// so the last 7 days survive power cycles and restarts.
+// Appends each new 10-minute sample (one 20-byte record with sequence number
+// and CRC32) to the active journal segment. Segments hold one day of samples;
+// when one fills, a new segment is started and segments that only contain
+// samples older than the HISTORY_SIZE window are deleted.
+// While the flash write budget (FlashWear.h) is spent, samples are kept in
+// RAM and written in one batch later (at most 6 hours). Also retries hourly
+// records whose append failed.
 void historyStorageLoop();
+
+// Writes every pending sample and hourly record now, regardless of the
+// budget. Call before a planned restart.
+void historyStorageFlush();
+
+// Hourly rollup tier (min/avg/max per hour), kept as a segment journal under
+// /histhourly/ on LittleFS so a full year fits without using RAM. Each record
+// is appended with its sequence number and CRC32 as soon as the hour closes;
+// a failed append stays in RAM and is retried. Reads go through a 32-record
+// cache and see pending records as well. A version 1/2 ring file
+// (/history_hourly.bin) is migrated on boot.
+void     historyHourlyAppend(const HistoryHourlyRecord &rec);
+size_t   historyHourlyCount();
+uint32_t historyHourlySeq();
+bool     historyHourlyRead(size_t ordinal, HistoryHourlyRecord &out);
@@ -0,0 +1,360 @@
+#include "HistoryTiers.h"
+#include "HistoryStorage.h"
+
+// ================= Raw (1-minute) tier =================
+
+static HistorySample sRawBuf[HISTORY_RAW_SIZE];
+static size_t              sRawIndex = 0;
+static bool                sRawFull  = false;
+static uint32_t            sRawSeq   = 0;
+
+// ================= Rollup buckets =================
+
+// Running aggregate of the minutes that fall into one coarser bucket
+struct RollupBucket {
+  double   tempSum;
+  float    tempMin, tempMax;
+  uint16_t tempCount;
+
+  double   humSum;
+  float    humMin, humMax;
+  uint16_t humCount;
+
+  long     soil1Sum;
+  int      soil1Min, soil1Max;
+  uint16_t soil1Count;
+
+  long     soil2Sum;
+  int      soil2Min, soil2Max;
+  uint16_t soil2Count;
+
+  uint16_t minutes;
+  uint16_t light1On;
+  uint16_t light2On;
+};
+
+static RollupBucket sTenMinBucket;
+static RollupBucket sHourBucket;
+
+static const uint16_t MINUTES_PER_10MIN = HISTORY_INTERVAL_MS / HISTORY_RAW_INTERVAL_MS;
+static const uint16_t MINUTES_PER_HOUR  = HISTORY_HOURLY_INTERVAL_MS / HISTORY_RAW_INTERVAL_MS;
+
+static void resetBucket(RollupBucket &b) {
+  memset(&b, 0, sizeof(b));
+}
+
+static void addToBucket(RollupBucket &b, const SensorState &avg, const RelayState &relays) {
+  if (!isnan(avg.temperatureC)) {
+    if (b.tempCount == 0 || avg.temperatureC < b.tempMin) b.tempMin = avg.temperatureC;
+    if (b.tempCount == 0 || avg.temperatureC > b.tempMax) b.tempMax = avg.temperatureC;
+    b.tempSum += avg.temperatureC;
+    b.tempCount++;
+  }
+  if (!isnan(avg.humidityRH)) {
+    if (b.humCount == 0 || avg.humidityRH < b.humMin) b.humMin = avg.humidityRH;
+    if (b.humCount == 0 || avg.humidityRH > b.humMax) b.humMax = avg.humidityRH;
+    b.humSum += avg.humidityRH;
+    b.humCount++;
+  }
+  if (avg.soil1Percent >= 0) {
+    if (b.soil1Count == 0 || avg.soil1Percent < b.soil1Min) b.soil1Min = avg.soil1Percent;
+    if (b.soil1Count == 0 || avg.soil1Percent > b.soil1Max) b.soil1Max = avg.soil1Percent;
+    b.soil1Sum += avg.soil1Percent;
+    b.soil1Count++;
+  }
+  if (avg.soil2Percent >= 0) {
+    if (b.soil2Count == 0 || avg.soil2Percent < b.soil2Min) b.soil2Min = avg.soil2Percent;
+    if (b.soil2Count == 0 || avg.soil2Percent > b.soil2Max) b.soil2Max = avg.soil2Percent;
+    b.soil2Sum += avg.soil2Percent;
+    b.soil2Count++;
+  }
+  if (relays.light1) b.light1On++;
+  if (relays.light2) b.light2On++;
+  b.minutes++;
+}
+
+static float bucketTempAvg(const RollupBucket &b) {
+  return b.tempCount ? (float)(b.tempSum / b.tempCount) : NAN;
+}
+
+static float bucketHumAvg(const RollupBucket &b) {
+  return b.humCount ? (float)(b.humSum / b.humCount) : NAN;
+}
+
+static int bucketSoilAvg(long sum, uint16_t count) {
+  return count ? (int)((sum / (double)count) + 0.5) : -1;
+}
+
+// ================= Encoding helpers =================
+
+int16_t historyEncodeTemp(float v) {
+  if (isnan(v)) return HISTORY_TEMP_NONE;
+  return (int16_t)constrain(lroundf(v * 10.0f), -32767L, 32767L);
+}
+
+uint16_t historyEncodeHum(float v) {
+  if (isnan(v)) return HISTORY_HUM_NONE;
+  return (uint16_t)constrain(lroundf(v * 10.0f), 0L, 1000L);
+}
+
+uint8_t historyEncodeSoil(int v) {
+  return (v < 0 || v > 100) ? HISTORY_SOIL_NONE : (uint8_t)v;
+}
+
+float historyDecodeTemp(int16_t v) {
+  return v == HISTORY_TEMP_NONE ? NAN : v / 10.0f;
+}
+
+float historyDecodeHum(uint16_t v) {
+  return v == HISTORY_HUM_NONE ? NAN : v / 10.0f;
+}
+
+int historyDecodeSoil(uint8_t v) {
+  return v == HISTORY_SOIL_NONE ? -1 : (int)v;
+}
+
+HistorySample historyPackSample(time_t timestamp, float temp, float hum, int soil1, int soil2, uint8_t relays) {
+  HistorySample s;
+  s.timestamp = (uint32_t)timestamp;
+  s.temp      = isnan(temp) ? HISTORY_SAMPLE_TEMP_NONE
+                            : (int16_t)constrain(lroundf(temp * 100.0f), -32767L, 32767L);
+  s.hum       = isnan(hum) ? HISTORY_SAMPLE_NONE : (uint8_t)constrain(lroundf(hum), 0L, 100L);
+  s.soil1     = (soil1 < 0 || soil1 > 100) ? HISTORY_SAMPLE_NONE : (uint8_t)soil1;
+  s.soil2     = (soil2 < 0 || soil2 > 100) ? HISTORY_SAMPLE_NONE : (uint8_t)soil2;
+  s.relays    = relays;
+  s.reserved  = 0;
+  return s;
+}
+
+void historyUnpackSample(const HistorySample &in, HistoryPoint &out) {
+  out.timestamp = (time_t)in.timestamp;
+  out.temp      = in.temp == HISTORY_SAMPLE_TEMP_NONE ? NAN : in.temp / 100.0f;
+  out.hum       = in.hum == HISTORY_SAMPLE_NONE ? NAN : (float)in.hum;
+  out.soil1     = in.soil1 == HISTORY_SAMPLE_NONE ? -1 : (int)in.soil1;
+  out.soil2     = in.soil2 == HISTORY_SAMPLE_NONE ? -1 : (int)in.soil2;
+  out.light1    = (in.relays & HISTORY_RELAY_LIGHT1) != 0;
+  out.light2    = (in.relays & HISTORY_RELAY_LIGHT2) != 0;
+}
+
+uint8_t historyRelayBits(const RelayState &relays) {
+  return (relays.light1 ? HISTORY_RELAY_LIGHT1 : 0) |
+         (relays.light2 ? HISTORY_RELAY_LIGHT2 : 0) |
+         (relays.fan    ? HISTORY_RELAY_FAN    : 0) |
+         (relays.pump   ? HISTORY_RELAY_PUMP   : 0);
+}
+
+// ================= Cascade =================
+
+static void closeTenMinuteBucket(time_t timestamp, const RelayState &relays) {
+  historyRingPush(historyPackSample(timestamp,
+                                    bucketTempAvg(sTenMinBucket),
+                                    bucketHumAvg(sTenMinBucket),
+                                    bucketSoilAvg(sTenMinBucket.soil1Sum, sTenMinBucket.soil1Count),
+                                    bucketSoilAvg(sTenMinBucket.soil2Sum, sTenMinBucket.soil2Count),
+                                    historyRelayBits(relays)));
+
+  gHistorySeq++;
+
+  resetBucket(sTenMinBucket);
+}
+
+static void closeHourBucket(time_t timestamp) {
+  const RollupBucket &b = sHourBucket;
+  HistoryHourlyRecord rec;
+  rec.timestamp = (uint32_t)timestamp;
+
+  rec.tempAvg = historyEncodeTemp(bucketTempAvg(b));
+  rec.tempMin = b.tempCount ? historyEncodeTemp(b.tempMin) : HISTORY_TEMP_NONE;
+  rec.tempMax = b.tempCount ? historyEncodeTemp(b.tempMax) : HISTORY_TEMP_NONE;
+
+  rec.humAvg = historyEncodeHum(bucketHumAvg(b));
+  rec.humMin = b.humCount ? historyEncodeHum(b.humMin) : HISTORY_HUM_NONE;
+  rec.humMax = b.humCount ? historyEncodeHum(b.humMax) : HISTORY_HUM_NONE;
+
+  rec.soil1Avg = historyEncodeSoil(bucketSoilAvg(b.soil1Sum, b.soil1Count));
+  rec.soil1Min = b.soil1Count ? historyEncodeSoil(b.soil1Min) : HISTORY_SOIL_NONE;
+  rec.soil1Max = b.soil1Count ? historyEncodeSoil(b.soil1Max) : HISTORY_SOIL_NONE;
+
+  rec.soil2Avg = historyEncodeSoil(bucketSoilAvg(b.soil2Sum, b.soil2Count));
+  rec.soil2Min = b.soil2Count ? historyEncodeSoil(b.soil2Min) : HISTORY_SOIL_NONE;
+  rec.soil2Max = b.soil2Count ? historyEncodeSoil(b.soil2Max) : HISTORY_SOIL_NONE;
+
+  rec.light1Pct = b.minutes ? (uint8_t)((b.light1On * 100UL) / b.minutes) : 0;
+  rec.light2Pct = b.minutes ? (uint8_t)((b.light2On * 100UL) / b.minutes) : 0;
+
+  historyHourlyAppend(rec);
+  resetBucket(sHourBucket);
+}
+
+void historyTiersAddMinute(time_t timestamp, const SensorState &avg, const RelayState &relays) {
+  sRawBuf[sRawIndex] = historyPackSample(timestamp, avg.temperatureC, avg.humidityRH,
+                                         avg.soil1Percent, avg.soil2Percent,
+                                         historyRelayBits(relays));
+
+  sRawIndex = (sRawIndex + 1) % HISTORY_RAW_SIZE;
+  if (sRawIndex == 0) sRawFull = true;
+  sRawSeq++;
+
+  addToBucket(sTenMinBucket, avg, relays);
+  if (sTenMinBucket.minutes >= MINUTES_PER_10MIN) {
+    closeTenMinuteBucket(timestamp, relays);
+  }
+
+  addToBucket(sHourBucket, avg, relays);
+  if (sHourBucket.minutes >= MINUTES_PER_HOUR) {
+    closeHourBucket(timestamp);
+  }
+}
+
+// ================= Accessors =================
+
+const char* historyTierName(HistoryTier tier) {
+  switch (tier) {
+    case HISTORY_TIER_RAW:    return "raw";
+    case HISTORY_TIER_10MIN:  return "10min";
+    case HISTORY_TIER_HOURLY: return "hourly";
+    default:                  return "";
+  }
+}
+
+bool historyTierFromName(const String &name, HistoryTier &out) {
+  for (uint8_t t = 0; t < HISTORY_TIER_COUNT; ++t) {
+    if (name == historyTierName((HistoryTier)t)) {
+      out = (HistoryTier)t;
+      return true;
+    }
+  }
+  return false;
+}
+
+unsigned long historyTierIntervalSec(HistoryTier tier) {
+  switch (tier) {
+    case HISTORY_TIER_RAW:    return HISTORY_RAW_INTERVAL_MS / 1000UL;
+    case HISTORY_TIER_10MIN:  return HISTORY_INTERVAL_MS / 1000UL;
+    case HISTORY_TIER_HOURLY: return HISTORY_HOURLY_INTERVAL_MS / 1000UL;
+    default:                  return 0;
+  }
+}
+
+size_t historyTierCapacity(HistoryTier tier) {
+  switch (tier) {
+    case HISTORY_TIER_RAW:    return HISTORY_RAW_SIZE;
+    case HISTORY_TIER_10MIN:  return HISTORY_SIZE;
+    case HISTORY_TIER_HOURLY: return HISTORY_HOURLY_SIZE;
+    default:                  return 0;
+  }
+}
+
+size_t historyTierCount(HistoryTier tier) {
+  switch (tier) {
+    case HISTORY_TIER_RAW:    return sRawFull ? HISTORY_RAW_SIZE : sRawIndex;
+    case HISTORY_TIER_10MIN:  return historyRingCount();
+    case HISTORY_TIER_HOURLY: return historyHourlyCount();
+    default:                  return 0;
+  }
+}
+
+uint32_t historyTierSeq(HistoryTier tier) {
+  switch (tier) {
+    case HISTORY_TIER_RAW:    return sRawSeq;
+    case HISTORY_TIER_10MIN:  return gHistorySeq;
+    case HISTORY_TIER_HOURLY: return historyHourlySeq();
+    default:                  return 0;
+  }
+}
+
+bool historyTierHasRange(HistoryTier tier) {
+  return tier == HISTORY_TIER_HOURLY;
+}
+
+bool historyTierRead(HistoryTier tier, size_t ordinal, HistoryPoint &out, HistoryRange *range) {
+  if (ordinal >= historyTierCount(tier)) return false;
+
+  switch (tier) {
+    case HISTORY_TIER_RAW: {
+      const size_t idx = sRawFull ? ((sRawIndex + ordinal) % HISTORY_RAW_SIZE) : ordinal;
+      historyUnpackSample(sRawBuf[idx], out);
+      return true;
+    }
+
+    case HISTORY_TIER_10MIN: {
+      HistorySample s;
+      if (!historyRingRead(ordinal, s)) return false;
+      historyUnpackSample(s, out);
+      return true;
+    }
+
+    case HISTORY_TIER_HOURLY: {
+      HistoryHourlyRecord rec;
+      if (!historyHourlyRead(ordinal, rec)) return false;
+      out.timestamp = (time_t)rec.timestamp;
+      out.temp      = historyDecodeTemp(rec.tempAvg);
+      out.hum       = historyDecodeHum(rec.humAvg);
+      out.soil1     = historyDecodeSoil(rec.soil1Avg);
+      out.soil2     = historyDecodeSoil(rec.soil2Avg);
+      out.light1    = rec.light1Pct >= 50;
+      out.light2    = rec.light2Pct >= 50;
+      if (range) {
+        range->tempMin   = historyDecodeTemp(rec.tempMin);
+        range->tempMax   = historyDecodeTemp(rec.tempMax);
+        range->humMin    = historyDecodeHum(rec.humMin);
+        range->humMax    = historyDecodeHum(rec.humMax);
+        range->soil1Min  = historyDecodeSoil(rec.soil1Min);
+        range->soil1Max  = historyDecodeSoil(rec.soil1Max);
+        range->soil2Min  = historyDecodeSoil(rec.soil2Min);
+        range->soil2Max  = historyDecodeSoil(rec.soil2Max);
+        range->light1Pct = rec.light1Pct;
+        range->light2Pct = rec.light2Pct;
+      }
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
+// ================= Tier selection =================
+
+HistoryTier historyTierForRange(int days, unsigned long resolutionSec) {
+  const unsigned long rangeSec = (unsigned long)days * 86400UL;
+
+  // Coverage is based on the samples actually held, so a freshly booted raw
+  // tier does not hide days of persisted 10-minute history.
+  bool          covers[HISTORY_TIER_COUNT];
+  unsigned long spanSec[HISTORY_TIER_COUNT];
+  for (uint8_t t = 0; t < HISTORY_TIER_COUNT; ++t) {
+    const unsigned long interval = historyTierIntervalSec((HistoryTier)t);
+    spanSec[t] = (unsigned long)historyTierCount((HistoryTier)t) * interval;
+    covers[t]  = spanSec[t] + interval >= rangeSec;
+  }
+
+  int best = -1;
+  for (uint8_t t = 0; t < HISTORY_TIER_COUNT; ++t) {
+    if (covers[t] && historyTierIntervalSec((HistoryTier)t) <= resolutionSec) best = t;
+  }
+  if (best >= 0) return (HistoryTier)best;
+
+  for (uint8_t t = 0; t < HISTORY_TIER_COUNT; ++t) {
+    if (covers[t]) return (HistoryTier)t;
+  }
+
+  // Nothing covers the range yet: serve the longest span, preferring the
+  // coarser tier on ties as long as it meets the resolution
+  best = 0;
+  for (uint8_t t = 1; t < HISTORY_TIER_COUNT; ++t) {
+    const bool fits = historyTierIntervalSec((HistoryTier)t) <= resolutionSec;
+    if (spanSec[t] > spanSec[best] || (fits && spanSec[t] == spanSec[best])) best = t;
+  }
+  return (HistoryTier)best;
+}
+
+int historyMaxDays() {
+  unsigned long maxSec = 0;
+  for (uint8_t t = 0; t < HISTORY_TIER_COUNT; ++t) {
+    const unsigned long span = (unsigned long)historyTierCapacity((HistoryTier)t) *
+                               historyTierIntervalSec((HistoryTier)t);
+    if (span > maxSec) maxSec = span;
+  }
+  return (int)(maxSec / 86400UL);
+}
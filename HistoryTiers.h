@@ -0,0 +1,77 @@
+#pragma once
+#include <Arduino.h>
+#include "Greenhouse.h"
+
+// Tiered history:
+//   raw    - 1-minute averages for 24 h (RAM)
+//   10min  - compressed 10-minute blocks for 30+ days (RAM, HistoryBlocks)
+//   hourly - min/avg/max per hour for 365 days (LittleFS ring, HistoryStorage)
+// Each closed minute cascades into the coarser tiers when their bucket closes.
+// The raw tier stores packed HistorySample records.
+
+enum HistoryTier : uint8_t {
+  HISTORY_TIER_RAW    = 0,
+  HISTORY_TIER_10MIN  = 1,
+  HISTORY_TIER_HOURLY = 2,
+  HISTORY_TIER_COUNT  = 3
+};
+
+// Missing values in the hourly records
+constexpr int16_t  HISTORY_TEMP_NONE = INT16_MIN;
+constexpr uint16_t HISTORY_HUM_NONE  = 0xFFFF;
+constexpr uint8_t  HISTORY_SOIL_NONE = 0xFF;
+
+// Hourly rollup (24 bytes, stored on LittleFS)
+struct __attribute__((packed)) HistoryHourlyRecord {
+  uint32_t timestamp;                     // end of the hour bucket
+  int16_t  tempMin, tempAvg, tempMax;     // 0.1 °C
+  uint16_t humMin, humAvg, humMax;        // 0.1 %RH
+  uint8_t  soil1Min, soil1Avg, soil1Max;  // %
+  uint8_t  soil2Min, soil2Avg, soil2Max;  // %
+  uint8_t  light1Pct, light2Pct;          // share of minutes the light was on
+};
+
+// Min/max companion values (hourly tier only)
+struct HistoryRange {
+  float   tempMin, tempMax;
+  float   humMin, humMax;
+  int     soil1Min, soil1Max;
+  int     soil2Min, soil2Max;
+  uint8_t light1Pct, light2Pct;
+};
+
+// Feed one closed 1-minute window (called from logHistorySample()).
+void historyTiersAddMinute(time_t timestamp, const SensorState &avg, const RelayState &relays);
+
+const char*   historyTierName(HistoryTier tier);
+bool          historyTierFromName(const String &name, HistoryTier &out);
+unsigned long historyTierIntervalSec(HistoryTier tier);
+size_t        historyTierCapacity(HistoryTier tier);
+size_t        historyTierCount(HistoryTier tier);
+uint32_t      historyTierSeq(HistoryTier tier);   // sequence of the newest sample
+bool          historyTierHasRange(HistoryTier tier);
+
+// Read the ordinal-th oldest sample of a tier. Hourly samples report their
+// averages in `out`; pass `range` to also receive min/max values.
+bool historyTierRead(HistoryTier tier, size_t ordinal, HistoryPoint &out, HistoryRange *range = nullptr);
+
+// Coarsest tier whose interval is <= resolutionSec and whose retention covers
+// `days`; falls back to the finest tier covering the range, then to the
+// longest-retention tier.
+HistoryTier historyTierForRange(int days, unsigned long resolutionSec);
+
+// Longest range (days) any tier can serve
+int historyMaxDays();
+
+// Packed HistorySample conversion (0.01 °C, 1 %RH, 1 % soil)
+HistorySample historyPackSample(time_t timestamp, float temp, float hum, int soil1, int soil2, uint8_t relays);
+void          historyUnpackSample(const HistorySample &in, HistoryPoint &out);
+uint8_t       historyRelayBits(const RelayState &relays);
+
+// 0.1-resolution encoding used by the hourly records and /api/history.bin
+int16_t  historyEncodeTemp(float v);
+uint16_t historyEncodeHum(float v);
+uint8_t  historyEncodeSoil(int v);
+float    historyDecodeTemp(int16_t v);
+float    historyDecodeHum(uint16_t v);
+int      historyDecodeSoil(uint8_t v);
@@ -0,0 +1,197 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Typed HTML templates (no Arduino dependencies, see
+// test/host/htmlTemplate_test.cpp).
+//
+// A template is a sequence of literal fragments and typed values:
+//
+//   htmlWrite(page, "<input name='c1Name' value='", htmlEsc(name), "'>",
+//             "<span>", htmlFixed(temp, 1), " °C</span>");
+//
+// Every argument is formatted by the HtmlFormat specialization for its type,
+// selected at compile time, straight into the output, which only needs
+// write(const char*, size_t). Nothing is allocated:
+//   string literal       copied as is; the length is a compile-time constant
+//                        and the text stays in flash (.rodata is mapped from
+//                        flash on the ESP32)
+//   const char*          copied as is (nullptr writes nothing)
+//   String-like          anything with c_str()/length(), copied as is
+//   htmlEsc(s)           text or attribute value with & < > " ' escaped
+//   int, long, unsigned  decimal
+//   htmlFixed(v, n)      float with n decimals ("nan" for NaN)
+//   bool                 "true" / "false"
+//   htmlIf(c, a[, b])    a when c holds, otherwise b (or nothing)
+// A plain float is rejected at compile time so the precision is always
+// spelled out.
+
+template <typename T>
+struct HtmlFormat {
+  // String-like: Arduino String, std::string
+  template <typename Out>
+  static void put(Out& out, const T& v) { out.write(v.c_str(), v.length()); }
+};
+
+template <size_t N>
+struct HtmlFormat<char[N]> {
+  template <typename Out>
+  static void put(Out& out, const char (&s)[N]) { out.write(s, N - 1); }
+};
+
+template <>
+struct HtmlFormat<const char*> {
+  template <typename Out>
+  static void put(Out& out, const char* s) { if (s) out.write(s, strlen(s)); }
+};
+
+template <>
+struct HtmlFormat<char*> : HtmlFormat<const char*> {};
+
+template <>
+struct HtmlFormat<char> {
+  template <typename Out>
+  static void put(Out& out, char c) { out.write(&c, 1); }
+};
+
+// ===== Escaped text =====
+
+struct HtmlEscaped {
+  const char* s;
+  size_t      len;
+};
+
+inline HtmlEscaped htmlEsc(const char* s) { return HtmlEscaped{ s ? s : "", s ? strlen(s) : 0 }; }
+inline HtmlEscaped htmlEsc(const char* s, size_t len) { return HtmlEscaped{ s, len }; }
+template <typename S>
+inline HtmlEscaped htmlEsc(const S& s) { return HtmlEscaped{ s.c_str(), s.length() }; }
+
+template <>
+struct HtmlFormat<HtmlEscaped> {
+  // Runs of plain characters are written in one call
+  template <typename Out>
+  static void put(Out& out, const HtmlEscaped& v) {
+    size_t run = 0;
+    for (size_t i = 0; i < v.len; ++i) {
+      const char* entity;
+      switch (v.s[i]) {
+        case '&':  entity = "&amp;"; break;
+        case '<':  entity = "&lt;"; break;
+        case '>':  entity = "&gt;"; break;
+        case '"':  entity = "&quot;"; break;
+        case '\'': entity = "&#39;"; break;
+        default:   continue;
+      }
+      if (i > run) out.write(v.s + run, i - run);
+      out.write(entity, strlen(entity));
+      run = i + 1;
+    }
+    if (v.len > run) out.write(v.s + run, v.len - run);
+  }
+};
+
+// ===== Numbers =====
+
+template <typename Out>
+inline void htmlPutUnsigned(Out& out, unsigned long v, bool negative) {
+  char buf[24];
+  size_t pos = sizeof(buf);
+  do {
+    buf[--pos] = (char)('0' + v % 10);
+    v /= 10;
+  } while (v);
+  if (negative) buf[--pos] = '-';
+  out.write(buf + pos, sizeof(buf) - pos);
+}
+
+template <typename T>
+struct HtmlSigned {
+  template <typename Out>
+  static void put(Out& out, T v) {
+    const bool negative = v < 0;
+    // Negate in unsigned arithmetic so the minimum value does not overflow
+    htmlPutUnsigned(out, negative ? 0UL - (unsigned long)v : (unsigned long)v, negative);
+  }
+};
+
+template <typename T>
+struct HtmlUnsigned {
+  template <typename Out>
+  static void put(Out& out, T v) { htmlPutUnsigned(out, (unsigned long)v, false); }
+};
+
+template <> struct HtmlFormat<signed char>    : HtmlSigned<signed char> {};
+template <> struct HtmlFormat<short>          : HtmlSigned<short> {};
+template <> struct HtmlFormat<int>            : HtmlSigned<int> {};
+template <> struct HtmlFormat<long>           : HtmlSigned<long> {};
+template <> struct HtmlFormat<unsigned char>  : HtmlUnsigned<unsigned char> {};
+template <> struct HtmlFormat<unsigned short> : HtmlUnsigned<unsigned short> {};
+template <> struct HtmlFormat<unsigned int>   : HtmlUnsigned<unsigned int> {};
+template <> struct HtmlFormat<unsigned long>  : HtmlUnsigned<unsigned long> {};
+
+struct HtmlFixedValue {
+  float   v;
+  uint8_t decimals;
+};
+
+inline HtmlFixedValue htmlFixed(float v, uint8_t decimals) { return HtmlFixedValue{ v, decimals }; }
+
+template <>
+struct HtmlFormat<HtmlFixedValue> {
+  template <typename Out>
+  static void put(Out& out, const HtmlFixedValue& f) {
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "%.*f", (int)f.decimals, (double)f.v);
+    if (n < 0) return;
+    out.write(buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+  }
+};
+
+template <>
+struct HtmlFormat<float> {
+  template <typename Out>
+  static void put(Out&, float) {
+    static_assert(sizeof(Out) == 0, "use htmlFixed(value, decimals) for floats");
+  }
+};
+
+template <>
+struct HtmlFormat<double> : HtmlFormat<float> {};
+
+// ===== Booleans and conditionals =====
+
+template <>
+struct HtmlFormat<bool> {
+  template <typename Out>
+  static void put(Out& out, bool b) {
+    if (b) out.write("true", 4);
+    else   out.write("false", 5);
+  }
+};
+
+struct HtmlChoice {
+  const char* text;
+};
+
+inline HtmlChoice htmlIf(bool cond, const char* yes, const char* no = nullptr) {
+  return HtmlChoice{ cond ? yes : no };
+}
+
+template <>
+struct HtmlFormat<HtmlChoice> {
+  template <typename Out>
+  static void put(Out& out, const HtmlChoice& c) { HtmlFormat<const char*>::put(out, c.text); }
+};
+
+// ===== Templates =====
+
+template <typename Out>
+inline void htmlWrite(Out&) {}
+
+template <typename Out, typename T, typename... Rest>
+inline void htmlWrite(Out& out, const T& first, const Rest&... rest) {
+  HtmlFormat<T>::put(out, first);
+  htmlWrite(out, rest...);
+}
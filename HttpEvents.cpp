@@ -0,0 +1,161 @@
+#include "HttpEvents.h"
+#include "HttpWebSocket.h"
+
+#include <stdio.h>
+#include <string.h>
+
+HttpEventStream::HttpEventStream() : _clients(0), _lastId(0) {
+  memset(&_stats, 0, sizeof(_stats));
+  for (size_t i = 0; i < HTTP_EVENT_CLIENTS; ++i) {
+    _subs[i].sink    = nullptr;
+    _subs[i].closing = false;
+    _subs[i].used    = 0;
+  }
+}
+
+HttpEventStream::~HttpEventStream() {
+  closeAll();
+}
+
+int HttpEventStream::subscribe(HttpBodySink* sink, uint32_t nowMs, HttpEventFraming framing) {
+  for (size_t i = 0; i < HTTP_EVENT_CLIENTS; ++i) {
+    Subscriber& s = _subs[i];
+    if (s.sink) continue;
+    s.sink       = sink;
+    s.framing    = framing;
+    s.closing    = false;
+    s.used       = 0;
+    s.lastSendMs = nowMs;
+    _clients++;
+    _stats.subscribed++;
+    if (framing == HTTP_EVENT_SSE) {
+      char retry[24];
+      const int n = snprintf(retry, sizeof(retry), "retry: %u\n\n", (unsigned)HTTP_EVENT_RETRY_MS);
+      enqueue(s, retry, (size_t)n);
+    }
+    return (int)i;
+  }
+  _stats.refused++;
+  return -1;
+}
+
+bool HttpEventStream::enqueue(Subscriber& s, const char* data, size_t len) {
+  if (len > HTTP_EVENT_QUEUE_BYTES - s.used) return false;
+  memcpy(s.queue + s.used, data, len);
+  s.used += len;
+  return true;
+}
+
+// id 0: no id (heartbeats, acknowledgements)
+bool HttpEventStream::enqueueEvent(Subscriber& s, uint32_t id, const char* event, const char* data, size_t len) {
+  char head[64];
+  int n;
+  if (s.framing == HTTP_EVENT_SSE) {
+    n = id ? snprintf(head, sizeof(head), "id: %lu\nevent: %s\ndata: ", (unsigned long)id, event)
+           : snprintf(head, sizeof(head), "event: %s\ndata: ", event);
+  } else {
+    n = id ? snprintf(head, sizeof(head), "{\"type\":\"%s\",\"id\":%lu,\"data\":", event, (unsigned long)id)
+           : snprintf(head, sizeof(head), "{\"type\":\"%s\",\"data\":", event);
+  }
+  if (n <= 0 || (size_t)n >= sizeof(head)) return false;
+  const size_t body = (size_t)n + len + (s.framing == HTTP_EVENT_SSE ? 2 : 1);
+
+  uint8_t frame[4];
+  const size_t frameLen = s.framing == HTTP_EVENT_WEBSOCKET ? httpWsFrameHeader(frame, HTTP_WS_TEXT, body) : 0;
+  if (frameLen + body > HTTP_EVENT_QUEUE_BYTES - s.used) return false;
+
+  enqueue(s, reinterpret_cast<const char*>(frame), frameLen);
+  enqueue(s, head, (size_t)n);
+  enqueue(s, data, len);
+  if (s.framing == HTTP_EVENT_SSE) enqueue(s, "\n\n", 2);
+  else                             enqueue(s, "}", 1);
+  return true;
+}
+
+void HttpEventStream::release(Subscriber& s) {
+  delete s.sink;
+  s.sink    = nullptr;
+  s.closing = false;
+  s.used    = 0;
+  _clients--;
+}
+
+void HttpEventStream::drop(Subscriber& s) {
+  release(s);
+  _stats.dropped++;
+}
+
+void HttpEventStream::publish(const char* event, const char* data, size_t len) {
+  _lastId++;
+  _stats.events++;
+  for (size_t i = 0; i < HTTP_EVENT_CLIENTS; ++i) {
+    Subscriber& s = _subs[i];
+    if (!s.sink || s.closing) continue;
+    // Too far behind; reconnects with a fresh snapshot
+    if (!enqueueEvent(s, _lastId, event, data, len)) drop(s);
+  }
+}
+
+bool HttpEventStream::sendTo(int slot, const char* event, const char* data, size_t len) {
+  if (!active(slot)) return false;
+  Subscriber& s = _subs[slot];
+  if (enqueueEvent(s, 0, event, data, len)) return true;
+  drop(s);
+  return false;
+}
+
+bool HttpEventStream::sendFrame(int slot, uint8_t opcode, const uint8_t* payload, size_t len) {
+  if (!active(slot) || _subs[slot].framing != HTTP_EVENT_WEBSOCKET) return false;
+  Subscriber& s = _subs[slot];
+  uint8_t frame[4];
+  const size_t frameLen = httpWsFrameHeader(frame, opcode, len);
+  if (frameLen + len > HTTP_EVENT_QUEUE_BYTES - s.used) return false;
+  enqueue(s, reinterpret_cast<const char*>(frame), frameLen);
+  enqueue(s, reinterpret_cast<const char*>(payload), len);
+  return true;
+}
+
+void HttpEventStream::close(int slot) {
+  if (!active(slot)) return;
+  _subs[slot].closing = true;
+  if (_subs[slot].used == 0) release(_subs[slot]);
+}
+
+bool HttpEventStream::active(int slot) const {
+  return slot >= 0 && slot < HTTP_EVENT_CLIENTS && _subs[slot].sink && !_subs[slot].closing;
+}
+
+size_t HttpEventStream::pump(uint32_t nowMs) {
+  size_t written = 0;
+  for (size_t i = 0; i < HTTP_EVENT_CLIENTS; ++i) {
+    Subscriber& s = _subs[i];
+    if (!s.sink) continue;
+    if (s.used == 0) {
+      if (s.closing || nowMs - s.lastSendMs < HTTP_EVENT_HEARTBEAT_MS) continue;
+      // Named event rather than a comment or ping frame so the page can watch for it
+      enqueueEvent(s, 0, "ping", "{}", 2);
+      s.lastSendMs = nowMs;
+      _stats.heartbeats++;
+    }
+    const int n = s.sink->write(reinterpret_cast<const uint8_t*>(s.queue), s.used);
+    if (n < 0) {
+      if (s.closing) release(s);
+      else           drop(s);
+      continue;
+    }
+    if (n == 0) continue;
+    memmove(s.queue, s.queue + n, s.used - (size_t)n);
+    s.used       -= (size_t)n;
+    s.lastSendMs  = nowMs;
+    _stats.bytes += (uint64_t)n;
+    written      += (size_t)n;
+    if (s.closing && s.used == 0) release(s);
+  }
+  return written;
+}
+
+void HttpEventStream::closeAll() {
+  for (size_t i = 0; i < HTTP_EVENT_CLIENTS; ++i) {
+    if (_subs[i].sink) release(_subs[i]);
+  }
+}
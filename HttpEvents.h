@@ -0,0 +1,106 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "HttpTransfers.h"  // HttpBodySink
+
+// Server-Sent Events fan-out (no Arduino dependencies, see
+// test/host/httpEvents_test.cpp).
+//
+// Dashboards subscribe to /api/events instead of polling /api/status. The
+// handler answers with text/event-stream, detaches the connection and
+// subscribes its sink here; WebUI.cpp publishes an event whenever the
+// sensors, relays or config change, and loop() pumps the queued bytes out
+// without blocking. An idle stream costs one small "ping" event per
+// HTTP_EVENT_HEARTBEAT_MS, which keeps proxies and the browser's own
+// timeout from closing it and lets the client notice a dead device.
+//
+// WebSocket subscribers (/api/ws, HttpWebSocket.h) get the same events as
+// text frames holding {"type":...,"id":...,"data":...}, plus messages
+// addressed to them alone (command acknowledgements).
+//
+// Every subscriber has a small queue. A subscriber that falls so far behind
+// that an event no longer fits is dropped; the page reconnects (EventSource
+// after HTTP_EVENT_RETRY_MS) and gets a fresh snapshot, which is cheaper than
+// buffering a backlog nobody needs.
+
+#ifndef HTTP_EVENT_CLIENTS
+#define HTTP_EVENT_CLIENTS      2      // open streams (sockets, see HTTP_TRANSFER_SLOTS)
+#endif
+#ifndef HTTP_EVENT_QUEUE_BYTES
+#define HTTP_EVENT_QUEUE_BYTES  1024   // per subscriber
+#endif
+#ifndef HTTP_EVENT_HEARTBEAT_MS
+#define HTTP_EVENT_HEARTBEAT_MS 15000
+#endif
+#ifndef HTTP_EVENT_RETRY_MS
+#define HTTP_EVENT_RETRY_MS     3000   // sent as "retry:" for EventSource reconnects
+#endif
+
+enum HttpEventFraming : uint8_t {
+  HTTP_EVENT_SSE = 0,    // text/event-stream
+  HTTP_EVENT_WEBSOCKET,  // RFC 6455 text frames
+};
+
+struct HttpEventStats {
+  uint32_t subscribed;
+  uint32_t refused;     // subscribe() with every slot taken
+  uint32_t dropped;     // queue overflow or connection lost
+  uint32_t events;      // published
+  uint32_t heartbeats;  // sent, all subscribers
+  uint64_t bytes;       // written, all subscribers
+};
+
+class HttpEventStream {
+ public:
+  HttpEventStream();
+  ~HttpEventStream();
+
+  // Takes ownership of sink (deleted when the subscriber goes away) and
+  // returns its slot; -1, with ownership left to the caller, when every slot
+  // is taken. SSE subscribers are sent the retry interval first.
+  int subscribe(HttpBodySink* sink, uint32_t nowMs, HttpEventFraming framing = HTTP_EVENT_SSE);
+
+  // Queues the event for every subscriber; data is one line of JSON
+  void publish(const char* event, const char* data, size_t len);
+  // Same for one subscriber; false when it is gone or too far behind
+  bool sendTo(int slot, const char* event, const char* data, size_t len);
+  // WebSocket control frame (pong, close) for one subscriber
+  bool sendFrame(int slot, uint8_t opcode, const uint8_t* payload, size_t len);
+  // Closes the subscriber once its queue is written
+  void close(int slot);
+  bool active(int slot) const;
+
+  // Writes what the sockets take and sends due heartbeats; returns the
+  // bytes written
+  size_t pump(uint32_t nowMs);
+
+  void closeAll();
+
+  size_t   clients() const { return _clients; }
+  uint32_t lastId() const { return _lastId; }
+  const HttpEventStats& stats() const { return _stats; }
+
+ private:
+  struct Subscriber {
+    HttpBodySink*    sink;     // nullptr: free
+    HttpEventFraming framing;
+    bool             closing;  // close() once the queue is written
+    uint32_t         lastSendMs;
+    size_t           used;     // queued bytes
+    char             queue[HTTP_EVENT_QUEUE_BYTES];
+  };
+
+  bool enqueue(Subscriber& s, const char* data, size_t len);
+  bool enqueueEvent(Subscriber& s, uint32_t id, const char* event, const char* data, size_t len);
+  void drop(Subscriber& s);
+  void release(Subscriber& s);
+
+  Subscriber     _subs[HTTP_EVENT_CLIENTS];
+  HttpEventStats _stats;
+  size_t         _clients;
+  uint32_t       _lastId;
+
+  HttpEventStream(const HttpEventStream&);
+  HttpEventStream& operator=(const HttpEventStream&);
+};
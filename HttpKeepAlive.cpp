@@ -0,0 +1,137 @@
+#include "HttpKeepAlive.h"
+
+#include <string.h>
+
+HttpKeepAlive::HttpKeepAlive(uint32_t idleMs, uint16_t maxRequests)
+  : _idleMs(idleMs), _maxRequests(maxRequests ? maxRequests : 1) {
+  memset(_slots, 0, sizeof(_slots));
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+const char* httpCloseReasonName(HttpCloseReason reason) {
+  switch (reason) {
+    case HTTP_CLOSE_PEER:      return "peer";
+    case HTTP_CLOSE_IDLE:      return "idle";
+    case HTTP_CLOSE_LIMIT:     return "limit";
+    case HTTP_CLOSE_REQUESTED: return "requested";
+    case HTTP_CLOSE_EVICTED:   return "evicted";
+    case HTTP_CLOSE_ERROR:     return "error";
+    default:                   return "unknown";
+  }
+}
+
+static bool validSlot(int slot) {
+  return slot >= 0 && slot < HTTP_SERVER_CONNECTIONS;
+}
+
+int HttpKeepAlive::open(uint32_t nowMs) {
+  for (int i = 0; i < HTTP_SERVER_CONNECTIONS; ++i) {
+    if (_slots[i].inUse) continue;
+    memset(&_slots[i], 0, sizeof(_slots[i]));
+    _slots[i].inUse  = true;
+    _slots[i].lastMs = nowMs;
+    _stats.accepted++;
+    return i;
+  }
+  return -1;
+}
+
+int HttpKeepAlive::evictionCandidate() const {
+  int best = -1;
+  for (int i = 0; i < HTTP_SERVER_CONNECTIONS; ++i) {
+    const Slot& s = _slots[i];
+    // Only connections waiting for their next request; a fresh connection
+    // may still be sending its first one
+    if (!s.inUse || s.busy || s.served == 0) continue;
+    if (best < 0 || (int32_t)(s.lastMs - _slots[best].lastMs) < 0) best = i;
+  }
+  return best;
+}
+
+void HttpKeepAlive::close(int slot, HttpCloseReason reason) {
+  if (!validSlot(slot) || !_slots[slot].inUse) return;
+  if (reason < HTTP_CLOSE_REASON_COUNT) _stats.closed[reason]++;
+  _slots[slot].inUse = false;
+}
+
+void HttpKeepAlive::touch(int slot, uint32_t nowMs) {
+  if (validSlot(slot)) _slots[slot].lastMs = nowMs;
+}
+
+void HttpKeepAlive::beginRequest(int slot, uint32_t nowMs, bool pipelined) {
+  if (!validSlot(slot)) return;
+  Slot& s = _slots[slot];
+  _stats.requests++;
+  if (s.served > 0) _stats.reused++;
+  if (pipelined) _stats.pipelined++;
+  s.busy   = true;
+  s.lastMs = nowMs;
+}
+
+bool HttpKeepAlive::endRequest(int slot, uint32_t nowMs, bool clientKeepAlive, bool responseKeepAlive) {
+  if (!validSlot(slot)) return false;
+  Slot& s = _slots[slot];
+  s.busy     = false;
+  s.deferred = false;
+  s.served++;
+  s.lastMs = nowMs;
+  if (!clientKeepAlive || !responseKeepAlive) {
+    close(slot, HTTP_CLOSE_REQUESTED);
+    return false;
+  }
+  if (s.served >= _maxRequests) {
+    close(slot, HTTP_CLOSE_LIMIT);
+    return false;
+  }
+  return true;
+}
+
+bool HttpKeepAlive::defer(int slot, uint32_t nowMs, uint32_t timeoutMs) {
+  if (!validSlot(slot) || !_slots[slot].busy) return false;
+  Slot& s = _slots[slot];
+  if (s.deferred) return nowMs - s.deferStartMs < s.deferMs;
+  if (timeoutMs == 0 || deferredCount() >= HTTP_KEEPALIVE_MAX_DEFERRED) return false;
+  s.deferred     = true;
+  s.deferStartMs = nowMs;
+  s.deferMs      = timeoutMs;
+  _stats.deferred++;
+  return true;
+}
+
+bool HttpKeepAlive::deferred(int slot) const {
+  return validSlot(slot) && _slots[slot].inUse && _slots[slot].deferred;
+}
+
+bool HttpKeepAlive::deferDue(int slot, uint32_t nowMs) const {
+  return deferred(slot) && nowMs - _slots[slot].deferStartMs >= _slots[slot].deferMs;
+}
+
+size_t HttpKeepAlive::deferredCount() const {
+  size_t n = 0;
+  for (int i = 0; i < HTTP_SERVER_CONNECTIONS; ++i) {
+    if (_slots[i].inUse && _slots[i].deferred) n++;
+  }
+  return n;
+}
+
+bool HttpKeepAlive::expired(int slot, uint32_t nowMs) const {
+  return validSlot(slot) && _slots[slot].inUse && !_slots[slot].busy && nowMs - _slots[slot].lastMs >= _idleMs;
+}
+
+uint16_t HttpKeepAlive::remaining(int slot) const {
+  if (!validSlot(slot)) return 0;
+  const uint16_t served = _slots[slot].served;
+  return served + 1 >= _maxRequests ? 0 : (uint16_t)(_maxRequests - served - 1);
+}
+
+bool HttpKeepAlive::inUse(int slot) const {
+  return validSlot(slot) && _slots[slot].inUse;
+}
+
+size_t HttpKeepAlive::openCount() const {
+  size_t n = 0;
+  for (int i = 0; i < HTTP_SERVER_CONNECTIONS; ++i) {
+    if (_slots[i].inUse) n++;
+  }
+  return n;
+}
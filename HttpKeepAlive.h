@@ -0,0 +1,112 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Persistent connection bookkeeping for HttpServer (no Arduino
+// dependencies, see test/host/httpServer_test.cpp).
+//
+// The server keeps up to HTTP_SERVER_CONNECTIONS client connections open.
+// A connection stays open after a response while the client allows it
+// (HTTP/1.1 without "Connection: close"), the response had a known length
+// or was chunked, fewer than HTTP_KEEPALIVE_MAX_REQUESTS requests have been
+// served on it and it has not been idle for HTTP_KEEPALIVE_IDLE_MS. When a
+// new connection arrives and every slot is taken, the connection that has
+// been idle longest is closed to make room.
+//
+// The counters show whether reuse works: with the dashboard polling, accepted
+// connections stay flat while requests grow.
+//
+// A handler may defer its request (long poll, HttpServer::deferRequest()):
+// the connection stays busy with the request buffered until the server
+// dispatches it again. At most HTTP_KEEPALIVE_MAX_DEFERRED requests wait at
+// once so the other connections stay free for page loads and commands.
+
+#ifndef HTTP_SERVER_CONNECTIONS
+#define HTTP_SERVER_CONNECTIONS     3     // sockets are shared with HTTP_TRANSFER_SLOTS and HTTP_EVENT_CLIENTS (lwIP: 10)
+#endif
+#ifndef HTTP_KEEPALIVE_IDLE_MS
+#define HTTP_KEEPALIVE_IDLE_MS      5000  // longer than the dashboard's 2 s poll
+#endif
+#ifndef HTTP_KEEPALIVE_MAX_REQUESTS
+#define HTTP_KEEPALIVE_MAX_REQUESTS 100
+#endif
+#ifndef HTTP_KEEPALIVE_MAX_DEFERRED
+#define HTTP_KEEPALIVE_MAX_DEFERRED 1     // long polls waiting at once
+#endif
+
+enum HttpCloseReason : uint8_t {
+  HTTP_CLOSE_PEER = 0,   // client closed or reset
+  HTTP_CLOSE_IDLE,       // idle or incomplete request for HTTP_KEEPALIVE_IDLE_MS
+  HTTP_CLOSE_LIMIT,      // HTTP_KEEPALIVE_MAX_REQUESTS served
+  HTTP_CLOSE_REQUESTED,  // "Connection: close", HTTP/1.0 or a response that ends the connection
+  HTTP_CLOSE_EVICTED,    // idle connection closed for a new one
+  HTTP_CLOSE_ERROR,      // malformed or oversized request
+  HTTP_CLOSE_REASON_COUNT
+};
+
+// "peer", "idle", ... for /api/status
+const char* httpCloseReasonName(HttpCloseReason reason);
+
+struct HttpConnectionStats {
+  uint32_t accepted;   // TCP connections, i.e. handshakes
+  uint32_t requests;
+  uint32_t reused;     // requests on a connection that had served one before
+  uint32_t pipelined;  // requests already buffered when the previous response ended
+  uint32_t deferred;   // requests that waited (long polls)
+  uint32_t closed[HTTP_CLOSE_REASON_COUNT];
+};
+
+class HttpKeepAlive {
+ public:
+  HttpKeepAlive(uint32_t idleMs = HTTP_KEEPALIVE_IDLE_MS, uint16_t maxRequests = HTTP_KEEPALIVE_MAX_REQUESTS);
+
+  // Slot for a new connection, or -1 when every slot is in use
+  int open(uint32_t nowMs);
+  // Idle slot to close for a new connection (longest idle first), or -1
+  int evictionCandidate() const;
+  void close(int slot, HttpCloseReason reason);
+
+  // Data arrived or was sent on the slot
+  void touch(int slot, uint32_t nowMs);
+  // A complete request is about to be handled
+  void beginRequest(int slot, uint32_t nowMs, bool pipelined);
+  // The response is complete; false when the connection must be closed
+  // (the slot is released and the reason counted)
+  bool endRequest(int slot, uint32_t nowMs, bool clientKeepAlive, bool responseKeepAlive);
+
+  // Lets the slot's request wait: true until timeoutMs have passed since its
+  // first defer(); false when the time is up or too many requests wait. The
+  // wait ends with endRequest() or close().
+  bool defer(int slot, uint32_t nowMs, uint32_t timeoutMs);
+  bool deferred(int slot) const;
+  // The deferred request's time is up; dispatch it again to be answered
+  bool deferDue(int slot, uint32_t nowMs) const;
+  size_t deferredCount() const;
+
+  // No complete request for idleMs
+  bool expired(int slot, uint32_t nowMs) const;
+  // Requests the slot may still serve, for the Keep-Alive header
+  uint16_t remaining(int slot) const;
+
+  bool     inUse(int slot) const;
+  size_t   openCount() const;
+  uint32_t idleMs() const { return _idleMs; }
+  uint16_t maxRequests() const { return _maxRequests; }
+  const HttpConnectionStats& stats() const { return _stats; }
+
+ private:
+  struct Slot {
+    bool     inUse;
+    bool     busy;      // request being handled
+    bool     deferred;  // ... and waiting (defer())
+    uint16_t served;
+    uint32_t lastMs;    // last activity
+    uint32_t deferStartMs;
+    uint32_t deferMs;
+  };
+
+  Slot                _slots[HTTP_SERVER_CONNECTIONS];
+  HttpConnectionStats _stats;
+  uint32_t            _idleMs;
+  uint16_t            _maxRequests;
+};
@@ -0,0 +1,260 @@
+#include "HttpParser.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static char lowerAscii(char c) {
+  return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+bool httpEqualsIgnoreCase(const char* a, size_t aLen, const char* b) {
+  size_t i = 0;
+  for (; i < aLen && b[i]; ++i) {
+    if (lowerAscii(a[i]) != lowerAscii(b[i])) return false;
+  }
+  return i == aLen && b[i] == '\0';
+}
+
+// True when the comma-separated list contains token (case-insensitive)
+static bool listHasToken(const char* s, size_t len, const char* token) {
+  size_t start = 0;
+  while (start < len) {
+    size_t end = start;
+    while (end < len && s[end] != ',') end++;
+    size_t a = start, b = end;
+    while (a < b && (s[a] == ' ' || s[a] == '\t')) a++;
+    while (b > a && (s[b - 1] == ' ' || s[b - 1] == '\t')) b--;
+    if (httpEqualsIgnoreCase(s + a, b - a, token)) return true;
+    start = end + 1;
+  }
+  return false;
+}
+
+static const char* findHeadEnd(const char* buf, size_t len) {
+  for (size_t i = 3; i < len; ++i) {
+    if (buf[i] == '\n' && buf[i - 1] == '\r' && buf[i - 2] == '\n' && buf[i - 3] == '\r') return buf + i + 1;
+  }
+  return nullptr;
+}
+
+HttpParseStatus httpParseRequestHead(const char* buf, size_t len, HttpRequestHead& head,
+                                     HttpHeaderVisitor visit, void* ctx) {
+  memset(&head, 0, sizeof(head));
+  head.contentLength = -1;
+
+  // Tolerate blank lines before a request (RFC 9112 2.2)
+  size_t skip = 0;
+  while (skip + 1 < len && buf[skip] == '\r' && buf[skip + 1] == '\n') skip += 2;
+
+  const char* end = findHeadEnd(buf + skip, len - skip);
+  if (!end) return (len > HTTP_MAX_HEAD_BYTES) ? HTTP_PARSE_ERROR : HTTP_PARSE_INCOMPLETE;
+  if ((size_t)(end - buf) > HTTP_MAX_HEAD_BYTES) return HTTP_PARSE_ERROR;
+  head.headBytes = (size_t)(end - buf);
+
+  // Request line: METHOD SP target SP HTTP/1.x CRLF
+  const char* p    = buf + skip;
+  const char* eol  = (const char*)memchr(p, '\r', (size_t)(end - p));
+  const char* sp1  = (const char*)memchr(p, ' ', (size_t)(eol - p));
+  if (!sp1 || sp1 == p) return HTTP_PARSE_ERROR;
+  const char* sp2  = (const char*)memchr(sp1 + 1, ' ', (size_t)(eol - sp1 - 1));
+  if (!sp2 || sp2 == sp1 + 1) return HTTP_PARSE_ERROR;
+  if (eol - sp2 - 1 != 8 || memcmp(sp2 + 1, "HTTP/1.", 7) != 0) return HTTP_PARSE_ERROR;
+  const char minor = sp2[8];
+  if (minor < '0' || minor > '9') return HTTP_PARSE_ERROR;
+
+  head.method       = p;
+  head.methodLen    = (size_t)(sp1 - p);
+  head.path         = sp1 + 1;
+  const char* q     = (const char*)memchr(head.path, '?', (size_t)(sp2 - head.path));
+  head.pathLen      = (size_t)((q ? q : sp2) - head.path);
+  head.query        = q ? q + 1 : sp2;
+  head.queryLen     = q ? (size_t)(sp2 - q - 1) : 0;
+  head.minorVersion = (uint8_t)(minor - '0');
+  if (head.pathLen == 0 || head.path[0] != '/') return HTTP_PARSE_ERROR;
+
+  bool connClose = false, connKeepAlive = false;
+  const char* line = eol + 2;
+  while (line < end - 2) {
+    const char* lineEnd = (const char*)memchr(line, '\r', (size_t)(end - line));
+    const char* colon   = (const char*)memchr(line, ':', (size_t)(lineEnd - line));
+    if (!colon || colon == line) return HTTP_PARSE_ERROR;
+    const char* v  = colon + 1;
+    const char* ve = lineEnd;
+    while (v < ve && (*v == ' ' || *v == '\t')) v++;
+    while (ve > v && (ve[-1] == ' ' || ve[-1] == '\t')) ve--;
+    const size_t nameLen  = (size_t)(colon - line);
+    const size_t valueLen = (size_t)(ve - v);
+
+    if (httpEqualsIgnoreCase(line, nameLen, "connection")) {
+      if (listHasToken(v, valueLen, "close"))      connClose = true;
+      if (listHasToken(v, valueLen, "keep-alive")) connKeepAlive = true;
+    } else if (httpEqualsIgnoreCase(line, nameLen, "content-length")) {
+      long n = 0;
+      if (valueLen == 0 || valueLen > 9) return HTTP_PARSE_ERROR;
+      for (size_t i = 0; i < valueLen; ++i) {
+        if (v[i] < '0' || v[i] > '9') return HTTP_PARSE_ERROR;
+        n = n * 10 + (v[i] - '0');
+      }
+      if (head.contentLength >= 0 && head.contentLength != n) return HTTP_PARSE_ERROR;
+      head.contentLength = n;
+    } else if (httpEqualsIgnoreCase(line, nameLen, "transfer-encoding")) {
+      head.chunkedBody = true;
+    } else if (httpEqualsIgnoreCase(line, nameLen, "expect")) {
+      head.expectContinue = httpEqualsIgnoreCase(v, valueLen, "100-continue");
+    }
+    if (visit) visit(line, nameLen, v, valueLen, ctx);
+    line = lineEnd + 2;
+  }
+
+  head.keepAlive = head.minorVersion >= 1 ? !connClose : (connKeepAlive && !connClose);
+  return HTTP_PARSE_DONE;
+}
+
+void httpForEachArg(const char* s, size_t len, HttpArgVisitor visit, void* ctx) {
+  size_t start = 0;
+  while (start < len) {
+    size_t end = start;
+    while (end < len && s[end] != '&') end++;
+    if (end > start) {
+      const char* eq = (const char*)memchr(s + start, '=', end - start);
+      if (eq) visit(s + start, (size_t)(eq - (s + start)), eq + 1, (size_t)(s + end - eq - 1), ctx);
+      else    visit(s + start, end - start, s + end, 0, ctx);
+    }
+    start = end + 1;
+  }
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  c = lowerAscii(c);
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+size_t httpUrlDecode(const char* in, size_t len, char* out) {
+  size_t n = 0;
+  for (size_t i = 0; i < len; ++i) {
+    if (in[i] == '+') {
+      out[n++] = ' ';
+    } else if (in[i] == '%' && i + 2 < len && hexValue(in[i + 1]) >= 0 && hexValue(in[i + 2]) >= 0) {
+      out[n++] = (char)(hexValue(in[i + 1]) * 16 + hexValue(in[i + 2]));
+      i += 2;
+    } else {
+      out[n++] = in[i];  // stray '%' kept as is
+    }
+  }
+  return n;
+}
+
+static int base64Value(char c) {
+  if (c >= 'A' && c <= 'Z') return c - 'A';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+  if (c >= '0' && c <= '9') return c - '0' + 52;
+  if (c == '+') return 62;
+  if (c == '/') return 63;
+  return -1;
+}
+
+size_t httpBase64Decode(const char* in, size_t len, char* out, size_t outCap) {
+  while (len > 0 && in[len - 1] == '=') len--;
+  if (len % 4 == 1) return 0;
+  const size_t need = len * 3 / 4;
+  if (need > outCap) return 0;
+
+  uint32_t acc  = 0;
+  int      bits = 0;
+  size_t   n    = 0;
+  for (size_t i = 0; i < len; ++i) {
+    const int v = base64Value(in[i]);
+    if (v < 0) return 0;
+    acc = (acc << 6) | (uint32_t)v;
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      out[n++] = (char)((acc >> bits) & 0xFF);
+    }
+  }
+  return n;
+}
+
+size_t httpBase64Encode(const uint8_t* in, size_t len, char* out) {
+  static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t n = 0;
+  for (size_t i = 0; i < len; i += 3) {
+    const uint32_t v = ((uint32_t)in[i] << 16) | (i + 1 < len ? (uint32_t)in[i + 1] << 8 : 0) |
+                       (i + 2 < len ? in[i + 2] : 0);
+    out[n++] = kAlphabet[(v >> 18) & 0x3F];
+    out[n++] = kAlphabet[(v >> 12) & 0x3F];
+    out[n++] = i + 1 < len ? kAlphabet[(v >> 6) & 0x3F] : '=';
+    out[n++] = i + 2 < len ? kAlphabet[v & 0x3F] : '=';
+  }
+  out[n] = '\0';
+  return n;
+}
+
+const char* httpReasonPhrase(int code) {
+  switch (code) {
+    case 100: return "Continue";
+    case 101: return "Switching Protocols";
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 303: return "See Other";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 411: return "Length Required";
+    case 413: return "Content Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default:  return "";
+  }
+}
+
+// ===== Receive buffer =====
+
+HttpReceiveBuffer::HttpReceiveBuffer(size_t maxBytes)
+  : _data(nullptr), _used(0), _cap(0), _max(maxBytes) {}
+
+HttpReceiveBuffer::~HttpReceiveBuffer() {
+  free(_data);
+}
+
+char* HttpReceiveBuffer::reserve(size_t want, size_t& granted) {
+  granted = 0;
+  if (_used >= _max) return nullptr;
+  if (want > _max - _used) want = _max - _used;
+  if (_cap - _used < want) {
+    size_t cap = _cap ? _cap : 512;
+    while (cap - _used < want) cap *= 2;
+    if (cap > _max) cap = _max;
+    char* grown = (char*)realloc(_data, cap);
+    if (!grown) return nullptr;
+    _data = grown;
+    _cap  = cap;
+  }
+  granted = want;
+  return _data + _used;
+}
+
+void HttpReceiveBuffer::consume(size_t n) {
+  if (n >= _used) {
+    _used = 0;
+    return;
+  }
+  memmove(_data, _data + n, _used - n);
+  _used -= n;
+}
+
+void HttpReceiveBuffer::clear() {
+  free(_data);
+  _data = nullptr;
+  _used = 0;
+  _cap  = 0;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// HTTP/1.x request parsing for HttpServer (no Arduino dependencies, see
+// test/host/httpServer_test.cpp).
+//
+// Requests are parsed in place from a connection's receive buffer, which
+// may hold more than one request (pipelining): httpParseRequestHead() reports
+// how many bytes the head took, the body follows, and whatever comes after
+// the body is the next request.
+
+#ifndef HTTP_MAX_HEAD_BYTES
+#define HTTP_MAX_HEAD_BYTES 2048   // request line and headers
+#endif
+#ifndef HTTP_MAX_BODY_BYTES
+#define HTTP_MAX_BODY_BYTES 16384  // form posts (the config page is the largest)
+#endif
+
+enum HttpParseStatus : uint8_t {
+  HTTP_PARSE_INCOMPLETE = 0,  // head not complete yet
+  HTTP_PARSE_DONE,
+  HTTP_PARSE_ERROR,           // malformed or over HTTP_MAX_HEAD_BYTES
+};
+
+struct HttpRequestHead {
+  const char* method;
+  size_t      methodLen;
+  const char* path;        // target without the query
+  size_t      pathLen;
+  const char* query;       // after '?', may be empty
+  size_t      queryLen;
+  uint8_t     minorVersion;  // HTTP/1.<minor>
+  bool        keepAlive;     // HTTP/1.1 unless "Connection: close", HTTP/1.0 only with "keep-alive"
+  bool        expectContinue;
+  bool        chunkedBody;   // not supported; answered with 411
+  long        contentLength; // -1 when absent
+  size_t      headBytes;     // request line + headers + blank line
+};
+
+// Called for every header line; name and value are trimmed, not terminated
+typedef void (*HttpHeaderVisitor)(const char* name, size_t nameLen, const char* value, size_t valueLen, void* ctx);
+
+HttpParseStatus httpParseRequestHead(const char* buf, size_t len, HttpRequestHead& head,
+                                     HttpHeaderVisitor visit = nullptr, void* ctx = nullptr);
+
+// Calls visit for every name=value pair of a query string or form body (raw,
+// not decoded; value is empty for "name" without '=')
+typedef void (*HttpArgVisitor)(const char* name, size_t nameLen, const char* value, size_t valueLen, void* ctx);
+void httpForEachArg(const char* s, size_t len, HttpArgVisitor visit, void* ctx);
+
+// %xx and '+' decoding; out needs len bytes. Returns the decoded length.
+size_t httpUrlDecode(const char* in, size_t len, char* out);
+
+// Returns the decoded length, or 0 when out is too small or in is not base64
+size_t httpBase64Decode(const char* in, size_t len, char* out, size_t outCap);
+// out needs 4 * ((len + 2) / 3) + 1 bytes; returns the encoded length
+size_t httpBase64Encode(const uint8_t* in, size_t len, char* out);
+
+bool httpEqualsIgnoreCase(const char* a, size_t aLen, const char* b);
+
+const char* httpReasonPhrase(int code);
+
+// Receive buffer of one connection; grows on demand up to maxBytes
+class HttpReceiveBuffer {
+ public:
+  explicit HttpReceiveBuffer(size_t maxBytes = HTTP_MAX_HEAD_BYTES + HTTP_MAX_BODY_BYTES);
+  ~HttpReceiveBuffer();
+
+  // Space for up to want more bytes; commit() what was actually filled.
+  // nullptr when the buffer is at maxBytes or out of memory.
+  char* reserve(size_t want, size_t& granted);
+  void  commit(size_t n) { _used += n; }
+
+  void consume(size_t n);  // drops n bytes from the front
+  void clear();            // also frees the memory
+
+  char*       data() { return _data; }
+  const char* data() const { return _data; }
+  size_t      size() const { return _used; }
+
+ private:
+  char*  _data;
+  size_t _used;
+  size_t _cap;
+  size_t _max;
+
+  HttpReceiveBuffer(const HttpReceiveBuffer&);
+  HttpReceiveBuffer& operator=(const HttpReceiveBuffer&);
+};
@@ -0,0 +1,494 @@
+#include "HttpServer.h"
+
+static const size_t HTTP_READ_CHUNK        = 1024;
+static const size_t HTTP_COALESCE_BYTES    = 1024;  // smaller payloads share a segment with their framing
+static const size_t CONTENT_LENGTH_NOT_SET = (size_t)-2;
+static const size_t HTTP_BUILTIN_HEADERS   = 2;     // Authorization, Content-Type
+
+static String makeString(const char* s, size_t len) {
+  String out;
+  out.concat(s, len);
+  return out;
+}
+
+static bool methodFromName(const char* s, size_t len, HTTPMethod& method) {
+  if (httpEqualsIgnoreCase(s, len, "GET"))     { method = HTTP_GET;     return true; }
+  if (httpEqualsIgnoreCase(s, len, "POST"))    { method = HTTP_POST;    return true; }
+  if (httpEqualsIgnoreCase(s, len, "HEAD"))    { method = HTTP_HEAD;    return true; }
+  if (httpEqualsIgnoreCase(s, len, "PUT"))     { method = HTTP_PUT;     return true; }
+  if (httpEqualsIgnoreCase(s, len, "PATCH"))   { method = HTTP_PATCH;   return true; }
+  if (httpEqualsIgnoreCase(s, len, "DELETE"))  { method = HTTP_DELETE;  return true; }
+  if (httpEqualsIgnoreCase(s, len, "OPTIONS")) { method = HTTP_OPTIONS; return true; }
+  return false;
+}
+
+HttpServer::HttpServer(uint16_t port)
+  : _server(port), _next(0), _wake(false), _routeCount(0), _notFound(nullptr),
+    _headerKeys(nullptr), _headerValues(nullptr), _headerCount(0),
+    _method(HTTP_GET), _minorVersion(1), _requestKeepAlive(false), _args(nullptr), _argCount(0),
+    _contentLength(CONTENT_LENGTH_NOT_SET), _slot(-1), _headSent(false), _chunked(false),
+    _chunkEnded(false), _responseKeepAlive(false), _detached(false), _deferred(false), _writeFailed(false) {
+  for (int i = 0; i < HTTP_SERVER_CONNECTIONS; ++i) {
+    _conns[i].leftover     = false;
+    _conns[i].continueSent = false;
+  }
+  collectHeaders(nullptr, 0);
+}
+
+HttpServer::~HttpServer() {
+  delete[] _headerKeys;
+  delete[] _headerValues;
+  delete[] _args;
+}
+
+void HttpServer::begin() {
+  _server.begin();
+  _server.setNoDelay(true);
+}
+
+void HttpServer::on(const String& uri, HTTPMethod method, THandlerFunction fn) {
+  if (_routeCount >= HTTP_SERVER_MAX_ROUTES) {
+    Serial.printf("[WEB] Route table full, %s not registered\n", uri.c_str());
+    return;
+  }
+  _routes[_routeCount].uri    = uri;
+  _routes[_routeCount].method = method;
+  _routes[_routeCount].fn     = fn;
+  _routeCount++;
+}
+
+void HttpServer::onNotFound(THandlerFunction fn) {
+  _notFound = fn;
+}
+
+void HttpServer::collectHeaders(const char* headerKeys[], size_t count) {
+  delete[] _headerKeys;
+  delete[] _headerValues;
+  _headerCount  = count + HTTP_BUILTIN_HEADERS;
+  _headerKeys   = new String[_headerCount];
+  _headerValues = new String[_headerCount];
+  _headerKeys[0] = "Authorization";  // authenticate()
+  _headerKeys[1] = "Content-Type";   // form bodies
+  for (size_t i = 0; i < count; ++i) _headerKeys[i + HTTP_BUILTIN_HEADERS] = headerKeys[i];
+}
+
+// ================= Connections =================
+
+void HttpServer::handleClient() {
+  const uint32_t now = millis();
+  acceptConnections(now);
+
+  for (int k = 0; k < HTTP_SERVER_CONNECTIONS; ++k) {
+    const int slot = (_next + k) % HTTP_SERVER_CONNECTIONS;
+    if (_keepAlive.inUse(slot)) serveConnection(slot, now);
+  }
+  _next = (_next + 1) % HTTP_SERVER_CONNECTIONS;
+  _wake = false;
+}
+
+void HttpServer::acceptConnections(uint32_t nowMs) {
+  while (_server.hasClient()) {
+    int slot = _keepAlive.openCount() < HTTP_SERVER_CONNECTIONS ? -2 : _keepAlive.evictionCandidate();
+    // Every connection is mid-request: leave the new one in the backlog
+    if (slot == -1) return;
+    if (slot >= 0) closeConnection(slot, HTTP_CLOSE_EVICTED);
+
+    WiFiClient client = _server.accept();
+    if (!client) return;
+    slot = _keepAlive.open(nowMs);
+    if (slot < 0) {
+      client.stop();
+      return;
+    }
+    client.setNoDelay(true);
+    Connection& c  = _conns[slot];
+    c.client       = client;
+    c.leftover     = false;
+    c.continueSent = false;
+  }
+}
+
+void HttpServer::receive(Connection& c) {
+  int avail;
+  while ((avail = c.client.available()) > 0) {
+    size_t granted;
+    char* dst = c.rx.reserve((size_t)avail < HTTP_READ_CHUNK ? (size_t)avail : HTTP_READ_CHUNK, granted);
+    if (!dst) return;  // full; the parser rejects the request
+    int n = c.client.read(reinterpret_cast<uint8_t*>(dst), granted);
+    if (n <= 0) return;
+    c.rx.commit((size_t)n);
+  }
+}
+
+bool HttpServer::serveConnection(int slot, uint32_t nowMs) {
+  Connection& c = _conns[slot];
+  const size_t before = c.rx.size();
+  receive(c);
+  if (c.rx.size() > before) _keepAlive.touch(slot, nowMs);
+
+  if (_keepAlive.deferred(slot)) {
+    if (!c.client.connected() && c.client.available() == 0) {
+      closeConnection(slot, HTTP_CLOSE_PEER);
+      return false;
+    }
+    // The buffered request is parsed and dispatched again below
+    if (!_wake && !_keepAlive.deferDue(slot, nowMs)) return false;
+  }
+
+  if (c.rx.size() == 0) {
+    if (!c.client.connected())          closeConnection(slot, HTTP_CLOSE_PEER);
+    else if (_keepAlive.expired(slot, nowMs)) closeConnection(slot, HTTP_CLOSE_IDLE);
+    return false;
+  }
+
+  HttpRequestHead head;
+  const HttpParseStatus st = httpParseRequestHead(c.rx.data(), c.rx.size(), head);
+  if (st == HTTP_PARSE_ERROR) {
+    rejectRequest(slot, c.rx.size() > HTTP_MAX_HEAD_BYTES ? 431 : 400);
+    return false;
+  }
+  if (st == HTTP_PARSE_DONE) {
+    if (head.chunkedBody) {
+      rejectRequest(slot, 411);
+      return false;
+    }
+    if (head.contentLength > HTTP_MAX_BODY_BYTES) {
+      rejectRequest(slot, 413);
+      return false;
+    }
+    const size_t total = head.headBytes + (head.contentLength > 0 ? (size_t)head.contentLength : 0);
+    if (c.rx.size() >= total) {
+      handleRequest(slot, head);
+      return true;
+    }
+    if (head.expectContinue && !c.continueSent) {
+      static const char kContinue[] = "HTTP/1.1 100 Continue\r\n\r\n";
+      c.client.write(reinterpret_cast<const uint8_t*>(kContinue), sizeof(kContinue) - 1);
+      c.continueSent = true;
+    }
+  }
+
+  // Incomplete request: the peer went away or stalled
+  if (!c.client.connected() && c.client.available() == 0) closeConnection(slot, HTTP_CLOSE_PEER);
+  else if (_keepAlive.expired(slot, nowMs))               closeConnection(slot, HTTP_CLOSE_IDLE);
+  return false;
+}
+
+void HttpServer::closeConnection(int slot, HttpCloseReason reason) {
+  Connection& c = _conns[slot];
+  c.client.stop();
+  c.client = WiFiClient();
+  c.rx.clear();
+  c.leftover     = false;
+  c.continueSent = false;
+  _keepAlive.close(slot, reason);
+}
+
+// Error answered without a handler; the connection is not reused
+void HttpServer::rejectRequest(int slot, int code) {
+  Connection& c = _conns[slot];
+  String head = String("HTTP/1.1 ") + code + " " + httpReasonPhrase(code) +
+                "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+  c.client.write(reinterpret_cast<const uint8_t*>(head.c_str()), head.length());
+  Serial.printf("[WEB] Rejected request (%d)\n", code);
+  closeConnection(slot, HTTP_CLOSE_ERROR);
+}
+
+// ================= Requests =================
+
+void HttpServer::handleRequest(int slot, const HttpRequestHead& head) {
+  Connection& c = _conns[slot];
+  resetRequest();
+
+  HttpRequestHead collected;
+  httpParseRequestHead(c.rx.data(), c.rx.size(), collected, collectHeader, this);
+
+  _slot             = slot;
+  _client           = c.client;
+  _minorVersion     = head.minorVersion;
+  _requestKeepAlive = head.keepAlive;
+
+  char* decoded = (char*)malloc(head.pathLen + 1);
+  if (decoded) {
+    _uri = makeString(decoded, httpUrlDecode(head.path, head.pathLen, decoded));
+    free(decoded);
+  }
+
+  // Query arguments, then form fields, then the raw body as "plain" (like WebServer)
+  const char*  body    = c.rx.data() + head.headBytes;
+  const size_t bodyLen = head.contentLength > 0 ? (size_t)head.contentLength : 0;
+  const String type    = header("Content-Type");
+  const bool   form    = type.startsWith("application/x-www-form-urlencoded");
+  size_t count = 0;
+  httpForEachArg(head.query, head.queryLen, countArg, &count);
+  if (form) httpForEachArg(body, bodyLen, countArg, &count);
+  if (bodyLen > 0) count++;
+  if (count > 0) {
+    _args = new Arg[count];
+    addArgs(head.query, head.queryLen);
+    if (form) addArgs(body, bodyLen);
+    if (bodyLen > 0) {
+      _args[_argCount].name  = "plain";
+      _args[_argCount].value = makeString(body, bodyLen);
+      _argCount++;
+    }
+  }
+
+  // A deferred request dispatched again is still the same request
+  if (!_keepAlive.deferred(slot)) _keepAlive.beginRequest(slot, millis(), c.leftover);
+  if (methodFromName(head.method, head.methodLen, _method)) {
+    dispatch();
+  } else {
+    send(405, "text/plain", "Method not allowed");
+  }
+  if (_deferred) {
+    resetRequest();
+    return;
+  }
+  finishResponse();
+
+  const size_t total = head.headBytes + bodyLen;
+  c.rx.consume(total);
+  c.leftover     = c.rx.size() > 0;
+  c.continueSent = false;
+
+  const bool keep = _keepAlive.endRequest(slot, millis(), _requestKeepAlive, _responseKeepAlive && !_writeFailed);
+  if (_detached) {
+    // The transfer owns the socket now
+    c.client = WiFiClient();
+    c.rx.clear();
+    c.leftover = false;
+  } else if (!keep) {
+    c.client.stop();
+    c.client = WiFiClient();
+    c.rx.clear();
+    c.leftover = false;
+  }
+  resetRequest();
+}
+
+void HttpServer::dispatch() {
+  for (size_t i = 0; i < _routeCount; ++i) {
+    const Route& r = _routes[i];
+    if ((r.method == _method || r.method == HTTP_ANY) && r.uri == _uri) {
+      r.fn();
+      return;
+    }
+  }
+  if (_notFound) _notFound();
+  else           send(404, "text/plain", "Not found");
+}
+
+void HttpServer::finishResponse() {
+  if (!_headSent) {
+    // The handler answered nothing; do not leave the client waiting
+    _responseKeepAlive = false;
+    send(500, "text/plain", "");
+  }
+  if (_chunked && !_chunkEnded) sendContent("", 0);
+}
+
+void HttpServer::resetRequest() {
+  delete[] _args;
+  _args     = nullptr;
+  _argCount = 0;
+  for (size_t i = 0; i < _headerCount; ++i) _headerValues[i] = String();
+  _uri              = String();
+  _client           = WiFiClient();
+  _slot             = -1;
+  _responseHeaders  = String();
+  _contentLength    = CONTENT_LENGTH_NOT_SET;
+  _headSent         = false;
+  _chunked          = false;
+  _chunkEnded       = false;
+  _responseKeepAlive = true;
+  _detached         = false;
+  _deferred         = false;
+  _writeFailed      = false;
+}
+
+void HttpServer::collectHeader(const char* name, size_t nameLen, const char* value, size_t valueLen, void* ctx) {
+  HttpServer* self = static_cast<HttpServer*>(ctx);
+  for (size_t i = 0; i < self->_headerCount; ++i) {
+    if (httpEqualsIgnoreCase(name, nameLen, self->_headerKeys[i].c_str())) {
+      self->_headerValues[i] = makeString(value, valueLen);
+      return;
+    }
+  }
+}
+
+void HttpServer::countArg(const char*, size_t, const char*, size_t, void* ctx) {
+  (*static_cast<size_t*>(ctx))++;
+}
+
+void HttpServer::storeArg(const char* name, size_t nameLen, const char* value, size_t valueLen, void* ctx) {
+  HttpServer* self = static_cast<HttpServer*>(ctx);
+  char* buf = (char*)malloc((nameLen > valueLen ? nameLen : valueLen) + 1);
+  if (!buf) return;
+  Arg& a = self->_args[self->_argCount++];
+  a.name  = makeString(buf, httpUrlDecode(name, nameLen, buf));
+  a.value = makeString(buf, httpUrlDecode(value, valueLen, buf));
+  free(buf);
+}
+
+void HttpServer::addArgs(const char* s, size_t len) {
+  httpForEachArg(s, len, storeArg, this);
+}
+
+bool HttpServer::hasArg(const String& name) const {
+  for (size_t i = 0; i < _argCount; ++i) {
+    if (_args[i].name == name) return true;
+  }
+  return false;
+}
+
+String HttpServer::arg(const String& name) const {
+  for (size_t i = 0; i < _argCount; ++i) {
+    if (_args[i].name == name) return _args[i].value;
+  }
+  return String();
+}
+
+String HttpServer::arg(int i) const {
+  return (i >= 0 && (size_t)i < _argCount) ? _args[i].value : String();
+}
+
+String HttpServer::argName(int i) const {
+  return (i >= 0 && (size_t)i < _argCount) ? _args[i].name : String();
+}
+
+bool HttpServer::hasHeader(const String& name) const {
+  return header(name).length() > 0;
+}
+
+String HttpServer::header(const String& name) const {
+  for (size_t i = 0; i < _headerCount; ++i) {
+    if (httpEqualsIgnoreCase(name.c_str(), name.length(), _headerKeys[i].c_str())) return _headerValues[i];
+  }
+  return String();
+}
+
+// HTTP Basic only, which is what requireAuth() asks for
+bool HttpServer::authenticate(const char* user, const char* pass) {
+  const String& auth = _headerValues[0];
+  if (!auth.startsWith("Basic ")) return false;
+  char decoded[160];
+  const size_t n = httpBase64Decode(auth.c_str() + 6, auth.length() - 6, decoded, sizeof(decoded) - 1);
+  if (n == 0) return false;
+  decoded[n] = '\0';
+  String expected = String(user) + ":" + pass;
+  return expected == decoded;
+}
+
+void HttpServer::requestAuthentication() {
+  sendHeader("WWW-Authenticate", "Basic realm=\"Login Required\"");
+  send(401, "text/plain", "");
+}
+
+// ================= Responses =================
+
+void HttpServer::sendHeader(const String& name, const String& value, bool first) {
+  String line = name + ": " + value + "\r\n";
+  if (first) _responseHeaders = line + _responseHeaders;
+  else       _responseHeaders += line;
+}
+
+WiFiClient HttpServer::detachClient() {
+  _detached = true;
+  return _client;
+}
+
+bool HttpServer::deferRequest(uint32_t timeoutMs) {
+  if (_headSent || _detached || _slot < 0) return false;
+  _deferred = _keepAlive.defer(_slot, millis(), timeoutMs);
+  return _deferred;
+}
+
+bool HttpServer::writeAll(const char* data, size_t len) {
+  if (_writeFailed) return false;
+  if (len == 0) return true;
+  if (_client.write(reinterpret_cast<const uint8_t*>(data), len) != len) {
+    _writeFailed = true;
+    return false;
+  }
+  return true;
+}
+
+void HttpServer::send(int code, const char* contentType, const String& content) {
+  if (_headSent) return;
+  _headSent = true;
+
+  const size_t length = _contentLength == CONTENT_LENGTH_NOT_SET ? content.length() : _contentLength;
+  if (_detached) _responseKeepAlive = false;
+
+  if (code == 101) {
+    // Protocol switch: the handler sets Upgrade and Connection, no body
+    _responseKeepAlive = false;
+    String head = String("HTTP/1.1 101 ") + httpReasonPhrase(101) + "\r\n" + _responseHeaders + "\r\n";
+    writeAll(head.c_str(), head.length());
+    return;
+  }
+
+  String head;
+  head.reserve(160 + _responseHeaders.length());
+  head = String("HTTP/1.1 ") + code + " " + httpReasonPhrase(code) + "\r\n";
+  head += "Content-Type: ";
+  head += contentType ? contentType : "text/html";
+  head += "\r\n";
+  if (length != CONTENT_LENGTH_UNKNOWN) {
+    head += "Content-Length: ";
+    head += String((unsigned long)length);
+    head += "\r\n";
+  } else if (_minorVersion >= 1 && !_detached) {
+    head += "Transfer-Encoding: chunked\r\n";
+    _chunked = true;
+  } else {
+    _responseKeepAlive = false;  // HTTP/1.0 or detached: the body ends with the connection
+  }
+  head += _responseHeaders;
+
+  const uint16_t remaining = _keepAlive.remaining(_slot);
+  if (_requestKeepAlive && _responseKeepAlive && remaining > 0) {
+    head += "Connection: keep-alive\r\nKeep-Alive: timeout=";
+    head += String((unsigned long)(_keepAlive.idleMs() / 1000));
+    head += ", max=";
+    head += String((unsigned long)remaining);
+    head += "\r\n\r\n";
+  } else {
+    _responseKeepAlive = false;
+    head += "Connection: close\r\n\r\n";
+  }
+
+  // Small bodies go out in the same segment as the headers
+  if (!_chunked && content.length() > 0 && content.length() < HTTP_COALESCE_BYTES) {
+    head += content;
+    writeAll(head.c_str(), head.length());
+    return;
+  }
+  writeAll(head.c_str(), head.length());
+  if (content.length() > 0) sendContent(content);
+}
+
+void HttpServer::sendContent(const char* data, size_t len) {
+  if (!_chunked) {
+    writeAll(data, len);
+    return;
+  }
+  if (_chunkEnded) return;
+  if (len == 0) {
+    writeAll("0\r\n\r\n", 5);
+    _chunkEnded = true;
+    return;
+  }
+  char frame[12 + HTTP_COALESCE_BYTES];
+  const int n = snprintf(frame, 12, "%x\r\n", (unsigned)len);
+  if (len <= HTTP_COALESCE_BYTES) {
+    memcpy(frame + n, data, len);
+    memcpy(frame + n + len, "\r\n", 2);
+    writeAll(frame, (size_t)n + len + 2);
+    return;
+  }
+  writeAll(frame, (size_t)n);
+  writeAll(data, len);
+  writeAll("\r\n", 2);
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WebServer.h>  // HTTPMethod, HTTP_GET, CONTENT_LENGTH_UNKNOWN
+
+#include "HttpKeepAlive.h"
+#include "HttpParser.h"
+
+// HTTP/1.1 server with persistent connections.
+//
+// Offers the part of the WebServer interface WebUI.cpp uses, so handlers,
+// the route table and requireAuth() are unchanged, but keeps up to
+// HTTP_SERVER_CONNECTIONS connections open between requests (see
+// HttpKeepAlive.h) instead of closing every connection after its response.
+// Requests are read without blocking; every handleClient() serves at most
+// one request per connection, in turn, and pipelined requests already in the
+// receive buffer are served on the following calls. Responses are written
+// like WebServer does (blocking until lwIP has taken them).
+
+#ifndef HTTP_SERVER_MAX_ROUTES
+#define HTTP_SERVER_MAX_ROUTES 40
+#endif
+
+class HttpServer {
+ public:
+  typedef void (*THandlerFunction)();
+
+  explicit HttpServer(uint16_t port = 80);
+  ~HttpServer();
+
+  void begin();
+  void handleClient();
+
+  void on(const String& uri, HTTPMethod method, THandlerFunction fn);
+  void onNotFound(THandlerFunction fn);
+  void collectHeaders(const char* headerKeys[], size_t count);
+
+  // ---- Current request ----
+  String     uri() const { return _uri; }
+  HTTPMethod method() const { return _method; }
+  bool       hasArg(const String& name) const;
+  String     arg(const String& name) const;
+  String     arg(int i) const;
+  String     argName(int i) const;
+  int        args() const { return (int)_argCount; }
+  bool       hasHeader(const String& name) const;
+  String     header(const String& name) const;
+  bool       authenticate(const char* user, const char* pass);
+  void       requestAuthentication();
+  WiFiClient client() { return _client; }
+
+  // ---- Response ----
+  void sendHeader(const String& name, const String& value, bool first = false);
+  void setContentLength(size_t len) { _contentLength = len; }
+  void send(int code, const char* contentType = nullptr, const String& content = String());
+  void send(int code, const String& contentType, const String& content) { send(code, contentType.c_str(), content); }
+  void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char* data, size_t len);
+
+  // Hands the connection to the caller once the response headers are out
+  // (call before send(); the response says "Connection: close", a body of
+  // unknown length is not chunked, and the server drops its reference
+  // without closing the socket).
+  WiFiClient detachClient();
+
+  // Long poll: leaves the current request unanswered, still buffered on its
+  // connection, and dispatches it again after wakeDeferred() or once
+  // timeoutMs have passed since it was first deferred. Returns false, and
+  // the handler answers now, when that time is up or the connection would
+  // exceed HTTP_KEEPALIVE_MAX_DEFERRED (see HttpKeepAlive.h).
+  bool deferRequest(uint32_t timeoutMs);
+  // Dispatches deferred requests again on the next handleClient()
+  void wakeDeferred() { _wake = true; }
+
+  const HttpKeepAlive& connections() const { return _keepAlive; }
+
+ private:
+  struct Route {
+    String           uri;
+    HTTPMethod       method;
+    THandlerFunction fn;
+  };
+  struct Arg {
+    String name;
+    String value;
+  };
+  struct Connection {
+    WiFiClient        client;
+    HttpReceiveBuffer rx;
+    bool              leftover;      // bytes of the next request arrived with the last one
+    bool              continueSent;  // "100 Continue" answered for the buffered head
+  };
+
+  void acceptConnections(uint32_t nowMs);
+  bool serveConnection(int slot, uint32_t nowMs);  // true when a request was handled
+  void receive(Connection& c);
+  void handleRequest(int slot, const HttpRequestHead& head);
+  void dispatch();
+  void finishResponse();
+  void closeConnection(int slot, HttpCloseReason reason);
+  void rejectRequest(int slot, int code);
+  void resetRequest();
+
+  static void collectHeader(const char* name, size_t nameLen, const char* value, size_t valueLen, void* ctx);
+  static void countArg(const char* name, size_t nameLen, const char* value, size_t valueLen, void* ctx);
+  static void storeArg(const char* name, size_t nameLen, const char* value, size_t valueLen, void* ctx);
+  void addArgs(const char* s, size_t len);
+
+  bool writeAll(const char* data, size_t len);
+
+  WiFiServer    _server;
+  HttpKeepAlive _keepAlive;
+  Connection    _conns[HTTP_SERVER_CONNECTIONS];
+  int           _next;  // round-robin start
+  bool          _wake;  // wakeDeferred() since the last handleClient()
+
+  Route            _routes[HTTP_SERVER_MAX_ROUTES];
+  size_t           _routeCount;
+  THandlerFunction _notFound;
+
+  String* _headerKeys;    // collected headers, plus Authorization
+  String* _headerValues;
+  size_t  _headerCount;
+
+  // Current request
+  WiFiClient _client;
+  String     _uri;
+  HTTPMethod _method;
+  uint8_t    _minorVersion;
+  bool       _requestKeepAlive;
+  Arg*       _args;
+  size_t     _argCount;
+
+  // Current response
+  String _responseHeaders;
+  size_t _contentLength;
+  int    _slot;
+  bool   _headSent;
+  bool   _chunked;
+  bool   _chunkEnded;
+  bool   _responseKeepAlive;
+  bool   _detached;
+  bool   _deferred;
+  bool   _writeFailed;
+
+  HttpServer(const HttpServer&);
+  HttpServer& operator=(const HttpServer&);
+};
@@ -0,0 +1,104 @@
+#include "HttpTransfers.h"
+
+#include <string.h>
+
+HttpTransferPool::HttpTransferPool(ClockFn micros)
+  : _micros(micros), _active(0), _next(0) {
+  memset(_slots, 0, sizeof(_slots));
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+HttpTransferPool::~HttpTransferPool() {
+  abortAll();
+}
+
+bool HttpTransferPool::start(HttpBodySink* sink, HttpBodySource* source, size_t length) {
+  for (size_t i = 0; i < HTTP_TRANSFER_SLOTS; ++i) {
+    Slot& slot = _slots[i];
+    if (slot.sink) continue;
+    slot.sink           = sink;
+    slot.source         = source;
+    slot.remaining      = length;
+    slot.untilEnd       = length == HTTP_TRANSFER_UNTIL_END;
+    slot.staged         = 0;
+    slot.offset         = 0;
+    slot.lastProgressUs = _micros();
+    _active++;
+    _stats.started++;
+    if (_active > _stats.peak) _stats.peak = (uint8_t)_active;
+    return true;
+  }
+  _stats.refused++;
+  return false;
+}
+
+void HttpTransferPool::finish(Slot& slot, bool completed) {
+  delete slot.sink;
+  delete slot.source;
+  slot.sink   = nullptr;
+  slot.source = nullptr;
+  _active--;
+  if (completed) _stats.completed++;
+  else           _stats.aborted++;
+}
+
+bool HttpTransferPool::step(Slot& slot, uint32_t nowUs) {
+  if (slot.staged == 0 && slot.remaining > 0) {
+    const size_t want = slot.remaining < sizeof(slot.buf) ? slot.remaining : sizeof(slot.buf);
+    slot.staged = slot.source->read(slot.buf, want);
+    slot.offset = 0;
+    if (slot.staged == 0) {  // unless sent until the end, the client cannot recover
+      finish(slot, slot.untilEnd);
+      return false;
+    }
+  }
+
+  if (slot.staged > 0) {
+    const int n = slot.sink->write(slot.buf + slot.offset, slot.staged);
+    if (n < 0) {
+      finish(slot, false);
+      return false;
+    }
+    if (n == 0) {
+      if (nowUs - slot.lastProgressUs >= HTTP_TRANSFER_STALL_MS * 1000UL) finish(slot, false);
+      return false;
+    }
+    slot.offset    += (size_t)n;
+    slot.staged    -= (size_t)n;
+    if (!slot.untilEnd) slot.remaining -= (size_t)n;
+    slot.lastProgressUs = nowUs;
+    _stats.bytes += (size_t)n;
+  }
+
+  if (slot.remaining == 0 && slot.staged == 0) finish(slot, true);
+  return true;
+}
+
+size_t HttpTransferPool::pump(uint32_t budgetUs) {
+  if (_active == 0) return 0;
+  const uint64_t before = _stats.bytes;
+  const uint32_t startUs = _micros();
+
+  bool progress = true;
+  while (progress && _active > 0) {
+    progress = false;
+    for (size_t k = 0; k < HTTP_TRANSFER_SLOTS; ++k) {
+      Slot& slot = _slots[(_next + k) % HTTP_TRANSFER_SLOTS];
+      if (!slot.sink) continue;
+      const uint32_t nowUs = _micros();
+      if (nowUs - startUs >= budgetUs) {
+        _next = (_next + k) % HTTP_TRANSFER_SLOTS;  // resume here next time
+        return (size_t)(_stats.bytes - before);
+      }
+      if (step(slot, nowUs)) progress = true;
+    }
+  }
+  _next = (_next + 1) % HTTP_TRANSFER_SLOTS;
+  return (size_t)(_stats.bytes - before);
+}
+
+void HttpTransferPool::abortAll() {
+  for (size_t i = 0; i < HTTP_TRANSFER_SLOTS; ++i) {
+    if (_slots[i].sink) finish(_slots[i], false);
+  }
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Non-blocking response bodies (no Arduino dependencies, see
+// test/host/httpTransfers_test.cpp).
+//
+// WebServer parses a request and runs its handler synchronously; a handler
+// that writes a large body to a slow client blocks until the client has
+// received all of it. Instead, a handler sends the status line and headers
+// and hands the body to an HttpTransferPool, which loop() pumps for a bounded
+// time per iteration: every connection gets one slice in turn, a socket that
+// cannot take more data is skipped rather than waited on, so several
+// downloads proceed side by side and the control loop keeps its schedule.
+// Connections that make no progress for HTTP_TRANSFER_STALL_MS are dropped.
+
+#ifndef HTTP_TRANSFER_SLOTS
+#define HTTP_TRANSFER_SLOTS    3     // concurrent bodies; with HTTP_SERVER_CONNECTIONS, HTTP_EVENT_CLIENTS, listen and DNS within lwIP's 10 sockets
+#endif
+#ifndef HTTP_TRANSFER_SLICE
+#define HTTP_TRANSFER_SLICE    1024  // bytes staged per connection
+#endif
+#ifndef HTTP_TRANSFER_STALL_MS
+#define HTTP_TRANSFER_STALL_MS 10000
+#endif
+
+// start() length of a body that ends when its source does (sent without
+// Content-Length on a connection that closes afterwards)
+#define HTTP_TRANSFER_UNTIL_END ((size_t)-1)
+
+// Where a body goes; write() must not block
+class HttpBodySink {
+ public:
+  virtual ~HttpBodySink() {}
+  // Bytes accepted (0 when the socket buffer is full), -1 when the
+  // connection is gone
+  virtual int write(const uint8_t* data, size_t len) = 0;
+};
+
+// Where a body comes from
+class HttpBodySource {
+ public:
+  virtual ~HttpBodySource() {}
+  // Next bytes of the body; 0 at the end (or on a read error)
+  virtual size_t read(uint8_t* buf, size_t len) = 0;
+};
+
+struct HttpTransferStats {
+  uint32_t started;
+  uint32_t completed;
+  uint32_t aborted;   // connection lost or stalled
+  uint32_t refused;   // start() with every slot busy
+  uint64_t bytes;
+  uint8_t  peak;      // most transfers active at once
+};
+
+class HttpTransferPool {
+ public:
+  typedef uint32_t (*ClockFn)();  // microseconds
+
+  explicit HttpTransferPool(ClockFn micros);
+  ~HttpTransferPool();
+
+  // Takes ownership of sink and source (deleted when the transfer ends);
+  // false, with ownership left to the caller, when every slot is busy.
+  // length may be HTTP_TRANSFER_UNTIL_END.
+  bool start(HttpBodySink* sink, HttpBodySource* source, size_t length);
+
+  // Moves data for up to budgetUs; returns the bytes written.
+  size_t pump(uint32_t budgetUs);
+
+  void abortAll();
+
+  size_t active() const { return _active; }
+  const HttpTransferStats& stats() const { return _stats; }
+
+ private:
+  struct Slot {
+    HttpBodySink*   sink;    // nullptr: free
+    HttpBodySource* source;
+    size_t          remaining;
+    bool            untilEnd;  // remaining is not counted down
+    size_t          staged;  // bytes in buf not yet written
+    size_t          offset;  // first unwritten byte in buf
+    uint32_t        lastProgressUs;
+    uint8_t         buf[HTTP_TRANSFER_SLICE];
+  };
+
+  // Writes one slice; false when the slot made no progress
+  bool step(Slot& slot, uint32_t nowUs);
+  void finish(Slot& slot, bool completed);
+
+  Slot              _slots[HTTP_TRANSFER_SLOTS];
+  ClockFn           _micros;
+  HttpTransferStats _stats;
+  size_t            _active;
+  size_t            _next;  // round-robin start
+
+  HttpTransferPool(const HttpTransferPool&);
+  HttpTransferPool& operator=(const HttpTransferPool&);
+};
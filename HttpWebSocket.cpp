@@ -0,0 +1,177 @@
+#include "HttpWebSocket.h"
+#include "HttpParser.h"
+
+#include <string.h>
+
+long httpWsParseFrame(uint8_t* buf, size_t len, HttpWsFrame& frame) {
+  if (len < 2) return 0;
+  const bool    fin    = (buf[0] & 0x80) != 0;
+  const uint8_t opcode = buf[0] & 0x0F;
+  const bool    masked = (buf[1] & 0x80) != 0;
+  if ((buf[0] & 0x70) || !masked || !fin) return -1;  // clients must mask (RFC 6455 5.1)
+
+  size_t payloadLen = buf[1] & 0x7F;
+  size_t pos = 2;
+  if (payloadLen == 126) {
+    if (len < 4) return 0;
+    payloadLen = ((size_t)buf[2] << 8) | buf[3];
+    pos = 4;
+  } else if (payloadLen == 127) {
+    return -1;  // 64-bit lengths are far over HTTP_WS_MAX_MESSAGE
+  }
+  if (payloadLen > HTTP_WS_MAX_MESSAGE) return -1;
+  if ((opcode & 0x08) && payloadLen > 125) return -1;  // control frames
+
+  if (len < pos + 4 + payloadLen) return 0;
+  const uint8_t* mask = buf + pos;
+  uint8_t* payload = buf + pos + 4;
+  for (size_t i = 0; i < payloadLen; ++i) payload[i] ^= mask[i & 3];
+
+  frame.opcode  = opcode;
+  frame.payload = payload;
+  frame.len     = payloadLen;
+  return (long)(pos + 4 + payloadLen);
+}
+
+size_t httpWsFrameHeader(uint8_t* out, uint8_t opcode, size_t payloadLen) {
+  out[0] = (uint8_t)(0x80 | (opcode & 0x0F));
+  if (payloadLen < 126) {
+    out[1] = (uint8_t)payloadLen;
+    return 2;
+  }
+  out[1] = 126;
+  out[2] = (uint8_t)(payloadLen >> 8);
+  out[3] = (uint8_t)payloadLen;
+  return 4;
+}
+
+// ===== SHA-1 (FIPS 180-4), only for the handshake =====
+
+static uint32_t rol(uint32_t v, int n) {
+  return (v << n) | (v >> (32 - n));
+}
+
+static void sha1Block(uint32_t h[5], const uint8_t block[64]) {
+  uint32_t w[80];
+  for (int i = 0; i < 16; ++i) {
+    w[i] = ((uint32_t)block[4 * i] << 24) | ((uint32_t)block[4 * i + 1] << 16) |
+           ((uint32_t)block[4 * i + 2] << 8) | block[4 * i + 3];
+  }
+  for (int i = 16; i < 80; ++i) w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+  uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+  for (int i = 0; i < 80; ++i) {
+    uint32_t f, k;
+    if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+    else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+    else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+    else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+    const uint32_t t = rol(a, 5) + f + e + k + w[i];
+    e = d;
+    d = c;
+    c = rol(b, 30);
+    b = a;
+    a = t;
+  }
+  h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+}
+
+void httpSha1(const uint8_t* data, size_t len, uint8_t digest[20]) {
+  uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64) sha1Block(h, data + i);
+
+  uint8_t tail[128];
+  size_t rest = len - i;
+  memcpy(tail, data + i, rest);
+  tail[rest++] = 0x80;
+  const size_t tailLen = rest + 8 <= 64 ? 64 : 128;
+  memset(tail + rest, 0, tailLen - rest);
+  const uint64_t bits = (uint64_t)len * 8;
+  for (int b = 0; b < 8; ++b) tail[tailLen - 1 - b] = (uint8_t)(bits >> (8 * b));
+  sha1Block(h, tail);
+  if (tailLen == 128) sha1Block(h, tail + 64);
+
+  for (int j = 0; j < 5; ++j) {
+    digest[4 * j]     = (uint8_t)(h[j] >> 24);
+    digest[4 * j + 1] = (uint8_t)(h[j] >> 16);
+    digest[4 * j + 2] = (uint8_t)(h[j] >> 8);
+    digest[4 * j + 3] = (uint8_t)h[j];
+  }
+}
+
+void httpWsAcceptKey(const char* key, size_t len, char out[29]) {
+  static const char kGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+  uint8_t buf[64 + sizeof(kGuid)];
+  if (len > 64) len = 64;  // real keys are 24 characters
+  memcpy(buf, key, len);
+  memcpy(buf + len, kGuid, sizeof(kGuid) - 1);
+  uint8_t digest[20];
+  httpSha1(buf, len + sizeof(kGuid) - 1, digest);
+  httpBase64Encode(digest, sizeof(digest), out);
+}
+
+// ===== Flat JSON fields =====
+
+static bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// End of the string starting at the quote json[i], or len when unterminated
+static size_t skipString(const char* json, size_t len, size_t i) {
+  for (++i; i < len; ++i) {
+    if (json[i] == '\\') ++i;
+    else if (json[i] == '"') return i;
+  }
+  return len;
+}
+
+// Position of the value for key, or len when the key is missing
+static size_t findValue(const char* json, size_t len, const char* key) {
+  const size_t keyLen = strlen(key);
+  for (size_t i = 0; i < len; ++i) {
+    if (json[i] != '"') continue;
+    const size_t end = skipString(json, len, i);
+    if (end >= len) return len;
+    size_t j = end + 1;
+    while (j < len && isSpace(json[j])) ++j;
+    if (j < len && json[j] == ':' && end - i - 1 == keyLen && memcmp(json + i + 1, key, keyLen) == 0) {
+      ++j;
+      while (j < len && isSpace(json[j])) ++j;
+      return j;
+    }
+    i = end;
+  }
+  return len;
+}
+
+bool httpJsonFindString(const char* json, size_t len, const char* key, char* out, size_t cap) {
+  size_t i = findValue(json, len, key);
+  if (i >= len || json[i] != '"' || cap == 0) return false;
+  size_t n = 0;
+  for (++i; i < len && json[i] != '"'; ++i) {
+    if (json[i] == '\\' && i + 1 < len) ++i;
+    if (n + 1 >= cap) return false;
+    out[n++] = json[i];
+  }
+  if (i >= len) return false;
+  out[n] = '\0';
+  return true;
+}
+
+bool httpJsonFindInt(const char* json, size_t len, const char* key, long& out) {
+  size_t i = findValue(json, len, key);
+  if (i >= len) return false;
+  if (len - i >= 4 && memcmp(json + i, "true", 4) == 0)  { out = 1; return true; }
+  if (len - i >= 5 && memcmp(json + i, "false", 5) == 0) { out = 0; return true; }
+  const bool neg = json[i] == '-';
+  if (neg) ++i;
+  if (i >= len || json[i] < '0' || json[i] > '9') return false;
+  long v = 0;
+  for (; i < len && json[i] >= '0' && json[i] <= '9'; ++i) {
+    if (v > 99999999L) return false;
+    v = v * 10 + (json[i] - '0');
+  }
+  out = neg ? -v : v;
+  return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// WebSocket (RFC 6455) framing and the control channel's command fields (no
+// Arduino dependencies, see test/host/httpWebSocket_test.cpp).
+//
+// /api/ws upgrades an authenticated request, then shares the live stream
+// slots with /api/events (HttpEvents.h): telemetry goes out as compact JSON
+// text frames, and relay/mode commands come in the same way and are
+// acknowledged on the same connection once the relay pins are driven.
+// Messages are small, so fragmented and oversized frames are refused.
+
+#ifndef HTTP_WS_MAX_MESSAGE
+#define HTTP_WS_MAX_MESSAGE 256  // bytes of an incoming message
+#endif
+
+enum HttpWsOpcode : uint8_t {
+  HTTP_WS_CONTINUATION = 0x0,
+  HTTP_WS_TEXT         = 0x1,
+  HTTP_WS_BINARY       = 0x2,
+  HTTP_WS_CLOSE        = 0x8,
+  HTTP_WS_PING         = 0x9,
+  HTTP_WS_PONG         = 0xA,
+};
+
+// Close status codes used by the server
+static const uint16_t HTTP_WS_CLOSE_NORMAL      = 1000;
+static const uint16_t HTTP_WS_CLOSE_PROTOCOL    = 1002;
+static const uint16_t HTTP_WS_CLOSE_UNSUPPORTED = 1003;
+
+struct HttpWsFrame {
+  uint8_t  opcode;
+  uint8_t* payload;  // unmasked, inside the parsed buffer
+  size_t   len;
+};
+
+// Parses one client frame from buf and unmasks its payload in place.
+// Returns the frame size, 0 when more bytes are needed, or -1 for a frame
+// the server does not accept (unmasked, reserved bits, fragmented or over
+// HTTP_WS_MAX_MESSAGE).
+long httpWsParseFrame(uint8_t* buf, size_t len, HttpWsFrame& frame);
+
+// Header of an unmasked server frame (payloads below 64 KB); out needs 4
+// bytes. Returns the header length.
+size_t httpWsFrameHeader(uint8_t* out, uint8_t opcode, size_t payloadLen);
+
+// Sec-WebSocket-Accept for a Sec-WebSocket-Key: 28 characters plus '\0'
+void httpWsAcceptKey(const char* key, size_t len, char out[29]);
+
+void httpSha1(const uint8_t* data, size_t len, uint8_t digest[20]);
+
+// Field lookup in a flat JSON object such as
+// {"op":"toggle","id":"fan","seq":7}; nested values are not supported.
+bool httpJsonFindString(const char* json, size_t len, const char* key, char* out, size_t cap);
+// Integers, and true/false as 1/0
+bool httpJsonFindInt(const char* json, size_t len, const char* key, long& out);
@@ -0,0 +1,279 @@
+#pragma once
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Streaming JSON writer (no Arduino dependencies, see
+// test/host/jsonWriter_test.cpp).
+//
+// Values are formatted straight into the output, which only needs
+// write(const char*, size_t) and usually is a fixed buffer that flushes to
+// the client when it fills (JsonResponse in WebUI.cpp, HistoryChunkWriter):
+//
+//   JsonWriter<JsonResponse> json(out);
+//   json.beginObject();
+//   json.field("name", cfg.name);              // escaped on write
+//   json.field("temp_c", jsonFixed(t, 1));     // null for NaN
+//   json.key("relays").beginObject() ... .endObject();
+//   json.endObject();
+//
+// Commas and colons are placed by the writer. Nothing is allocated:
+//   const char*, String-like  escaped string (nullptr writes null)
+//   bool                      true / false
+//   integers                  decimal, up to 64 bits
+//   jsonFixed(v, n)           float with n decimals (at most 6), rounded half
+//                             away from zero; null for NaN, infinities and
+//                             magnitudes of 1e15 and more
+//   jsonRaw(s, len)           pre-formatted JSON, copied as is
+// beginString()/part()/endString() write one string value from pieces.
+// A plain float is rejected at compile time so the precision is always
+// spelled out. Keys are expected to be plain identifiers and are not
+// escaped. Nesting is limited to JSON_WRITER_MAX_DEPTH.
+
+#ifndef JSON_WRITER_MAX_DEPTH
+#define JSON_WRITER_MAX_DEPTH 16
+#endif
+
+struct JsonFixedValue {
+  float   v;
+  uint8_t decimals;
+};
+
+inline JsonFixedValue jsonFixed(float v, uint8_t decimals) { return JsonFixedValue{ v, decimals }; }
+
+struct JsonRawValue {
+  const char* s;
+  size_t      len;
+};
+
+inline JsonRawValue jsonRaw(const char* s, size_t len) { return JsonRawValue{ s, len }; }
+
+template <typename Out>
+class JsonWriter {
+ public:
+  explicit JsonWriter(Out& out) : _out(out), _depth(0), _afterKey(false) { _hasItems[0] = false; }
+
+  JsonWriter& beginObject() { return open('{'); }
+  JsonWriter& endObject()   { return close('}'); }
+  JsonWriter& beginArray()  { return open('['); }
+  JsonWriter& endArray()    { return close(']'); }
+
+  JsonWriter& key(const char* k) {
+    separate();
+    put('"');
+    put(k, strlen(k));
+    put("\":", 2);
+    _afterKey = true;
+    return *this;
+  }
+
+  // ===== Values =====
+
+  JsonWriter& value(const char* s) {
+    if (!s) return null();
+    return value(s, strlen(s));
+  }
+
+  JsonWriter& value(const char* s, size_t len) {
+    separate();
+    put('"');
+    putEscaped(s, len);
+    put('"');
+    return *this;
+  }
+
+  // String-like: Arduino String, std::string
+  template <typename S, typename = decltype(((const S*)nullptr)->c_str())>
+  JsonWriter& value(const S& s) { return value(s.c_str(), s.length()); }
+
+  // A string value written in pieces: beginString().part(a).part(b).endString()
+  JsonWriter& beginString() {
+    separate();
+    put('"');
+    return *this;
+  }
+  JsonWriter& part(const char* s, size_t len) {
+    putEscaped(s, len);
+    return *this;
+  }
+  JsonWriter& part(const char* s) { return part(s, strlen(s)); }
+  JsonWriter& endString() {
+    put('"');
+    return *this;
+  }
+
+  JsonWriter& value(bool b) {
+    separate();
+    if (b) put("true", 4);
+    else   put("false", 5);
+    return *this;
+  }
+
+  JsonWriter& value(int v)                { return putSigned(v); }
+  JsonWriter& value(long v)               { return putSigned(v); }
+  JsonWriter& value(long long v)          { return putSigned(v); }
+  JsonWriter& value(unsigned v)           { return putUnsigned(v); }
+  JsonWriter& value(unsigned long v)      { return putUnsigned(v); }
+  JsonWriter& value(unsigned long long v) { return putUnsigned(v); }
+
+  JsonWriter& value(float) = delete;   // use jsonFixed(value, decimals)
+  JsonWriter& value(double) = delete;
+
+  JsonWriter& value(const JsonFixedValue& f) {
+    separate();
+    const uint8_t decimals = f.decimals > 6 ? 6 : f.decimals;
+    double v = f.v;
+    if (isnan(v) || isinf(v) || fabs(v) >= 1e15) {
+      put("null", 4);
+      return *this;
+    }
+    static const uint32_t kPow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+    const bool negative = v < 0;
+    if (negative) v = -v;
+    const unsigned long long scaled = (unsigned long long)(v * kPow10[decimals] + 0.5);
+    if (negative) put('-');
+    writeDigits(scaled / kPow10[decimals], 1);
+    if (decimals) {
+      put('.');
+      writeDigits(scaled % kPow10[decimals], decimals);
+    }
+    return *this;
+  }
+
+  JsonWriter& value(const JsonRawValue& r) {
+    separate();
+    put(r.s, r.len);
+    return *this;
+  }
+
+  JsonWriter& null() {
+    separate();
+    put("null", 4);
+    return *this;
+  }
+
+  template <typename T>
+  JsonWriter& field(const char* k, const T& v) { return key(k).value(v); }
+
+  size_t depth() const { return _depth; }
+
+ private:
+  JsonWriter& open(char c) {
+    separate();
+    put(c);
+    if (_depth + 1 < JSON_WRITER_MAX_DEPTH) _depth++;
+    _hasItems[_depth] = false;
+    return *this;
+  }
+
+  JsonWriter& close(char c) {
+    put(c);
+    if (_depth > 0) _depth--;
+    _afterKey = false;
+    return *this;
+  }
+
+  // Comma before every item but the first; nothing between key and value
+  void separate() {
+    if (_afterKey) {
+      _afterKey = false;
+      return;
+    }
+    if (_hasItems[_depth]) put(',');
+    _hasItems[_depth] = true;
+  }
+
+  template <typename T>
+  JsonWriter& putSigned(T v) {
+    separate();
+    const bool negative = v < 0;
+    if (negative) put('-');
+    // Negate in unsigned arithmetic so the minimum value does not overflow
+    writeDigits(negative ? 0ULL - (unsigned long long)v : (unsigned long long)v, 1);
+    return *this;
+  }
+
+  template <typename T>
+  JsonWriter& putUnsigned(T v) {
+    separate();
+    writeDigits((unsigned long long)v, 1);
+    return *this;
+  }
+
+  // Decimal, zero-padded to at least minDigits
+  void writeDigits(unsigned long long v, uint8_t minDigits) {
+    char buf[24];
+    size_t pos = sizeof(buf);
+    do {
+      buf[--pos] = (char)('0' + v % 10);
+      v /= 10;
+    } while (v || sizeof(buf) - pos < minDigits);
+    put(buf + pos, sizeof(buf) - pos);
+  }
+
+  // Runs of plain characters (UTF-8 included) are written in one call
+  void putEscaped(const char* s, size_t len) {
+    static const char kHex[] = "0123456789abcdef";
+    size_t run = 0;
+    for (size_t i = 0; i < len; ++i) {
+      const unsigned char c = (unsigned char)s[i];
+      if (c >= 0x20 && c != '"' && c != '\\') continue;
+      if (i > run) put(s + run, i - run);
+      run = i + 1;
+      char esc[6] = { '\\', 0, 0, 0, 0, 0 };
+      size_t n = 2;
+      switch (c) {
+        case '"':  esc[1] = '"'; break;
+        case '\\': esc[1] = '\\'; break;
+        case '\n': esc[1] = 'n'; break;
+        case '\r': esc[1] = 'r'; break;
+        case '\t': esc[1] = 't'; break;
+        default:
+          esc[1] = 'u'; esc[2] = '0'; esc[3] = '0';
+          esc[4] = kHex[c >> 4]; esc[5] = kHex[c & 15];
+          n = 6;
+          break;
+      }
+      put(esc, n);
+    }
+    if (len > run) put(s + run, len - run);
+  }
+
+  void put(char c) { _out.write(&c, 1); }
+  void put(const char* s, size_t len) { _out.write(s, len); }
+
+  Out&   _out;
+  size_t _depth;
+  bool   _afterKey;
+  bool   _hasItems[JSON_WRITER_MAX_DEPTH];
+
+  JsonWriter(const JsonWriter&);
+  JsonWriter& operator=(const JsonWriter&);
+};
+
+// Output into a caller's array (event payloads, WebSocket acknowledgements);
+// what does not fit is cut off and reported by overflow()
+class JsonBuffer {
+ public:
+  JsonBuffer(char* buf, size_t cap) : _buf(buf), _cap(cap), _used(0), _overflow(false) {}
+
+  void write(const char* data, size_t len) {
+    if (len > _cap - _used) {
+      len = _cap - _used;
+      _overflow = true;
+    }
+    memcpy(_buf + _used, data, len);
+    _used += len;
+  }
+
+  const char* data() const { return _buf; }
+  size_t      size() const { return _used; }
+  bool        overflow() const { return _overflow; }
+
+ private:
+  char*  _buf;
+  size_t _cap;
+  size_t _used;
+  bool   _overflow;
+};
@@ -0,0 +1,131 @@
+#include "StaticFileCache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+StaticFileCache::StaticFileCache(size_t budgetBytes, size_t maxFileBytes, AllocFn alloc, FreeFn release)
+  : _alloc(alloc ? alloc : malloc),
+    _free(release ? release : free),
+    _budget(budgetBytes),
+    _maxFile(maxFileBytes < budgetBytes ? maxFileBytes : budgetBytes),
+    _bytes(0),
+    _clock(0),
+    _generation(0) {
+  memset(_slots, 0, sizeof(_slots));
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+StaticFileCache::~StaticFileCache() {
+  clear();
+}
+
+StaticCacheEntry* StaticFileCache::find(const char* key) {
+  for (size_t i = 0; i < STATIC_CACHE_SLOTS; ++i) {
+    if (_slots[i].data && _slots[i].key[0] && strcmp(_slots[i].key, key) == 0) return &_slots[i];
+  }
+  return nullptr;
+}
+
+void StaticFileCache::release(StaticCacheEntry& e) {
+  if (!e.data) return;
+  if (e.pins) {
+    e.key[0] = '\0';  // freed by the last unpin()
+    return;
+  }
+  _free(e.data);
+  _bytes -= e.len;
+  memset(&e, 0, sizeof(e));
+}
+
+StaticCacheEntry* StaticFileCache::evictLru() {
+  StaticCacheEntry* oldest = nullptr;
+  for (size_t i = 0; i < STATIC_CACHE_SLOTS; ++i) {
+    if (_slots[i].data && !_slots[i].pins && (!oldest || _slots[i].lastUse < oldest->lastUse)) oldest = &_slots[i];
+  }
+  if (oldest) {
+    release(*oldest);
+    _stats.evictions++;
+  }
+  return oldest;
+}
+
+const StaticCacheEntry* StaticFileCache::get(const char* key) {
+  StaticCacheEntry* e = find(key);
+  if (!e) {
+    _stats.misses++;
+    return nullptr;
+  }
+  _stats.hits++;
+  e->lastUse = ++_clock;
+  return e;
+}
+
+uint8_t* StaticFileCache::insert(const char* key, size_t len, uint32_t stamp) {
+  remove(key);
+  if (len == 0 || len > _maxFile || strlen(key) >= STATIC_CACHE_KEY_LEN) {
+    _stats.rejected++;
+    return nullptr;
+  }
+
+  while (_bytes + len > _budget && evictLru()) {}
+  StaticCacheEntry* slot = nullptr;
+  for (size_t i = 0; i < STATIC_CACHE_SLOTS && !slot; ++i) {
+    if (!_slots[i].data) slot = &_slots[i];
+  }
+  if (!slot) slot = evictLru();
+  if (!slot || _bytes + len > _budget) {  // everything left is pinned
+    _stats.rejected++;
+    return nullptr;
+  }
+
+  uint8_t* data = (uint8_t*)_alloc(len);
+  if (!data) {
+    _stats.rejected++;
+    return nullptr;
+  }
+  strcpy(slot->key, key);
+  slot->data    = data;
+  slot->len     = len;
+  slot->stamp   = stamp;
+  slot->lastUse = ++_clock;
+  _bytes += len;
+  _stats.inserts++;
+  return data;
+}
+
+void StaticFileCache::pin(const StaticCacheEntry* e) {
+  if (e && e >= _slots && e < _slots + STATIC_CACHE_SLOTS) _slots[e - _slots].pins++;
+}
+
+void StaticFileCache::unpin(const StaticCacheEntry* e) {
+  if (!e || e < _slots || e >= _slots + STATIC_CACHE_SLOTS) return;
+  StaticCacheEntry& slot = _slots[e - _slots];
+  if (slot.pins == 0) return;
+  slot.pins--;
+  if (slot.pins == 0 && slot.key[0] == '\0') release(slot);
+}
+
+void StaticFileCache::remove(const char* key) {
+  StaticCacheEntry* e = find(key);
+  if (e) release(*e);
+}
+
+void StaticFileCache::clear() {
+  for (size_t i = 0; i < STATIC_CACHE_SLOTS; ++i) release(_slots[i]);
+}
+
+bool StaticFileCache::setGeneration(uint32_t generation) {
+  if (generation == _generation) return false;
+  _generation = generation;
+  if (entries() > 0) _stats.invalidations++;
+  clear();
+  return true;
+}
+
+size_t StaticFileCache::entries() const {
+  size_t n = 0;
+  for (size_t i = 0; i < STATIC_CACHE_SLOTS; ++i) {
+    if (_slots[i].data) n++;
+  }
+  return n;
+}
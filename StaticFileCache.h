@@ -0,0 +1,103 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Bounded LRU cache of small static files (no Arduino dependencies, see
+// test/host/staticFileCache_test.cpp).
+//
+// Entries are whole file bodies keyed by name, allocated through the
+// allocator passed to the constructor (WebUI.cpp prefers PSRAM). Inserting
+// evicts least recently used entries until the new body fits the byte
+// budget; files above the per-file limit are never cached so one large
+// asset cannot flush the small hot ones. Each entry carries a caller-defined
+// stamp (WebUI.cpp: the file's modification time, for its ETag).
+//
+// The cache belongs to one filesystem generation: setGeneration() with a
+// different value drops every entry.
+//
+// An entry that is still being sent can be pinned: it is never evicted, and
+// removing it only hides it from lookups until the last unpin() frees it.
+
+#ifndef STATIC_CACHE_BUDGET_BYTES
+#define STATIC_CACHE_BUDGET_BYTES   32768  // RAM for cached bodies
+#endif
+#ifndef STATIC_CACHE_MAX_FILE_BYTES
+#define STATIC_CACHE_MAX_FILE_BYTES 16384  // larger files are always read from the filesystem
+#endif
+
+static const size_t STATIC_CACHE_SLOTS   = 8;
+static const size_t STATIC_CACHE_KEY_LEN = 40;  // including NUL; longer names are not cached
+
+struct StaticCacheEntry {
+  char     key[STATIC_CACHE_KEY_LEN];
+  uint8_t* data;     // nullptr: free slot
+  size_t   len;
+  uint32_t stamp;
+  uint32_t lastUse;  // LRU clock
+  uint8_t  pins;     // transfers still reading data
+};
+
+struct StaticCacheStats {
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t inserts;
+  uint32_t evictions;   // entries dropped to make room
+  uint32_t rejected;    // inserts refused: too large, key too long or no memory
+  uint32_t invalidations;  // generation changes that dropped entries
+};
+
+class StaticFileCache {
+ public:
+  typedef void* (*AllocFn)(size_t);
+  typedef void  (*FreeFn)(void*);
+
+  StaticFileCache(size_t budgetBytes, size_t maxFileBytes, AllocFn alloc = nullptr, FreeFn release = nullptr);
+  ~StaticFileCache();
+
+  // Cached entry for key, or nullptr; counts a hit or a miss. The entry
+  // stays valid until the next insert(), remove(), clear() or setGeneration().
+  const StaticCacheEntry* get(const char* key);
+  // Same lookup without counting it or refreshing the entry
+  const StaticCacheEntry* peek(const char* key) { return find(key); }
+
+  // Buffer of len bytes for key, to be filled by the caller (remove() it if
+  // that fails). Replaces an existing entry. nullptr when the body cannot be
+  // cached.
+  uint8_t* insert(const char* key, size_t len, uint32_t stamp);
+
+  // Keeps e (as returned by get()) alive until the matching unpin()
+  void pin(const StaticCacheEntry* e);
+  void unpin(const StaticCacheEntry* e);
+
+  void remove(const char* key);
+  void clear();
+
+  // Drops every entry when generation differs from the current one; returns
+  // true if it did.
+  bool setGeneration(uint32_t generation);
+
+  size_t   budget() const { return _budget; }
+  size_t   maxFileBytes() const { return _maxFile; }
+  size_t   bytes() const { return _bytes; }
+  size_t   entries() const;  // including removed entries that are still pinned
+  uint32_t generation() const { return _generation; }
+  const StaticCacheStats& stats() const { return _stats; }
+
+ private:
+  StaticCacheEntry* find(const char* key);
+  void              release(StaticCacheEntry& e);
+  StaticCacheEntry* evictLru();
+
+  StaticCacheEntry _slots[STATIC_CACHE_SLOTS];
+  StaticCacheStats _stats;
+  AllocFn          _alloc;
+  FreeFn           _free;
+  size_t           _budget;
+  size_t           _maxFile;
+  size_t           _bytes;
+  uint32_t         _clock;
+  uint32_t         _generation;
+
+  StaticFileCache(const StaticFileCache&);
+  StaticFileCache& operator=(const StaticFileCache&);
+};
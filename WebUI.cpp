@@ -1,14 +1,33 @@
 #include "WebUI.h"
 #include "Greenhouse.h"
+#include "HistoryTiers.h"
+#include "FlashWear.h"
+#include "HtmlTemplate.h"
+#include "StaticFileCache.h"
+#include "HttpTransfers.h"
+#include "HttpServer.h"
+#include "HttpEvents.h"
+#include "HttpWebSocket.h"
+#include "JsonWriter.h"
 
 #include <WebServer.h>
 #include <LittleFS.h>
 #include <ctype.h>
 #include <WiFi.h>
 #include <DNSServer.h>
+#include <lwip/sockets.h>
+#include <errno.h>
+#include <esp_wifi.h>
 
-// Single global web server (port 80)
-static WebServer server(80);
+// Logs size, time and heap low-water mark of page and history responses to
+// Serial. For measurements only: the lines would otherwise be printed for
+// every request
+#ifndef WEB_DEBUG_TIMING
+#define WEB_DEBUG_TIMING 0
+#endif
+
+// Single global web server (port 80), keeps connections alive (HttpServer.h)
+static HttpServer server(80);
 
 // DNS server for captive portal
 static DNSServer dnsServer;
@@ -36,17 +55,34 @@ void refreshCaptivePortalState() {
 
 // ================= Helpers =================
 
-static String htmlBool(bool b) { return b ? "ON" : "OFF"; }
-static String htmlAuto(bool a) { return a ? "AUTO" : "MAN"; }
-static String htmlAutoChange(bool applies, bool a) { return applies ? htmlAuto(a) : String("—"); }
+static const char* htmlBool(bool b) { return b ? "ON" : "OFF"; }
+static const char* htmlAuto(bool a) { return a ? "AUTO" : "MAN"; }
+static const char* htmlAutoChange(bool applies, bool a) { return applies ? htmlAuto(a) : "—"; }
 
-static String minutesToTimeStrSafe(int mins) {
+// "HH:MM", out needs 6 bytes
+static void formatTimeOfDay(char* out, int mins) {
   mins = constrain(mins, 0, 24 * 60 - 1);
-  char buf[6];
-  sprintf(buf, "%02d:%02d", mins / 60, mins % 60);
-  return String(buf);
+  snprintf(out, 6, "%02d:%02d", mins / 60, mins % 60);
 }
 
+// "HH:MM" as a page template value (see HtmlTemplate.h)
+struct HtmlTimeOfDay {
+  int minutes;
+};
+
+static HtmlTimeOfDay htmlTime(int mins) { return HtmlTimeOfDay{ mins }; }
+
+template <>
+struct HtmlFormat<HtmlTimeOfDay> {
+  template <typename Out>
+  static void put(Out& out, const HtmlTimeOfDay& t) {
+    const int mins = constrain(t.minutes, 0, 24 * 60 - 1);
+    const char buf[5] = { (char)('0' + mins / 600), (char)('0' + mins / 60 % 10), ':',
+                          (char)('0' + mins % 60 / 10), (char)('0' + mins % 10) };
+    out.write(buf, sizeof(buf));
+  }
+};
+
 // Convert "HH:MM" to minutes since midnight
 static int parseTimeToMinutes(const String &s, int fallback) {
   int colon = s.indexOf(':');
@@ -57,22 +93,6 @@ static int parseTimeToMinutes(const String &s, int fallback) {
   return h * 60 + m;
 }
 
-static String htmlEscape(const String& in) {
-  String s; s.reserve(in.length() + 8);
-  for (size_t i = 0; i < in.length(); i++) {
-    char c = in[i];
-    switch (c) {
-      case '&': s += "&amp;"; break;
-      case '<': s += "&lt;"; break;
-      case '>': s += "&gt;"; break;
-      case '"': s += "&quot;"; break;
-      case '\'': s += "&#39;"; break;
-      default: s += c; break;
-    }
-  }
-  return s;
-}
-
 static String urlencode(const String& in) {
   String s; s.reserve(in.length() * 2);
   const char* hex = "0123456789ABCDEF";
@@ -91,33 +111,11 @@ static String urlencode(const String& in) {
   return s;
 }
 
-static String jsonEscape(const String& in) {
-  String s; s.reserve(in.length() + 8);
-  for (size_t i = 0; i < in.length(); i++) {
-    char c = in[i];
-    switch (c) {
-      case '\\': s += "\\\\"; break;
-      case '"':  s += "\\\""; break;
-      case '\n': s += "\\n"; break;
-      case '\r': s += "\\r"; break;
-      case '\t': s += "\\t"; break;
-      default:
-        if ((uint8_t)c < 0x20) {
-          // skip control chars
-        } else {
-          s += c;
-        }
-        break;
-    }
-  }
-  return s;
-}
-
-static String growProfileLabelForId(int id) {
-  if (id < 0) return String("");
+static const char* growProfileLabelForId(int id) {
+  if (id < 0) return "";
   const GrowProfileInfo* info = growProfileInfoAt((size_t)id);
-  if (!info) return String("");
-  return info->label;
+  if (!info) return "";
+  return info->label.c_str();
 }
 
 // In AP-only (captive portal) mode, we skip authentication so onboarding is open.
@@ -140,47 +138,433 @@ static bool requireAuth() {
   return true;
 }
 
-static void streamStaticFile(const char* path, const char* contentType) {
-  File f = LittleFS.open(path, "r");
+// True when Accept-Encoding lists gzip without q=0
+static bool clientAcceptsGzip() {
+  String enc = server.header("Accept-Encoding");
+  int pos = enc.indexOf("gzip");
+  if (pos < 0) return false;
+  int end = enc.indexOf(',', pos);
+  String params = enc.substring(pos + 4, end < 0 ? enc.length() : end);
+  int q = params.indexOf("q=");
+  return q < 0 || params.substring(q + 2).toFloat() > 0.0f;
+}
+
+// Static assets are fingerprinted by /asset-manifest.txt (written into data/
+// by scripts/build-assets.mjs), one "<file> <hash>" line per asset. Pages
+// link /app.<hash>.js, which is cached for a year without revalidation; a
+// new upload changes the hash and therefore the URL. The plain URLs keep
+// working and are revalidated with the same ETag. Without a manifest the
+// pages link the plain URLs and the ETag is derived from size and mtime.
+enum StaticGzipState : uint8_t { STATIC_GZIP_UNKNOWN = 0, STATIC_GZIP_ABSENT, STATIC_GZIP_PRESENT };
+
+struct StaticAsset {
+  const char*     path;     // LittleFS path and plain URL
+  char            hash[17]; // from the manifest, empty when unknown
+  String          url;      // fingerprinted URL, empty when unknown
+  StaticGzipState gzip;     // whether path.gz exists, looked up once
+};
+
+static StaticAsset sStaticAssets[] = {
+  { "/chart.umd.min.js" },
+  { "/app.js" },
+  { "/app.css" },
+  { "/logo-ezgrow.png" },
+};
+static const size_t STATIC_ASSET_COUNT = sizeof(sStaticAssets) / sizeof(sStaticAssets[0]);
+
+static StaticAsset* findStaticAsset(const char* path) {
+  for (size_t i = 0; i < STATIC_ASSET_COUNT; ++i) {
+    if (strcmp(sStaticAssets[i].path, path) == 0) return &sStaticAssets[i];
+  }
+  return nullptr;
+}
+
+// URL to link from pages: fingerprinted when the manifest lists the asset
+static const char* staticAssetUrl(const char* path) {
+  const StaticAsset* asset = findStaticAsset(path);
+  return (asset && asset->url.length()) ? asset->url.c_str() : path;
+}
+
+// Small assets (app.js.gz, app.css.gz, the logo) are served from RAM after
+// the first request, preferably from PSRAM. The cache generation is a hash
+// of the manifest, which changes with every asset upload, so entries from an
+// older filesystem image are dropped when the manifest is (re)loaded.
+static void* staticCacheAlloc(size_t len) {
+  void* p = psramFound() ? ps_malloc(len) : nullptr;
+  return p ? p : malloc(len);
+}
+
+static StaticFileCache sStaticCache(STATIC_CACHE_BUDGET_BYTES, STATIC_CACHE_MAX_FILE_BYTES, staticCacheAlloc);
+
+// Returns the number of assets fingerprinted
+static size_t loadStaticAssetManifest() {
+  for (size_t i = 0; i < STATIC_ASSET_COUNT; ++i) {
+    sStaticAssets[i].hash[0] = '\0';
+    sStaticAssets[i].url     = String();
+    sStaticAssets[i].gzip    = STATIC_GZIP_UNKNOWN;
+  }
+
+  File f = LittleFS.open("/asset-manifest.txt", "r");
   if (!f) {
-    server.send(404, "text/plain", String(path) + " not found");
-    return;
+    Serial.println("[WEB] /asset-manifest.txt missing; static assets are not fingerprinted");
+    sStaticCache.setGeneration(0);
+    return 0;
+  }
+
+  size_t   loaded     = 0;
+  uint32_t generation = 2166136261UL;  // FNV-1a of the manifest
+  while (f.available()) {
+    String line = f.readStringUntil('\n');
+    line.trim();
+    for (size_t i = 0; i < line.length(); ++i) generation = (generation ^ (uint8_t)line[i]) * 16777619UL;
+    int sp = line.indexOf(' ');
+    if (sp <= 0) continue;
+    String name = "/" + line.substring(0, sp);
+    String hash = line.substring(sp + 1);
+    hash.trim();
+    StaticAsset* asset = findStaticAsset(name.c_str());
+    if (!asset || hash.length() == 0 || hash.length() >= sizeof(asset->hash)) continue;
+
+    strncpy(asset->hash, hash.c_str(), sizeof(asset->hash));
+    // /chart.umd.min.js -> /chart.umd.min.<hash>.js
+    int dot = name.lastIndexOf('.');
+    asset->url = name.substring(0, dot) + "." + hash + name.substring(dot);
+    loaded++;
   }
-  server.streamFile(f, contentType);
   f.close();
+  sStaticCache.setGeneration(generation);
+  return loaded;
+}
+
+// ---- Non-blocking bodies (HttpTransfers.h) ----
+// Static asset handlers send the headers and leave the body to sTransfers,
+// which handleWebServer() pumps for HTTP_TRANSFER_PUMP_US per loop(), so a
+// slow download no longer holds up sensors, control logic and the pump
+// timeout, and up to HTTP_TRANSFER_SLOTS downloads run side by side.
+// Requests keep being served while every slot is busy; only a body that
+// needs a slot is refused (see reserveTransfer()).
+static const uint32_t HTTP_TRANSFER_PUMP_US = 2000;
+static const char* const HTTP_TRANSFER_RETRY_AFTER = "2";  // seconds
+
+// Owns the connection once the server has detached it
+class ClientBodySink : public HttpBodySink {
+ public:
+  explicit ClientBodySink(const WiFiClient& client) : _client(client) {}
+  ~ClientBodySink() { _client.stop(); }
+
+  int write(const uint8_t* data, size_t len) override {
+    if (!_client.connected()) return -1;
+    int n = send(_client.fd(), data, len, MSG_DONTWAIT);
+    if (n >= 0) return n;
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+  }
+
+ private:
+  WiFiClient _client;
+};
+
+class FileBodySource : public HttpBodySource {
+ public:
+  explicit FileBodySource(File f) : _file(f) {}
+  ~FileBodySource() { _file.close(); }
+  size_t read(uint8_t* buf, size_t len) override { return _file.read(buf, len); }
+
+ private:
+  File _file;
+};
+
+// Pins the cache entry so eviction cannot free it mid-transfer
+class CachedBodySource : public HttpBodySource {
+ public:
+  explicit CachedBodySource(const StaticCacheEntry* e) : _entry(e), _pos(0) { sStaticCache.pin(e); }
+  ~CachedBodySource() { sStaticCache.unpin(_entry); }
+  size_t read(uint8_t* buf, size_t len) override {
+    size_t n = _entry->len - _pos < len ? _entry->len - _pos : len;
+    memcpy(buf, _entry->data + _pos, n);
+    _pos += n;
+    return n;
+  }
+
+ private:
+  const StaticCacheEntry* _entry;
+  size_t                  _pos;
+};
+
+static uint32_t transferMicros() {
+  return (uint32_t)micros();
+}
+
+static HttpTransferPool sTransfers(transferMicros);
+
+// History exports are long; capped so they never hold every slot
+static const size_t HISTORY_EXPORT_MAX_ACTIVE = 1;
+static size_t sHistoryExports = 0;  // HistoryExportSource instances alive
+
+// Call before sending any header of a response whose body goes through
+// sendStaticBody(); answers 503 with Retry-After and returns false when the
+// body could not be queued now.
+static bool reserveTransfer(bool historyExport) {
+  if (sTransfers.active() < HTTP_TRANSFER_SLOTS &&
+      (!historyExport || sHistoryExports < HISTORY_EXPORT_MAX_ACTIVE)) {
+    return true;
+  }
+  server.sendHeader("Retry-After", HTTP_TRANSFER_RETRY_AFTER);
+  server.send(503, "text/plain", historyExport ? "Export in progress" : "Busy");
+  return false;
+}
+
+// Sends the headers and queues the body (takes ownership of source); len may
+// be HTTP_TRANSFER_UNTIL_END, the body then ends with the connection.
+// The handler has checked reserveTransfer().
+static void sendStaticBody(HttpBodySource* source, size_t len, const char* contentType, bool gzip) {
+  if (gzip) server.sendHeader("Content-Encoding", "gzip");
+  server.setContentLength(len == HTTP_TRANSFER_UNTIL_END ? CONTENT_LENGTH_UNKNOWN : len);
+  HttpBodySink* sink = new ClientBodySink(server.detachClient());
+  server.send(200, contentType, "");
+
+  if (sTransfers.start(sink, source, len)) return;
+
+  // Not reserved: drop the connection rather than block the loop
+  delete sink;
+  delete source;
+}
+
+// Serves path.gz when the client accepts gzip, otherwise the plain file,
+// from sStaticCache when possible.
+// Answers 304 when If-None-Match carries the ETag of that representation.
+static void streamStaticFile(const char* path, const char* contentType) {
+  StaticAsset* asset = findStaticAsset(path);
+  String file = path;
+  bool gzip = false;
+  if (clientAcceptsGzip()) {
+    String gz = file + ".gz";
+    if (asset && asset->gzip != STATIC_GZIP_UNKNOWN) {
+      gzip = asset->gzip == STATIC_GZIP_PRESENT;
+    } else {
+      gzip = LittleFS.exists(gz);  // open() logs missing files
+      if (asset) asset->gzip = gzip ? STATIC_GZIP_PRESENT : STATIC_GZIP_ABSENT;
+    }
+    if (gzip) file = gz;
+  }
+
+  const StaticCacheEntry* cached = sStaticCache.get(file.c_str());
+  File f;
+  size_t   size  = cached ? cached->len : 0;
+  uint32_t mtime = cached ? cached->stamp : 0;
+  if (!cached) {
+    f = LittleFS.open(file, "r");
+    if (!f) {
+      server.send(404, "text/plain", String(path) + " not found");
+      return;
+    }
+    size  = f.size();
+    mtime = (uint32_t)f.getLastWrite();
+  }
+
+  const bool fingerprinted = asset && asset->url.length();
+  char etag[48];
+  if (fingerprinted) {
+    snprintf(etag, sizeof(etag), "\"%s%s\"", asset->hash, gzip ? "-gz" : "");
+  } else {
+    snprintf(etag, sizeof(etag), "\"%x-%lx%s\"", (unsigned)size, (unsigned long)mtime, gzip ? "-gz" : "");
+  }
+
+  const bool notModified = server.hasHeader("If-None-Match") && server.header("If-None-Match").indexOf(etag) >= 0;
+  if (!notModified && !reserveTransfer(false)) {
+    if (f) f.close();
+    return;
+  }
+
+  server.sendHeader("ETag", etag);
+  server.sendHeader("Vary", "Accept-Encoding");
+  server.sendHeader("Cache-Control", (fingerprinted && server.uri() == asset->url)
+                                       ? "public, max-age=31536000, immutable"
+                                       : "no-cache");
+  if (notModified) {
+    if (f) f.close();
+    server.send(304, "text/plain", "");
+    return;
+  }
+
+  if (cached) {
+    sendStaticBody(new CachedBodySource(cached), size, contentType, gzip);
+    return;
+  }
+
+  // Small files are read into the cache and sent from there
+  uint8_t* body = size <= sStaticCache.maxFileBytes() ? sStaticCache.insert(file.c_str(), size, mtime) : nullptr;
+  if (body) {
+    if (f.read(body, size) == size) {
+      f.close();
+      sendStaticBody(new CachedBodySource(sStaticCache.peek(file.c_str())), size, contentType, gzip);
+      return;
+    }
+    sStaticCache.remove(file.c_str());
+    f.seek(0);
+  }
+  sendStaticBody(new FileBodySource(f), size, contentType, gzip);
 }
 
-static void beginPage(String& page, const char* title, const char* activeNav, bool includeCharts) {
+// HTML pages are rendered into a fixed chunk that goes out with chunked
+// transfer encoding whenever it fills, so a page costs PAGE_CHUNK_SIZE bytes
+// of stack instead of a heap String as large as the page, and the browser
+// can fetch the stylesheet while the body is still being rendered. The
+// status line is sent with the first chunk; until then a handler can still
+// answer with an error instead.
+static const size_t PAGE_CHUNK_SIZE = 1024;
+
+class PageWriter {
+ public:
+  PageWriter() : _used(0), _total(0), _started(false), _startMs(millis()), _heapLow(ESP.getFreeHeap()) {}
+
+  // page += v appends one template value (see HtmlTemplate.h)
+  template <typename T>
+  PageWriter& operator+=(const T& v) {
+    HtmlFormat<T>::put(*this, v);
+    return *this;
+  }
+
+  void write(const char* data, size_t len) {
+    while (len > 0) {
+      if (_used == sizeof(_chunk)) flush();
+      size_t n = sizeof(_chunk) - _used;
+      if (n > len) n = len;
+      memcpy(_chunk + _used, data, n);
+      _used += n;
+      data  += n;
+      len   -= n;
+    }
+  }
+
+  // Sends what has been rendered so far (also used before slow calls)
+  void flush() {
+    if (!_started) {
+      server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+      server.send(200, "text/html", "");
+      _started = true;
+    }
+    if (_used == 0) return;
+    server.sendContent(_chunk, _used);
+    _total += _used;
+    _used = 0;
+    uint32_t heapNow = ESP.getFreeHeap();
+    if (heapNow < _heapLow) _heapLow = heapNow;
+  }
+
+  // Sends the rest and terminates the response
+  void end() {
+    flush();
+    server.sendContent("");
+    if (!WEB_DEBUG_TIMING) return;
+    Serial.printf("[WEB] %s bytes=%u ms=%lu heap_low=%u\n", server.uri().c_str(),
+                  (unsigned)_total, millis() - _startMs, (unsigned)_heapLow);
+  }
+
+ private:
+  char          _chunk[PAGE_CHUNK_SIZE];
+  size_t        _used;
+  size_t        _total;
+  bool          _started;
+  unsigned long _startMs;
+  uint32_t      _heapLow;
+};
+
+// JSON API responses are written (JsonWriter.h) into a fixed chunk the same
+// way: a response that fits is sent with Content-Length, a larger one goes
+// out with chunked transfer encoding whenever the chunk fills. Escaping and
+// number formatting happen on write, so the body needs no heap at all.
+static const size_t JSON_CHUNK_SIZE = 1024;
+
+class JsonResponse {
+ public:
+  explicit JsonResponse(int code = 200) : _code(code), _used(0), _started(false) {}
+
+  void write(const char* data, size_t len) {
+    while (len > 0) {
+      if (_used == sizeof(_chunk)) flush();
+      size_t n = sizeof(_chunk) - _used;
+      if (n > len) n = len;
+      memcpy(_chunk + _used, data, n);
+      _used += n;
+      data  += n;
+      len   -= n;
+    }
+  }
+
+  void flush() {
+    if (!_started) {
+      server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+      server.send(_code, "application/json", "");
+      _started = true;
+    }
+    if (_used == 0) return;
+    server.sendContent(_chunk, _used);
+    _used = 0;
+  }
+
+  void end() {
+    if (_started) {
+      flush();
+      server.sendContent("");
+      return;
+    }
+    server.setContentLength(_used);
+    server.send(_code, "application/json", "");
+    server.sendContent(_chunk, _used);
+  }
+
+ private:
+  char   _chunk[JSON_CHUNK_SIZE];
+  int    _code;
+  size_t _used;
+  bool   _started;
+};
+
+typedef JsonWriter<JsonResponse> ApiJson;
+
+static void beginPage(PageWriter& page, const char* title, const char* activeNav, bool includeCharts) {
   page += "<!DOCTYPE html><html><head><meta charset='utf-8'>";
   page += "<meta name='viewport' content='width=device-width,initial-scale=1'>";
   page += "<meta name='theme-color' content='#12a150'>";
   page += "<title>";
   page += title;
   page += "</title>";
-  page += "<link rel='icon' href='/logo-ezgrow.png' type='image/png'>";
-  page += "<link rel='stylesheet' href='/app.css'>";
-  if (includeCharts) page += "<script defer src='/chart.umd.min.js'></script>";
-  page += "<script defer src='/app.js'></script>";
+  page += "<link rel='icon' href='";
+  page += staticAssetUrl("/logo-ezgrow.png");
+  page += "' type='image/png'>";
+  page += "<link rel='stylesheet' href='";
+  page += staticAssetUrl("/app.css");
+  page += "'>";
+  if (includeCharts) {
+    page += "<script defer src='";
+    page += staticAssetUrl("/chart.umd.min.js");
+    page += "'></script>";
+  }
+  page += "<script defer src='";
+  page += staticAssetUrl("/app.js");
+  page += "'></script>";
   page += "</head><body data-page='";
   page += activeNav;
   page += "'>";
 
   // Top bar
   page += "<div class='topbar'><div class='topbar-inner'>";
-  page += "<div class='brand'><img src='/logo-ezgrow.png' class='brand-logo' alt='EZgrow logo'></div>";
+  page += "<div class='brand'><img src='";
+  page += staticAssetUrl("/logo-ezgrow.png");
+  page += "' class='brand-logo' alt='EZgrow logo'></div>";
 
   page += "<div class='nav'>";
   if (!sCaptivePortalActive) {
     page += "<a href='/'";
-    if (String(activeNav) == "dashboard") page += " class='active'";
+    if (strcmp(activeNav, "dashboard") == 0) page += " class='active'";
     page += ">Dashboard</a>";
 
     page += "<a href='/config'";
-    if (String(activeNav) == "config") page += " class='active'";
+    if (strcmp(activeNav, "config") == 0) page += " class='active'";
     page += ">Config</a>";
   } else {
     page += "<a href='/wifi'";
-    if (String(activeNav) == "wifi") page += " class='active'";
+    if (strcmp(activeNav, "wifi") == 0) page += " class='active'";
     page += ">Wi-Fi Setup</a>";
   }
   page += "</div>";
@@ -195,209 +579,1500 @@ static void beginPage(String& page, const char* title, const char* activeNav, bo
   page += "<div class='container'>";
 }
 
-static void endPage(String& page) {
+static void endPage(PageWriter& page) {
   page += "</div></body></html>";
+  page.end();
 }
 
 // ================= History API =================
 
-static void handleHistoryApi() {
-  if (!requireAuth()) return;
+// Points are serialized into a fixed stack buffer and flushed with chunked
+// transfer encoding, so peak RAM stays constant regardless of the range.
+static const size_t HISTORY_CHUNK_SIZE = 1024;
+
+struct HistoryWindow {
+  HistoryTier tier;
+  size_t   count;       // samples currently held in the tier
+  size_t   first;       // ordinals that can be selected: [first, end)
+  size_t   end;
+  size_t   maxSamples;  // fallback limit for samples without a timestamp
+  time_t   cutoffTs;
+  bool     hasTs;
+  uint32_t newestSeq;   // write sequence of the newest sample
+  uint32_t sinceSeq;    // only samples with a larger sequence (0 = all)
+  time_t   sinceTs;     // only samples with a later timestamp (0 = all)
+  time_t   fromTs;      // export range: samples in [fromTs, toTs] (0 = unbounded)
+  time_t   toTs;
+  bool     reset;       // true when the full window is returned
+};
+
+// Random per-boot id: sequence numbers restart after a reboot, so clients
+// holding an older cursor must reload the whole window.
+static uint32_t sHistoryBootId = 0;
+
+// since= values at or above this are Unix timestamps, below are sequences
+static const uint32_t HISTORY_SINCE_TS_MIN = 1000000000UL;
+
+// The i-th oldest sample of the window's tier (missing values if unreadable).
+// An export keeps its window across loop() passes: samples recorded since
+// the window was taken shift the ordinals, and evicted ones read as missing.
+static HistoryPoint historySampleAt(const HistoryWindow& w, size_t i, HistoryRange* range = nullptr) {
+  const uint32_t added    = historyTierSeq(w.tier) - w.newestSeq;
+  const size_t   countNow = historyTierCount(w.tier);
+  HistoryPoint s;
+  if (i + countNow < w.count + added ||
+      !historyTierRead(w.tier, i + countNow - w.count - added, s, range)) {
+    s.timestamp = 0;
+    s.temp      = NAN;
+    s.hum       = NAN;
+    s.soil1     = -1;
+    s.soil2     = -1;
+    s.light1    = false;
+    s.light2    = false;
+  }
+  return s;
+}
+
+static HistoryWindow historyWindowFor(HistoryTier tier, int days) {
+  HistoryWindow w;
+  w.tier = tier;
+  const unsigned long intervalSec  = historyTierIntervalSec(tier);
+  const size_t        capacity      = historyTierCapacity(tier);
+  const size_t        samplesPerDay = intervalSec ? (86400UL / intervalSec) : 0;
+  w.maxSamples = samplesPerDay > 0
+    ? min(capacity, samplesPerDay * (size_t)days)
+    : capacity;
+  w.count     = historyTierCount(tier);
+  w.newestSeq = historyTierSeq(tier);
+  w.end       = w.count;
+
+  // Timestamps rise with the ordinal, so scanning from the newest sample
+  // finds the cutoff first and stops at the first sample before it: only
+  // the window itself is read. Samples without a timestamp (recorded before
+  // time sync) are selected by count instead.
+  w.hasTs    = false;
+  w.cutoffTs = 0;
+  size_t firstByTs = w.count;
+  for (size_t i = w.count; i-- > 0;) {
+    const time_t ts = historySampleAt(w, i).timestamp;
+    if (ts <= 0) continue;
+    if (!w.hasTs) {
+      w.hasTs    = true;
+      w.cutoffTs = ts - ((time_t)days * 24 * 60 * 60);
+    }
+    if (ts < w.cutoffTs) break;
+    firstByTs = i;
+  }
+  const size_t firstByCount = w.count - min(w.count, w.maxSamples);
+  w.first = w.hasTs ? min(firstByTs, firstByCount) : firstByCount;
+
+  w.sinceSeq  = 0;
+  w.sinceTs   = 0;
+  w.fromTs    = 0;
+  w.toTs      = 0;
+  w.reset     = true;
+  return w;
+}
 
+// Applies since=<timestamp|sequence> (and the client's boot= id) to the window.
+// Cursors from another boot or from the future fall back to the full window.
+static void applyHistorySince(HistoryWindow& w) {
+  if (!server.hasArg("since")) return;
+  if (server.hasArg("boot") &&
+      strtoul(server.arg("boot").c_str(), nullptr, 16) != sHistoryBootId) {
+    return;
+  }
+
+  const uint32_t since = strtoul(server.arg("since").c_str(), nullptr, 10);
+  if (since >= HISTORY_SINCE_TS_MIN) {
+    w.sinceTs = (time_t)since;
+    w.reset   = false;
+  } else if (since <= w.newestSeq) {
+    w.sinceSeq = since;
+    w.reset    = false;
+    // Sequences are consecutive: the newer samples are the last ones
+    const uint32_t newer = w.newestSeq - since;
+    if (newer < w.count) w.first = max(w.first, w.count - (size_t)newer);
+  }
+}
+
+static bool historyWindowIncludes(const HistoryWindow& w, size_t i, const HistoryPoint& s) {
+  if (w.sinceSeq > 0 && (w.newestSeq - (uint32_t)(w.count - 1 - i)) <= w.sinceSeq) return false;
+  if (w.sinceTs > 0 && s.timestamp <= w.sinceTs) return false;
+  if (w.fromTs > 0 && (s.timestamp == 0 || s.timestamp < w.fromTs)) return false;
+  if (w.toTs > 0 && (s.timestamp == 0 || s.timestamp > w.toTs)) return false;
+
+  const bool withinRangeByTs    = w.hasTs && s.timestamp > 0 && s.timestamp >= w.cutoffTs;
+  const bool withinRangeByCount = (!w.hasTs || s.timestamp == 0)
+    ? ((w.count - i) <= w.maxSamples)
+    : false;
+  return withinRangeByTs || withinRangeByCount;
+}
+
+// ---- Downsampling (points= / maxPoints=) ----
+
+static const int    HISTORY_SERIES_COUNT      = 4;  // temp, hum, soil1, soil2
+static const size_t HISTORY_BUCKET_POINTS     = HISTORY_SERIES_COUNT + 2;  // picks and light switches
+static const size_t HISTORY_MIN_POINTS        = 16;
+
+static bool historySeriesValue(const HistoryPoint& s, int series, float& out) {
+  switch (series) {
+    case 0: out = s.temp; return !isnan(s.temp);
+    case 1: out = s.hum;  return !isnan(s.hum);
+    case 2: out = (float)s.soil1; return s.soil1 >= 0;
+    case 3: out = (float)s.soil2; return s.soil2 >= 0;
+    default: return false;
+  }
+}
+
+static inline uint8_t historyLightBits(const HistoryPoint& s) {
+  return (s.light1 ? 0x01 : 0x00) | (s.light2 ? 0x02 : 0x00);
+}
+
+// Largest-Triangle-Three-Buckets over the selected window, evaluated per
+// series, in one pass over [first, end) with O(1) state. A bucket's pick
+// depends on the average of the next bucket, so a bucket is decided once
+// the next one has been read; instead of keeping all its samples, it keeps
+// the lowest and highest value per series as candidates (MinMax
+// preselection: the largest triangle almost always has its apex at one of
+// them). The first and the last switch of either light in a bucket are kept
+// as well, so the chart shows each bucket's final light state.
+// Output never exceeds maxPoints: the first and last selected samples plus
+// HISTORY_BUCKET_POINTS per bucket. Without a point budget (or when the
+// window already fits) every selected sample is yielded unchanged.
+class HistoryDecimator {
+ public:
+  HistoryDecimator(const HistoryWindow& w, size_t maxPoints)
+    : _w(w), _lo(w.first), _hi(w.end), _buckets(0), _every(0.0f), _bucket(0),
+      _cursor(w.first), _end(0), _prevLights(0), _anchored(false), _last(0),
+      _hasLast(false), _hasPending(false), _qHead(0), _qLen(0), _queuedUpTo(0),
+      _queuedAny(false), _phase(PHASE_DONE) {
+    if (_lo >= _hi) return;
+    if (maxPoints == 0 || _hi - _lo <= maxPoints) {
+      _phase = PHASE_ALL;
+      return;
+    }
+    _buckets = (maxPoints - 2) / HISTORY_BUCKET_POINTS;
+    _every   = (float)(_hi - _lo) / (float)_buckets;
+    _end     = bucketStart(1);
+    _cur.reset();
+    _cur.start = _lo;
+    _phase = PHASE_SCAN;
+  }
+
+  // Next selected sample, oldest first (range filled when given); false
+  // when exhausted.
+  bool next(HistoryPoint& s, HistoryRange* range = nullptr) {
+    if (_phase == PHASE_ALL) {
+      while (_cursor < _hi) {
+        const size_t i = _cursor++;
+        s = historySampleAt(_w, i, range);
+        if (historyWindowIncludes(_w, i, s)) return true;
+      }
+      _phase = PHASE_DONE;
+      return false;
+    }
+    while (_qLen == 0 && _phase == PHASE_SCAN) scan();
+    if (_qLen == 0) return false;
+    s = historySampleAt(_w, _queue[_qHead++], range);
+    _qLen--;
+    return true;
+  }
+
+ private:
+  enum Phase { PHASE_ALL, PHASE_SCAN, PHASE_DONE };
+
+  // Candidates and running average of one bucket
+  struct Bucket {
+    size_t start;
+    size_t lo[HISTORY_SERIES_COUNT], hi[HISTORY_SERIES_COUNT];
+    float  loVal[HISTORY_SERIES_COUNT], hiVal[HISTORY_SERIES_COUNT];
+    float  sumX[HISTORY_SERIES_COUNT], sumY[HISTORY_SERIES_COUNT];
+    size_t n[HISTORY_SERIES_COUNT];
+    size_t edges[2];
+    size_t edgeCount;
+
+    void reset() { *this = Bucket(); }
+
+    void add(size_t i, const HistoryPoint& s, bool edge) {
+      for (int k = 0; k < HISTORY_SERIES_COUNT; ++k) {
+        float v;
+        if (!historySeriesValue(s, k, v)) continue;
+        if (n[k] == 0 || v < loVal[k]) { lo[k] = i; loVal[k] = v; }
+        if (n[k] == 0 || v > hiVal[k]) { hi[k] = i; hiVal[k] = v; }
+        sumX[k] += (float)i;
+        sumY[k] += v;
+        n[k]++;
+      }
+      if (!edge) return;
+      if (edgeCount < 2) edgeCount++;
+      edges[edgeCount - 1] = i;  // the first stays, the second follows the last
+    }
+  };
+
+  const HistoryWindow& _w;
+  size_t  _lo, _hi, _buckets;
+  float   _every;
+  size_t  _bucket, _cursor, _end;
+  uint8_t _prevLights;
+  bool    _anchored;
+
+  // The previous pick per series (the first corner of the triangle)
+  size_t _prev[HISTORY_SERIES_COUNT];
+  float  _prevVal[HISTORY_SERIES_COUNT];
+  bool   _prevOk[HISTORY_SERIES_COUNT];
+
+  // Newest selected sample so far (the last point of the output)
+  size_t _last;
+  float  _lastVal[HISTORY_SERIES_COUNT];
+  bool   _lastOk[HISTORY_SERIES_COUNT];
+  bool   _hasLast;
+
+  Bucket _pending;  // read, waiting for the next bucket's average
+  Bucket _cur;      // being read
+  bool   _hasPending;
+
+  // Ordinals decided but not yet yielded
+  size_t _queue[2 * HISTORY_BUCKET_POINTS + 2];
+  size_t _qHead, _qLen;
+  size_t _queuedUpTo;
+  bool   _queuedAny;
+  Phase  _phase;
+
+  size_t bucketStart(size_t b) const {
+    if (b >= _buckets) return _hi;
+    const size_t pos = _lo + (size_t)(b * _every);
+    return pos < _hi ? pos : _hi;
+  }
+
+  // Appends in ordinal order, skipping ordinals already queued
+  void enqueue(size_t i) {
+    if (_queuedAny && i <= _queuedUpTo) return;
+    if (_qLen == 0) _qHead = 0;
+    _queue[_qHead + _qLen++] = i;
+    _queuedUpTo = i;
+    _queuedAny  = true;
+  }
+
+  // Reads samples until something is queued or the window is done
+  void scan() {
+    while (_cursor < _end) {
+      const size_t i = _cursor++;
+      const HistoryPoint s = historySampleAt(_w, i);
+      if (!historyWindowIncludes(_w, i, s)) continue;
+      const uint8_t lights = historyLightBits(s);
+
+      _last    = i;
+      _hasLast = true;
+      for (int k = 0; k < HISTORY_SERIES_COUNT; ++k) _lastOk[k] = historySeriesValue(s, k, _lastVal[k]);
+
+      if (!_anchored) {  // the first selected sample is always kept
+        _anchored = true;
+        for (int k = 0; k < HISTORY_SERIES_COUNT; ++k) {
+          _prev[k]    = i;
+          _prevOk[k]  = _lastOk[k];
+          _prevVal[k] = _lastVal[k];
+        }
+        _prevLights = lights;
+        enqueue(i);
+        return;
+      }
+      _cur.add(i, s, lights != _prevLights);
+      _prevLights = lights;
+    }
+
+    // Bucket complete: the previous one can be decided
+    if (_hasPending) {
+      float cx[HISTORY_SERIES_COUNT], cy[HISTORY_SERIES_COUNT];
+      for (int k = 0; k < HISTORY_SERIES_COUNT; ++k) {
+        if (_cur.n[k] > 0) {
+          cx[k] = _cur.sumX[k] / (float)_cur.n[k];
+          cy[k] = _cur.sumY[k] / (float)_cur.n[k];
+        } else {
+          cx[k] = (float)_cur.start;
+          cy[k] = _prevOk[k] ? _prevVal[k] : 0.0f;
+        }
+      }
+      decide(_pending, cx, cy);
+    }
+    _pending    = _cur;
+    _hasPending = true;
+    _cur.reset();
+    _cur.start = _end;
+
+    if (++_bucket < _buckets) {
+      _end = bucketStart(_bucket + 1);
+      return;
+    }
+
+    // The last bucket closes against the newest sample
+    if (_hasLast) {
+      float cx[HISTORY_SERIES_COUNT], cy[HISTORY_SERIES_COUNT];
+      for (int k = 0; k < HISTORY_SERIES_COUNT; ++k) {
+        cx[k] = (float)_last;
+        cy[k] = _lastOk[k] ? _lastVal[k] : (_prevOk[k] ? _prevVal[k] : 0.0f);
+      }
+      decide(_pending, cx, cy);
+      enqueue(_last);
+    }
+    _phase = PHASE_DONE;
+  }
+
+  // Queues the bucket's pick per series (the candidate forming the largest
+  // triangle with the previous pick and c) and its light switches
+  void decide(const Bucket& b, const float* cx, const float* cy) {
+    size_t picks[HISTORY_BUCKET_POINTS];
+    size_t count = 0;
+    for (int k = 0; k < HISTORY_SERIES_COUNT; ++k) {
+      if (b.n[k] == 0) continue;
+      const float ax = (float)_prev[k];
+      const float ay = _prevOk[k] ? _prevVal[k] : cy[k];
+      const float loArea = fabsf((ax - cx[k]) * (b.loVal[k] - ay) - (ax - (float)b.lo[k]) * (cy[k] - ay));
+      const float hiArea = fabsf((ax - cx[k]) * (b.hiVal[k] - ay) - (ax - (float)b.hi[k]) * (cy[k] - ay));
+      const bool  useHi  = hiArea > loArea;
+      _prev[k]    = useHi ? b.hi[k] : b.lo[k];
+      _prevVal[k] = useHi ? b.hiVal[k] : b.loVal[k];
+      _prevOk[k]  = true;
+      picks[count++] = _prev[k];
+    }
+    for (size_t e = 0; e < b.edgeCount; ++e) picks[count++] = b.edges[e];
+
+    // A handful of ordinals: insertion sort
+    for (size_t a = 1; a < count; ++a) {
+      const size_t v = picks[a];
+      size_t j = a;
+      while (j > 0 && picks[j - 1] > v) {
+        picks[j] = picks[j - 1];
+        --j;
+      }
+      picks[j] = v;
+    }
+    for (size_t a = 0; a < count; ++a) enqueue(picks[a]);
+  }
+};
+
+static void formatHistoryFloat(char* out, size_t cap, float v, int decimals) {
+  if (isnan(v)) snprintf(out, cap, "null");
+  else snprintf(out, cap, "%.*f", decimals, v);
+}
+
+static void formatHistorySoil(char* out, size_t cap, int v) {
+  if (v < 0) snprintf(out, cap, "null");
+  else snprintf(out, cap, "%d", v);
+}
+
+// Missing readings are null
+static JsonFixedValue historyJsonSoil(int v) {
+  return jsonFixed(v < 0 ? NAN : (float)v, 0);
+}
+
+// One point as JSON (plus min/max fields for hourly rollups)
+template <typename Out>
+static void writeHistoryPointJson(JsonWriter<Out>& json, const HistoryPoint& s, const HistoryRange* range) {
+  json.beginObject();
+  json.field("t", (unsigned long)s.timestamp);
+  json.field("temp", jsonFixed(s.temp, 1));
+  json.field("hum", jsonFixed(s.hum, 0));
+  json.field("soil1", historyJsonSoil(s.soil1));
+  json.field("soil2", historyJsonSoil(s.soil2));
+  json.field("l1", s.light1 ? 1 : 0);
+  json.field("l2", s.light2 ? 1 : 0);
+  if (range) {
+    json.field("temp_min", jsonFixed(range->tempMin, 1));
+    json.field("temp_max", jsonFixed(range->tempMax, 1));
+    json.field("hum_min", jsonFixed(range->humMin, 0));
+    json.field("hum_max", jsonFixed(range->humMax, 0));
+    json.field("soil1_min", historyJsonSoil(range->soil1Min));
+    json.field("soil1_max", historyJsonSoil(range->soil1Max));
+    json.field("soil2_min", historyJsonSoil(range->soil2Min));
+    json.field("soil2_max", historyJsonSoil(range->soil2Max));
+    json.field("l1_pct", (unsigned)range->light1Pct);
+    json.field("l2_pct", (unsigned)range->light2Pct);
+  }
+  json.endObject();
+}
+
+// Buffers response bytes in a fixed chunk and hands full chunks to the server.
+struct HistoryChunkWriter {
+  char     chunk[HISTORY_CHUNK_SIZE];
+  size_t   used;
+  size_t   total;
+  uint32_t heapLow;
+
+  HistoryChunkWriter() : used(0), total(0), heapLow(ESP.getFreeHeap()) {}
+
+  size_t space() const { return sizeof(chunk) - used; }
+
+  void flush() {
+    if (used == 0) return;
+    server.sendContent(chunk, used);
+    total += used;
+    used = 0;
+    uint32_t heapNow = ESP.getFreeHeap();
+    if (heapNow < heapLow) heapLow = heapNow;
+  }
+
+  void put(const void* data, size_t len) {
+    if (space() < len) flush();
+    memcpy(chunk + used, data, len);
+    used += len;
+  }
+
+  // JsonWriter output; values may span chunks
+  void write(const char* data, size_t len) {
+    while (len > 0) {
+      if (used == sizeof(chunk)) flush();
+      size_t n = space() < len ? space() : len;
+      memcpy(chunk + used, data, n);
+      used += n;
+      data += n;
+      len  -= n;
+    }
+  }
+
+  void putU8(uint8_t v) { put(&v, 1); }
+
+  void putU16(uint16_t v) {
+    uint8_t b[2] = { (uint8_t)(v & 0xFF), (uint8_t)(v >> 8) };
+    put(b, sizeof(b));
+  }
+
+  void putU32(uint32_t v) {
+    uint8_t b[4] = { (uint8_t)(v & 0xFF), (uint8_t)((v >> 8) & 0xFF),
+                     (uint8_t)((v >> 16) & 0xFF), (uint8_t)(v >> 24) };
+    put(b, sizeof(b));
+  }
+};
+
+static int historyRequestedDays() {
   int requestedDays = 1;
   if (server.hasArg("days")) {
     requestedDays = server.arg("days").toInt();
   }
+  const int maxDays = historyMaxDays();
   if (requestedDays < 1) requestedDays = 1;
-  if (requestedDays > 7) requestedDays = 7;
+  if (requestedDays > maxDays) requestedDays = maxDays;
+  return requestedDays;
+}
 
-  const unsigned long intervalSec  = HISTORY_INTERVAL_MS / 1000UL;
-  const size_t        samplesPerDay = intervalSec ? (86400UL / intervalSec) : 0;
-  const size_t        maxSamples    = samplesPerDay > 0
-    ? min((size_t)HISTORY_SIZE, samplesPerDay * (size_t)requestedDays)
-    : (size_t)HISTORY_SIZE;
+// points= / maxPoints= budget; 0 means no downsampling
+static size_t historyRequestedPoints() {
+  String raw = server.hasArg("points") ? server.arg("points")
+             : server.hasArg("maxPoints") ? server.arg("maxPoints") : String();
+  long requested = raw.length() ? raw.toInt() : 0;
+  if (requested <= 0) return 0;
+  if ((size_t)requested < HISTORY_MIN_POINTS) return HISTORY_MIN_POINTS;
+  return (size_t)requested;
+}
+
+// tier= forces a tier; otherwise the coarsest tier that covers the range at
+// the requested resolution (range / points, or 10 minutes without a budget)
+static HistoryTier historyRequestedTier(int days, size_t maxPoints) {
+  HistoryTier tier;
+  if (server.hasArg("tier") && historyTierFromName(server.arg("tier"), tier)) return tier;
+
+  const unsigned long resolutionSec = maxPoints > 0
+    ? ((unsigned long)days * 86400UL) / maxPoints
+    : HISTORY_INTERVAL_MS / 1000UL;
+  return historyTierForRange(days, resolutionSec);
+}
+
+static void logHistoryRequest(const char* route, int days, HistoryTier tier, size_t points,
+                              const HistoryChunkWriter& out, unsigned long startMs) {
+  if (!WEB_DEBUG_TIMING) return;
+  Serial.printf("[WEB] %s days=%d tier=%s points=%u bytes=%u ms=%lu heap_low=%u\n",
+                route, days, historyTierName(tier), (unsigned)points, (unsigned)out.total,
+                millis() - startMs, (unsigned)out.heapLow);
+}
+
+// ETag for the buffer state and the since= cursor; an unchanged ring asked
+// for the same cursor is answered with 304. A cursor from another boot is
+// ignored by applyHistorySince(), so it is left out of the tag as well.
+// Returns false when the response has already been sent.
+static bool sendHistoryValidators(HistoryTier tier, int days, size_t maxPoints) {
+  char cursor[16] = "";
+  if (server.hasArg("since") &&
+      (!server.hasArg("boot") ||
+       strtoul(server.arg("boot").c_str(), nullptr, 16) == sHistoryBootId)) {
+    snprintf(cursor, sizeof(cursor), "-s%lu",
+             (unsigned long)strtoul(server.arg("since").c_str(), nullptr, 10));
+  }
+
+  char etag[72];
+  snprintf(etag, sizeof(etag), "\"%08lx-%s%lu-%d-%u%s\"",
+           (unsigned long)sHistoryBootId, historyTierName(tier),
+           (unsigned long)historyTierSeq(tier), days, (unsigned)maxPoints, cursor);
+
+  server.sendHeader("ETag", etag);
+  server.sendHeader("Cache-Control", "no-cache");
+  if (server.hasHeader("If-None-Match") && server.header("If-None-Match") == etag) {
+    server.send(304, "text/plain", "");
+    return false;
+  }
+  return true;
+}
+
+static void handleHistoryApi() {
+  if (!requireAuth()) return;
 
-  size_t count = gHistoryFull ? HISTORY_SIZE : gHistoryIndex;
-  if (count == 0) {
-    server.send(200, "application/json", "{ \"points\":[] }");
+  const int         requestedDays = historyRequestedDays();
+  const size_t      maxPoints     = historyRequestedPoints();
+  const HistoryTier tier          = historyRequestedTier(requestedDays, maxPoints);
+  if (!sendHistoryValidators(tier, requestedDays, maxPoints)) return;
+
+  HistoryWindow window = historyWindowFor(tier, requestedDays);
+  applyHistorySince(window);
+
+  const unsigned long startMs = millis();
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+
+  HistoryChunkWriter out;
+  JsonWriter<HistoryChunkWriter> json(out);
+  char boot[12];
+  snprintf(boot, sizeof(boot), "%08lx", (unsigned long)sHistoryBootId);
+  json.beginObject();
+  json.field("tier", historyTierName(tier));
+  json.field("interval", (unsigned long)historyTierIntervalSec(tier));
+  json.field("seq", (unsigned long)window.newestSeq);
+  json.field("boot", boot);
+  json.field("reset", window.reset);
+  json.key("points").beginArray();
+
+  const bool withRange = historyTierHasRange(tier);
+  HistoryDecimator picks(window, maxPoints);
+  size_t points = 0;
+  HistoryPoint s;
+  HistoryRange range;
+  while (picks.next(s, withRange ? &range : nullptr)) {
+    writeHistoryPointJson(json, s, withRange ? &range : nullptr);
+    points++;
+  }
+
+  json.endArray().endObject();
+  out.flush();
+  server.sendContent("");
+
+  logHistoryRequest("/api/history", requestedDays, tier, points, out, startMs);
+}
+
+// Binary history (little-endian, one record per point):
+//   header  "EZHB" magic, u8 version, u8 header size,
+//           u16 flags (bit0 reset, bit1 range fields, bits 8-11 tier),
+//           u32 record size, u32 sample interval (s), u32 newest sequence,
+//           u32 boot id
+//   records u32 t, i16 temp (0.1 °C), u16 hum (0.1 %RH), u8 soil1, u8 soil2,
+//           u8 lights (bit0 light1, bit1 light2)
+//           range fields (hourly tier): i16 temp_min/temp_max,
+//           u16 hum_min/hum_max, u8 soil1_min/soil1_max,
+//           u8 soil2_min/soil2_max, u8 l1_pct/l2_pct
+// The records run to the end of the body, so each point is read and
+// written once as the decimator yields it and the body goes out chunked;
+// the client splits the records into columns.
+// Missing values are encoded as INT16_MIN / 0xFFFF / 0xFF.
+static const uint8_t HISTORY_BIN_VERSION          = 2;
+static const uint8_t HISTORY_BIN_HEADER_SIZE      = 24;
+static const size_t  HISTORY_BIN_POINT_SIZE       = 4 + 2 + 2 + 1 + 1 + 1;
+static const size_t  HISTORY_BIN_RANGE_POINT_SIZE = 2 + 2 + 2 + 2 + 1 + 1 + 1 + 1 + 1 + 1;
+
+static void putHistoryBinRecord(HistoryChunkWriter& out, const HistoryPoint& s, const HistoryRange* r) {
+  out.putU32((uint32_t)s.timestamp);
+  out.putU16((uint16_t)historyEncodeTemp(s.temp));
+  out.putU16(historyEncodeHum(s.hum));
+  out.putU8(historyEncodeSoil(s.soil1));
+  out.putU8(historyEncodeSoil(s.soil2));
+  out.putU8(historyLightBits(s));
+  if (!r) return;
+  out.putU16((uint16_t)historyEncodeTemp(r->tempMin));
+  out.putU16((uint16_t)historyEncodeTemp(r->tempMax));
+  out.putU16(historyEncodeHum(r->humMin));
+  out.putU16(historyEncodeHum(r->humMax));
+  out.putU8(historyEncodeSoil(r->soil1Min));
+  out.putU8(historyEncodeSoil(r->soil1Max));
+  out.putU8(historyEncodeSoil(r->soil2Min));
+  out.putU8(historyEncodeSoil(r->soil2Max));
+  out.putU8(r->light1Pct);
+  out.putU8(r->light2Pct);
+}
+
+static void handleHistoryBinApi() {
+  if (!requireAuth()) return;
+
+  const int         requestedDays = historyRequestedDays();
+  const size_t      maxPoints     = historyRequestedPoints();
+  const HistoryTier tier          = historyRequestedTier(requestedDays, maxPoints);
+  if (!sendHistoryValidators(tier, requestedDays, maxPoints)) return;
+
+  HistoryWindow window = historyWindowFor(tier, requestedDays);
+  applyHistorySince(window);
+
+  const bool   withRange  = historyTierHasRange(tier);
+  const size_t recordSize = HISTORY_BIN_POINT_SIZE + (withRange ? HISTORY_BIN_RANGE_POINT_SIZE : 0);
+  uint16_t flags = (uint16_t)((uint16_t)tier << 8);
+  if (window.reset) flags |= 0x0001;
+  if (withRange)    flags |= 0x0002;
+
+  const unsigned long startMs = millis();
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/octet-stream", "");
+
+  HistoryChunkWriter out;
+  out.put("EZHB", 4);
+  out.putU8(HISTORY_BIN_VERSION);
+  out.putU8(HISTORY_BIN_HEADER_SIZE);
+  out.putU16(flags);
+  out.putU32((uint32_t)recordSize);
+  out.putU32((uint32_t)historyTierIntervalSec(tier));
+  out.putU32(window.newestSeq);
+  out.putU32(sHistoryBootId);
+
+  HistoryDecimator picks(window, maxPoints);
+  size_t points = 0;
+  HistoryPoint s;
+  HistoryRange range = {};
+  while (picks.next(s, withRange ? &range : nullptr)) {
+    putHistoryBinRecord(out, s, withRange ? &range : nullptr);
+    points++;
+  }
+  out.flush();
+  server.sendContent("");
+
+  logHistoryRequest("/api/history.bin", requestedDays, tier, points, out, startMs);
+}
+
+// ---- Export (CSV / NDJSON) ----
+//   /api/history.csv?from=<unix>&to=<unix>&columns=time,temp,hum
+//   /api/history.ndjson?...
+// Rows are formatted one at a time by a HistoryExportSource as sTransfers
+// asks for body bytes, so a long range is sent across many loop() passes.
+static const size_t HISTORY_EXPORT_ROW_SIZE = 320;
+
+enum HistoryExportColumn : uint8_t {
+  HIST_EXP_TIME,       // ISO-8601 in the device time zone
+  HIST_EXP_T,          // unix seconds
+  HIST_EXP_TEMP,
+  HIST_EXP_HUM,
+  HIST_EXP_SOIL1,
+  HIST_EXP_SOIL2,
+  HIST_EXP_L1,
+  HIST_EXP_L2,
+  HIST_EXP_BASE_COUNT,
+  HIST_EXP_TEMP_MIN = HIST_EXP_BASE_COUNT,  // hourly tier only
+  HIST_EXP_TEMP_MAX,
+  HIST_EXP_HUM_MIN,
+  HIST_EXP_HUM_MAX,
+  HIST_EXP_SOIL1_MIN,
+  HIST_EXP_SOIL1_MAX,
+  HIST_EXP_SOIL2_MIN,
+  HIST_EXP_SOIL2_MAX,
+  HIST_EXP_L1_PCT,
+  HIST_EXP_L2_PCT,
+  HIST_EXP_COUNT
+};
+
+static const char* const HISTORY_EXPORT_COLUMN_NAMES[HIST_EXP_COUNT] = {
+  "time", "t", "temp", "hum", "soil1", "soil2", "l1", "l2",
+  "temp_min", "temp_max", "hum_min", "hum_max",
+  "soil1_min", "soil1_max", "soil2_min", "soil2_max", "l1_pct", "l2_pct"
+};
+
+struct HistoryExportColumns {
+  uint8_t order[HIST_EXP_COUNT];
+  size_t  count;
+};
+
+// columns=a,b,c (request order, duplicates ignored); defaults to every column
+// of the tier. Returns false and names the offending column if unknown.
+static bool parseHistoryExportColumns(const String& raw, bool withRange,
+                                      HistoryExportColumns& out, String& bad) {
+  out.count = 0;
+  if (raw.length() == 0) {
+    const size_t n = withRange ? HIST_EXP_COUNT : HIST_EXP_BASE_COUNT;
+    for (size_t c = 0; c < n; ++c) out.order[out.count++] = (uint8_t)c;
+    return true;
+  }
+
+  uint32_t seen = 0;
+  int start = 0;
+  while (start <= (int)raw.length()) {
+    int comma = raw.indexOf(',', start);
+    if (comma < 0) comma = raw.length();
+    String name = raw.substring(start, comma);
+    name.trim();
+    start = comma + 1;
+    if (name.length() == 0) continue;
+
+    size_t c = 0;
+    while (c < HIST_EXP_COUNT && name != HISTORY_EXPORT_COLUMN_NAMES[c]) c++;
+    if (c == HIST_EXP_COUNT) {
+      bad = name;
+      return false;
+    }
+    if (seen & (1UL << c)) continue;
+    seen |= 1UL << c;
+    out.order[out.count++] = (uint8_t)c;
+  }
+  if (out.count == 0) {
+    bad = raw;
+    return false;
+  }
+  return true;
+}
+
+// 2024-03-31T14:05:00+02:00 (empty if the time is unknown)
+static size_t formatHistoryIsoTime(char* out, size_t cap, time_t ts) {
+  if (ts <= 0) {
+    if (cap) out[0] = '\0';
+    return 0;
+  }
+  struct tm local;
+  localtime_r(&ts, &local);
+  char zone[8];
+  if (strftime(zone, sizeof(zone), "%z", &local) != 5) snprintf(zone, sizeof(zone), "+0000");
+  const int n = snprintf(out, cap, "%04d-%02d-%02dT%02d:%02d:%02d%.3s:%.2s",
+                         local.tm_year + 1900, local.tm_mon + 1, local.tm_mday,
+                         local.tm_hour, local.tm_min, local.tm_sec, zone, zone + 3);
+  return (n < 0 || (size_t)n >= cap) ? 0 : (size_t)n;
+}
+
+// One value; missing readings are empty in CSV and null in NDJSON
+static void formatHistoryExportValue(char* out, size_t cap, HistoryExportColumn col,
+                                     const HistoryPoint& s, const HistoryRange* r, bool csv) {
+  if (col >= HIST_EXP_BASE_COUNT && !r) {
+    snprintf(out, cap, "%s", csv ? "" : "null");
     return;
   }
+  switch (col) {
+    case HIST_EXP_TIME: {
+      char iso[32];
+      if (formatHistoryIsoTime(iso, sizeof(iso), s.timestamp) == 0) snprintf(out, cap, "%s", csv ? "" : "null");
+      else snprintf(out, cap, csv ? "%s" : "\"%s\"", iso);
+      return;
+    }
+    case HIST_EXP_T:         snprintf(out, cap, "%lu", (unsigned long)s.timestamp); break;
+    case HIST_EXP_TEMP:      formatHistoryFloat(out, cap, s.temp, 1); break;
+    case HIST_EXP_HUM:       formatHistoryFloat(out, cap, s.hum, 0); break;
+    case HIST_EXP_SOIL1:     formatHistorySoil(out, cap, s.soil1); break;
+    case HIST_EXP_SOIL2:     formatHistorySoil(out, cap, s.soil2); break;
+    case HIST_EXP_L1:        snprintf(out, cap, "%d", s.light1 ? 1 : 0); break;
+    case HIST_EXP_L2:        snprintf(out, cap, "%d", s.light2 ? 1 : 0); break;
+    case HIST_EXP_TEMP_MIN:  formatHistoryFloat(out, cap, r->tempMin, 1); break;
+    case HIST_EXP_TEMP_MAX:  formatHistoryFloat(out, cap, r->tempMax, 1); break;
+    case HIST_EXP_HUM_MIN:   formatHistoryFloat(out, cap, r->humMin, 0); break;
+    case HIST_EXP_HUM_MAX:   formatHistoryFloat(out, cap, r->humMax, 0); break;
+    case HIST_EXP_SOIL1_MIN: formatHistorySoil(out, cap, r->soil1Min); break;
+    case HIST_EXP_SOIL1_MAX: formatHistorySoil(out, cap, r->soil1Max); break;
+    case HIST_EXP_SOIL2_MIN: formatHistorySoil(out, cap, r->soil2Min); break;
+    case HIST_EXP_SOIL2_MAX: formatHistorySoil(out, cap, r->soil2Max); break;
+    case HIST_EXP_L1_PCT:    snprintf(out, cap, "%u", (unsigned)r->light1Pct); break;
+    case HIST_EXP_L2_PCT:    snprintf(out, cap, "%u", (unsigned)r->light2Pct); break;
+    default:                 snprintf(out, cap, "%s", csv ? "" : "null"); return;
+  }
+  if (csv && strcmp(out, "null") == 0) out[0] = '\0';
+}
+
+// CSV line or NDJSON object (with trailing newline); returns its length
+static size_t formatHistoryExportRow(char* out, size_t cap, const HistoryExportColumns& cols,
+                                     const HistoryPoint& s, const HistoryRange* r, bool csv) {
+  size_t used = 0;
+  if (!csv) out[used++] = '{';
+  for (size_t k = 0; k < cols.count; ++k) {
+    const HistoryExportColumn col = (HistoryExportColumn)cols.order[k];
+    char value[40];
+    formatHistoryExportValue(value, sizeof(value), col, s, r, csv);
+    const int n = csv
+      ? snprintf(out + used, cap - used, "%s%s", k ? "," : "", value)
+      : snprintf(out + used, cap - used, "%s\"%s\":%s", k ? "," : "", HISTORY_EXPORT_COLUMN_NAMES[col], value);
+    if (n < 0 || (size_t)n >= cap - used) return 0;
+    used += (size_t)n;
+  }
+  const int n = snprintf(out + used, cap - used, csv ? "\r\n" : "}\n");
+  if (n < 0 || (size_t)n >= cap - used) return 0;
+  return used + (size_t)n;
+}
 
-  // Find newest timestamp to build a cutoff window if time is available
-  time_t newestTs = 0;
-  bool   hasTs    = false;
-  for (size_t i = 0; i < count; ++i) {
-    size_t idx = gHistoryFull ? ((gHistoryIndex + i) % HISTORY_SIZE) : i;
-    time_t ts  = gHistoryBuf[idx].timestamp;
-    if (ts > 0) {
-      hasTs = true;
-      if (ts > newestTs) newestTs = ts;
+// Cursor over the decimated window; one row is formatted at a time, so the
+// source holds a row of RAM however long the range is.
+class HistoryExportSource : public HttpBodySource {
+ public:
+  HistoryExportSource(const char* route, int days, const HistoryWindow& w, size_t maxPoints,
+                      const HistoryExportColumns& cols, bool csv)
+    : _route(route), _days(days), _window(w), _picks(_window, maxPoints), _cols(cols),
+      _csv(csv), _withRange(historyTierHasRange(w.tier)), _len(0), _pos(0), _points(0),
+      _bytes(0), _startMs(millis()) {
+    sHistoryExports++;
+    if (!csv) return;
+    // The header fits: an NDJSON row carries the same names
+    for (size_t k = 0; k < cols.count; ++k) {
+      const char* name = HISTORY_EXPORT_COLUMN_NAMES[cols.order[k]];
+      if (k) _row[_len++] = ',';
+      memcpy(_row + _len, name, strlen(name));
+      _len += strlen(name);
     }
+    memcpy(_row + _len, "\r\n", 2);
+    _len += 2;
+  }
+
+  ~HistoryExportSource() {
+    sHistoryExports--;
+    if (!WEB_DEBUG_TIMING) return;
+    Serial.printf("[WEB] %s days=%d tier=%s points=%u bytes=%u ms=%lu\n", _route, _days,
+                  historyTierName(_window.tier), (unsigned)_points, (unsigned)_bytes,
+                  millis() - _startMs);
+  }
+
+  size_t read(uint8_t* buf, size_t len) override {
+    size_t used = 0;
+    while (used < len) {
+      if (_pos == _len && !nextRow()) break;
+      const size_t n = _len - _pos < len - used ? _len - _pos : len - used;
+      memcpy(buf + used, _row + _pos, n);
+      _pos += n;
+      used += n;
+    }
+    _bytes += used;
+    return used;
+  }
+
+ private:
+  bool nextRow() {
+    HistoryPoint s;
+    HistoryRange range = {};
+    if (!_picks.next(s, _withRange ? &range : nullptr)) return false;
+    _len = formatHistoryExportRow(_row, sizeof(_row), _cols, s, _withRange ? &range : nullptr, _csv);
+    _pos = 0;
+    _points++;
+    return true;
+  }
+
+  const char*          _route;
+  int                  _days;
+  HistoryWindow        _window;
+  HistoryDecimator     _picks;  // refers to _window
+  HistoryExportColumns _cols;
+  bool                 _csv;
+  bool                 _withRange;
+  char                 _row[HISTORY_EXPORT_ROW_SIZE];
+  size_t               _len, _pos;
+  size_t               _points, _bytes;
+  unsigned long        _startMs;
+};
+
+static void handleHistoryExport(bool csv) {
+  if (!requireAuth()) return;
+
+  // from= widens days= so the window reaches back far enough
+  const time_t fromTs = server.hasArg("from") ? (time_t)strtoul(server.arg("from").c_str(), nullptr, 10) : 0;
+  const time_t toTs   = server.hasArg("to")   ? (time_t)strtoul(server.arg("to").c_str(), nullptr, 10) : 0;
+  if (fromTs > 0 && toTs > 0 && fromTs > toTs) {
+    server.send(400, "text/plain", "from must not be after to");
+    return;
+  }
+  int requestedDays = historyRequestedDays();
+  const time_t now = time(nullptr);
+  if (fromTs > 0 && now > fromTs) {
+    const long spanDays = (long)((now - fromTs) / 86400) + 1;
+    requestedDays = (int)min((long)historyMaxDays(), max((long)requestedDays, spanDays));
+  }
+  const size_t      maxPoints = historyRequestedPoints();
+  const HistoryTier tier      = historyRequestedTier(requestedDays, maxPoints);
+  const bool        withRange = historyTierHasRange(tier);
+
+  HistoryExportColumns cols;
+  String bad;
+  if (!parseHistoryExportColumns(server.arg("columns"), withRange, cols, bad)) {
+    server.send(400, "text/plain", "unknown column: " + bad);
+    return;
   }
 
-  const time_t cutoffTs = hasTs ? (newestTs - (requestedDays * 24 * 60 * 60)) : 0;
+  HistoryWindow window = historyWindowFor(tier, requestedDays);
+  applyHistorySince(window);
+  window.fromTs = fromTs;
+  window.toTs   = toTs;
 
-  String json;
-  json.reserve(90000);
-  json += "{ \"points\":[";
+  if (!reserveTransfer(true)) return;
+  server.sendHeader("Cache-Control", "no-cache");
+  server.sendHeader("Content-Disposition", csv ? "attachment; filename=\"ezgrow-history.csv\""
+                                               : "attachment; filename=\"ezgrow-history.ndjson\"");
+  sendStaticBody(new HistoryExportSource(csv ? "/api/history.csv" : "/api/history.ndjson", requestedDays,
+                                         window, maxPoints, cols, csv),
+                 HTTP_TRANSFER_UNTIL_END, csv ? "text/csv; charset=utf-8" : "application/x-ndjson", false);
+}
 
-  bool first = true;
-  for (size_t i = 0; i < count; ++i) {
-    size_t idx = gHistoryFull ? ((gHistoryIndex + i) % HISTORY_SIZE) : i;
-    HistorySample &s = gHistoryBuf[idx];
+static void handleHistoryCsvApi() {
+  handleHistoryExport(true);
+}
 
-    const bool withinRangeByTs   = hasTs && s.timestamp > 0 && s.timestamp >= cutoffTs;
-    const bool withinRangeByCount = (!hasTs || s.timestamp == 0)
-      ? ((count - i) <= maxSamples)
-      : false;
-    if (!(withinRangeByTs || withinRangeByCount)) continue;
+static void handleHistoryNdjsonApi() {
+  handleHistoryExport(false);
+}
 
-    if (!first) json += ",";
-    first = false;
+// Aggregates over the 10-minute tier:
+//   /api/history/stats?from=<unix>&to=<unix>   (default: 24 h up to the newest sample)
+// Served from the per-block summaries (HistoryStats.h) instead of a scan.
+static size_t formatHistoryStatsSeries(char* out, size_t cap, const char* name,
+                                       const HistorySeriesStats& a, float scale, int decimals) {
+  char min[16], max[16], mean[16];
+  const bool any = a.count > 0;
+  formatHistoryFloat(min, sizeof(min), any ? a.min * scale : NAN, decimals);
+  formatHistoryFloat(max, sizeof(max), any ? a.max * scale : NAN, decimals);
+  formatHistoryFloat(mean, sizeof(mean), any ? (float)((double)a.sum / a.count) * scale : NAN, decimals + 1);
+  const int n = snprintf(out, cap, ",\"%s\":{\"min\":%s,\"max\":%s,\"mean\":%s,\"count\":%lu}",
+                         name, min, max, mean, (unsigned long)a.count);
+  return (n < 0 || (size_t)n >= cap) ? 0 : (size_t)n;
+}
+
+static void handleHistoryStatsApi() {
+  if (!requireAuth()) return;
 
-    json += "{";
+  uint32_t to = 0;
+  if (server.hasArg("to")) {
+    to = (uint32_t)strtoul(server.arg("to").c_str(), nullptr, 10);
+  } else {
+    HistorySample newest;
+    const size_t count = historyRingCount();
+    if (count > 0 && historyRingRead(count - 1, newest)) to = newest.timestamp;
+  }
+  uint32_t from = server.hasArg("from")
+    ? (uint32_t)strtoul(server.arg("from").c_str(), nullptr, 10)
+    : (to > 86400UL ? to - 86400UL : 0);
+  if (from > to) {
+    server.send(400, "application/json", "{\"error\":\"from must not be after to\"}");
+    return;
+  }
 
-    json += "\"t\":";
-    json += String((unsigned long)s.timestamp);
+  const unsigned long startUs = micros();
+  HistoryStats stats;
+  historyRingStats(from, to, stats);
+  const unsigned long queryUs = micros() - startUs;
+
+  char body[512];
+  size_t used = (size_t)snprintf(body, sizeof(body),
+                                 "{\"tier\":\"%s\",\"from\":%lu,\"to\":%lu,\"first\":%lu,\"last\":%lu,\"samples\":%lu",
+                                 historyTierName(HISTORY_TIER_10MIN), (unsigned long)from, (unsigned long)to,
+                                 (unsigned long)stats.firstTs, (unsigned long)stats.lastTs,
+                                 (unsigned long)stats.samples);
+  used += formatHistoryStatsSeries(body + used, sizeof(body) - used, "temp",
+                                   stats.series[HISTORY_STATS_TEMP], 0.01f, 2);
+  used += formatHistoryStatsSeries(body + used, sizeof(body) - used, "hum",
+                                   stats.series[HISTORY_STATS_HUM], 1.0f, 0);
+  used += formatHistoryStatsSeries(body + used, sizeof(body) - used, "soil1",
+                                   stats.series[HISTORY_STATS_SOIL1], 1.0f, 0);
+  used += formatHistoryStatsSeries(body + used, sizeof(body) - used, "soil2",
+                                   stats.series[HISTORY_STATS_SOIL2], 1.0f, 0);
+  snprintf(body + used, sizeof(body) - used, "}");
+
+  server.sendHeader("Cache-Control", "no-cache");
+  server.send(200, "application/json", body);
+
+  if (WEB_DEBUG_TIMING) {
+    Serial.printf("[WEB] /api/history/stats from=%lu to=%lu samples=%lu merged=%u scanned=%u us=%lu\n",
+                  (unsigned long)from, (unsigned long)to, (unsigned long)stats.samples,
+                  (unsigned)stats.blocksMerged, (unsigned)stats.blocksScanned, queryUs);
+  }
+}
 
-    json += ",\"temp\":";
-    if (isnan(s.temp)) json += "null";
-    else json += String(s.temp, 1);
+// ================= Event stream (SSE) =================
+// /api/events pushes what the dashboard would otherwise poll /api/status
+// for: "sensors" when an averaged reading changes as displayed, "relays"
+// with the relays whose state or mode changed, and "config" (empty) when
+// saveConfig() ran, after which the page refetches /api/status once.
+// A new subscriber triggers a full "sensors" + "relays" snapshot.
+
+static HttpEventStream sEvents;
+
+static const char* const kRelayIds[] = { "light1", "light2", "fan", "pump" };
+static const size_t      kRelayCount = sizeof(kRelayIds) / sizeof(kRelayIds[0]);
+
+struct RelaySnapshot {
+  bool state[kRelayCount];
+  bool autoOn[kRelayCount];
+};
+
+static RelaySnapshot currentRelays() {
+  RelaySnapshot r;
+  r.state[0] = gRelays.light1; r.autoOn[0] = gConfig.light1.enabled;
+  r.state[1] = gRelays.light2; r.autoOn[1] = gConfig.light2.enabled;
+  r.state[2] = gRelays.fan;    r.autoOn[2] = gConfig.autoFan;
+  r.state[3] = gRelays.pump;   r.autoOn[3] = gConfig.autoPump;
+  return r;
+}
 
-    json += ",\"hum\":";
-    if (isnan(s.hum)) json += "null";
-    else json += String(s.hum, 0);
+static RelaySnapshot sEventRelays;
+static uint32_t      sEventSensorSeq = 0;
+static uint32_t      sEventConfigSeq = 0;
+static char          sEventSensors[96] = "";
+static bool          sEventsResync = false;
+static uint32_t      sWsCommands = 0;  // handled on /api/ws
+
+// Shared by /api/status and the "sensors" event; compact: short keys
+// (/api/status?compact=1)
+template <typename Out>
+static void writeSensorsJson(JsonWriter<Out>& json, bool compact = false) {
+  json.beginObject();
+  json.field(compact ? "t" : "temp_c", jsonFixed(gSensors.temperatureC, 1));
+  json.field(compact ? "h" : "hum_rh", jsonFixed(gSensors.humidityRH, 0));
+  json.field(compact ? "s1" : "soil1", gSensors.soil1Percent);
+  json.field(compact ? "s2" : "soil2", gSensors.soil2Percent);
+  json.endObject();
+}
 
-    json += ",\"soil1\":";
-    json += String(s.soil1);
-    json += ",\"soil2\":";
-    json += String(s.soil2);
+// NUL-terminated; 0 when it does not fit
+static size_t formatSensorsJson(char* text, size_t cap) {
+  JsonBuffer buf(text, cap - 1);
+  JsonWriter<JsonBuffer> json(buf);
+  writeSensorsJson(json);
+  if (buf.overflow()) return 0;
+  text[buf.size()] = '\0';
+  return buf.size();
+}
 
-    json += ",\"l1\":";
-    json += s.light1 ? "1" : "0";
-    json += ",\"l2\":";
-    json += s.light2 ? "1" : "0";
+// Called every loop(); a few comparisons unless something changed
+static void publishStatusEvents() {
+  if (sEvents.clients() == 0) return;
+
+  if (sEventsResync || gSensorSeq != sEventSensorSeq) {
+    sEventSensorSeq = gSensorSeq;
+    char text[sizeof(sEventSensors)];
+    const size_t n = formatSensorsJson(text, sizeof(text));
+    if (n > 0 && (sEventsResync || strcmp(text, sEventSensors) != 0)) {
+      memcpy(sEventSensors, text, n + 1);
+      sEvents.publish("sensors", text, n);
+    }
+  }
 
-    json += "}";
+  const RelaySnapshot now = currentRelays();
+  char json[160];
+  size_t used = 0;
+  for (size_t i = 0; i < kRelayCount; ++i) {
+    if (!sEventsResync && now.state[i] == sEventRelays.state[i] && now.autoOn[i] == sEventRelays.autoOn[i]) continue;
+    used += snprintf(json + used, sizeof(json) - used, "%s\"%s\":{\"state\":%d,\"auto\":%d}",
+                     used ? "," : "{", kRelayIds[i], now.state[i] ? 1 : 0, now.autoOn[i] ? 1 : 0);
+  }
+  if (used > 0) {
+    used += snprintf(json + used, sizeof(json) - used, "}");
+    sEvents.publish("relays", json, used);
+    sEventRelays = now;
   }
 
-  json += "]}";
-  server.send(200, "application/json", json);
+  if (gConfigSeq != sEventConfigSeq) {
+    sEventConfigSeq = gConfigSeq;
+    if (!sEventsResync) sEvents.publish("config", "{}", 2);
+  }
+  sEventsResync = false;
+}
+
+static void handleEventsApi() {
+  if (!requireAuth()) return;
+  if (sEvents.clients() >= HTTP_EVENT_CLIENTS) {
+    // EventSource gives up on a non-200 answer; the page falls back to polling
+    server.send(503, "text/plain", "Too many event streams");
+    return;
+  }
+  server.sendHeader("Cache-Control", "no-cache");
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  HttpBodySink* sink = new ClientBodySink(server.detachClient());
+  server.send(200, "text/event-stream", "");
+  if (sEvents.subscribe(sink, millis()) < 0) {
+    delete sink;
+    return;
+  }
+  sEventsResync = true;
+  Serial.printf("[WEB] Event stream opened (%u/%u)\n", (unsigned)sEvents.clients(), (unsigned)HTTP_EVENT_CLIENTS);
 }
 
 // ================= Status API (new) =================
 
-static void handleStatusApi() {
-  if (!requireAuth()) return;
+// /api/status is versioned by a generation that moves whenever something the
+// dashboard renders from it changes: readings as displayed, relay states and
+// modes, saved config, time sync and the Wi-Fi connection (mode and
+// address). It is sent as the ETag; a matching If-None-Match is answered
+// with 304, and with ?wait=<ms> the request is parked on its connection
+// (HttpServer::deferRequest()) until the generation moves or the wait ends.
+// The ticking clock and the RSSI do not move it (the page runs its own clock
+// between fetches), nor do the diagnostic counters, so only projections
+// within STATUS_VERSIONED are validated: a plain /api/status, which
+// includes the counters, always gets a full 200 without an ETag.
+
+#ifndef STATUS_WAIT_MAX_MS
+#define STATUS_WAIT_MAX_MS 30000
+#endif
+
+// ?fields=sensors,relays limits the answer to those groups (every group by
+// default); groups left out are not formatted at all. ?compact=1 shortens
+// the sensor and relay keys and leaves out the light schedules, for pollers
+// that only want the live values.
+enum StatusField : uint16_t {
+  STATUS_TIME           = 1 << 0,  // time, time_synced, timezone, timezone_iana
+  STATUS_WIFI           = 1 << 1,
+  STATUS_SENSORS        = 1 << 2,
+  STATUS_CHART_SCALES   = 1 << 3,
+  STATUS_CHAMBERS       = 1 << 4,
+  STATUS_RELAYS         = 1 << 5,
+  STATUS_FLASH          = 1 << 6,
+  STATUS_STATIC_CACHE   = 1 << 7,
+  STATUS_HTTP_TRANSFERS = 1 << 8,
+  STATUS_HTTP           = 1 << 9,
+  STATUS_EVENTS         = 1 << 10,
+  STATUS_ALL            = (1 << 11) - 1,
+  // Groups covered by sStatusGen (time and wifi up to the clock and RSSI).
+  // The counters change without a new generation, so a projection
+  // including them gets no ETag and therefore no 304 or ?wait=
+  STATUS_VERSIONED      = STATUS_TIME | STATUS_WIFI | STATUS_SENSORS | STATUS_CHART_SCALES |
+                          STATUS_CHAMBERS | STATUS_RELAYS
+};
+
+static const struct {
+  const char* name;
+  uint16_t    bit;
+} kStatusFields[] = {
+  { "time",           STATUS_TIME },
+  { "wifi",           STATUS_WIFI },
+  { "sensors",        STATUS_SENSORS },
+  { "chart_scales",   STATUS_CHART_SCALES },
+  { "chambers",       STATUS_CHAMBERS },
+  { "relays",         STATUS_RELAYS },
+  { "flash",          STATUS_FLASH },
+  { "static_cache",   STATUS_STATIC_CACHE },
+  { "http_transfers", STATUS_HTTP_TRANSFERS },
+  { "http",           STATUS_HTTP },
+  { "events",         STATUS_EVENTS },
+};
+
+// Comma-separated group names; false for an unknown name or none at all
+static bool parseStatusFields(const char* s, uint16_t& mask) {
+  mask = 0;
+  while (true) {
+    const char* end = strchr(s, ',');
+    const size_t len = end ? (size_t)(end - s) : strlen(s);
+    if (len > 0) {
+      size_t i = 0;
+      while (i < sizeof(kStatusFields) / sizeof(kStatusFields[0]) &&
+             !(strlen(kStatusFields[i].name) == len && memcmp(kStatusFields[i].name, s, len) == 0)) {
+        ++i;
+      }
+      if (i == sizeof(kStatusFields) / sizeof(kStatusFields[0])) return false;
+      mask |= kStatusFields[i].bit;
+    }
+    if (!end) break;
+    s = end + 1;
+  }
+  return mask != 0;
+}
+
+struct StatusSnapshot {
+  RelaySnapshot relays;
+  uint32_t      sensorSeq;
+  uint32_t      configSeq;
+  uint32_t      wifiIp;
+  uint8_t       wifiMode;   // 0 none, 1 AP, 2 STA (as in writeWifiJson())
+  bool          timeSynced;
+  char          sensors[sizeof(sEventSensors)];
+};
+
+static StatusSnapshot sStatusSeen;
+static uint32_t       sStatusGen = 0;
+
+// Called every loop() before the server runs; wakes parked long polls
+static void trackStatusGeneration() {
+  bool changed = false;
+
+  if (gSensorSeq != sStatusSeen.sensorSeq) {
+    sStatusSeen.sensorSeq = gSensorSeq;
+    char text[sizeof(sStatusSeen.sensors)];
+    const size_t n = formatSensorsJson(text, sizeof(text));
+    if (n > 0 && strcmp(text, sStatusSeen.sensors) != 0) {
+      memcpy(sStatusSeen.sensors, text, n + 1);
+      changed = true;
+    }
+  }
+
+  const RelaySnapshot relays = currentRelays();
+  if (memcmp(&relays, &sStatusSeen.relays, sizeof(relays)) != 0) {
+    sStatusSeen.relays = relays;
+    changed = true;
+  }
+
+  if (gConfigSeq != sStatusSeen.configSeq) {
+    sStatusSeen.configSeq = gConfigSeq;
+    changed = true;
+  }
 
   struct tm nowTime;
-  bool timeAvail;
-  greenhouseGetTime(nowTime, timeAvail);
+  bool timeSynced;
+  greenhouseGetTime(nowTime, timeSynced);
+  if (timeSynced != sStatusSeen.timeSynced) {
+    sStatusSeen.timeSynced = timeSynced;
+    changed = true;
+  }
 
-  String timeStr = "syncing…";
-  if (timeAvail) {
-    char buf[16];
-    sprintf(buf, "%02d:%02d:%02d", nowTime.tm_hour, nowTime.tm_min, nowTime.tm_sec);
-    timeStr = buf;
+  const bool connected = (WiFi.status() == WL_CONNECTED);
+  const uint8_t wifiMode = connected ? 2 : ((WiFi.getMode() & WIFI_MODE_AP) ? 1 : 0);
+  uint32_t wifiIp = 0;
+  if (connected) {
+    const IPAddress ip = WiFi.localIP();
+    wifiIp = ((uint32_t)ip[0] << 24) | ((uint32_t)ip[1] << 16) | ((uint32_t)ip[2] << 8) | ip[3];
+  }
+  if (wifiMode != sStatusSeen.wifiMode || wifiIp != sStatusSeen.wifiIp) {
+    sStatusSeen.wifiMode = wifiMode;
+    sStatusSeen.wifiIp   = wifiIp;
+    changed = true;
   }
 
-  bool connected = (WiFi.status() == WL_CONNECTED);
-  String modeStr = connected ? "STA" : ((WiFi.getMode() & WIFI_MODE_AP) ? "AP" : "NONE");
+  if (changed || sStatusGen == 0) {
+    sStatusGen++;
+    server.wakeDeferred();
+  }
+}
 
-  String json;
-  json.reserve(1100);
+// RAM cache in front of the LittleFS static assets (StaticFileCache.h)
+static void writeStaticCacheJson(ApiJson& json) {
+  const StaticCacheStats& st = sStaticCache.stats();
+  json.key("static_cache").beginObject();
+  json.field("budget_bytes", (unsigned long)sStaticCache.budget());
+  json.field("bytes", (unsigned long)sStaticCache.bytes());
+  json.field("entries", (unsigned long)sStaticCache.entries());
+  json.field("hits", (unsigned long)st.hits);
+  json.field("misses", (unsigned long)st.misses);
+  json.field("evictions", (unsigned long)st.evictions);
+  json.field("invalidations", (unsigned long)st.invalidations);
+  json.endObject();
+}
 
-  json += "{";
-  json += "\"time\":\"" + jsonEscape(timeStr) + "\",";
-  json += "\"time_synced\":"; json += (timeAvail ? "true" : "false"); json += ",";
-  json += "\"timezone\":\"" + jsonEscape(greenhouseTimezoneLabel()) + "\",";
-  json += "\"timezone_iana\":\"" + jsonEscape(greenhouseTimezoneIana()) + "\",";
+// Static asset bodies in flight (HttpTransfers.h)
+static void writeHttpTransfersJson(ApiJson& json) {
+  const HttpTransferStats& st = sTransfers.stats();
+  json.key("http_transfers").beginObject();
+  json.field("active", (unsigned long)sTransfers.active());
+  json.field("peak", (unsigned)st.peak);
+  json.field("started", (unsigned long)st.started);
+  json.field("completed", (unsigned long)st.completed);
+  json.field("aborted", (unsigned long)st.aborted);
+  json.field("refused", (unsigned long)st.refused);
+  json.field("bytes", (unsigned long long)st.bytes);
+  json.endObject();
+}
 
-  json += "\"wifi\":{";
-  json += "\"connected\":"; json += (connected ? "true" : "false"); json += ",";
-  json += "\"mode\":\"" + jsonEscape(modeStr) + "\"";
+// Persistent connections (HttpKeepAlive.h): accepted stays flat while
+// requests grow when clients reuse their connections
+static void writeHttpConnectionsJson(ApiJson& json) {
+  const HttpConnectionStats& st = server.connections().stats();
+  json.key("http").beginObject();
+  json.field("open", (unsigned long)server.connections().openCount());
+  json.field("accepted", (unsigned long)st.accepted);
+  json.field("requests", (unsigned long)st.requests);
+  json.field("reused", (unsigned long)st.reused);
+  json.field("pipelined", (unsigned long)st.pipelined);
+  json.field("deferred", (unsigned long)st.deferred);
+  json.key("closed").beginObject();
+  for (int r = 0; r < HTTP_CLOSE_REASON_COUNT; ++r) {
+    json.field(httpCloseReasonName((HttpCloseReason)r), (unsigned long)st.closed[r]);
+  }
+  json.endObject();
+  json.endObject();
+}
 
-  if (connected) {
-    json += ",\"ssid\":\"" + jsonEscape(WiFi.SSID()) + "\"";
-    json += ",\"rssi\":" + String(WiFi.RSSI());
-    json += ",\"ip\":\"" + jsonEscape(WiFi.localIP().toString()) + "\"";
-  }
-  json += "},";
-
-  json += "\"sensors\":{";
-  json += "\"temp_c\":";
-  if (isnan(gSensors.temperatureC)) json += "null";
-  else json += String(gSensors.temperatureC, 1);
-  json += ",\"hum_rh\":";
-  if (isnan(gSensors.humidityRH)) json += "null";
-  else json += String(gSensors.humidityRH, 0);
-  json += ",\"soil1\":" + String(gSensors.soil1Percent);
-  json += ",\"soil2\":" + String(gSensors.soil2Percent);
-  json += "},";
-
-  json += "\"chart_scales\":{";
-  json += "\"temp_min\":" + String(gConfig.charts.tempMinC, 1);
-  json += ",\"temp_max\":" + String(gConfig.charts.tempMaxC, 1);
-  json += ",\"hum_min\":" + String(gConfig.charts.humMinPct);
-  json += ",\"hum_max\":" + String(gConfig.charts.humMaxPct);
-  json += "},";
-
-  json += "\"chambers\":[";
-  auto chamberJson = [&](int idx, const ChamberConfig& cfg, int soilPercent, const char* lightId) {
-    const int id = idx + 1;
-    const char* fallback = (idx == 0) ? DEFAULT_CHAMBER1_NAME : DEFAULT_CHAMBER2_NAME;
-    const String name = cfg.name.length() ? cfg.name : String(fallback);
-    json += "{\"id\":" + String(id);
-    json += ",\"idx\":" + String(idx);
-    json += ",\"name\":\"" + jsonEscape(name) + "\"";
-    json += ",\"soil\":" + String(soilPercent);
-    json += ",\"soil_dry_threshold\":" + String(cfg.soilDryThreshold);
-    json += ",\"soil_wet_threshold\":" + String(cfg.soilWetThreshold);
-    json += ",\"profile_id\":" + String(cfg.profileId);
-    json += ",\"profile_label\":\"" + jsonEscape(growProfileLabelForId(cfg.profileId)) + "\"";
-    json += ",\"light_relay_id\":\"" + jsonEscape(lightId) + "\"}";
-  };
-  chamberJson(0, gConfig.chamber1, gSensors.soil1Percent, "light1");
-  json += ",";
-  chamberJson(1, gConfig.chamber2, gSensors.soil2Percent, "light2");
-  json += "],";
+// Open /api/events streams and what they carried (HttpEvents.h)
+static void writeEventStreamJson(ApiJson& json) {
+  const HttpEventStats& st = sEvents.stats();
+  json.key("events").beginObject();
+  json.field("clients", (unsigned long)sEvents.clients());
+  json.field("subscribed", (unsigned long)st.subscribed);
+  json.field("refused", (unsigned long)st.refused);
+  json.field("dropped", (unsigned long)st.dropped);
+  json.field("published", (unsigned long)st.events);
+  json.field("heartbeats", (unsigned long)st.heartbeats);
+  json.field("ws_commands", (unsigned long)sWsCommands);
+  json.field("bytes", (unsigned long long)st.bytes);
+  json.endObject();
+}
 
-  auto sched = [](const LightSchedule& lc)->String {
-    return minutesToTimeStrSafe(lc.onMinutes) + "–" + minutesToTimeStrSafe(lc.offMinutes);
+// Write budget, per-pool erase totals and lifetime projection, per-subsystem
+// counters since boot (FlashWear.h)
+static void writeFlashWearJson(ApiJson& json) {
+  const uint32_t uptime = greenhouseUptimeSec();
+  auto days = [&json](const char* key, uint32_t d) {
+    if (d == FLASH_WEAR_LIFETIME_UNKNOWN) json.key(key).null();
+    else json.field(key, (unsigned long)d);
   };
 
-  json += "\"relays\":{";
+  json.key("flash").beginObject();
+  json.field("uptime_s", (unsigned long)uptime);
+  json.field("budget_bytes_per_day", (unsigned long)flashWearBudget());
+  json.field("budget_available", (long)flashWearTokens());
+  json.field("bytes_today", (unsigned long)flashWearBytesToday());
+  json.field("bytes_yesterday", (unsigned long)flashWearBytesYesterday());
+  days("lifetime_days", flashWearLifetimeDays(uptime));
+
+  json.key("pools").beginObject();
+  for (int p = 0; p < FLASH_WEAR_POOL_COUNT; ++p) {
+    const FlashWearPool pool = (FlashWearPool)p;
+    json.key(flashWearPoolName(pool)).beginObject();
+    json.field("size", (unsigned long)flashWearPoolSize(pool));
+    json.field("erases", (unsigned long long)flashWearPoolErases(pool));
+    days("lifetime_days", flashWearLifetimeDays(pool, uptime));
+    json.endObject();
+  }
+  json.endObject();
+
+  json.key("subsystems").beginObject();
+  for (int i = 0; i < FLASH_WEAR_SUBSYSTEM_COUNT; ++i) {
+    const FlashWearSubsystem sub = (FlashWearSubsystem)i;
+    const FlashWearCounters& c = flashWearCounters(sub);
+    json.key(flashWearSubsystemName(sub)).beginObject();
+    json.field("writes", (unsigned long)c.writes);
+    json.field("bytes", (unsigned long long)c.bytes);
+    json.field("erases", (unsigned long)c.erases);
+    json.field("deferred", (unsigned long)c.deferred);
+    json.endObject();
+  }
+  json.endObject();
+  json.endObject();
+}
 
-  json += "\"light1\":{";
-  json += "\"state\":"; json += (gRelays.light1 ? "1" : "0"); json += ",";
-  json += "\"auto\":";  json += (gConfig.light1.enabled ? "1" : "0"); json += ",";
-  json += "\"on_minutes\":" + String(gConfig.light1.onMinutes) + ",";
-  json += "\"off_minutes\":" + String(gConfig.light1.offMinutes) + ",";
-  json += "\"schedule\":\"" + jsonEscape(sched(gConfig.light1)) + "\"";
-  json += "},";
+static void writeChamberJson(ApiJson& json, int idx, const ChamberConfig& cfg, int soilPercent, const char* lightId) {
+  const char* fallback = (idx == 0) ? DEFAULT_CHAMBER1_NAME : DEFAULT_CHAMBER2_NAME;
+  json.beginObject();
+  json.field("id", idx + 1);
+  json.field("idx", idx);
+  json.field("name", cfg.name.length() ? cfg.name.c_str() : fallback);
+  json.field("soil", soilPercent);
+  json.field("soil_dry_threshold", (int)cfg.soilDryThreshold);
+  json.field("soil_wet_threshold", (int)cfg.soilWetThreshold);
+  json.field("profile_id", (int)cfg.profileId);
+  json.field("profile_label", growProfileLabelForId(cfg.profileId));
+  json.field("light_relay_id", lightId);
+  json.endObject();
+}
 
-  json += "\"light2\":{";
-  json += "\"state\":"; json += (gRelays.light2 ? "1" : "0"); json += ",";
-  json += "\"auto\":";  json += (gConfig.light2.enabled ? "1" : "0"); json += ",";
-  json += "\"on_minutes\":" + String(gConfig.light2.onMinutes) + ",";
-  json += "\"off_minutes\":" + String(gConfig.light2.offMinutes) + ",";
-  json += "\"schedule\":\"" + jsonEscape(sched(gConfig.light2)) + "\"";
-  json += "},";
+static void writeLightRelayJson(ApiJson& json, const char* id, bool state, const LightSchedule& lc) {
+  char on[6], off[6];
+  formatTimeOfDay(on, lc.onMinutes);
+  formatTimeOfDay(off, lc.offMinutes);
+  json.key(id).beginObject();
+  json.field("state", state ? 1 : 0);
+  json.field("auto", lc.enabled ? 1 : 0);
+  json.field("on_minutes", (int)lc.onMinutes);
+  json.field("off_minutes", (int)lc.offMinutes);
+  json.key("schedule").beginString().part(on).part("–").part(off).endString();
+  json.endObject();
+}
 
-  json += "\"fan\":{";
-  json += "\"state\":"; json += (gRelays.fan ? "1" : "0"); json += ",";
-  json += "\"auto\":";  json += (gConfig.autoFan ? "1" : "0");
-  json += "},";
+static void writeRelaysJson(ApiJson& json, bool compact) {
+  if (compact) {
+    const RelaySnapshot r = currentRelays();
+    json.key("r").beginObject();
+    for (size_t i = 0; i < kRelayCount; ++i) {
+      json.key(kRelayIds[i]).beginObject().field("s", r.state[i] ? 1 : 0).field("a", r.autoOn[i] ? 1 : 0).endObject();
+    }
+    json.endObject();
+    return;
+  }
+  json.key("relays").beginObject();
+  writeLightRelayJson(json, "light1", gRelays.light1, gConfig.light1);
+  writeLightRelayJson(json, "light2", gRelays.light2, gConfig.light2);
+  json.key("fan").beginObject().field("state", gRelays.fan ? 1 : 0).field("auto", gConfig.autoFan ? 1 : 0).endObject();
+  json.key("pump").beginObject().field("state", gRelays.pump ? 1 : 0).field("auto", gConfig.autoPump ? 1 : 0).endObject();
+  json.endObject();
+}
 
-  json += "\"pump\":{";
-  json += "\"state\":"; json += (gRelays.pump ? "1" : "0"); json += ",";
-  json += "\"auto\":";  json += (gConfig.autoPump ? "1" : "0");
-  json += "}";
+static void writeTimeJson(ApiJson& json) {
+  struct tm nowTime;
+  bool timeAvail;
+  greenhouseGetTime(nowTime, timeAvail);
 
-  json += "}"; // relays
-  json += "}";
+  char timeStr[16] = "syncing…";
+  if (timeAvail) {
+    snprintf(timeStr, sizeof(timeStr), "%02d:%02d:%02d", nowTime.tm_hour, nowTime.tm_min, nowTime.tm_sec);
+  }
+  json.field("time", timeStr);
+  json.field("time_synced", timeAvail);
+  json.field("timezone", greenhouseTimezoneLabel());
+  json.field("timezone_iana", greenhouseTimezoneIana());
+}
 
-  server.send(200, "application/json", json);
+static void writeWifiJson(ApiJson& json) {
+  const bool connected = (WiFi.status() == WL_CONNECTED);
+  const char* modeStr = connected ? "STA" : ((WiFi.getMode() & WIFI_MODE_AP) ? "AP" : "NONE");
+
+  json.key("wifi").beginObject();
+  json.field("connected", connected);
+  json.field("mode", modeStr);
+  wifi_ap_record_t ap;
+  if (connected && esp_wifi_sta_get_ap_info(&ap) == ESP_OK) {
+    // Read directly: WiFi.SSID() returns a heap String
+    json.field("ssid", reinterpret_cast<const char*>(ap.ssid));
+    json.field("rssi", (int)ap.rssi);
+    const IPAddress ip = WiFi.localIP();
+    char ipStr[16];
+    snprintf(ipStr, sizeof(ipStr), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    json.field("ip", ipStr);
+  }
+  json.endObject();
+}
+
+static void handleStatusApi() {
+  if (!requireAuth()) return;
+
+  uint16_t fields = STATUS_ALL;
+  if (server.hasArg("fields") && !parseStatusFields(server.arg("fields").c_str(), fields)) {
+    server.send(400, "text/plain", "Unknown field");
+    return;
+  }
+  const bool compact = server.arg("compact") == "1";
+
+  // The representation is part of the ETag
+  if ((fields & ~STATUS_VERSIONED) == 0) {
+    char etag[40];
+    snprintf(etag, sizeof(etag), "\"%08lx-%lu-%x%s\"", (unsigned long)sHistoryBootId,
+             (unsigned long)sStatusGen, (unsigned)fields, compact ? "c" : "");
+    if (server.hasHeader("If-None-Match") && server.header("If-None-Match") == etag) {
+      const long waitMs = server.hasArg("wait") ? server.arg("wait").toInt() : 0;
+      if (waitMs > 0 && server.deferRequest(waitMs < STATUS_WAIT_MAX_MS ? (uint32_t)waitMs : STATUS_WAIT_MAX_MS)) return;
+      server.sendHeader("ETag", etag);
+      server.sendHeader("Cache-Control", "no-cache");
+      server.send(304, "application/json", "");
+      return;
+    }
+    server.sendHeader("ETag", etag);
+  }
+  server.sendHeader("Cache-Control", "no-cache");
+
+  JsonResponse out;
+  ApiJson json(out);
+  json.beginObject();
+  if (fields & STATUS_TIME) writeTimeJson(json);
+  if (fields & STATUS_WIFI) writeWifiJson(json);
+
+  if (fields & STATUS_SENSORS) {
+    json.key(compact ? "s" : "sensors");
+    writeSensorsJson(json, compact);
+  }
+
+  if (fields & STATUS_CHART_SCALES) {
+    json.key("chart_scales").beginObject();
+    json.field("temp_min", jsonFixed(gConfig.charts.tempMinC, 1));
+    json.field("temp_max", jsonFixed(gConfig.charts.tempMaxC, 1));
+    json.field("hum_min", (int)gConfig.charts.humMinPct);
+    json.field("hum_max", (int)gConfig.charts.humMaxPct);
+    json.endObject();
+  }
+
+  if (fields & STATUS_CHAMBERS) {
+    json.key("chambers").beginArray();
+    writeChamberJson(json, 0, gConfig.chamber1, gSensors.soil1Percent, "light1");
+    writeChamberJson(json, 1, gConfig.chamber2, gSensors.soil2Percent, "light2");
+    json.endArray();
+  }
+
+  if (fields & STATUS_RELAYS)         writeRelaysJson(json, compact);
+  if (fields & STATUS_FLASH)          writeFlashWearJson(json);
+  if (fields & STATUS_STATIC_CACHE)   writeStaticCacheJson(json);
+  if (fields & STATUS_HTTP_TRANSFERS) writeHttpTransfersJson(json);
+  if (fields & STATUS_HTTP)           writeHttpConnectionsJson(json);
+  if (fields & STATUS_EVENTS)         writeEventStreamJson(json);
+  json.endObject();
+  out.end();
 }
 
 // ================= Reboot API =================
@@ -413,6 +2088,7 @@ static void handleRebootApi() {
 
   delay(250);
   Serial.println("[SYS] Rebooting after API request");
+  flushPersistence();
   delay(250);
   ESP.restart();
 }
@@ -489,18 +2165,19 @@ static void handleApplyProfileChamberApi() {
 
   ChamberConfig &cfg = (chamberIdx == 0) ? gConfig.chamber1 : gConfig.chamber2;
   const char* fallback = (chamberIdx == 0) ? DEFAULT_CHAMBER1_NAME : DEFAULT_CHAMBER2_NAME;
-  const String chamberName = cfg.name.length() ? cfg.name : String(fallback);
-  String label = appliedName + " -> " + chamberName;
-
-  String json = "{";
-  json += "\"ok\":true,";
-  json += "\"applied_profile\":\"" + jsonEscape(appliedName) + "\",";
-  json += "\"chamber_idx\":" + String(chamberIdx) + ",";
-  json += "\"chamber_id\":" + String(chamberId) + ",";
-  json += "\"chamber_name\":\"" + jsonEscape(chamberName) + "\",";
-  json += "\"label\":\"" + jsonEscape(label) + "\"";
-  json += "}";
-  server.send(200, "application/json", json);
+  const char* chamberName = cfg.name.length() ? cfg.name.c_str() : fallback;
+
+  JsonResponse out;
+  ApiJson json(out);
+  json.beginObject();
+  json.field("ok", true);
+  json.field("applied_profile", appliedName);
+  json.field("chamber_idx", chamberIdx);
+  json.field("chamber_id", chamberId);
+  json.field("chamber_name", chamberName);
+  json.key("label").beginString().part(appliedName.c_str(), appliedName.length()).part(" -> ").part(chamberName).endString();
+  json.endObject();
+  out.end();
 }
 
 static void handleApplyProfileAllApi() {
@@ -522,11 +2199,10 @@ static void handleApplyProfileAllApi() {
   Serial.print("[AUDIT] Grow profile applied to all chambers: ");
   Serial.println(appliedName);
 
-  String json = "{";
-  json += "\"ok\":true,";
-  json += "\"applied_profile\":\"" + jsonEscape(appliedName) + "\"";
-  json += "}";
-  server.send(200, "application/json", json);
+  JsonResponse out;
+  ApiJson json(out);
+  json.beginObject().field("ok", true).field("applied_profile", appliedName).endObject();
+  out.end();
 }
 
 // ================= Static assets from LittleFS =================
@@ -550,6 +2226,42 @@ static void handleAppJs() {
 
 // ================= API controls (new) =================
 
+// Relay and AUTO flag by id; false for an unknown id
+static bool relayFlags(const char* id, bool*& state, bool*& autoOn) {
+  if (strcmp(id, "light1") == 0) { state = &gRelays.light1; autoOn = &gConfig.light1.enabled; return true; }
+  if (strcmp(id, "light2") == 0) { state = &gRelays.light2; autoOn = &gConfig.light2.enabled; return true; }
+  if (strcmp(id, "fan") == 0)    { state = &gRelays.fan;    autoOn = &gConfig.autoFan;        return true; }
+  if (strcmp(id, "pump") == 0)   { state = &gRelays.pump;   autoOn = &gConfig.autoPump;       return true; }
+  return false;
+}
+
+// Flips a manual relay and drives its pin right away, so the answer
+// reports the relay as it is. Refused with reason "AUTO" while automatic.
+static bool toggleRelay(const char* id, const char*& reason) {
+  bool* state;
+  bool* autoOn;
+  if (!relayFlags(id, state, autoOn)) return false;
+  if (*autoOn) {
+    reason = "AUTO";
+    return false;
+  }
+  *state = !*state;
+  syncRelays();
+  return true;
+}
+
+// Switching to AUTO runs the control logic at once instead of on the next
+// loop(), which also drives the pins
+static bool setRelayMode(const char* id, bool autoOn) {
+  bool* state;
+  bool* flag;
+  if (!relayFlags(id, state, flag) || *flag == autoOn) return false;
+  *flag = autoOn;
+  saveConfig();
+  updateControlLogic();
+  return true;
+}
+
 static void handleApiToggle() {
   if (!requireAuth()) return;
 
@@ -559,35 +2271,15 @@ static void handleApiToggle() {
   }
 
   String id = server.arg("id");
-
-  bool changed = false;
-  String reason = "";
-  if (id == "light1" && !gConfig.light1.enabled) {
-    gRelays.light1 = !gRelays.light1; changed = true;
-  } else if (id == "light1") {
-    reason = "AUTO";
-  } else if (id == "light2" && !gConfig.light2.enabled) {
-    gRelays.light2 = !gRelays.light2; changed = true;
-  } else if (id == "light2") {
-    reason = "AUTO";
-  } else if (id == "fan" && !gConfig.autoFan) {
-    gRelays.fan = !gRelays.fan; changed = true;
-  } else if (id == "fan") {
-    reason = "AUTO";
-  } else if (id == "pump" && !gConfig.autoPump) {
-    gRelays.pump = !gRelays.pump; changed = true;
-  } else if (id == "pump") {
-    reason = "AUTO";
-  }
-
-  String json = String("{\"ok\":true,\"changed\":") + (changed ? "true" : "false");
-  if (!changed && reason.length() > 0) {
-    json += ",\"reason\":\"";
-    json += jsonEscape(reason);
-    json += "\"";
-  }
-  json += "}";
-  server.send(200, "application/json", json);
+  const char* reason = nullptr;
+  bool changed = toggleRelay(id.c_str(), reason);
+
+  JsonResponse out;
+  ApiJson json(out);
+  json.beginObject().field("ok", true).field("changed", changed);
+  if (!changed && reason) json.field("reason", reason);
+  json.endObject();
+  out.end();
 }
 
 static void handleApiMode() {
@@ -601,102 +2293,237 @@ static void handleApiMode() {
   String id   = server.arg("id");
   bool autoOn = (server.arg("auto") == "1");
 
-  bool changed = false;
+  bool changed = setRelayMode(id.c_str(), autoOn);
+  JsonResponse out;
+  ApiJson json(out);
+  json.beginObject().field("ok", true).field("changed", changed).endObject();
+  out.end();
+}
 
-  if (id == "fan") {
-    changed = (gConfig.autoFan != autoOn);
-    if (changed) gConfig.autoFan = autoOn;
-  } else if (id == "pump") {
-    changed = (gConfig.autoPump != autoOn);
-    if (changed) gConfig.autoPump = autoOn;
-  } else if (id == "light1") {
-    changed = (gConfig.light1.enabled != autoOn);
-    if (changed) gConfig.light1.enabled = autoOn;
-  } else if (id == "light2") {
-    changed = (gConfig.light2.enabled != autoOn);
-    if (changed) gConfig.light2.enabled = autoOn;
+// ================= WebSocket control channel =================
+//
+// /api/ws carries the /api/events stream as JSON text frames (HttpEvents.h)
+// and takes relay commands on the same connection:
+//   {"op":"toggle","id":"fan","seq":7}
+//   {"op":"mode","id":"fan","auto":1,"seq":8}
+// Each is answered with an "ack" holding the relay as driven, e.g.
+//   {"type":"ack","data":{"seq":7,"ok":true,"changed":true,"id":"fan","state":1,"auto":0}}
+// so a toggle is confirmed within one loop() instead of the next status
+// poll. The event stream owns the connection (its sink writes and closes
+// it); the reader here only keeps the receiving side of each slot.
+
+struct WsReader {
+  WiFiClient        client;
+  HttpReceiveBuffer rx;
+  bool              open;
+  WsReader() : rx(HTTP_WS_MAX_MESSAGE + 8), open(false) {}  // largest frame header is 8 bytes
+};
+
+static WsReader sWsReaders[HTTP_EVENT_CLIENTS];
+
+static void handleWebSocketApi() {
+  if (!requireAuth()) return;
+
+  const String key = server.header("Sec-WebSocket-Key");
+  const String upgrade = server.header("Upgrade");
+  if (!httpEqualsIgnoreCase(upgrade.c_str(), upgrade.length(), "websocket") || key.length() == 0 ||
+      server.header("Sec-WebSocket-Version") != "13") {
+    server.sendHeader("Sec-WebSocket-Version", "13");
+    server.send(400, "text/plain", "WebSocket upgrade required");
+    return;
+  }
+  if (sEvents.clients() >= HTTP_EVENT_CLIENTS) {
+    server.send(503, "text/plain", "Too many event streams");
+    return;
   }
 
-  if (changed) saveConfig();
-  server.send(200, "application/json", String("{\"ok\":true,\"changed\":") + (changed ? "true" : "false") + "}");
+  char accept[29];
+  httpWsAcceptKey(key.c_str(), key.length(), accept);
+  server.sendHeader("Upgrade", "websocket");
+  server.sendHeader("Connection", "Upgrade");
+  server.sendHeader("Sec-WebSocket-Accept", accept);
+  WiFiClient client = server.detachClient();
+  server.send(101, "", "");
+
+  HttpBodySink* sink = new ClientBodySink(client);
+  const int slot = sEvents.subscribe(sink, millis(), HTTP_EVENT_WEBSOCKET);
+  if (slot < 0) {
+    delete sink;
+    return;
+  }
+  sWsReaders[slot].client = client;
+  sWsReaders[slot].rx.clear();
+  sWsReaders[slot].open = true;
+  sEventsResync = true;
+  Serial.printf("[WEB] WebSocket opened (%u/%u)\n", (unsigned)sEvents.clients(), (unsigned)HTTP_EVENT_CLIENTS);
+}
+
+static void closeWebSocket(int slot, uint16_t code) {
+  const uint8_t payload[2] = { (uint8_t)(code >> 8), (uint8_t)code };
+  sEvents.sendFrame(slot, HTTP_WS_CLOSE, payload, sizeof(payload));
+  sEvents.close(slot);
+}
+
+static void handleWebSocketCommand(int slot, const char* msg, size_t len) {
+  char op[12], id[12];
+  long seq = 0;
+  httpJsonFindInt(msg, len, "seq", seq);
+  sWsCommands++;
+
+  char json[160];
+  int n;
+  bool* state;
+  bool* autoOn;
+  if (!httpJsonFindString(msg, len, "op", op, sizeof(op)) || !httpJsonFindString(msg, len, "id", id, sizeof(id))) {
+    n = snprintf(json, sizeof(json), "{\"seq\":%ld,\"ok\":false,\"error\":\"Missing args\"}", seq);
+  } else if (!relayFlags(id, state, autoOn)) {
+    n = snprintf(json, sizeof(json), "{\"seq\":%ld,\"ok\":false,\"error\":\"Unknown id\"}", seq);
+  } else {
+    bool changed = false;
+    const char* reason = nullptr;
+    long autoArg;
+    if (strcmp(op, "toggle") == 0) {
+      changed = toggleRelay(id, reason);
+    } else if (strcmp(op, "mode") == 0 && httpJsonFindInt(msg, len, "auto", autoArg)) {
+      changed = setRelayMode(id, autoArg != 0);
+    } else {
+      n = snprintf(json, sizeof(json), "{\"seq\":%ld,\"ok\":false,\"error\":\"Bad command\"}", seq);
+      sEvents.sendTo(slot, "ack", json, (size_t)n);
+      return;
+    }
+    n = snprintf(json, sizeof(json), "{\"seq\":%ld,\"ok\":true,\"changed\":%s,\"id\":\"%s\",\"state\":%d,\"auto\":%d",
+                 seq, changed ? "true" : "false", id, *state ? 1 : 0, *autoOn ? 1 : 0);
+    if (reason) n += snprintf(json + n, sizeof(json) - n, ",\"reason\":\"%s\"", reason);
+    n += snprintf(json + n, sizeof(json) - n, "}");
+  }
+  sEvents.sendTo(slot, "ack", json, (size_t)n);
+}
+
+// Reads what the WebSocket clients sent; called every loop()
+static void pumpWebSockets() {
+  for (int slot = 0; slot < HTTP_EVENT_CLIENTS; ++slot) {
+    WsReader& r = sWsReaders[slot];
+    if (!r.open) continue;
+    if (!sEvents.active(slot)) {
+      // Closed or dropped by the event stream, which stops the socket
+      r.client = WiFiClient();
+      r.rx.clear();
+      r.open = false;
+      continue;
+    }
+
+    const int avail = r.client.available();
+    if (avail > 0) {
+      size_t granted = 0;
+      char* buf = r.rx.reserve((size_t)avail, granted);
+      if (!buf) {
+        closeWebSocket(slot, HTTP_WS_CLOSE_PROTOCOL);
+        continue;
+      }
+      const int n = r.client.read(reinterpret_cast<uint8_t*>(buf), granted);
+      if (n > 0) r.rx.commit((size_t)n);
+    }
+
+    while (r.rx.size() > 0 && sEvents.active(slot)) {
+      HttpWsFrame frame;
+      const long used = httpWsParseFrame(reinterpret_cast<uint8_t*>(r.rx.data()), r.rx.size(), frame);
+      if (used == 0) break;
+      if (used < 0) {
+        closeWebSocket(slot, HTTP_WS_CLOSE_PROTOCOL);
+        break;
+      }
+      switch (frame.opcode) {
+        case HTTP_WS_TEXT:
+          handleWebSocketCommand(slot, reinterpret_cast<const char*>(frame.payload), frame.len);
+          break;
+        case HTTP_WS_PING:
+          sEvents.sendFrame(slot, HTTP_WS_PONG, frame.payload, frame.len);
+          break;
+        case HTTP_WS_PONG:
+          break;
+        case HTTP_WS_CLOSE:
+          closeWebSocket(slot, HTTP_WS_CLOSE_NORMAL);
+          break;
+        default:
+          closeWebSocket(slot, HTTP_WS_CLOSE_UNSUPPORTED);
+          break;
+      }
+      r.rx.consume((size_t)used);
+    }
+  }
 }
 
 // ================= Wi-Fi configuration page =================
 
-static void appendWifiConfigSection(String& page, const String& storedSsid, const String& storedPass, int networkCount) {
+static void appendWifiConfigSection(PageWriter& page, const String& storedSsid, const String& storedPass, int networkCount) {
   page += "<div class='card'><h2>Current connection</h2>";
-  wl_status_t st = WiFi.status();
-  if (st == WL_CONNECTED) {
-    page += "<div class='sub'>Connected to <b>" + htmlEscape(WiFi.SSID()) + "</b>";
-    page += " · RSSI " + String(WiFi.RSSI()) + " dBm";
-    page += " · IP " + htmlEscape(WiFi.localIP().toString()) + "</div>";
+  if (WiFi.status() == WL_CONNECTED) {
+    htmlWrite(page,
+      "<div class='sub'>Connected to <b>", htmlEsc(WiFi.SSID()), "</b>"
+      " · RSSI ", WiFi.RSSI(), " dBm"
+      " · IP ", htmlEsc(WiFi.localIP().toString()), "</div>");
   } else {
     page += "<div class='sub'>Not connected.</div>";
   }
   page += "</div>";
 
-  page += "<div class='card'><h2>Configure Wi-Fi</h2>";
-  page += "<div class='sub'>After saving, the device will reboot and try to connect.</div>";
-  page += "<form method='POST' action='/wifi'>";
-  page += "<div class='form-grid' style='margin-top:12px'>";
-  page += "<div class='field'><label>SSID</label>";
-  page += "<input type='text' id='ssid' name='ssid' value='" + htmlEscape(storedSsid) + "'></div>";
-  page += "<div class='field'><label>Password</label>";
-  page += "<input type='password' name='pass' value='" + htmlEscape(storedPass) + "'></div>";
-  page += "</div>";
-  page += "<p class='small'>Password is stored in ESP32 NVS (not encrypted).</p>";
-  page += "<div class='row'><button class='btn primary' type='submit'>Save &amp; Reboot</button></div>";
-  page += "</form></div>";
-
-  page += "<div class='card'><h2>Available networks</h2>";
-  page += "<div class='row' style='justify-content:space-between'>";
-  page += "<div class='sub'>Click a row to copy the SSID into the form.</div>";
-  page += "<input id='ssidFilter' placeholder='Filter SSIDs…' style='max-width:280px'>";
-  page += "</div>";
+  htmlWrite(page,
+    "<div class='card'><h2>Configure Wi-Fi</h2>"
+    "<div class='sub'>After saving, the device will reboot and try to connect.</div>"
+    "<form method='POST' action='/wifi'>"
+    "<div class='form-grid' style='margin-top:12px'>"
+    "<div class='field'><label>SSID</label>"
+    "<input type='text' id='ssid' name='ssid' value='", htmlEsc(storedSsid), "'></div>"
+    "<div class='field'><label>Password</label>"
+    "<input type='password' name='pass' value='", htmlEsc(storedPass), "'></div>"
+    "</div>"
+    "<p class='small'>Password is stored in ESP32 NVS (not encrypted).</p>"
+    "<div class='row'><button class='btn primary' type='submit'>Save &amp; Reboot</button></div>"
+    "</form></div>");
+
+  page += "<div class='card'><h2>Available networks</h2>"
+          "<div class='row' style='justify-content:space-between'>"
+          "<div class='sub'>Click a row to copy the SSID into the form.</div>"
+          "<input id='ssidFilter' placeholder='Filter SSIDs…' style='max-width:280px'>"
+          "</div>";
 
   if (networkCount <= 0) {
     page += "<p class='small'>No networks found.</p>";
   } else {
-    page += "<table class='table' style='margin-top:12px'>";
-    page += "<tr><th>SSID</th><th>RSSI</th><th>Encryption</th></tr>";
+    page += "<table class='table' style='margin-top:12px'>"
+            "<tr><th>SSID</th><th>RSSI</th><th>Encryption</th></tr>";
     for (int i = 0; i < networkCount; ++i) {
-      String ssid = WiFi.SSID(i);
-      int32_t rssi = WiFi.RSSI(i);
-      wifi_auth_mode_t enc = WiFi.encryptionType(i);
-
-      page += "<tr class='ssid-row' data-ssid='";
-      page += htmlEscape(ssid);
-      page += "'><td>";
-      page += htmlEscape(ssid);
-      page += "</td><td>";
-      page += String(rssi);
-      page += " dBm</td><td>";
-      page += (enc == WIFI_AUTH_OPEN) ? "open" : "secured";
-      page += "</td></tr>";
+      const String ssid = WiFi.SSID(i);
+      htmlWrite(page,
+        "<tr class='ssid-row' data-ssid='", htmlEsc(ssid), "'>"
+        "<td>", htmlEsc(ssid), "</td>"
+        "<td>", WiFi.RSSI(i), " dBm</td>"
+        "<td>", htmlIf(WiFi.encryptionType(i) == WIFI_AUTH_OPEN, "open", "secured"), "</td></tr>");
     }
     page += "</table>";
   }
   page += "</div>";
 }
 
-static void handleWifiConfigGet() {
-  if (!requireAuth()) return;
-
+// Scans for networks (blocks for a few seconds) only after everything above
+// the Wi-Fi section has been sent.
+static void appendWifiConfigSection(PageWriter& page) {
   String storedSsid, storedPass;
   loadWifiCredentials(storedSsid, storedPass, false);
 
+  page.flush();
   int n = WiFi.scanNetworks();
+  appendWifiConfigSection(page, storedSsid, storedPass, n);
+  WiFi.scanDelete();
+}
 
-  String page;
-  page.reserve(12000);
+static void handleWifiConfigGet() {
+  if (!requireAuth()) return;
 
+  PageWriter page;
   beginPage(page, "Wi-Fi", "wifi", false);
-  appendWifiConfigSection(page, storedSsid, storedPass, n);
-
+  appendWifiConfigSection(page);
   endPage(page);
-
-  server.send(200, "text/html", page);
-  WiFi.scanDelete();
 }
 
 static void handleWifiConfigPost() {
@@ -715,18 +2542,16 @@ static void handleWifiConfigPost() {
 
   saveWifiCredentials(ssid, pass);
 
-  String page;
-  page.reserve(1600);
-
+  PageWriter page;
   beginPage(page, "Wi-Fi Saved", "wifi", false);
-  page += "<div class='card'><h2>Wi-Fi configuration saved</h2>";
-  page += "<p class='sub'>SSID: <b>" + htmlEscape(ssid) + "</b></p>";
-  page += "<p class='sub'>Rebooting now and attempting to connect…</p>";
-  page += "</div>";
+  htmlWrite(page,
+    "<div class='card'><h2>Wi-Fi configuration saved</h2>"
+    "<p class='sub'>SSID: <b>", htmlEsc(ssid), "</b></p>"
+    "<p class='sub'>Rebooting now and attempting to connect…</p>"
+    "</div>");
   endPage(page);
 
-  server.send(200, "text/html", page);
-
+  flushPersistence();
   delay(500);
   ESP.restart();
 }
@@ -736,143 +2561,121 @@ static void handleWifiConfigPost() {
 static void handleRoot() {
   if (!requireAuth()) return;
 
-  String page;
-  page.reserve(9000);
-
+  PageWriter page;
   beginPage(page, "EZgrow Dashboard", "dashboard", true);
 
-  page += "<div class='grid grid-tiles'>";
-  page += "<div class='tile'><div class='tile-label'>Temperature</div>"
-          "<div class='tile-value'><span id='v-temp'>—</span><span class='tile-unit'>°C</span></div>"
-          "<div class='tile-label'>Air</div><canvas class='sparkline' id='spark-temp' height='38'></canvas></div>";
-
-  page += "<div class='tile'><div class='tile-label'>Humidity</div>"
-          "<div class='tile-value'><span id='v-hum'>—</span><span class='tile-unit'>%</span></div>"
-          "<div class='tile-label'>Air</div><canvas class='sparkline' id='spark-hum' height='38'></canvas></div>";
-
-  page += "<div class='tile'><div class='tile-label'>Soil · <span id='lbl-s1'>" + htmlEscape(gConfig.chamber1.name) + "</span></div>"
-          "<div class='tile-value'><span id='v-s1'>—</span><span class='tile-unit'>%</span></div>"
-          "<div class='tile-label'>Moisture</div><canvas class='sparkline' id='spark-s1' height='38'></canvas></div>";
-
-  page += "<div class='tile'><div class='tile-label'>Soil · <span id='lbl-s2'>" + htmlEscape(gConfig.chamber2.name) + "</span></div>"
-          "<div class='tile-value'><span id='v-s2'>—</span><span class='tile-unit'>%</span></div>"
-          "<div class='tile-label'>Moisture</div><canvas class='sparkline' id='spark-s2' height='38'></canvas></div>";
-  page += "</div>";
-
-  page += "<div class='card' style='margin-top:14px'>";
-  page += "<h2>Controls</h2>";
-  page += "<div class='controls'>";
-
-  auto control = [&](const char* id, const char* label, const String& chamberName, bool isAuto, bool isOn, const String& schedule, const char* profileTarget = nullptr) {
-    page += "<div class='card' style='box-shadow:none'>";
-    page += "<div class='control-head'>";
-    page += "<div><div class='control-title'>" + String(label);
-    if (chamberName.length()) {
-      page += " · <span id='ctl-";
-      page += id;
-      page += "-name'>";
-      page += htmlEscape(chamberName);
-      page += "</span>";
+  htmlWrite(page,
+    "<div class='grid grid-tiles'>"
+    "<div class='tile'><div class='tile-label'>Temperature</div>"
+    "<div class='tile-value'><span id='v-temp'>—</span><span class='tile-unit'>°C</span></div>"
+    "<div class='tile-label'>Air</div><canvas class='sparkline' id='spark-temp' height='38'></canvas></div>"
+
+    "<div class='tile'><div class='tile-label'>Humidity</div>"
+    "<div class='tile-value'><span id='v-hum'>—</span><span class='tile-unit'>%</span></div>"
+    "<div class='tile-label'>Air</div><canvas class='sparkline' id='spark-hum' height='38'></canvas></div>"
+
+    "<div class='tile'><div class='tile-label'>Soil · <span id='lbl-s1'>", htmlEsc(gConfig.chamber1.name), "</span></div>"
+    "<div class='tile-value'><span id='v-s1'>—</span><span class='tile-unit'>%</span></div>"
+    "<div class='tile-label'>Moisture</div><canvas class='sparkline' id='spark-s1' height='38'></canvas></div>"
+
+    "<div class='tile'><div class='tile-label'>Soil · <span id='lbl-s2'>", htmlEsc(gConfig.chamber2.name), "</span></div>"
+    "<div class='tile-value'><span id='v-s2'>—</span><span class='tile-unit'>%</span></div>"
+    "<div class='tile-label'>Moisture</div><canvas class='sparkline' id='spark-s2' height='38'></canvas></div>"
+    "</div>"
+
+    "<div class='card' style='margin-top:14px'>"
+    "<h2>Controls</h2>"
+    "<div class='controls'>");
+
+  // schedule: light on/off times, or nullptr with scheduleText
+  auto control = [&](const char* id, const char* label, const char* chamberName, bool isAuto, bool isOn,
+                     const LightSchedule* schedule, const char* scheduleText, const char* profileTarget = nullptr) {
+    htmlWrite(page,
+      "<div class='card' style='box-shadow:none'>"
+      "<div class='control-head'>"
+      "<div><div class='control-title'>", label);
+    if (chamberName && *chamberName) {
+      htmlWrite(page, " · <span id='ctl-", id, "-name'>", htmlEsc(chamberName), "</span>");
     }
-    page += "</div>";
-    page += "<div class='sub'>Mode <span class='badge ";
-    page += (isAuto ? "auto" : "man");
-    page += "' id='m-"; page += id; page += "'>";
-    page += htmlAuto(isAuto);
-    page += "</span></div></div>";
-
-    page += "<span class='badge ";
-    page += (isOn ? "on" : "off");
-    page += "' id='b-"; page += id; page += "'>";
-    page += htmlBool(isOn);
-    page += "</span>";
-    page += "</div>";
-
-    page += "<div class='row control-actions'>";
-    page += "<div class='segmented' role='group' aria-label='Mode'>";
-    page += "<button type='button' class='seg-btn";
-    if (isAuto) page += " active";
-    page += "' id='seg-"; page += id; page += "-auto' data-mode='auto'>AUTO</button>";
-    page += "<button type='button' class='seg-btn";
-    if (!isAuto) page += " active";
-    page += "' id='seg-"; page += id; page += "-man' data-mode='man'>MAN</button>";
-    page += "</div>";
-
-    page += "<button type='button' class='btn' id='tog-"; page += id; page += "'";
-    if (isAuto) page += " disabled";
-    page += ">";
-    page += isOn ? "Turn OFF" : "Turn ON";
-    page += "</button>";
-
-    page += "<span class='meta' id='sched-"; page += id; page += "'>";
-    page += htmlEscape(schedule);
-    page += "</span>";
-
-    page += "</div>";
+    htmlWrite(page,
+      "</div>"
+      "<div class='sub'>Mode <span class='badge ", htmlIf(isAuto, "auto", "man"), "' id='m-", id, "'>",
+      htmlAuto(isAuto), "</span></div></div>"
+      "<span class='badge ", htmlIf(isOn, "on", "off"), "' id='b-", id, "'>", htmlBool(isOn), "</span>"
+      "</div>"
+
+      "<div class='row control-actions'>"
+      "<div class='segmented' role='group' aria-label='Mode'>"
+      "<button type='button' class='seg-btn", htmlIf(isAuto, " active"), "' id='seg-", id, "-auto' data-mode='auto'>AUTO</button>"
+      "<button type='button' class='seg-btn", htmlIf(!isAuto, " active"), "' id='seg-", id, "-man' data-mode='man'>MAN</button>"
+      "</div>"
+
+      "<button type='button' class='btn' id='tog-", id, "'", htmlIf(isAuto, " disabled"), ">",
+      htmlIf(isOn, "Turn OFF", "Turn ON"), "</button>"
+
+      "<span class='meta' id='sched-", id, "'>");
+    if (schedule) {
+      htmlWrite(page, htmlTime(schedule->onMinutes), "–", htmlTime(schedule->offMinutes));
+    } else {
+      page += scheduleText;
+    }
+    page += "</span></div>";
     if (profileTarget) {
-      page += "<div class='meta profile-label' id='profile-";
-      page += profileTarget;
-      page += "'>Profile: —</div>";
+      htmlWrite(page, "<div class='meta profile-label' id='profile-", profileTarget, "'>Profile: —</div>");
     }
     page += "</div>";
   };
 
-  control("light1", "Light 1", gConfig.chamber1.name, gConfig.light1.enabled, gRelays.light1,
-          minutesToTimeStrSafe(gConfig.light1.onMinutes) + "–" + minutesToTimeStrSafe(gConfig.light1.offMinutes), "ch1");
-  control("light2", "Light 2", gConfig.chamber2.name, gConfig.light2.enabled, gRelays.light2,
-          minutesToTimeStrSafe(gConfig.light2.onMinutes) + "–" + minutesToTimeStrSafe(gConfig.light2.offMinutes), "ch2");
-  control("fan", "Fan", "", gConfig.autoFan, gRelays.fan, "threshold-based");
-  control("pump", "Pump", "", gConfig.autoPump, gRelays.pump, "soil-based");
-
-  page += "</div>"; // controls
-
-  page += "<p class='small' style='margin-top:12px'>Fan: ON ≥ ";
-  page += String(gConfig.env.fanOnTemp, 1);
-  page += " °C or ≥ ";
-  page += String(gConfig.env.fanHumOn);
-  page += "% RH · OFF when ≤ ";
-  page += String(gConfig.env.fanOffTemp, 1);
-  page += " °C and ≤ ";
-  page += String(gConfig.env.fanHumOff);
-  page += "% RH. Pump: ";
-  page += htmlEscape(gConfig.chamber1.name);
-  page += " dry &lt; ";
-  page += String(gConfig.chamber1.soilDryThreshold);
-  page += "%, wet &gt; ";
-  page += String(gConfig.chamber1.soilWetThreshold);
-  page += "% · ";
-  page += htmlEscape(gConfig.chamber2.name);
-  page += " dry &lt; ";
-  page += String(gConfig.chamber2.soilDryThreshold);
-  page += "%, wet &gt; ";
-  page += String(gConfig.chamber2.soilWetThreshold);
-  page += "%.</p>";
-
-  page += "</div>"; // card
-
-  page += "<div class='card' style='margin-top:14px'>";
-  page += "<h2>History</h2>";
-  page += "<div class='sub'>Temperature/humidity and soil moisture logged every 10 minutes (retained for 7 days).</div>";
-  page += "<div class='field' style='max-width:220px;margin-top:12px'>";
-  page += "<label for='historyRange'>Show range</label>";
-  page += "<select id='historyRange'>";
-  page += "<option value='1'>Last 24 hours</option>";
-  page += "<option value='2'>Last 2 days</option>";
-  page += "<option value='3'>Last 3 days</option>";
-  page += "<option value='4'>Last 4 days</option>";
-  page += "<option value='5'>Last 5 days</option>";
-  page += "<option value='6'>Last 6 days</option>";
-  page += "<option value='7'>Last 7 days</option>";
-  page += "</select>";
-  page += "<div class='small'>Selection is saved per browser.</div>";
-  page += "</div>";
-  page += "<div style='margin-top:12px'><canvas id='tempHumChart' height='150'></canvas></div>";
-  page += "<div style='margin-top:14px'><canvas id='soilChart' height='120'></canvas></div>";
-  page += "<!-- Light history chart removed -->";
-  page += "</div>";
+  control("light1", "Light 1", gConfig.chamber1.name.c_str(), gConfig.light1.enabled, gRelays.light1,
+          &gConfig.light1, nullptr, "ch1");
+  control("light2", "Light 2", gConfig.chamber2.name.c_str(), gConfig.light2.enabled, gRelays.light2,
+          &gConfig.light2, nullptr, "ch2");
+  control("fan", "Fan", nullptr, gConfig.autoFan, gRelays.fan, nullptr, "threshold-based");
+  control("pump", "Pump", nullptr, gConfig.autoPump, gRelays.pump, nullptr, "soil-based");
+
+  htmlWrite(page,
+    "</div>" // controls
+
+    "<p class='small' style='margin-top:12px'>Fan: ON ≥ ", htmlFixed(gConfig.env.fanOnTemp, 1),
+    " °C or ≥ ", gConfig.env.fanHumOn,
+    "% RH · OFF when ≤ ", htmlFixed(gConfig.env.fanOffTemp, 1),
+    " °C and ≤ ", gConfig.env.fanHumOff,
+    "% RH. Pump: ", htmlEsc(gConfig.chamber1.name),
+    " dry &lt; ", gConfig.chamber1.soilDryThreshold,
+    "%, wet &gt; ", gConfig.chamber1.soilWetThreshold,
+    "% · ", htmlEsc(gConfig.chamber2.name),
+    " dry &lt; ", gConfig.chamber2.soilDryThreshold,
+    "%, wet &gt; ", gConfig.chamber2.soilWetThreshold,
+    "%.</p>"
+
+    "</div>"); // card
+
+  page += "<div class='card' style='margin-top:14px'>"
+          "<h2>History</h2>"
+          "<div class='sub'>Temperature/humidity and soil moisture logged every minute (kept 24 hours), rolled up to 10 minutes (36 days) and hourly min/avg/max (365 days).</div>"
+          "<div class='field' style='max-width:220px;margin-top:12px'>"
+          "<label for='historyRange'>Show range</label>"
+          "<select id='historyRange'>"
+          "<option value='1'>Last 24 hours</option>"
+          "<option value='2'>Last 2 days</option>"
+          "<option value='3'>Last 3 days</option>"
+          "<option value='4'>Last 4 days</option>"
+          "<option value='5'>Last 5 days</option>"
+          "<option value='6'>Last 6 days</option>"
+          "<option value='7'>Last 7 days</option>"
+          "<option value='14'>Last 14 days</option>"
+          "<option value='30'>Last 30 days</option>"
+          "<option value='90'>Last 90 days</option>"
+          "<option value='365'>Last year</option>"
+          "</select>"
+          "<div class='small'>Selection is saved per browser.</div>"
+          "</div>"
+          "<div style='margin-top:12px'><canvas id='tempHumChart' height='150'></canvas></div>"
+          "<div style='margin-top:14px'><canvas id='soilChart' height='120'></canvas></div>"
+          "<!-- Light history chart removed -->"
+          "</div>";
 
   endPage(page);
-  server.send(200, "text/html", page);
 }
 
 // ================= Relay toggle & mode (legacy endpoints kept) =================
@@ -937,36 +2740,47 @@ static void handleMode() {
 static void handleConfigGet() {
   if (!requireAuth()) return;
 
-  String storedSsid, storedPass;
-  loadWifiCredentials(storedSsid, storedPass, false);
-  int wifiNetworks = WiFi.scanNetworks();
-
-  String page;
-  page.reserve(12000);
-
+  PageWriter page;
   beginPage(page, "EZgrow Config", "config", false);
 
-  page += "<div class='card'><h2>Configuration</h2>";
-  page += "<div class='sub'>Settings are saved to NVS and applied immediately.</div>";
+  // <div class='field'><label>…</label><input … value='…'>[hint]</div>
+  auto inputField = [&](const char* label, const char* inputAttrs, const HtmlEscaped& value, const char* hint = nullptr) {
+    htmlWrite(page, "<div class='field'><label>", label, "</label><input ", inputAttrs, " value='", value, "'>");
+    if (hint) htmlWrite(page, "<div class='small'>", hint, "</div>");
+    page += "</div>";
+  };
+  auto numberField = [&](const char* label, const char* inputAttrs, int value, const char* hint = nullptr) {
+    htmlWrite(page, "<div class='field'><label>", label, "</label><input ", inputAttrs, " value='", value, "'>");
+    if (hint) htmlWrite(page, "<div class='small'>", hint, "</div>");
+    page += "</div>";
+  };
+  auto decimalField = [&](const char* label, const char* inputAttrs, float value, const char* hint = nullptr) {
+    htmlWrite(page, "<div class='field'><label>", label, "</label><input ", inputAttrs, " value='", htmlFixed(value, 1), "'>");
+    if (hint) htmlWrite(page, "<div class='small'>", hint, "</div>");
+    page += "</div>";
+  };
+  auto timeField = [&](const char* label, const char* inputAttrs, int minutes) {
+    htmlWrite(page, "<div class='field'><label>", label, "</label><input ", inputAttrs, " value='", htmlTime(minutes), "'></div>");
+  };
 
-  String appliedBanner = server.hasArg("appliedProfile") ? server.arg("appliedProfile") : "";
-  page += "<div id='appliedProfileBanner' class='pill' data-label='" + htmlEscape(appliedBanner) + "' style='margin-top:10px";
-  if (!appliedBanner.length()) page += ";display:none";
-  page += "'>";
-  if (appliedBanner.length()) {
-    page += "Applied profile: " + htmlEscape(appliedBanner);
-  }
+  const String appliedBanner = server.hasArg("appliedProfile") ? server.arg("appliedProfile") : "";
+  htmlWrite(page,
+    "<div class='card'><h2>Configuration</h2>"
+    "<div class='sub'>Settings are saved to NVS and applied immediately.</div>"
+    "<div id='appliedProfileBanner' class='pill' data-label='", htmlEsc(appliedBanner), "' style='margin-top:10px",
+    htmlIf(!appliedBanner.length(), ";display:none"), "'>");
+  if (appliedBanner.length()) htmlWrite(page, "Applied profile: ", htmlEsc(appliedBanner));
   page += "</div>";
 
-  page += "<div class='tabs' data-tabs='config' data-persist='ezgrow_config_tab' style='margin-top:12px'>";
-  page += "<button type='button' class='tab' data-tab='env'>Environment</button>";
-  page += "<button type='button' class='tab' data-tab='lights'>Lights</button>";
-  page += "<button type='button' class='tab' data-tab='waterair'>Water &amp; Air</button>";
-  page += "<button type='button' class='tab' data-tab='profile'>Grow profile</button>";
-  page += "<button type='button' class='tab' data-tab='wifi'>Wi-Fi</button>";
-  page += "<button type='button' class='tab' data-tab='system'>System</button>";
-  page += "<button type='button' class='tab' data-tab='security'>Security</button>";
-  page += "</div>";
+  page += "<div class='tabs' data-tabs='config' data-persist='ezgrow_config_tab' style='margin-top:12px'>"
+          "<button type='button' class='tab' data-tab='env'>Environment</button>"
+          "<button type='button' class='tab' data-tab='lights'>Lights</button>"
+          "<button type='button' class='tab' data-tab='waterair'>Water &amp; Air</button>"
+          "<button type='button' class='tab' data-tab='profile'>Grow profile</button>"
+          "<button type='button' class='tab' data-tab='wifi'>Wi-Fi</button>"
+          "<button type='button' class='tab' data-tab='system'>System</button>"
+          "<button type='button' class='tab' data-tab='security'>Security</button>"
+          "</div>";
 
   page += "<div class='tab-panels'>";
 
@@ -975,55 +2789,48 @@ static void handleConfigGet() {
   // ENV
   page += "<div class='tab-panel' data-tab='env'>";
   page += "<div class='form-grid'>";
-  page += "<div class='field'><label>Chamber 1 name</label>"
-          "<input type='text' maxlength='24' name='c1Name' value='" + htmlEscape(gConfig.chamber1.name) + "'><div class='small'>1–24 characters, HTML is stripped automatically.</div></div>";
-  page += "<div class='field'><label>Chamber 2 name</label>"
-          "<input type='text' maxlength='24' name='c2Name' value='" + htmlEscape(gConfig.chamber2.name) + "'><div class='small'>1–24 characters, HTML is stripped automatically.</div></div>";
-  page += "<div class='field'><label>Chamber 1 DRY threshold (%)</label>"
-          "<input type='number' step='1' name='c1SoilDry' value='" + String(gConfig.chamber1.soilDryThreshold) + "'><div class='small'>Uses soil sensor 1; pump is shared across chambers.</div></div>";
-  page += "<div class='field'><label>Chamber 1 WET threshold (%)</label>"
-          "<input type='number' step='1' name='c1SoilWet' value='" + String(gConfig.chamber1.soilWetThreshold) + "'><div class='small'>Keep wet > dry for stable pump automation.</div></div>";
-  page += "<div class='field'><label>Chamber 2 DRY threshold (%)</label>"
-          "<input type='number' step='1' name='c2SoilDry' value='" + String(gConfig.chamber2.soilDryThreshold) + "'><div class='small'>Uses soil sensor 2; shared pump serves both chambers.</div></div>";
-  page += "<div class='field'><label>Chamber 2 WET threshold (%)</label>"
-          "<input type='number' step='1' name='c2SoilWet' value='" + String(gConfig.chamber2.soilWetThreshold) + "'><div class='small'>Keep wet > dry for stable pump automation.</div></div>";
-  page += "<div class='field'><label>Chamber 1 profile ID (optional)</label>"
-          "<input type='number' step='1' name='c1Prof' value='" + String(gConfig.chamber1.profileId) + "'></div>";
-  page += "<div class='field'><label>Chamber 2 profile ID (optional)</label>"
-          "<input type='number' step='1' name='c2Prof' value='" + String(gConfig.chamber2.profileId) + "'></div>";
-  page += "<div class='field'><label>Temperature chart min (°C)</label>"
-          "<input type='number' step='0.1' name='chartTempMin' value='" + String(gConfig.charts.tempMinC, 1) + "'><div class='small'>Dashboard temperature history Y-axis minimum.</div></div>";
-  page += "<div class='field'><label>Temperature chart max (°C)</label>"
-          "<input type='number' step='0.1' name='chartTempMax' value='" + String(gConfig.charts.tempMaxC, 1) + "'><div class='small'>Dashboard temperature history Y-axis maximum.</div></div>";
-  page += "<div class='field'><label>Humidity chart min (%RH)</label>"
-          "<input type='number' step='1' name='chartHumMin' value='" + String(gConfig.charts.humMinPct) + "'><div class='small'>Dashboard humidity history Y-axis minimum.</div></div>";
-  page += "<div class='field'><label>Humidity chart max (%RH)</label>"
-          "<input type='number' step='1' name='chartHumMax' value='" + String(gConfig.charts.humMaxPct) + "'><div class='small'>Dashboard humidity history Y-axis maximum.</div></div>";
+  inputField("Chamber 1 name", "type='text' maxlength='24' name='c1Name'", htmlEsc(gConfig.chamber1.name),
+             "1–24 characters, HTML is stripped automatically.");
+  inputField("Chamber 2 name", "type='text' maxlength='24' name='c2Name'", htmlEsc(gConfig.chamber2.name),
+             "1–24 characters, HTML is stripped automatically.");
+  numberField("Chamber 1 DRY threshold (%)", "type='number' step='1' name='c1SoilDry'", gConfig.chamber1.soilDryThreshold,
+              "Uses soil sensor 1; pump is shared across chambers.");
+  numberField("Chamber 1 WET threshold (%)", "type='number' step='1' name='c1SoilWet'", gConfig.chamber1.soilWetThreshold,
+              "Keep wet > dry for stable pump automation.");
+  numberField("Chamber 2 DRY threshold (%)", "type='number' step='1' name='c2SoilDry'", gConfig.chamber2.soilDryThreshold,
+              "Uses soil sensor 2; shared pump serves both chambers.");
+  numberField("Chamber 2 WET threshold (%)", "type='number' step='1' name='c2SoilWet'", gConfig.chamber2.soilWetThreshold,
+              "Keep wet > dry for stable pump automation.");
+  numberField("Chamber 1 profile ID (optional)", "type='number' step='1' name='c1Prof'", gConfig.chamber1.profileId);
+  numberField("Chamber 2 profile ID (optional)", "type='number' step='1' name='c2Prof'", gConfig.chamber2.profileId);
+  decimalField("Temperature chart min (°C)", "type='number' step='0.1' name='chartTempMin'", gConfig.charts.tempMinC,
+               "Dashboard temperature history Y-axis minimum.");
+  decimalField("Temperature chart max (°C)", "type='number' step='0.1' name='chartTempMax'", gConfig.charts.tempMaxC,
+               "Dashboard temperature history Y-axis maximum.");
+  numberField("Humidity chart min (%RH)", "type='number' step='1' name='chartHumMin'", gConfig.charts.humMinPct,
+              "Dashboard humidity history Y-axis minimum.");
+  numberField("Humidity chart max (%RH)", "type='number' step='1' name='chartHumMax'", gConfig.charts.humMaxPct,
+              "Dashboard humidity history Y-axis maximum.");
   page += "</div>";
   page += "<p class='small' style='margin-top:10px'>Tip: keep hysteresis sane (OFF < ON) to avoid oscillation. Names are limited to 24 characters with HTML stripped. Wet thresholds must stay above dry thresholds per chamber while using the shared pump.</p>";
   page += "</div>";
 
   // LIGHTS
-  page += "<div class='tab-panel' data-tab='lights'>";
-  page += "<div class='form-grid'>";
-  page += "<div class='field'><label><input type='checkbox' name='l1Auto' value='1'";
-  if (gConfig.light1.enabled) page += " checked";
-  page += "> Use schedule for Light 1</label>";
-  page += "<div class='small'>AUTO uses schedule; MAN allows dashboard toggling.</div></div>";
-
-  page += "<div class='field'><label><input type='checkbox' name='l2Auto' value='1'";
-  if (gConfig.light2.enabled) page += " checked";
-  page += "> Use schedule for Light 2</label>";
-  page += "<div class='small'>Schedules can cross midnight; offsets use the device timezone.</div></div>";
-
-  page += "<div class='field'><label>Light 1 ON</label>"
-          "<input type='time' name='l1On' value='" + minutesToTimeStrSafe(gConfig.light1.onMinutes) + "'></div>";
-  page += "<div class='field'><label>Light 1 OFF</label>"
-          "<input type='time' name='l1Off' value='" + minutesToTimeStrSafe(gConfig.light1.offMinutes) + "'></div>";
-  page += "<div class='field'><label>Light 2 ON</label>"
-          "<input type='time' name='l2On' value='" + minutesToTimeStrSafe(gConfig.light2.onMinutes) + "'></div>";
-  page += "<div class='field'><label>Light 2 OFF</label>"
-          "<input type='time' name='l2Off' value='" + minutesToTimeStrSafe(gConfig.light2.offMinutes) + "'></div>";
+  htmlWrite(page,
+    "<div class='tab-panel' data-tab='lights'>"
+    "<div class='form-grid'>"
+    "<div class='field'><label><input type='checkbox' name='l1Auto' value='1'", htmlIf(gConfig.light1.enabled, " checked"),
+    "> Use schedule for Light 1</label>"
+    "<div class='small'>AUTO uses schedule; MAN allows dashboard toggling.</div></div>"
+
+    "<div class='field'><label><input type='checkbox' name='l2Auto' value='1'", htmlIf(gConfig.light2.enabled, " checked"),
+    "> Use schedule for Light 2</label>"
+    "<div class='small'>Schedules can cross midnight; offsets use the device timezone.</div></div>");
+
+  timeField("Light 1 ON", "type='time' name='l1On'", gConfig.light1.onMinutes);
+  timeField("Light 1 OFF", "type='time' name='l1Off'", gConfig.light1.offMinutes);
+  timeField("Light 2 ON", "type='time' name='l2On'", gConfig.light2.onMinutes);
+  timeField("Light 2 OFF", "type='time' name='l2Off'", gConfig.light2.offMinutes);
   page += "</div>";
   page += "</div>";
 
@@ -1031,214 +2838,220 @@ static void handleConfigGet() {
   page += "<div class='tab-panel' data-tab='waterair'>";
   page += "<div class='sub'>Pump and fan thresholds, automation toggles, and safety timing for shared hardware.</div>";
   page += "<div class='form-grid'>";
-  page += "<div class='field'><label>Fan ON temperature (°C)</label>"
-          "<input type='number' step='0.1' name='fanOn' value='" + String(gConfig.env.fanOnTemp, 1) + "'></div>";
-  page += "<div class='field'><label>Fan OFF temperature (°C)</label>"
-          "<input type='number' step='0.1' name='fanOff' value='" + String(gConfig.env.fanOffTemp, 1) + "'></div>";
-  page += "<div class='field'><label>Fan ON humidity (%RH)</label>"
-          "<input type='number' step='1' name='fanHumOn' value='" + String(gConfig.env.fanHumOn) + "'></div>";
-  page += "<div class='field'><label>Fan OFF humidity (%RH)</label>"
-          "<input type='number' step='1' name='fanHumOff' value='" + String(gConfig.env.fanHumOff) + "'></div>";
-  page += "<div class='field'><label>Pump minimum OFF time (seconds)</label>"
-          "<input type='number' step='1' name='pumpOff' value='" + String(gConfig.env.pumpMinOffSec) + "'><div class='small'>Controls dry-to-wet pump hysteresis along with presets.</div></div>";
-  page += "<div class='field'><label>Pump maximum ON time (seconds)</label>"
-          "<input type='number' step='1' name='pumpOn' value='" + String(gConfig.env.pumpMaxOnSec) + "'><div class='small'>Safety cutoff for the shared pump.</div></div>";
-  page += "<div class='field'><label><input type='checkbox' name='autoFan' value='1'";
-  if (gConfig.autoFan) page += " checked";
-  page += "> Automatic fan control</label><div class='small'>Uses temperature/humidity thresholds.</div></div>";
-  page += "<div class='field'><label><input type='checkbox' name='autoPump' value='1'";
-  if (gConfig.autoPump) page += " checked";
-  page += "> Automatic pump control</label><div class='small'>Uses soil thresholds + min OFF / max ON timing.</div></div>";
-  page += "</div>";
-  page += "</div>";
+  decimalField("Fan ON temperature (°C)", "type='number' step='0.1' name='fanOn'", gConfig.env.fanOnTemp);
+  decimalField("Fan OFF temperature (°C)", "type='number' step='0.1' name='fanOff'", gConfig.env.fanOffTemp);
+  numberField("Fan ON humidity (%RH)", "type='number' step='1' name='fanHumOn'", gConfig.env.fanHumOn);
+  numberField("Fan OFF humidity (%RH)", "type='number' step='1' name='fanHumOff'", gConfig.env.fanHumOff);
+  numberField("Pump minimum OFF time (seconds)", "type='number' step='1' name='pumpOff'", gConfig.env.pumpMinOffSec,
+              "Controls dry-to-wet pump hysteresis along with presets.");
+  numberField("Pump maximum ON time (seconds)", "type='number' step='1' name='pumpOn'", gConfig.env.pumpMaxOnSec,
+              "Safety cutoff for the shared pump.");
+  htmlWrite(page,
+    "<div class='field'><label><input type='checkbox' name='autoFan' value='1'", htmlIf(gConfig.autoFan, " checked"),
+    "> Automatic fan control</label><div class='small'>Uses temperature/humidity thresholds.</div></div>"
+    "<div class='field'><label><input type='checkbox' name='autoPump' value='1'", htmlIf(gConfig.autoPump, " checked"),
+    "> Automatic pump control</label><div class='small'>Uses soil thresholds + min OFF / max ON timing.</div></div>"
+    "</div>"
+    "</div>");
 
   // GROW PROFILE
   page += "<div class='tab-panel' data-tab='profile'>";
   page += "<div class='sub'>Grow profiles are presets for soil thresholds, light schedule and automation (fan/pump). Applying a preset updates the configuration and enables AUTO modes where defined.</div>";
 
-  auto profileOptions = [](int selectedId) -> String {
-    auto profileDataAttrs = [](const GrowProfileInfo* info) -> String {
-      if (!info) return String("");
-
-      String attrs;
-      attrs.reserve(180);
-
-      attrs += " data-label='" + htmlEscape(info->label) + "'";
-
-      attrs += " data-c1-dry='" + String(info->chamber1.soilDryThreshold) + "'";
-      attrs += " data-c1-wet='" + String(info->chamber1.soilWetThreshold) + "'";
-      attrs += " data-c2-dry='" + String(info->chamber2.soilDryThreshold) + "'";
-      attrs += " data-c2-wet='" + String(info->chamber2.soilWetThreshold) + "'";
-
-      attrs += " data-l1-on='" + minutesToTimeStrSafe(info->light1.onMinutes) + "'";
-      attrs += " data-l1-off='" + minutesToTimeStrSafe(info->light1.offMinutes) + "'";
-      attrs += " data-l1-auto='" + String(info->light1.enabled ? 1 : 0) + "'";
-      attrs += " data-l2-on='" + minutesToTimeStrSafe(info->light2.onMinutes) + "'";
-      attrs += " data-l2-off='" + minutesToTimeStrSafe(info->light2.offMinutes) + "'";
-      attrs += " data-l2-auto='" + String(info->light2.enabled ? 1 : 0) + "'";
-
-      attrs += " data-auto-fan='" + String(info->autoFan ? 1 : 0) + "'";
-      attrs += " data-auto-pump='" + String(info->autoPump ? 1 : 0) + "'";
-      attrs += " data-set-auto-fan='" + String(info->setsAutoFan ? 1 : 0) + "'";
-      attrs += " data-set-auto-pump='" + String(info->setsAutoPump ? 1 : 0) + "'";
-
-      return attrs;
-    };
-
-    String opts;
-    opts.reserve(160);
+  auto profileOptions = [&](int selectedId) {
     for (size_t i = 0; i < growProfileCount(); i++) {
       const GrowProfileInfo* info = growProfileInfoAt(i);
       if (!info) continue;
-      opts += "<option value='" + String(i) + "'";
-      opts += profileDataAttrs(info);
-      if ((int)i == selectedId) opts += " selected";
-      opts += ">" + htmlEscape(info->label) + "</option>";
+      htmlWrite(page,
+        "<option value='", i, "'"
+        " data-label='", htmlEsc(info->label), "'"
+        " data-c1-dry='", info->chamber1.soilDryThreshold, "'"
+        " data-c1-wet='", info->chamber1.soilWetThreshold, "'"
+        " data-c2-dry='", info->chamber2.soilDryThreshold, "'"
+        " data-c2-wet='", info->chamber2.soilWetThreshold, "'"
+        " data-l1-on='", htmlTime(info->light1.onMinutes), "'"
+        " data-l1-off='", htmlTime(info->light1.offMinutes), "'"
+        " data-l1-auto='", htmlIf(info->light1.enabled, "1", "0"), "'"
+        " data-l2-on='", htmlTime(info->light2.onMinutes), "'"
+        " data-l2-off='", htmlTime(info->light2.offMinutes), "'"
+        " data-l2-auto='", htmlIf(info->light2.enabled, "1", "0"), "'"
+        " data-auto-fan='", htmlIf(info->autoFan, "1", "0"), "'"
+        " data-auto-pump='", htmlIf(info->autoPump, "1", "0"), "'"
+        " data-set-auto-fan='", htmlIf(info->setsAutoFan, "1", "0"), "'"
+        " data-set-auto-pump='", htmlIf(info->setsAutoPump, "1", "0"), "'",
+        htmlIf((int)i == selectedId, " selected"), ">", htmlEsc(info->label), "</option>");
     }
-    return opts;
+  };
+
+  auto modePill = [&](const char* label, bool isAuto) {
+    htmlWrite(page, "<span class='mode-pill ", htmlIf(isAuto, "mode-auto", "mode-manual"), "'>",
+              label, ": ", htmlIf(isAuto, "AUTO", "MANUAL"), "</span>");
   };
 
   auto chamberProfileRow = [&](int idx, const ChamberConfig& cfg, int selectedId) {
     const char* fallback = (idx == 0) ? DEFAULT_CHAMBER1_NAME : DEFAULT_CHAMBER2_NAME;
-    const String chamberName = cfg.name.length() ? cfg.name : String(fallback);
+    const HtmlEscaped chamberName = cfg.name.length() ? htmlEsc(cfg.name) : htmlEsc(fallback);
     const String activeProfile = growProfileLabelForId(cfg.profileId);
     const bool lightAuto = (idx == 0) ? gConfig.light1.enabled : gConfig.light2.enabled;
-    auto modePill = [](const char* label, bool isAuto) -> String {
-      String pill = "<span class='mode-pill ";
-      pill += isAuto ? "mode-auto" : "mode-manual";
-      pill += "'>";
-      pill += label;
-      pill += ": ";
-      pill += isAuto ? "AUTO" : "MANUAL";
-      pill += "</span>";
-      return pill;
+    const int no = idx + 1;
+    // data-chamber / -id / -name / data-light-label shared by the card, field and button
+    auto chamberAttrs = [&]() {
+      htmlWrite(page, " data-chamber='", idx, "' data-chamber-id='", no, "' data-chamber-name='", chamberName,
+                "' data-light-label='Light ", no, "'");
     };
 
-    page += "<div class='grow-card' data-chamber='" + String(idx) + "' data-chamber-id='" + String(idx + 1) + "' data-chamber-name='" + htmlEscape(chamberName) + "' data-light-label='Light " + String(idx + 1) + "'>";
-    page += "<div class='grow-card-head'>";
-    page += "<div><div class='eyebrow'>Chamber " + String(idx + 1) + "</div>";
-    page += "<div class='grow-card-title'>" + htmlEscape(chamberName) + "</div>";
-    page += "<div class='sub active-profile' data-active-profile='ch" + String(idx + 1) + "'>Active profile: " + htmlEscape(activeProfile.length() ? activeProfile : String("Custom/manual")) + "</div></div>";
-    page += "<div class='mode-pill-row'>";
-    page += modePill("Light", lightAuto);
-    page += modePill("Fan", gConfig.autoFan);
-    page += modePill("Pump", gConfig.autoPump);
-    page += "</div>";
-    page += "</div>";
-
-    page += "<div class='field chamber-profile' data-chamber='" + String(idx) + "' data-chamber-id='" + String(idx + 1) + "' data-chamber-name='" + htmlEscape(chamberName) + "' data-light-label='Light " + String(idx + 1) + "'>";
-    page += "<label>Preset</label>";
-    page += "<div class='row grow-action-row'>";
-    page += "<select id='prof-ch" + String(idx + 1) + "' name='growProfileCh" + String(idx + 1) + "'>";
-    page += profileOptions(selectedId);
-    page += "</select>";
-    page += "<button class='btn primary apply-profile' type='button' data-chamber='" + String(idx) + "' data-chamber-id='" + String(idx + 1) + "' data-chamber-name='" + htmlEscape(chamberName) + "' data-light-label='Light " + String(idx + 1) + "'>";
-    page += "Apply to Chamber " + String(idx + 1);
-    page += "</button></div>";
-    page += "<div class='apply-status' data-apply-status='ch" + String(idx + 1) + "'></div>";
-    page += "<div class='small'>Updates only this chamber's soil thresholds and linked light schedule/auto flag.</div>";
-    page += "</div>";
-    page += "<div class='profile-preview' data-preview='ch" + String(idx + 1) + "' data-chamber-name='" + htmlEscape(chamberName) + "' data-light-label='Light " + String(idx + 1) + "'>";
-    page += "<div class='preview-header'>Preview</div>";
-    page += "<div class='preview-grid'>";
-    page += "<div class='preview-item'><label>Soil dry/wet</label><div class='pv-soil'>Select a preset</div></div>";
-    page += "<div class='preview-item'><label>Light schedule</label><div class='pv-light'>—</div></div>";
-    page += "<div class='preview-item'><label>Light mode</label><div class='pv-mode'>—</div></div>";
-    page += "<div class='preview-item'><label>Automation</label><div class='pv-auto'>—</div></div>";
-    page += "</div></div>";
-    page += "</div>";
+    page += "<div class='grow-card'";
+    chamberAttrs();
+    htmlWrite(page, ">"
+      "<div class='grow-card-head'>"
+      "<div><div class='eyebrow'>Chamber ", no, "</div>"
+      "<div class='grow-card-title'>", chamberName, "</div>"
+      "<div class='sub active-profile' data-active-profile='ch", no, "'>Active profile: ",
+      activeProfile.length() ? htmlEsc(activeProfile) : htmlEsc("Custom/manual"), "</div></div>"
+      "<div class='mode-pill-row'>");
+    modePill("Light", lightAuto);
+    modePill("Fan", gConfig.autoFan);
+    modePill("Pump", gConfig.autoPump);
+    page += "</div>"
+            "</div>";
+
+    page += "<div class='field chamber-profile'";
+    chamberAttrs();
+    htmlWrite(page, ">"
+      "<label>Preset</label>"
+      "<div class='row grow-action-row'>"
+      "<select id='prof-ch", no, "' name='growProfileCh", no, "'>");
+    profileOptions(selectedId);
+    page += "</select>"
+            "<button class='btn primary apply-profile' type='button'";
+    chamberAttrs();
+    htmlWrite(page, ">"
+      "Apply to Chamber ", no,
+      "</button></div>"
+      "<div class='apply-status' data-apply-status='ch", no, "'></div>"
+      "<div class='small'>Updates only this chamber's soil thresholds and linked light schedule/auto flag.</div>"
+      "</div>"
+      "<div class='profile-preview' data-preview='ch", no, "' data-chamber-name='", chamberName,
+      "' data-light-label='Light ", no, "'>"
+      "<div class='preview-header'>Preview</div>"
+      "<div class='preview-grid'>"
+      "<div class='preview-item'><label>Soil dry/wet</label><div class='pv-soil'>Select a preset</div></div>"
+      "<div class='preview-item'><label>Light schedule</label><div class='pv-light'>—</div></div>"
+      "<div class='preview-item'><label>Light mode</label><div class='pv-mode'>—</div></div>"
+      "<div class='preview-item'><label>Automation</label><div class='pv-auto'>—</div></div>"
+      "</div></div>"
+      "</div>");
   };
 
   int chamber1Selected = (gConfig.chamber1.profileId > 0) ? gConfig.chamber1.profileId : 0;
   int chamber2Selected = (gConfig.chamber2.profileId > 0) ? gConfig.chamber2.profileId : 0;
-  page += "<div class='grow-global row' style='align-items:flex-end;gap:12px;flex-wrap:wrap'>";
-  page += "<div class='grow-global-label'><label>Global preset</label><div class='small'>Apply to both chambers + env</div></div>";
-  page += "<div class='row grow-action-row'>";
-  page += "<select id='globalPresetSelect' name='growProfileAll'>";
-  page += profileOptions(0);
-  page += "</select>";
-  page += "<button class='btn primary' type='submit' id='applyProfileAllBtn' name='applyProfile' value='1'>Apply to both + env</button>";
-  page += "</div>";
-  page += "<div class='apply-status' data-apply-status='all'></div>";
-  page += "</div>";
+  page += "<div class='grow-global row' style='align-items:flex-end;gap:12px;flex-wrap:wrap'>"
+          "<div class='grow-global-label'><label>Global preset</label><div class='small'>Apply to both chambers + env</div></div>"
+          "<div class='row grow-action-row'>"
+          "<select id='globalPresetSelect' name='growProfileAll'>";
+  profileOptions(0);
+  page += "</select>"
+          "<button class='btn primary' type='submit' id='applyProfileAllBtn' name='applyProfile' value='1'>Apply to both + env</button>"
+          "</div>"
+          "<div class='apply-status' data-apply-status='all'></div>"
+          "</div>";
 
   page += "<div class='grow-profile-grid'>";
   chamberProfileRow(0, gConfig.chamber1, chamber1Selected);
   chamberProfileRow(1, gConfig.chamber2, chamber2Selected);
   page += "</div>";
 
-  page += "<div class='small' style='margin-top:10px'>Preset preview:</div>";
-  page += "<table class='table profile-summary' style='margin-top:6px'>";
-  page += "<tr><th>Preset</th><th>Ch1 soil (dry/wet %)</th><th>Ch2 soil (dry/wet %)</th><th>Light windows (L1/L2)</th><th>Fan on/off (°C)</th><th>Hum on/off (%)</th><th>Pump OFF/ON (s)</th><th>Automation</th></tr>";
+  page += "<div class='small' style='margin-top:10px'>Preset preview:</div>"
+          "<table class='table profile-summary' style='margin-top:6px'>"
+          "<tr><th>Preset</th><th>Ch1 soil (dry/wet %)</th><th>Ch2 soil (dry/wet %)</th><th>Light windows (L1/L2)</th><th>Fan on/off (°C)</th><th>Hum on/off (%)</th><th>Pump OFF/ON (s)</th><th>Automation</th></tr>";
   for (size_t i = 0; i < growProfileCount(); i++) {
     const GrowProfileInfo* info = growProfileInfoAt(i);
     if (!info) continue;
-    page += "<tr class='preset-row' data-preset-label='" + htmlEscape(info->label) + "'";
-    page += " data-l1-on='" + minutesToTimeStrSafe(info->light1.onMinutes) + "'";
-    page += " data-l1-off='" + minutesToTimeStrSafe(info->light1.offMinutes) + "'";
-    page += " data-l2-on='" + minutesToTimeStrSafe(info->light2.onMinutes) + "'";
-    page += " data-l2-off='" + minutesToTimeStrSafe(info->light2.offMinutes) + "'>";
-    page += "<td>" + htmlEscape(info->label) + "</td>";
-    page += "<td>" + String(info->chamber1.soilDryThreshold) + " / " + String(info->chamber1.soilWetThreshold) + "</td>";
-    page += "<td>" + String(info->chamber2.soilDryThreshold) + " / " + String(info->chamber2.soilWetThreshold) + "</td>";
-    page += "<td class='preset-schedules'>L1 " + minutesToTimeStrSafe(info->light1.onMinutes) + "–" + minutesToTimeStrSafe(info->light1.offMinutes) +
-            " · L2 " + minutesToTimeStrSafe(info->light2.onMinutes) + "–" + minutesToTimeStrSafe(info->light2.offMinutes) + "</td>";
-    page += "<td>" + String(info->env.fanOnTemp, 1) + " / " + String(info->env.fanOffTemp, 1) + "</td>";
-    page += "<td>" + String(info->env.fanHumOn) + " / " + String(info->env.fanHumOff) + "</td>";
-    page += "<td>" + String(info->env.pumpMinOffSec) + " / " + String(info->env.pumpMaxOnSec) + "</td>";
-    page += "<td><div class='automation-pills'>";
-    page += "<span class='mode-pill " + String(info->setsAutoFan && info->autoFan ? "mode-auto" : "mode-manual") + "'>Fan: " + htmlAutoChange(info->setsAutoFan, info->autoFan) + "</span>";
-    page += "<span class='mode-pill " + String(info->setsAutoPump && info->autoPump ? "mode-auto" : "mode-manual") + "'>Pump: " + htmlAutoChange(info->setsAutoPump, info->autoPump) + "</span>";
-    page += "</div></td></tr>";
+    htmlWrite(page,
+      "<tr class='preset-row' data-preset-label='", htmlEsc(info->label), "'"
+      " data-l1-on='", htmlTime(info->light1.onMinutes), "'"
+      " data-l1-off='", htmlTime(info->light1.offMinutes), "'"
+      " data-l2-on='", htmlTime(info->light2.onMinutes), "'"
+      " data-l2-off='", htmlTime(info->light2.offMinutes), "'>"
+      "<td>", htmlEsc(info->label), "</td>"
+      "<td>", info->chamber1.soilDryThreshold, " / ", info->chamber1.soilWetThreshold, "</td>"
+      "<td>", info->chamber2.soilDryThreshold, " / ", info->chamber2.soilWetThreshold, "</td>"
+      "<td class='preset-schedules'>L1 ", htmlTime(info->light1.onMinutes), "–", htmlTime(info->light1.offMinutes),
+      " · L2 ", htmlTime(info->light2.onMinutes), "–", htmlTime(info->light2.offMinutes), "</td>"
+      "<td>", htmlFixed(info->env.fanOnTemp, 1), " / ", htmlFixed(info->env.fanOffTemp, 1), "</td>"
+      "<td>", info->env.fanHumOn, " / ", info->env.fanHumOff, "</td>"
+      "<td>", info->env.pumpMinOffSec, " / ", info->env.pumpMaxOnSec, "</td>"
+      "<td><div class='automation-pills'>"
+      "<span class='mode-pill ", htmlIf(info->setsAutoFan && info->autoFan, "mode-auto", "mode-manual"), "'>Fan: ",
+      htmlAutoChange(info->setsAutoFan, info->autoFan), "</span>"
+      "<span class='mode-pill ", htmlIf(info->setsAutoPump && info->autoPump, "mode-auto", "mode-manual"), "'>Pump: ",
+      htmlAutoChange(info->setsAutoPump, info->autoPump), "</span>"
+      "</div></td></tr>");
   }
   page += "</table>";
   page += "<div class='sub' style='margin-top:14px'>Edit grow profile presets</div>";
   for (size_t i = 1; i < growProfileCount(); i++) {
     const GrowProfileInfo* info = growProfileInfoAt(i);
     if (!info) continue;
-    const String idxStr = String(i);
-    page += "<div class='grow-card' data-profile-edit='" + idxStr + "'>";
-    page += "<div class='grow-card-head'>";
-    page += "<div><div class='eyebrow'>Preset</div><div class='grow-card-title'>" + htmlEscape(info->label) + "</div><div class='sub'>Update the values used when applying this preset.</div></div>";
-    page += "<div class='mode-pill-row'><span class='mode-pill mode-auto'>" + htmlEscape(info->label) + "</span></div>";
-    page += "</div>";
-    page += "<div class='form-grid'>";
-    page += "<div class='field'><label>Preset label</label><input type='text' name='gp" + idxStr + "_label' maxlength='24' value='" + htmlEscape(info->label) + "'><div class='small'>Shown in selectors and dashboard.</div></div>";
-    page += "<div class='field'><label>Ch1 DRY (%)</label><input type='number' step='1' name='gp" + idxStr + "_c1_dry' value='" + String(info->chamber1.soilDryThreshold) + "'></div>";
-    page += "<div class='field'><label>Ch1 WET (%)</label><input type='number' step='1' name='gp" + idxStr + "_c1_wet' value='" + String(info->chamber1.soilWetThreshold) + "'></div>";
-    page += "<div class='field'><label>Ch2 DRY (%)</label><input type='number' step='1' name='gp" + idxStr + "_c2_dry' value='" + String(info->chamber2.soilDryThreshold) + "'></div>";
-    page += "<div class='field'><label>Ch2 WET (%)</label><input type='number' step='1' name='gp" + idxStr + "_c2_wet' value='" + String(info->chamber2.soilWetThreshold) + "'></div>";
-    page += "<div class='field'><label>Light 1 ON</label><input type='time' name='gp" + idxStr + "_l1_on' value='" + minutesToTimeStrSafe(info->light1.onMinutes) + "'></div>";
-    page += "<div class='field'><label>Light 1 OFF</label><input type='time' name='gp" + idxStr + "_l1_off' value='" + minutesToTimeStrSafe(info->light1.offMinutes) + "'></div>";
-    page += "<div class='field'><label>Light 1 mode</label><label><input type='checkbox' name='gp" + idxStr + "_l1_auto' value='1'";
-    if (info->light1.enabled) page += " checked";
-    page += "> Use schedule</label><div class='small'>Unchecked sets MAN mode.</div></div>";
-    page += "<div class='field'><label>Light 2 ON</label><input type='time' name='gp" + idxStr + "_l2_on' value='" + minutesToTimeStrSafe(info->light2.onMinutes) + "'></div>";
-    page += "<div class='field'><label>Light 2 OFF</label><input type='time' name='gp" + idxStr + "_l2_off' value='" + minutesToTimeStrSafe(info->light2.offMinutes) + "'></div>";
-    page += "<div class='field'><label>Light 2 mode</label><label><input type='checkbox' name='gp" + idxStr + "_l2_auto' value='1'";
-    if (info->light2.enabled) page += " checked";
-    page += "> Use schedule</label><div class='small'>Unchecked sets MAN mode.</div></div>";
-    page += "<div class='field'><label>Fan ON temp (°C)</label><input type='number' step='0.1' name='gp" + idxStr + "_fan_on' value='" + String(info->env.fanOnTemp, 1) + "'></div>";
-    page += "<div class='field'><label>Fan OFF temp (°C)</label><input type='number' step='0.1' name='gp" + idxStr + "_fan_off' value='" + String(info->env.fanOffTemp, 1) + "'></div>";
-    page += "<div class='field'><label>Fan ON humidity (%RH)</label><input type='number' step='1' name='gp" + idxStr + "_hum_on' value='" + String(info->env.fanHumOn) + "'></div>";
-    page += "<div class='field'><label>Fan OFF humidity (%RH)</label><input type='number' step='1' name='gp" + idxStr + "_hum_off' value='" + String(info->env.fanHumOff) + "'></div>";
-    page += "<div class='field'><label>Pump minimum OFF (s)</label><input type='number' step='1' name='gp" + idxStr + "_pump_off' value='" + String(info->env.pumpMinOffSec) + "'></div>";
-    page += "<div class='field'><label>Pump maximum ON (s)</label><input type='number' step='1' name='gp" + idxStr + "_pump_on' value='" + String(info->env.pumpMaxOnSec) + "'></div>";
+    // Inputs are named gp<i>_<key>
+    auto presetNumber = [&](const char* label, const char* key, int value) {
+      htmlWrite(page, "<div class='field'><label>", label, "</label><input type='number' step='1' name='gp", i, '_', key,
+                "' value='", value, "'></div>");
+    };
+    auto presetDecimal = [&](const char* label, const char* key, float value) {
+      htmlWrite(page, "<div class='field'><label>", label, "</label><input type='number' step='0.1' name='gp", i, '_', key,
+                "' value='", htmlFixed(value, 1), "'></div>");
+    };
+    auto presetTime = [&](const char* label, const char* key, int minutes) {
+      htmlWrite(page, "<div class='field'><label>", label, "</label><input type='time' name='gp", i, '_', key,
+                "' value='", htmlTime(minutes), "'></div>");
+    };
+    auto presetCheckbox = [&](const char* key, bool checked, const char* text) {
+      htmlWrite(page, "<label><input type='checkbox' name='gp", i, '_', key, "' value='1'", htmlIf(checked, " checked"),
+                "> ", text, "</label>");
+    };
+
+    htmlWrite(page,
+      "<div class='grow-card' data-profile-edit='", i, "'>"
+      "<div class='grow-card-head'>"
+      "<div><div class='eyebrow'>Preset</div><div class='grow-card-title'>", htmlEsc(info->label), "</div>"
+      "<div class='sub'>Update the values used when applying this preset.</div></div>"
+      "<div class='mode-pill-row'><span class='mode-pill mode-auto'>", htmlEsc(info->label), "</span></div>"
+      "</div>"
+      "<div class='form-grid'>"
+      "<div class='field'><label>Preset label</label><input type='text' name='gp", i, "_label' maxlength='24' value='",
+      htmlEsc(info->label), "'><div class='small'>Shown in selectors and dashboard.</div></div>");
+    presetNumber("Ch1 DRY (%)", "c1_dry", info->chamber1.soilDryThreshold);
+    presetNumber("Ch1 WET (%)", "c1_wet", info->chamber1.soilWetThreshold);
+    presetNumber("Ch2 DRY (%)", "c2_dry", info->chamber2.soilDryThreshold);
+    presetNumber("Ch2 WET (%)", "c2_wet", info->chamber2.soilWetThreshold);
+    presetTime("Light 1 ON", "l1_on", info->light1.onMinutes);
+    presetTime("Light 1 OFF", "l1_off", info->light1.offMinutes);
+    page += "<div class='field'><label>Light 1 mode</label>";
+    presetCheckbox("l1_auto", info->light1.enabled, "Use schedule");
+    page += "<div class='small'>Unchecked sets MAN mode.</div></div>";
+    presetTime("Light 2 ON", "l2_on", info->light2.onMinutes);
+    presetTime("Light 2 OFF", "l2_off", info->light2.offMinutes);
+    page += "<div class='field'><label>Light 2 mode</label>";
+    presetCheckbox("l2_auto", info->light2.enabled, "Use schedule");
+    page += "<div class='small'>Unchecked sets MAN mode.</div></div>";
+    presetDecimal("Fan ON temp (°C)", "fan_on", info->env.fanOnTemp);
+    presetDecimal("Fan OFF temp (°C)", "fan_off", info->env.fanOffTemp);
+    presetNumber("Fan ON humidity (%RH)", "hum_on", info->env.fanHumOn);
+    presetNumber("Fan OFF humidity (%RH)", "hum_off", info->env.fanHumOff);
+    presetNumber("Pump minimum OFF (s)", "pump_off", info->env.pumpMinOffSec);
+    presetNumber("Pump maximum ON (s)", "pump_on", info->env.pumpMaxOnSec);
     page += "<div class='field'><label>Automation defaults</label>";
-    page += "<label><input type='checkbox' name='gp" + idxStr + "_set_auto_fan' value='1'";
-    if (info->setsAutoFan) page += " checked";
-    page += "> Apply AUTO fan</label><br>";
-    page += "<label><input type='checkbox' name='gp" + idxStr + "_set_auto_pump' value='1'";
-    if (info->setsAutoPump) page += " checked";
-    page += "> Apply AUTO pump</label><br>";
-    page += "<label><input type='checkbox' name='gp" + idxStr + "_auto_fan' value='1'";
-    if (info->autoFan) page += " checked";
-    page += "> Fan AUTO value</label><br>";
-    page += "<label><input type='checkbox' name='gp" + idxStr + "_auto_pump' value='1'";
-    if (info->autoPump) page += " checked";
-    page += "> Pump AUTO value</label><div class='small'>If set AUTO is unchecked, the automation defaults above are ignored.</div></div>";
-    page += "</div>";
-    page += "</div>";
+    presetCheckbox("set_auto_fan", info->setsAutoFan, "Apply AUTO fan");
+    page += "<br>";
+    presetCheckbox("set_auto_pump", info->setsAutoPump, "Apply AUTO pump");
+    page += "<br>";
+    presetCheckbox("auto_fan", info->autoFan, "Fan AUTO value");
+    page += "<br>";
+    presetCheckbox("auto_pump", info->autoPump, "Pump AUTO value");
+    page += "<div class='small'>If set AUTO is unchecked, the automation defaults above are ignored.</div></div>"
+            "</div>"
+            "</div>";
   }
   page += "<p class='small' style='margin-top:8px'>Saving config also stores preset edits. Apply buttons will use these values.</p>";
   page += "</div>";
@@ -1250,51 +3063,46 @@ static void handleConfigGet() {
   if (tzCount > 0 && (size_t)tzIndex >= tzCount) tzIndex = tzCount - 1;
   gConfig.tzIndex = tzIndex;
 
-  page += "<div class='tab-panel' data-tab='system'>";
-  page += "<div class='form-grid'>";
-  page += "<div class='field'><label>Current local time</label><div class='pill muted' id='cfg-time'>—</div></div>";
-  page += "<div class='field'><label>Timezone</label><select name='tzIndex'>";
+  page += "<div class='tab-panel' data-tab='system'>"
+          "<div class='form-grid'>"
+          "<div class='field'><label>Current local time</label><div class='pill muted' id='cfg-time'>—</div></div>"
+          "<div class='field'><label>Timezone</label><select name='tzIndex'>";
   for (size_t i = 0; i < tzCount; i++) {
-    page += "<option value='" + String(i) + "'";
-    if ((int)i == tzIndex) page += " selected";
-    page += ">" + htmlEscape(greenhouseTimezoneLabelAt(i)) + "</option>";
-  }
-  page += "</select><div class='small'>Applied immediately to NTP and time display.</div></div>";
-  page += "<div class='field'><label>Device reboot</label>";
-  page += "<p class='small'>Gracefully restarts the controller after confirming the request.</p>";
-  page += "<button type='button' class='btn danger' id='rebootBtn' data-confirm='Reboot the device now? Active sessions may disconnect.'>Reboot</button>";
-  page += "<div class='small'>Responds before restarting so the UI can show confirmation.</div></div>";
-  page += "</div>";
-  page += "</div>";
+    htmlWrite(page, "<option value='", i, "'", htmlIf((int)i == tzIndex, " selected"), ">",
+              htmlEsc(greenhouseTimezoneLabelAt(i)), "</option>");
+  }
+  page += "</select><div class='small'>Applied immediately to NTP and time display.</div></div>"
+          "<div class='field'><label>Device reboot</label>"
+          "<p class='small'>Gracefully restarts the controller after confirming the request.</p>"
+          "<button type='button' class='btn danger' id='rebootBtn' data-confirm='Reboot the device now? Active sessions may disconnect.'>Reboot</button>"
+          "<div class='small'>Responds before restarting so the UI can show confirmation.</div></div>"
+          "</div>"
+          "</div>";
 
   // SECURITY
   page += "<div class='tab-panel' data-tab='security'>";
   page += "<p class='small'>If username is empty, HTTP Basic Auth is disabled.</p>";
   page += "<div class='form-grid'>";
-  page += "<div class='field'><label>Username</label>"
-          "<input type='text' name='authUser' value='" + htmlEscape(sWebAuthUser) + "'></div>";
-  page += "<div class='field'><label>Password (leave blank to keep current)</label>"
-          "<input type='password' name='authPass' value=''></div>";
+  inputField("Username", "type='text' name='authUser'", htmlEsc(sWebAuthUser));
+  inputField("Password (leave blank to keep current)", "type='password' name='authPass'", htmlEsc(""));
   page += "</div>";
   page += "</div>";
 
-  page += "<div class='row' style='margin-top:14px'>";
-  page += "<button class='btn primary' type='submit'>Save</button>";
-  page += "<a class='btn ghost' href='/'>Back</a>";
-  page += "</div>";
+  page += "<div class='row' style='margin-top:14px'>"
+          "<button class='btn primary' type='submit'>Save</button>"
+          "<a class='btn ghost' href='/'>Back</a>"
+          "</div>";
 
   page += "</form>";
 
   // WIFI
   page += "<div class='tab-panel' data-tab='wifi'>";
-  appendWifiConfigSection(page, storedSsid, storedPass, wifiNetworks);
+  appendWifiConfigSection(page);
   page += "</div>";
   page += "</div>"; // panels
   page += "</div>"; // card
 
   endPage(page);
-  server.send(200, "text/html", page);
-  WiFi.scanDelete();
 }
 
 static void handleConfigPost() {
@@ -1595,6 +3403,12 @@ static void handleNotFound() {
 
 void initWebServer() {
   loadWebAuthConfig(sWebAuthUser, sWebAuthPass);
+  sHistoryBootId = esp_random();
+
+  static const char* kCollectedHeaders[] = {
+    "If-None-Match", "Accept-Encoding", "Upgrade", "Sec-WebSocket-Key", "Sec-WebSocket-Version"
+  };
+  server.collectHeaders(kCollectedHeaders, sizeof(kCollectedHeaders) / sizeof(kCollectedHeaders[0]));
 
   refreshCaptivePortalState();
 
@@ -1612,6 +3426,8 @@ void initWebServer() {
   server.on("/api/grow/apply_all", HTTP_POST, handleApplyProfileAllApi);
   server.on("/api/grow/apply_all", HTTP_GET,  handleApplyProfileAllApi);
   server.on("/api/reboot",       HTTP_POST, handleRebootApi);
+  server.on("/api/events",       HTTP_GET,  handleEventsApi);
+  server.on("/api/ws",           HTTP_GET,  handleWebSocketApi);
 
   server.on("/config",           HTTP_GET,  handleConfigGet);
   server.on("/config",           HTTP_POST, handleConfigPost);
@@ -1620,6 +3436,10 @@ void initWebServer() {
   server.on("/wifi",             HTTP_POST, handleWifiConfigPost);
 
   server.on("/api/history",      HTTP_GET,  handleHistoryApi);
+  server.on("/api/history.bin",  HTTP_GET,  handleHistoryBinApi);
+  server.on("/api/history.csv",  HTTP_GET,  handleHistoryCsvApi);
+  server.on("/api/history.ndjson", HTTP_GET, handleHistoryNdjsonApi);
+  server.on("/api/history/stats", HTTP_GET, handleHistoryStatsApi);
 
   // Static assets (offline)
   server.on("/chart.umd.min.js", HTTP_GET,  handleChartJs);
@@ -1627,6 +3447,14 @@ void initWebServer() {
   server.on("/app.css",          HTTP_GET,  handleAppCss);
   server.on("/app.js",           HTTP_GET,  handleAppJs);
 
+  // Fingerprinted URLs of the same assets
+  if (loadStaticAssetManifest() > 0) {
+    server.on(staticAssetUrl("/chart.umd.min.js"), HTTP_GET, handleChartJs);
+    server.on(staticAssetUrl("/logo-ezgrow.png"),  HTTP_GET, handleLogoPng);
+    server.on(staticAssetUrl("/app.css"),          HTTP_GET, handleAppCss);
+    server.on(staticAssetUrl("/app.js"),           HTTP_GET, handleAppJs);
+  }
+
   server.onNotFound(handleNotFound);
 
   server.begin();
@@ -1635,7 +3463,12 @@ void initWebServer() {
 
 void handleWebServer() {
   refreshCaptivePortalState();
+  trackStatusGeneration();
   server.handleClient();
+  sTransfers.pump(HTTP_TRANSFER_PUMP_US);
+  pumpWebSockets();
+  publishStatusEvents();
+  sEvents.pump(millis());
   if (sCaptivePortalActive) {
     dnsServer.processNextRequest();
   }
@@ -169,9 +169,14 @@
 
   const HISTORY_RANGE_KEY       = "historyRangeDays";
   const HISTORY_MIN_DAYS        = 1;
-  const HISTORY_MAX_DAYS        = 7;
+  const HISTORY_MAX_DAYS        = 365;
   const HISTORY_INTERVAL_MINUTES = 10;
   const HISTORY_SAMPLES_PER_DAY = Math.max(1, Math.round((24 * 60) / HISTORY_INTERVAL_MINUTES));
+  const HISTORY_TIERS           = ["raw", "10min", "hourly"];
+
+  const historySamplesPerDay = (intervalSec) => (Number(intervalSec) > 0
+    ? Math.max(1, Math.round((24 * 60 * 60) / Number(intervalSec)))
+    : HISTORY_SAMPLES_PER_DAY);
 
   const clampHistoryDays = (v) => {
     const num = Number(v);
@@ -179,12 +184,12 @@
     return Math.min(HISTORY_MAX_DAYS, Math.max(HISTORY_MIN_DAYS, Math.round(num)));
   };
 
-  function filterHistoryPoints(points, days = HISTORY_MIN_DAYS){
+  function filterHistoryPoints(points, days = HISTORY_MIN_DAYS, intervalSec = 0){
     const pts = Array.isArray(points) ? points : [];
     if (!pts.length) return [];
 
     const rangeDays = clampHistoryDays(days);
-    const maxSamples = HISTORY_SAMPLES_PER_DAY * rangeDays;
+    const maxSamples = historySamplesPerDay(intervalSec) * rangeDays;
 
     let newestTs = 0;
     pts.forEach(p => {
@@ -451,8 +456,19 @@
     if (arr.length > 60) arr.shift();
   }
 
-  function formatTimeLabel(dt, timezone){
-    const baseOpts = { hour: "2-digit", minute:"2-digit" };
+  function formatTimeLabel(dt, timezone, withDate=false){
+    const baseOpts = withDate
+      ? { month: "short", day: "numeric", hour: "2-digit", minute:"2-digit" }
+      : { hour: "2-digit", minute:"2-digit" };
+
+    if (withDate){
+      if (timezone){
+        try{
+          return dt.toLocaleString([], { ...baseOpts, timeZone: timezone });
+        }catch{}
+      }
+      return dt.toLocaleString([], baseOpts);
+    }
 
     if (timezone){
       try{
@@ -530,40 +546,211 @@
     return `${base}${tzText}${deltaText ? ` · ${deltaText}` : ""}`;
   }
 
-  function prepareHistoryDatasets(points, timezone, chamberLabels=[]){
-    const pts = Array.isArray(points) ? points : [];
-    const labelNames = Array.isArray(chamberLabels) && chamberLabels.length >= 2
-      ? chamberLabels
-      : ["Chamber 1", "Chamber 2"];
+  const HISTORY_BIN_MAGIC      = "EZHB";
+  const HISTORY_BIN_VERSION    = 2;
+  const HISTORY_BIN_POINT_SIZE = 4 + 2 + 2 + 1 + 1 + 1;
+  const HISTORY_BIN_RANGE_SIZE = 2 + 2 + 2 + 2 + 1 + 1 + 1 + 1 + 1 + 1;
 
+  // Column form shared by the JSON and binary history feeds (null = missing)
+  function historyColumnsFromPoints(points){
+    const pts = Array.isArray(points) ? points : [];
     const safeVal = v => (v == null || Number.isNaN(v)) ? null : v;
     const soilVal = (p, keyShort, keyLong) => {
       const raw = (keyLong in p) ? p[keyLong] : p[keyShort];
       return Number.isFinite(raw) ? raw : null;
     };
+    const lightVal = v => (v ? 1 : 0);
+
+    return {
+      count: pts.length,
+      t: pts.map(p => (p && Number.isFinite(p.t)) ? p.t : 0),
+      temp: pts.map(p => safeVal(p?.temp)),
+      hum: pts.map(p => safeVal(p?.hum)),
+      soil1: pts.map(p => soilVal(p || {}, "s1", "soil1")),
+      soil2: pts.map(p => soilVal(p || {}, "s2", "soil2")),
+      l1: pts.map(p => lightVal(p?.l1)),
+      l2: pts.map(p => lightVal(p?.l2)),
+    };
+  }
 
-    const labels = pts.map((p, idx) => {
-      if (p && Number.isFinite(p.t) && p.t > 0){
-        const dt = new Date(p.t * 1000);
-        return formatTimeLabel(dt, timezone);
+  // Decodes the little-endian /api/history.bin payload (one record per
+  // point) into columns; returns null when the buffer is not a supported
+  // history payload.
+  function decodeHistoryBinary(buffer){
+    if (!buffer || typeof buffer.byteLength !== "number" || buffer.byteLength < 24) return null;
+    const view = new DataView(buffer);
+    const magic = String.fromCharCode(view.getUint8(0), view.getUint8(1), view.getUint8(2), view.getUint8(3));
+    if (magic !== HISTORY_BIN_MAGIC || view.getUint8(4) !== HISTORY_BIN_VERSION) return null;
+
+    const headerSize = view.getUint8(5);
+    const flags = view.getUint16(6, true);
+    const recordSize = view.getUint32(8, true);
+    const intervalSec = view.getUint32(12, true);
+    const seq = view.getUint32(16, true);
+    const boot = view.getUint32(20, true).toString(16).padStart(8, "0");
+    const hasRange = (flags & 0x0002) !== 0;
+    const tier = HISTORY_TIERS[(flags >> 8) & 0x0F] || null;
+    const body = buffer.byteLength - headerSize;
+    if (headerSize < 24 || body < 0 || recordSize < HISTORY_BIN_POINT_SIZE + (hasRange ? HISTORY_BIN_RANGE_SIZE : 0) ||
+        body % recordSize !== 0) return null;
+    const count = body / recordSize;
+
+    const i16 = at => { const raw = view.getInt16(at, true); return raw === -32768 ? null : raw / 10; };
+    const u16 = at => { const raw = view.getUint16(at, true); return raw === 0xFFFF ? null : raw / 10; };
+    const u8 = at => { const raw = view.getUint8(at); return raw === 0xFF ? null : raw; };
+
+    const t = new Array(count);
+    const temp = new Array(count);
+    const hum = new Array(count);
+    const soil1 = new Array(count);
+    const soil2 = new Array(count);
+    const l1 = new Array(count);
+    const l2 = new Array(count);
+    const cols = { count, intervalSec, tier, seq, boot, reset: (flags & 0x0001) !== 0, t, temp, hum, soil1, soil2, l1, l2 };
+    if (hasRange){
+      // Hourly rollups carry min/max fields and the share of minutes each light was on
+      for (const key of ["tempMin", "tempMax", "humMin", "humMax", "soil1Min", "soil1Max", "soil2Min", "soil2Max", "l1Pct", "l2Pct"]){
+        cols[key] = new Array(count);
       }
-      return String(idx);
-    });
+    }
 
-    const lightVal = v => (v ? 1 : 0);
+    for (let i = 0, off = headerSize; i < count; i++, off += recordSize){
+      t[i] = view.getUint32(off, true);
+      temp[i] = i16(off + 4);
+      hum[i] = u16(off + 6);
+      soil1[i] = u8(off + 8);
+      soil2[i] = u8(off + 9);
+      const lights = view.getUint8(off + 10);
+      l1[i] = lights & 0x01 ? 1 : 0;
+      l2[i] = lights & 0x02 ? 1 : 0;
+      if (!hasRange) continue;
+      cols.tempMin[i] = i16(off + 11);
+      cols.tempMax[i] = i16(off + 13);
+      cols.humMin[i] = u16(off + 15);
+      cols.humMax[i] = u16(off + 17);
+      cols.soil1Min[i] = u8(off + 19);
+      cols.soil1Max[i] = u8(off + 20);
+      cols.soil2Min[i] = u8(off + 21);
+      cols.soil2Max[i] = u8(off + 22);
+      cols.l1Pct[i] = u8(off + 23);
+      cols.l2Pct[i] = u8(off + 24);
+    }
+    return cols;
+  }
+
+  function prepareHistoryColumns(cols, timezone, chamberLabels=[]){
+    const labelNames = Array.isArray(chamberLabels) && chamberLabels.length >= 2
+      ? chamberLabels
+      : ["Chamber 1", "Chamber 2"];
+    const count = cols?.count || 0;
+    // Hourly and multi-day ranges need the date to tell the labels apart
+    const span = count > 1 ? (cols.t[count - 1] - cols.t[0]) : 0;
+    const withDate = Number(cols?.intervalSec) >= 3600 || span > 24 * 60 * 60;
+
+    const labels = new Array(count);
+    for (let i = 0; i < count; i++){
+      const ts = cols.t[i];
+      labels[i] = (Number.isFinite(ts) && ts > 0)
+        ? formatTimeLabel(new Date(ts * 1000), timezone, withDate)
+        : String(i);
+    }
 
     return {
       labels,
-      temps: pts.map(p => safeVal(p?.temp)),
-      hums:  pts.map(p => safeVal(p?.hum)),
-      light1: pts.map(p => lightVal(p?.l1)),
-      light2: pts.map(p => lightVal(p?.l2)),
-      soil1: pts.map(p => soilVal(p || {}, "s1", "soil1")),
-      soil2: pts.map(p => soilVal(p || {}, "s2", "soil2")),
+      times: count ? cols.t.slice(0, count) : [],
+      temps: count ? cols.temp.slice(0, count) : [],
+      hums: count ? cols.hum.slice(0, count) : [],
+      light1: count ? cols.l1.slice(0, count) : [],
+      light2: count ? cols.l2.slice(0, count) : [],
+      soil1: count ? cols.soil1.slice(0, count) : [],
+      soil2: count ? cols.soil2.slice(0, count) : [],
       chamberLabels: labelNames,
+      intervalSec: Number(cols?.intervalSec) || 0,
     };
   }
 
+  function prepareHistoryDatasets(points, timezone, chamberLabels=[]){
+    return prepareHistoryColumns(historyColumnsFromPoints(points), timezone, chamberLabels);
+  }
+
+  // Appends newer samples to chart-ready arrays in place (so Chart.js datasets
+  // keep their references) and drops samples that left the range window.
+  // intervalSec is the sample interval of the tier the view was loaded from.
+  function appendHistoryWindow(view, addition, days, intervalSec = view?.intervalSec){
+    const keys = ["times", "labels", "temps", "hums", "soil1", "soil2"];
+    keys.forEach(k => {
+      if (Array.isArray(view[k]) && Array.isArray(addition[k])) view[k].push(...addition[k]);
+    });
+
+    const rangeDays = clampHistoryDays(days);
+    const times = view.times || [];
+    const newestTs = times.length ? times[times.length - 1] : 0;
+    const cutoff = newestTs > 0 ? newestTs - (rangeDays * 24 * 60 * 60) : 0;
+    const maxSamples = historySamplesPerDay(intervalSec) * rangeDays;
+
+    let drop = Math.max(0, times.length - maxSamples);
+    while (drop < times.length && cutoff > 0 && times[drop] > 0 && times[drop] < cutoff) drop++;
+    if (drop > 0){
+      keys.forEach(k => { if (Array.isArray(view[k])) view[k].splice(0, drop); });
+    }
+    return drop;
+  }
+
+  // One history point per device pixel of chart width is enough; the device
+  // downsamples (LTTB) when the range holds more samples than that.
+  function historyPointBudget(canvas){
+    const width = Number(canvas?.clientWidth) || 0;
+    if (width <= 0) return 0;
+    const dpr = Math.min(2, Math.max(1, Number(window.devicePixelRatio) || 1));
+    return Math.max(64, Math.round(width * dpr));
+  }
+
+  // Prefers the compact binary feed and falls back to the JSON one (older firmware).
+  // With a cursor only samples newer than cursor.seq (of the same tier) are
+  // requested, and an unchanged buffer is answered with 304 ({ notModified:true }).
+  async function fetchHistoryColumns(days, ts, cursor=null, points=0){
+    let query = `days=${days}`;
+    if (points > 0) query += `&points=${points}`;
+    const headers = {};
+    if (cursor && cursor.seq != null){
+      query += `&since=${cursor.seq}&boot=${encodeURIComponent(cursor.boot || "")}`;
+      if (cursor.tier) query += `&tier=${encodeURIComponent(cursor.tier)}`;
+      if (cursor.etag) headers["If-None-Match"] = cursor.etag;
+    }
+    query += `&ts=${ts}`;
+
+    const fromJson = (d, etag) => {
+      const intervalSec = Number.isFinite(d.interval) ? d.interval : HISTORY_INTERVAL_MINUTES * 60;
+      const cols = historyColumnsFromPoints(filterHistoryPoints(d.points || [], days, intervalSec));
+      cols.intervalSec = intervalSec;
+      cols.tier = typeof d.tier === "string" ? d.tier : null;
+      cols.seq = Number.isFinite(d.seq) ? d.seq : null;
+      cols.boot = d.boot ?? null;
+      cols.reset = d.reset !== false;
+      return { cols, etag };
+    };
+
+    try{
+      const r = await fetch(`/api/history.bin?${query}`, { cache: "no-store", headers });
+      if (r.status === 304) return { notModified: true };
+      if (r.ok){
+        const type = r.headers?.get?.("Content-Type") || "";
+        const etag = r.headers?.get?.("ETag") || null;
+        if (typeof r.arrayBuffer === "function" && !type.includes("json")){
+          const cols = decodeHistoryBinary(await r.arrayBuffer());
+          if (cols) return { cols, etag };
+        }else if (typeof r.json === "function"){
+          return fromJson(await r.json(), etag);
+        }
+      }
+    }catch{}
+
+    const r = await fetch(`/api/history?${query}`, { cache: "no-store", headers });
+    if (r.status === 304) return { notModified: true };
+    if (!r.ok) throw new Error(`${r.status} ${r.statusText}`);
+    return fromJson(await r.json(), r.headers?.get?.("ETag") || null);
+  }
+
   function drawSpark(id, data, color, opts={}){
     const canvas = $(id);
     if (!canvas || !data.length) return;
@@ -632,43 +819,72 @@
     const relayStates = {};
     const pollIntervalMs = 2000;
     const staleAfterMs = 10000;
+    // A WebSocket (/api/ws) or Server-Sent Events (/api/events) replace
+    // polling when available
+    const streamHeartbeatTimeoutMs = 40000;  // device sends "ping" every 15 s
+    const streamRetryMs = 60000;             // retry SSE this long after falling back
+    const streamResyncMs = 5 * 60 * 1000;    // full /api/status refresh (RSSI, clock drift)
+    const commandTimeoutMs = 2000;           // WebSocket relay command acknowledgement
+    // Without a stream each poll waits on the device until the status
+    // changes (long poll, answered 304 when the wait ends unchanged)
+    const statusWaitMs = 20000;
+    const liveStatusFields = "time,wifi,sensors,relays,chambers,chart_scales";  // the versioned groups
     let lastOkTs = Date.now();
     let consecutiveErrors = 0;
     let chamberLabels = ["Chamber 1", "Chamber 2"];
     let chartScales = defaultChartScales;
+    let clockBase = null;  // { secs, at } of the last synced /api/status time
+    let statusEtag = null;
+    let lastFullStatusTs = 0;
 
     function setStaleState(on){
       document.body.classList.toggle("stale", !!on);
       if (on) setText("#top-conn", "reconnecting…");
     }
 
-    async function refresh(){
-      const s = await apiGet(`/api/status?ts=${Date.now()}`);
+    // Full status, or with waitMs the next version of the live groups after
+    // the one on screen; false when the device answered that nothing changed
+    async function refresh(waitMs = 0){
+      let url = `/api/status?ts=${Date.now()}`;
+      const headers = {};
+      if (waitMs){
+        url += `&fields=${liveStatusFields}`;
+        if (statusEtag){
+          url += `&wait=${waitMs}`;
+          headers["If-None-Match"] = statusEtag;
+        }
+      }
+      const r = await fetch(url, { cache: "no-store", headers });
+      if (r.status !== 304 && !r.ok) throw new Error(`${r.status} ${r.statusText}`);
 
       lastOkTs = Date.now();
       consecutiveErrors = 0;
       setStaleState(false);
-      updateDeviceClockFromStatus(s);
+      if (r.status === 304){
+        renderClock();
+        return false;
+      }
+      if (waitMs) statusEtag = r.headers?.get?.("ETag") || null;
+      const s = await r.json();
       chamberLabels = deriveChamberLabels(s.chambers);
 
-      const tzLabel = deviceClock.timezoneLabel ? ` (${deviceClock.timezoneLabel})` : "";
-      setText("#top-time", s.time_synced ? `${s.time}${tzLabel}` : "syncing…");
+      if (!waitMs) lastFullStatusTs = Date.now();
+      updateDeviceClockFromStatus(s);
+      const [hh, mm, ss] = String(s.time || "").split(":").map(Number);
+      clockBase = (s.time_synced && [hh, mm, ss].every(Number.isFinite))
+        ? { secs: hh * 3600 + mm * 60 + ss, at: Date.now() }
+        : null;
 
       if (s.wifi?.connected){
         setText("#top-conn", `${s.wifi.ssid} (${s.wifi.rssi} dBm) · ${s.wifi.ip}`);
       } else {
         setText("#top-conn", s.wifi?.mode === "AP" ? "AP mode" : "not connected");
       }
+      renderClock();
 
       setText("#lbl-s1", chamberLabels[0]);
       setText("#lbl-s2", chamberLabels[1]);
 
-      const temp = (s.sensors?.temp_c == null) ? "N/A" : s.sensors.temp_c.toFixed(1);
-      const hum  = (s.sensors?.hum_rh == null) ? "N/A" : Math.round(s.sensors.hum_rh).toString();
-      setText("#v-temp", temp);
-      setText("#v-hum", hum);
-      setText("#v-s1",  (s.sensors?.soil1 ?? 0).toString());
-      setText("#v-s2",  (s.sensors?.soil2 ?? 0).toString());
       setText("#ctl-light1-name", chamberLabels[0]);
       setText("#ctl-light2-name", chamberLabels[1]);
 
@@ -687,18 +903,46 @@
 
       chartScales = resolveChartScales(s.chart_scales);
 
-      pushSpark("temp", sparkData.temp,  s.sensors?.temp_c);
-      pushSpark("hum",  sparkData.hum,   s.sensors?.hum_rh);
-      pushSpark("s1",   sparkData.s1,    s.sensors?.soil1);
-      pushSpark("s2",   sparkData.s2,    s.sensors?.soil2);
+      renderSensors(s.sensors);
+      renderRelays(s.relays, s);
+      return true;
+    }
+
+    // Between /api/status fetches (event stream) the clock runs locally
+    function renderClock(){
+      const tzLabel = deviceClock.timezoneLabel ? ` (${deviceClock.timezoneLabel})` : "";
+      if (!clockBase){
+        setText("#top-time", "syncing…");
+        return;
+      }
+      const secs = (clockBase.secs + Math.floor((Date.now() - clockBase.at) / 1000)) % 86400;
+      const pad = n => String(n).padStart(2, "0");
+      setText("#top-time", `${pad(Math.floor(secs / 3600))}:${pad(Math.floor(secs / 60) % 60)}:${pad(secs % 60)}${tzLabel}`);
+    }
+
+    function renderSensors(sensors){
+      const temp = (sensors?.temp_c == null) ? "N/A" : sensors.temp_c.toFixed(1);
+      const hum  = (sensors?.hum_rh == null) ? "N/A" : Math.round(sensors.hum_rh).toString();
+      setText("#v-temp", temp);
+      setText("#v-hum", hum);
+      setText("#v-s1",  (sensors?.soil1 ?? 0).toString());
+      setText("#v-s2",  (sensors?.soil2 ?? 0).toString());
+
+      pushSpark("temp", sparkData.temp,  sensors?.temp_c);
+      pushSpark("hum",  sparkData.hum,   sensors?.hum_rh);
+      pushSpark("s1",   sparkData.s1,    sensors?.soil1);
+      pushSpark("s2",   sparkData.s2,    sensors?.soil2);
 
       drawSpark("#spark-temp", sparkData.temp, accent, { min: chartScales.tempMin,  max: chartScales.tempMax });
       drawSpark("#spark-hum",  sparkData.hum,  muted,  { min: chartScales.humMin,   max: chartScales.humMax });
       drawSpark("#spark-s1",   sparkData.s1,   accent, { min: 0,  max: 100 });
       drawSpark("#spark-s2",   sparkData.s2,   muted,  { min: 0,  max: 100 });
+    }
 
+    // relays may hold only the relays that changed ("relays" events carry no schedule)
+    function renderRelays(relays, s = {}){
       for (const id of ["light1","light2","fan","pump"]){
-        const r = s.relays?.[id];
+        const r = relays?.[id];
         if (!r) continue;
         relayStates[id] = !!r.state;
         setBadge(id, r.state, r.auto);
@@ -731,12 +975,12 @@
           try{
             const res = await withRelayGuard(
               id,
-              async () => apiGet(`/api/mode?id=${encodeURIComponent(id)}&auto=1`),
+              async () => relayCommand({ op:"mode", id, auto:1 }, `/api/mode?id=${encodeURIComponent(id)}&auto=1`),
               { errorMessage:"Mode change failed" }
             );
             if (res?.changed){
               toast("Mode updated");
-              await refresh();
+              if (!("state" in res)) await refresh();
             }
           }catch{}
         });
@@ -746,12 +990,12 @@
           try{
             const res = await withRelayGuard(
               id,
-              async () => apiGet(`/api/mode?id=${encodeURIComponent(id)}&auto=0`),
+              async () => relayCommand({ op:"mode", id, auto:0 }, `/api/mode?id=${encodeURIComponent(id)}&auto=0`),
               { errorMessage:"Mode change failed" }
             );
             if (res?.changed){
               toast("Mode updated");
-              await refresh();
+              if (!("state" in res)) await refresh();
             }
           }catch{}
         });
@@ -766,12 +1010,12 @@
           try{
             const res = await withRelayGuard(
               id,
-              async () => apiGet(`/api/toggle?id=${encodeURIComponent(id)}`),
+              async () => relayCommand({ op:"toggle", id }, `/api/toggle?id=${encodeURIComponent(id)}`),
               { errorMessage:"Toggle failed" }
             );
             if (res?.changed){
               toast("Toggle sent");
-              await refresh();
+              if (!("state" in res)) await refresh();
             } else if (res?.reason === "AUTO"){
               toast("Switch to MAN to toggle");
             }
@@ -803,6 +1047,8 @@
     let lastHistoryFetch = 0;
     let tempHumChart = null;
     let soilChart = null;
+    let historyView = null;    // arrays shared with the chart datasets
+    let historyCursor = null;  // { seq, boot, tier, etag } of the last history response
     const historyRefreshMs = 60 * 1000;
 
     async function initCharts(opts={}){
@@ -817,13 +1063,26 @@
       const soilCanvas = $("#soilChart");
       chartsLoading = true;
       try{
-        const d = await apiGet(`/api/history?days=${historyRangeDays}&ts=${now}`);
+        const incremental = chartsInit && !force && historyCursor != null;
+        const res = await fetchHistoryColumns(historyRangeDays, now, incremental ? historyCursor : null,
+          historyPointBudget(tempHumCanvas));
         lastHistoryFetch = now;
-        const pts = filterHistoryPoints(d.points || [], historyRangeDays);
-        if (!pts.length) return;
+        if (res.notModified) return;
 
-        const { labels, temps, hums, soil1, soil2, chamberLabels: soilLabels } =
-          prepareHistoryDatasets(pts, statusTimezone, chamberLabels);
+        const cols = res.cols;
+        historyCursor = cols.seq != null ? { seq: cols.seq, boot: cols.boot, tier: cols.tier, etag: res.etag } : null;
+
+        if (incremental && !cols.reset){
+          if (!cols.count || !historyView) return;
+          appendHistoryWindow(historyView, prepareHistoryColumns(cols, statusTimezone, chamberLabels), historyRangeDays);
+          if (tempHumChart && typeof tempHumChart.update === "function") tempHumChart.update();
+          if (soilChart && typeof soilChart.update === "function") soilChart.update();
+          return;
+        }
+        if (!cols.count) return;
+
+        historyView = prepareHistoryColumns(cols, statusTimezone, chamberLabels);
+        const { labels, temps, hums, soil1, soil2, chamberLabels: soilLabels } = historyView;
 
         if (!chartsInit){
           tempHumChart = new Chart(tempHumCanvas.getContext("2d"), {
@@ -882,20 +1141,203 @@
       }
     }
 
+    // Ticks every pollIntervalMs; while the long poll is parked on the
+    // device a tick only advances the clock
+    let pollStarted = 0;
     const poll = async () => {
+      if (pollStarted){
+        renderClock();
+        if (Date.now() - pollStarted > statusWaitMs + staleAfterMs) setStaleState(true);
+        return;
+      }
+      pollStarted = Date.now();
       try{
-        await refresh();
+        // RSSI and clock drift do not move the version: refreshed with the full status
+        await refresh(Date.now() - lastFullStatusTs > streamResyncMs ? 0 : statusWaitMs);
         await initCharts();
       }catch(e){
         consecutiveErrors++;
         if (consecutiveErrors % 3 === 0) toast(`Status failed: ${e.message}`);
         setStaleState(true);
+      }finally{
+        pollStarted = 0;
       }
       if (Date.now() - lastOkTs > staleAfterMs) setStaleState(true);
     };
 
+    // Live updates: the device pushes sensor and relay changes, so an idle
+    // dashboard only receives a heartbeat every 15 s. A WebSocket (/api/ws)
+    // is tried first since it also carries relay commands; if the device
+    // refuses it the page uses the event stream (/api/events). Falls back to
+    // polling when neither is available, the device refuses the stream (all
+    // slots taken) or the heartbeat stops; the stream is retried later.
+    let stream = null;
+    let socket = null;          // the stream, once a WebSocket is open
+    let socketRefused = false;  // use EventSource from now on
+    let pollTimer = null;
+    let lastStreamAttempt = 0;
+    let lastStreamEventTs = 0;
+    let lastResync = 0;
+    let commandSeq = 0;
+    const pendingCommands = new Map();  // seq -> { resolve, reject, timer }
+
+    function startPolling(){
+      if (!pollTimer) pollTimer = setInterval(poll, pollIntervalMs);
+    }
+    function stopPolling(){
+      if (pollTimer) clearInterval(pollTimer);
+      pollTimer = null;
+    }
+    function failCommands(){
+      for (const [seq, p] of pendingCommands){
+        clearTimeout(p.timer);
+        p.reject(new Error("connection lost"));
+        pendingCommands.delete(seq);
+      }
+    }
+    function dropStream(){
+      if (stream) stream.close();
+      stream = socket = null;
+      failCommands();
+      startPolling();
+    }
+
+    const resync = async () => {
+      lastResync = Date.now();
+      try{
+        await refresh();
+      }catch{}
+    };
+
+    const liveHandlers = {
+      sensors: renderSensors,
+      relays:  renderRelays,
+      config:  resync,  // schedules and labels are not streamed
+      ping:    () => {},
+    };
+    function streamSeen(){
+      lastStreamEventTs = lastOkTs = Date.now();
+      consecutiveErrors = 0;
+      setStaleState(false);
+    }
+    function streamOpened(){
+      streamSeen();
+      stopPolling();
+      resync();  // the clock, Wi-Fi and config are not streamed
+    }
+
+    function startSocket(){
+      lastStreamAttempt = Date.now();
+      const scheme = window.location.protocol === "https:" ? "wss" : "ws";
+      const ws = new window.WebSocket(`${scheme}://${window.location.host}/api/ws`);
+      let opened = false;
+      stream = ws;
+      ws.addEventListener("open", () => {
+        if (stream !== ws) return;
+        opened = true;
+        socket = ws;
+        streamOpened();
+      });
+      ws.addEventListener("message", ev => {
+        if (stream !== ws) return;
+        streamSeen();
+        let msg;
+        try{ msg = JSON.parse(ev.data); }catch{ return; }
+        if (msg.type === "ack"){
+          const p = pendingCommands.get(msg.data?.seq);
+          if (!p) return;
+          pendingCommands.delete(msg.data.seq);
+          clearTimeout(p.timer);
+          p.resolve(msg.data);
+          return;
+        }
+        const fn = liveHandlers[msg.type];
+        if (fn) try{ fn(msg.data || {}); }catch{}
+      });
+      ws.addEventListener("close", () => {
+        if (stream !== ws) return;
+        stream = socket = null;
+        failCommands();
+        if (opened){
+          startPolling();
+          return;
+        }
+        // Refused (older firmware, no slot, proxy): the event stream instead
+        socketRefused = true;
+        if (!startStream()) startPolling();
+      });
+      return true;
+    }
+
+    function startStream(){
+      if (!socketRefused && typeof window.WebSocket === "function") return startSocket();
+      if (typeof EventSource !== "function") return false;
+      lastStreamAttempt = Date.now();
+      const es = new EventSource("/api/events");
+      stream = es;
+      es.addEventListener("open", () => {
+        if (stream !== es) return;
+        streamOpened();
+      });
+      for (const [name, fn] of Object.entries(liveHandlers)){
+        es.addEventListener(name, ev => {
+          if (stream !== es) return;
+          streamSeen();
+          try{ fn(ev.data ? JSON.parse(ev.data) : {}); }catch{}
+        });
+      }
+      es.addEventListener("error", () => {
+        if (stream !== es) return;
+        // CLOSED: refused (503) or unauthorised; otherwise the browser reconnects
+        if (es.readyState === 2) dropStream();
+        else setStaleState(true);
+      });
+      return true;
+    }
+
+    // Sends a relay command over the open WebSocket and resolves with the
+    // device's acknowledgement, or null without a socket (the caller then
+    // uses the HTTP endpoint). No HTTP retry after a timeout: the command
+    // may have been applied.
+    function liveCommand(cmd){
+      if (!socket || socket.readyState !== 1) return Promise.resolve(null);
+      const seq = ++commandSeq;
+      return new Promise((resolve, reject) => {
+        const timer = setTimeout(() => {
+          pendingCommands.delete(seq);
+          reject(new Error("no answer"));
+        }, commandTimeoutMs);
+        pendingCommands.set(seq, { resolve, reject, timer });
+        socket.send(JSON.stringify({ ...cmd, seq }));
+      });
+    }
+
+    // The ack holds the relay as driven, so it is rendered without a refresh
+    async function relayCommand(cmd, url){
+      const ack = await liveCommand(cmd);
+      if (!ack) return apiGet(url);
+      if (!ack.ok) throw new Error(ack.error || "refused");
+      renderRelays({ [ack.id]: { state: ack.state, auto: ack.auto } });
+      return ack;
+    }
+
+    function superviseStream(){
+      const now = Date.now();
+      if (stream){
+        if (now - lastStreamEventTs > streamHeartbeatTimeoutMs && now - lastStreamAttempt > streamHeartbeatTimeoutMs) dropStream();
+        else{
+          renderClock();
+          if (now - lastResync > streamResyncMs) resync();
+          initCharts().catch(() => {});
+        }
+      } else if (now - lastStreamAttempt > streamRetryMs){
+        startStream();
+      }
+    }
+
     try{ await poll(); }catch{}
-    setInterval(poll, pollIntervalMs);
+    if (!startStream()) startPolling();
+    setInterval(superviseStream, 1000);
   }
 
   async function initConfig(){
@@ -1096,6 +1538,10 @@
       updateDeviceClockFromStatus,
       buildChamberConfirmMessage,
       prepareHistoryDatasets,
+      prepareHistoryColumns,
+      decodeHistoryBinary,
+      appendHistoryWindow,
+      historyPointBudget,
       filterHistoryPoints,
       resolveChartScales,
       defaultChartScales,
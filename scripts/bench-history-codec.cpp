@@ -0,0 +1,126 @@
+// Compression ratio and decode throughput of the 10-minute history codec.
+//
+//   c++ -std=c++11 -O2 -I. scripts/bench-history-codec.cpp HistoryCodec.cpp -o /tmp/bench-history-codec
+//   /tmp/bench-history-codec [history.json]
+//
+// Pass a recorded /api/history response (curl '<device>/api/history?days=30&tier=10min')
+// to measure real data; without one a synthetic 36-day grow-tent series is
+// used (test/host/historySynth.h). Runs on the host only.
+#include "HistoryBlocks.h"
+#include "HistoryCodec.h"
+#include "test/host/historySynth.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static bool readFile(const char* path, std::string& out) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+  fclose(f);
+  return true;
+}
+
+// Value of "key": in the point object starting at p (NAN for null/missing)
+static double jsonNumber(const char* p, const char* end, const char* key) {
+  char pattern[32];
+  snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+  const char* k = strstr(p, pattern);
+  if (!k || k >= end) return NAN;
+  k += strlen(pattern);
+  if (strncmp(k, "null", 4) == 0) return NAN;
+  return strtod(k, nullptr);
+}
+
+static uint8_t jsonByte(double v, double scale) {
+  return isnan(v) ? HISTORY_SAMPLE_NONE : (uint8_t)lround(v * scale);
+}
+
+// Pulls the points out of an /api/history JSON body
+static void parseHistoryJson(const std::string& body, std::vector<HistorySample>& out) {
+  const char* p = body.c_str();
+  while ((p = strstr(p, "{\"t\":")) != nullptr) {
+    const char* end = strchr(p + 1, '}');
+    if (!end) break;
+    HistorySample s;
+    memset(&s, 0, sizeof(s));
+    const double temp = jsonNumber(p, end, "temp");
+    s.timestamp = (uint32_t)jsonNumber(p, end, "t");
+    s.temp      = isnan(temp) ? HISTORY_SAMPLE_TEMP_NONE : (int16_t)lround(temp * 100.0);
+    s.hum       = jsonByte(jsonNumber(p, end, "hum"), 1.0);
+    s.soil1     = jsonByte(jsonNumber(p, end, "soil1"), 1.0);
+    s.soil2     = jsonByte(jsonNumber(p, end, "soil2"), 1.0);
+    if (jsonNumber(p, end, "l1") > 0) s.relays |= HISTORY_RELAY_LIGHT1;
+    if (jsonNumber(p, end, "l2") > 0) s.relays |= HISTORY_RELAY_LIGHT2;
+    out.push_back(s);
+    p = end;
+  }
+}
+
+int main(int argc, char** argv) {
+  std::vector<HistorySample> samples;
+  const char* source = "synthetic 36 days";
+  if (argc > 1) {
+    std::string body;
+    if (!readFile(argv[1], body)) {
+      fprintf(stderr, "cannot read %s\n", argv[1]);
+      return 1;
+    }
+    parseHistoryJson(body, samples);
+    source = argv[1];
+  } else {
+    HistorySynth synth;
+    for (size_t i = 0; i < 36 * HISTORY_BLOCK_SAMPLES; ++i) samples.push_back(synth.next());
+  }
+  if (samples.size() < HISTORY_BLOCK_SAMPLES) {
+    fprintf(stderr, "need at least %u samples, got %u\n", (unsigned)HISTORY_BLOCK_SAMPLES,
+            (unsigned)samples.size());
+    return 1;
+  }
+
+  // Encode day-sized blocks the way the ring seals them
+  const size_t blocks = samples.size() / HISTORY_BLOCK_SAMPLES;
+  std::vector<std::vector<uint8_t> > encoded(blocks);
+  size_t compressed = 0;
+  for (size_t b = 0; b < blocks; ++b) {
+    const HistorySample* in = &samples[b * HISTORY_BLOCK_SAMPLES];
+    encoded[b].resize(historyBlockEncode(in, HISTORY_BLOCK_SAMPLES, nullptr, 0));
+    historyBlockEncode(in, HISTORY_BLOCK_SAMPLES, encoded[b].data(), encoded[b].size());
+    compressed += encoded[b].size();
+  }
+  const size_t n = blocks * HISTORY_BLOCK_SAMPLES;
+
+  // Decode throughput
+  HistorySample out[HISTORY_BLOCK_SAMPLES];
+  const int rounds = 200;
+  uint32_t sink = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    for (size_t b = 0; b < blocks; ++b) {
+      historyBlockDecode(encoded[b].data(), encoded[b].size(), out, HISTORY_BLOCK_SAMPLES);
+      sink += out[HISTORY_BLOCK_SAMPLES - 1].timestamp;
+    }
+  }
+  const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  const double perDay = (double)compressed / blocks;
+  printf("source:             %s\n", source);
+  printf("samples:            %u in %u blocks\n", (unsigned)n, (unsigned)blocks);
+  printf("raw (24 B, v1):     %u bytes\n", (unsigned)(n * 24));
+  printf("raw (12 B packed):  %u bytes\n", (unsigned)(n * sizeof(HistorySample)));
+  printf("compressed:         %u bytes (%.2f B/sample, %.1fx vs 12 B, %.1fx vs 24 B)\n",
+         (unsigned)compressed, (double)compressed / n, (double)(n * sizeof(HistorySample)) / compressed,
+         (double)(n * 24) / compressed);
+  printf("days per arena:     %.1f (%u bytes)\n", HISTORY_10MIN_ARENA_BYTES / perDay,
+         (unsigned)HISTORY_10MIN_ARENA_BYTES);
+  printf("decode:             %.1f M samples/s on this host (checksum %08x)\n",
+         (double)n * rounds / secs / 1e6, (unsigned)sink);
+  return 0;
+}
@@ -0,0 +1,187 @@
+// Raw partition ring vs. the LittleFS segment journal.
+//
+//   c++ -std=c++11 -O2 -I. -o /tmp/bench-history-partition scripts/bench-history-partition.cpp HistoryPartitionRing.cpp HistoryJournal.cpp
+//   /tmp/bench-history-partition
+//
+// Appends a full 10-minute window (HISTORY_10MIN_SLOTS records) through both
+// backends and times one append and one boot-time restore of each:
+//   partition  HistoryPartitionRing on test/host/historyFlashFile.h (128 KB)
+//   LittleFS   the segment-file pattern of HistoryStorage.cpp on host files:
+//              open/append/close per record, 144 records per segment, oldest
+//              segment removed once the rest cover the window; restore lists
+//              the directory and scans every segment with historyJournalScan()
+// Runs on the host only, where the file system is the kernel's and not
+// LittleFS on SPI flash, so absolute times say little about the ESP32. The
+// byte counts and the number of flash probes at mount are what carry over.
+#include "HistoryBlocks.h"
+#include "HistoryPartitionRing.h"
+#include "test/host/historyFlashFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <dirent.h>
+#include <stdio.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static const size_t PARTITION_BYTES = 0x20000;  // doc/partitions-history.csv
+static const size_t SEGMENT_RECORDS = 144;
+
+static double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static void makeRecord(uint32_t seq, HistoryJournalRecord& rec) {
+  memset(&rec, 0, sizeof(rec));
+  rec.seq = seq;
+  for (size_t i = 0; i < sizeof(rec.payload); ++i) rec.payload[i] = (uint8_t)(seq * 7 + i);
+  historyJournalSealRecord(rec);
+}
+
+static void countRecord(const HistoryJournalRecord&, void* ctx) {
+  ++*static_cast<size_t*>(ctx);
+}
+
+// ===== LittleFS-style segment journal on host files =====
+
+class SegmentJournal {
+ public:
+  explicit SegmentJournal(const std::string& dir) : _dir(dir), _records(0), bytesWritten(0) {
+    mkdir(dir.c_str(), 0755);
+  }
+
+  void append(const HistoryJournalRecord& rec) {
+    if (_segments.empty() || _segments.back().second == SEGMENT_RECORDS) rotate();
+    FILE* f = fopen(path(_segments.back().first).c_str(), "ab");
+    fwrite(&rec, sizeof(rec), 1, f);
+    fclose(f);
+    bytesWritten += sizeof(rec);
+    _segments.back().second++;
+    _records++;
+  }
+
+  // Boot path: list the directory, then read and scan every segment
+  size_t restore() const {
+    std::vector<std::string> names;
+    DIR* d = opendir(_dir.c_str());
+    while (struct dirent* e = readdir(d)) {
+      if (e->d_name[0] != '.') names.push_back(e->d_name);
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());  // segment ids are zero-padded hex
+
+    size_t visited = 0;
+    uint32_t lastSeq = 0;
+    std::vector<uint8_t> buf;
+    for (size_t i = 0; i < names.size(); ++i) {
+      FILE* f = fopen((_dir + "/" + names[i]).c_str(), "rb");
+      HistoryJournalSegmentHeader hdr;
+      if (fread(&hdr, sizeof(hdr), 1, f) == 1 && historyJournalHeaderValid(hdr)) {
+        buf.resize(SEGMENT_RECORDS * sizeof(HistoryJournalRecord));
+        const size_t got = fread(buf.data(), 1, buf.size(), f);
+        historyJournalScan(buf.data(), got, lastSeq, countRecord, &visited);
+      }
+      fclose(f);
+    }
+    return visited;
+  }
+
+  size_t segments() const { return _segments.size(); }
+
+ private:
+  std::string path(uint32_t id) const {
+    char name[16];
+    snprintf(name, sizeof(name), "/%08x.log", (unsigned)id);
+    return _dir + name;
+  }
+
+  void rotate() {
+    while (_segments.size() > 1 && _records - _segments.front().second >= HISTORY_10MIN_SLOTS) {
+      remove(path(_segments.front().first).c_str());
+      _records -= _segments.front().second;
+      _segments.erase(_segments.begin());
+    }
+    const uint32_t id = _segments.empty() ? 1 : _segments.back().first + 1;
+    HistoryJournalSegmentHeader hdr;
+    historyJournalSealHeader(hdr, id);
+    FILE* f = fopen(path(id).c_str(), "wb");
+    fwrite(&hdr, sizeof(hdr), 1, f);
+    fclose(f);
+    bytesWritten += sizeof(hdr);
+    _segments.push_back(std::make_pair(id, (size_t)0));
+  }
+
+  std::string                                  _dir;
+  std::vector<std::pair<uint32_t, size_t> >    _segments;
+  size_t                                       _records;
+
+ public:
+  size_t bytesWritten;
+};
+
+int main() {
+  char tmpl[] = "/tmp/bench-history-partition-XXXXXX";
+  if (!mkdtemp(tmpl)) return 1;
+  const std::string dir = tmpl;
+  const std::string image = dir + "/history.bin";
+  const size_t records = HISTORY_10MIN_SLOTS;
+
+  // Partition ring
+  size_t partErased = 0, partWritten = 0;
+  double partAppendUs;
+  {
+    HistoryFlashFile flash(image.c_str(), PARTITION_BYTES, true);
+    HistoryPartitionRing ring(flash);
+    ring.mount();
+    const auto start = Clock::now();
+    for (uint32_t seq = 1; seq <= records; ++seq) {
+      HistoryJournalRecord rec;
+      makeRecord(seq, rec);
+      ring.append(rec);
+    }
+    partAppendUs = secondsSince(start) * 1e6 / records;
+    partErased   = flash.sectorsErased;
+    partWritten  = flash.bytesWritten;
+  }
+  HistoryFlashFile flash(image.c_str(), PARTITION_BYTES, false);
+  HistoryPartitionRing ring(flash);
+  const auto partBoot = Clock::now();
+  ring.mount();
+  const size_t probes = ring.mountReads();
+  size_t partVisited = 0;
+  uint32_t lastSeq = 0;
+  ring.replay(lastSeq, countRecord, &partVisited);
+  const double partBootMs = secondsSince(partBoot) * 1e3;
+
+  // LittleFS-style segments
+  SegmentJournal journal(dir + "/histlog");
+  const auto segStart = Clock::now();
+  for (uint32_t seq = 1; seq <= records; ++seq) {
+    HistoryJournalRecord rec;
+    makeRecord(seq, rec);
+    journal.append(rec);
+  }
+  const double segAppendUs = secondsSince(segStart) * 1e6 / records;
+  const auto segBoot = Clock::now();
+  const size_t segVisited = journal.restore();
+  const double segBootMs = secondsSince(segBoot) * 1e3;
+
+  printf("%u records of %u bytes\n", (unsigned)records, (unsigned)sizeof(HistoryJournalRecord));
+  printf("%-10s %10s %10s %10s %12s\n", "backend", "append us", "boot ms", "restored", "bytes out");
+  printf("%-10s %10.2f %10.3f %10u %12u\n", "partition", partAppendUs, partBootMs,
+         (unsigned)partVisited, (unsigned)partWritten);
+  printf("%-10s %10.2f %10.3f %10u %12u\n", "littlefs", segAppendUs, segBootMs,
+         (unsigned)segVisited, (unsigned)journal.bytesWritten);
+  printf("partition: %u sectors, %u erased, head %u/%u found with %u probes\n",
+         (unsigned)ring.sectors(), (unsigned)partErased, (unsigned)ring.headSector(),
+         (unsigned)ring.headSlot(), (unsigned)probes);
+  printf("littlefs:  %u segment files at the end (each open/close also rewrites LittleFS metadata)\n",
+         (unsigned)journal.segments());
+
+  std::string cmd = "rm -rf " + dir;
+  return system(cmd.c_str()) == 0 ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+// Range-aggregate index vs. linear scan over the 10-minute ring.
+//
+//   c++ -std=c++11 -O2 -I. -o /tmp/bench-history-stats scripts/bench-history-stats.cpp HistoryStats.cpp HistoryBlocks.cpp HistoryCodec.cpp
+//   /tmp/bench-history-stats
+//
+// Fills the ring with a synthetic 36-day series (test/host/historySynth.h),
+// then times /api/history/stats-style queries (last 24 h, last 7 days, whole
+// ring, random windows) through historyRingStats() and through a scan of
+// every sample, and the cost of the incremental update per pushed sample.
+// Runs on the host only; on the ESP32 both paths are slower by a similar
+// factor, so the ratio is what matters.
+#include "HistoryBlocks.h"
+#include "HistoryStats.h"
+#include "test/host/historySynth.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static void scanStats(uint32_t from, uint32_t to, HistoryStats& out) {
+  historyStatsReset(out);
+  const size_t n = historyRingCount();
+  for (size_t i = 0; i < n; ++i) {
+    HistorySample s;
+    if (historyRingRead(i, s)) historyStatsAddSample(out, s, from, to);
+  }
+}
+
+struct Window {
+  const char* name;
+  uint32_t    from;
+  uint32_t    to;
+};
+
+template <typename Query>
+static double microsPerQuery(const std::vector<Window>& windows, int rounds, Query query, uint32_t& sink) {
+  const auto start = Clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    for (size_t w = 0; w < windows.size(); ++w) {
+      HistoryStats stats;
+      query(windows[w].from, windows[w].to, stats);
+      sink += stats.samples;
+    }
+  }
+  const double secs = std::chrono::duration<double>(Clock::now() - start).count();
+  return secs * 1e6 / (rounds * windows.size());
+}
+
+int main() {
+  HistorySynth synth;
+  historyRingClear();
+  const size_t pushes = HISTORY_10MIN_SLOTS + 77;  // leaves a partly filled open block
+  const auto pushStart = Clock::now();
+  for (size_t i = 0; i < pushes; ++i) historyRingPush(synth.next());
+  const double pushNs = std::chrono::duration<double>(Clock::now() - pushStart).count() * 1e9 / pushes;
+
+  HistorySample first, last;
+  historyRingRead(0, first);
+  historyRingRead(historyRingCount() - 1, last);
+
+  std::vector<Window> named;
+  named.push_back(Window{ "last 24 h", last.timestamp - 86400U, last.timestamp });
+  named.push_back(Window{ "last 7 days", last.timestamp - 7 * 86400U, last.timestamp });
+  named.push_back(Window{ "whole ring", first.timestamp, last.timestamp });
+
+  uint32_t rng = 99, sink = 0;
+  std::vector<Window> random;
+  for (int i = 0; i < 256; ++i) {
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    const uint32_t a = first.timestamp + rng % (last.timestamp - first.timestamp);
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    const uint32_t b = first.timestamp + rng % (last.timestamp - first.timestamp);
+    random.push_back(Window{ "random", a < b ? a : b, a < b ? b : a });
+  }
+
+  printf("ring: %u samples, %u sealed blocks, push incl. summary update %.0f ns/sample\n",
+         (unsigned)historyRingCount(), (unsigned)historyRingSealedBlocks(), pushNs);
+  printf("%-12s %10s %10s %8s\n", "window", "index us", "scan us", "speedup");
+  for (size_t w = 0; w <= named.size(); ++w) {
+    const bool rnd = (w == named.size());
+    std::vector<Window> set = rnd ? random : std::vector<Window>(1, named[w]);
+    const int rounds = rnd ? 20 : 2000;
+    const double fast = microsPerQuery(set, rounds, historyRingStats, sink);
+    const double slow = microsPerQuery(set, rounds / 10 + 1, scanStats, sink);
+    printf("%-12s %10.2f %10.2f %7.1fx\n", rnd ? "random x256" : named[w].name, fast, slow, slow / fast);
+  }
+  printf("(checksum %u)\n", (unsigned)sink);
+  return 0;
+}
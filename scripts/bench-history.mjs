@@ -0,0 +1,110 @@
+#!/usr/bin/env node
+// Benchmarks /api/history on a running controller.
+//
+//   node scripts/bench-history.mjs --url http://192.168.1.50 [--compare http://192.168.1.51]
+//                                  [--user admin --pass admin] [--runs 10] [--days 1,7]
+//                                  [--routes /api/history,/api/history.bin]
+//                                  [--points 300] [--serial-log serial.txt]
+//
+// Reports time-to-first-byte, total time and payload size per route and
+// range. Pass --compare to benchmark a second device (e.g. one still running
+// the previous firmware) side by side. Heap usage is only visible on the
+// device: capture the serial console while the benchmark runs and pass it via
+// --serial-log to summarize the "[WEB] /api/history ... heap_low=" lines.
+
+import { readFileSync } from 'node:fs';
+import { performance } from 'node:perf_hooks';
+
+function parseArgs(argv){
+  const args = { runs: 10, days: [1, 7], user: '', pass: '', routes: ['/api/history', '/api/history.bin'] };
+  for (let i = 0; i < argv.length; i++){
+    const key = argv[i];
+    const val = argv[i + 1];
+    switch (key){
+      case '--url': args.url = val; i++; break;
+      case '--compare': args.compare = val; i++; break;
+      case '--user': args.user = val; i++; break;
+      case '--pass': args.pass = val; i++; break;
+      case '--runs': args.runs = Math.max(1, parseInt(val, 10) || 1); i++; break;
+      case '--days': args.days = val.split(',').map(v => parseInt(v, 10)).filter(Boolean); i++; break;
+      case '--routes': args.routes = val.split(',').filter(Boolean); i++; break;
+      case '--points': args.points = Math.max(0, parseInt(val, 10) || 0); i++; break;
+      case '--serial-log': args.serialLog = val; i++; break;
+      default:
+        throw new Error(`Unknown argument: ${key}`);
+    }
+  }
+  if (!args.url) throw new Error('--url is required');
+  return args;
+}
+
+async function measure(base, route, days, headers, args){
+  const points = args.points ? `&points=${args.points}` : '';
+  const url = `${base.replace(/\/$/, '')}${route}?days=${days}${points}&ts=${Date.now()}`;
+  const start = performance.now();
+  const res = await fetch(url, { headers });
+  if (!res.ok) throw new Error(`${url}: HTTP ${res.status}`);
+  const reader = res.body.getReader();
+  let ttfb = null;
+  let bytes = 0;
+  for (;;){
+    const { done, value } = await reader.read();
+    if (done) break;
+    if (ttfb === null) ttfb = performance.now() - start;
+    bytes += value.length;
+  }
+  return { ttfb: ttfb ?? performance.now() - start, total: performance.now() - start, bytes };
+}
+
+const median = values => {
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+};
+
+async function bench(label, base, args){
+  const headers = {};
+  if (args.user){
+    headers.Authorization = 'Basic ' + Buffer.from(`${args.user}:${args.pass}`).toString('base64');
+  }
+  for (const route of args.routes){
+    for (const days of args.days){
+      const samples = [];
+      for (let i = 0; i < args.runs; i++){
+        samples.push(await measure(base, route, days, headers, args));
+      }
+      console.log(
+        `${label.padEnd(9)} ${route.padEnd(18)} days=${days}  ttfb p50=${median(samples.map(s => s.ttfb)).toFixed(1)} ms` +
+        `  total p50=${median(samples.map(s => s.total)).toFixed(1)} ms` +
+        `  bytes=${samples[samples.length - 1].bytes}`
+      );
+    }
+  }
+}
+
+function summarizeSerialLog(path){
+  const lines = readFileSync(path, 'utf8').split(/\r?\n/);
+  const byRoute = new Map();
+  for (const line of lines){
+    const m = /\[WEB\] (\/api\/history\S*) days=(\d+) points=(\d+) bytes=(\d+) ms=(\d+) heap_low=(\d+)/.exec(line);
+    if (!m) continue;
+    const key = `${m[1]} days=${m[2]}`;
+    const entry = byRoute.get(key) || { points: 0, bytes: 0, heapLow: Infinity, ms: [] };
+    entry.points = Number(m[3]);
+    entry.bytes = Number(m[4]);
+    entry.heapLow = Math.min(entry.heapLow, Number(m[6]));
+    entry.ms.push(Number(m[5]));
+    byRoute.set(key, entry);
+  }
+  if (byRoute.size === 0){
+    console.log('serial    no streaming log lines found (previous firmware does not log them)');
+    return;
+  }
+  for (const [key, entry] of byRoute){
+    console.log(`serial    ${key}  points=${entry.points}  bytes=${entry.bytes}  device ms p50=${median(entry.ms)}  min free heap=${entry.heapLow} B`);
+  }
+}
+
+const args = parseArgs(process.argv.slice(2));
+await bench('device', args.url, args);
+if (args.compare) await bench('compare', args.compare, args);
+if (args.serialLog) summarizeSerialLog(args.serialLog);
@@ -0,0 +1,284 @@
+// String-concatenated page rendering vs. typed templates into a fixed chunk.
+//
+//   c++ -std=c++11 -O2 -I. -o /tmp/bench-html-template scripts/bench-html-template.cpp
+//   /tmp/bench-html-template
+//
+// Renders the grow-profile part of the /config page (preset table and one
+// editor card per preset, the densest markup in WebUI.cpp) two ways:
+//   string    the previous WebUI.cpp pattern: a reserved page String grown
+//             with += and "..." + htmlEscape(v) + "..." temporaries, sent
+//             in one piece
+//   template  htmlWrite() into a 1 KB chunk that is handed to the (dummy)
+//             server whenever it fills, as PageWriter does
+// and reports time and heap allocations (operator new) per page. The host
+// std::string stands in for Arduino's String, whose growth policy differs, so
+// the allocation counts are indicative; the template path allocates nothing
+// on either.
+#include "HtmlTemplate.h"
+
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+typedef std::chrono::steady_clock Clock;
+
+static size_t sAllocs = 0;
+static size_t sAllocBytes = 0;
+
+void* operator new(size_t n) {
+  sAllocs++;
+  sAllocBytes += n;
+  if (void* p = malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+
+// ===== Sample data (shaped like GrowProfileInfo) =====
+
+struct Preset {
+  std::string label;
+  int   c1Dry, c1Wet, c2Dry, c2Wet;
+  int   l1On, l1Off, l2On, l2Off;
+  bool  l1Auto, l2Auto;
+  float fanOn, fanOff;
+  int   humOn, humOff, pumpOff, pumpOn;
+  bool  setsFan, setsPump, autoFan, autoPump;
+};
+
+static const Preset kPresets[] = {
+  { "Custom/manual", 35, 55, 35, 55, 360, 1320, 360, 1320, true, true, 27.5f, 25.0f, 75, 65, 600, 20, false, false, false, false },
+  { "Seedling",      45, 65, 45, 65, 360, 1320, 360, 1320, true, true, 26.0f, 24.0f, 80, 70, 900, 15, true, true, true, true },
+  { "Vegetative",    40, 60, 40, 60, 300, 1380, 300, 1380, true, true, 28.0f, 26.0f, 70, 60, 600, 20, true, true, true, true },
+  { "Flowering",     35, 55, 35, 55, 480, 1200, 480, 1200, true, true, 27.0f, 25.0f, 60, 50, 600, 25, true, true, true, false },
+  { "Drying <& 'cure'>", 0, 5, 0, 5, 0, 0, 0, 0, false, false, 22.0f, 20.0f, 60, 55, 3600, 5, true, true, true, false },
+};
+static const size_t kPresetCount = sizeof(kPresets) / sizeof(kPresets[0]);
+
+// ===== Previous pattern =====
+
+static std::string str(int v) { return std::to_string(v); }
+static std::string str(float v, int decimals) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.*f", decimals, (double)v);
+  return buf;
+}
+static std::string timeStr(int mins) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%02d:%02d", mins / 60, mins % 60);
+  return buf;
+}
+static std::string htmlEscape(const std::string& in) {
+  std::string s;
+  s.reserve(in.length() + 8);
+  for (size_t i = 0; i < in.length(); i++) {
+    switch (in[i]) {
+      case '&': s += "&amp;"; break;
+      case '<': s += "&lt;"; break;
+      case '>': s += "&gt;"; break;
+      case '"': s += "&quot;"; break;
+      case '\'': s += "&#39;"; break;
+      default: s += in[i]; break;
+    }
+  }
+  return s;
+}
+static std::string autoChange(bool applies, bool a) { return applies ? (a ? "AUTO" : "MAN") : "—"; }
+
+static size_t renderString() {
+  std::string page;
+  page.reserve(12000);
+  for (size_t i = 0; i < kPresetCount; i++) {
+    const Preset& p = kPresets[i];
+    page += "<tr class='preset-row' data-preset-label='" + htmlEscape(p.label) + "'";
+    page += " data-l1-on='" + timeStr(p.l1On) + "'";
+    page += " data-l1-off='" + timeStr(p.l1Off) + "'";
+    page += " data-l2-on='" + timeStr(p.l2On) + "'";
+    page += " data-l2-off='" + timeStr(p.l2Off) + "'>";
+    page += "<td>" + htmlEscape(p.label) + "</td>";
+    page += "<td>" + str(p.c1Dry) + " / " + str(p.c1Wet) + "</td>";
+    page += "<td>" + str(p.c2Dry) + " / " + str(p.c2Wet) + "</td>";
+    page += "<td class='preset-schedules'>L1 " + timeStr(p.l1On) + "–" + timeStr(p.l1Off) +
+            " · L2 " + timeStr(p.l2On) + "–" + timeStr(p.l2Off) + "</td>";
+    page += "<td>" + str(p.fanOn, 1) + " / " + str(p.fanOff, 1) + "</td>";
+    page += "<td>" + str(p.humOn) + " / " + str(p.humOff) + "</td>";
+    page += "<td>" + str(p.pumpOff) + " / " + str(p.pumpOn) + "</td>";
+    page += "<td><div class='automation-pills'>";
+    page += "<span class='mode-pill " + std::string(p.setsFan && p.autoFan ? "mode-auto" : "mode-manual") + "'>Fan: " + autoChange(p.setsFan, p.autoFan) + "</span>";
+    page += "<span class='mode-pill " + std::string(p.setsPump && p.autoPump ? "mode-auto" : "mode-manual") + "'>Pump: " + autoChange(p.setsPump, p.autoPump) + "</span>";
+    page += "</div></td></tr>";
+  }
+  for (size_t i = 1; i < kPresetCount; i++) {
+    const Preset& p = kPresets[i];
+    const std::string idx = str((int)i);
+    page += "<div class='grow-card' data-profile-edit='" + idx + "'>";
+    page += "<div class='grow-card-head'>";
+    page += "<div><div class='eyebrow'>Preset</div><div class='grow-card-title'>" + htmlEscape(p.label) + "</div><div class='sub'>Update the values used when applying this preset.</div></div>";
+    page += "<div class='mode-pill-row'><span class='mode-pill mode-auto'>" + htmlEscape(p.label) + "</span></div>";
+    page += "</div>";
+    page += "<div class='form-grid'>";
+    page += "<div class='field'><label>Preset label</label><input type='text' name='gp" + idx + "_label' maxlength='24' value='" + htmlEscape(p.label) + "'><div class='small'>Shown in selectors and dashboard.</div></div>";
+    page += "<div class='field'><label>Ch1 DRY (%)</label><input type='number' step='1' name='gp" + idx + "_c1_dry' value='" + str(p.c1Dry) + "'></div>";
+    page += "<div class='field'><label>Ch1 WET (%)</label><input type='number' step='1' name='gp" + idx + "_c1_wet' value='" + str(p.c1Wet) + "'></div>";
+    page += "<div class='field'><label>Ch2 DRY (%)</label><input type='number' step='1' name='gp" + idx + "_c2_dry' value='" + str(p.c2Dry) + "'></div>";
+    page += "<div class='field'><label>Ch2 WET (%)</label><input type='number' step='1' name='gp" + idx + "_c2_wet' value='" + str(p.c2Wet) + "'></div>";
+    page += "<div class='field'><label>Light 1 ON</label><input type='time' name='gp" + idx + "_l1_on' value='" + timeStr(p.l1On) + "'></div>";
+    page += "<div class='field'><label>Light 1 OFF</label><input type='time' name='gp" + idx + "_l1_off' value='" + timeStr(p.l1Off) + "'></div>";
+    page += "<div class='field'><label>Light 1 mode</label><label><input type='checkbox' name='gp" + idx + "_l1_auto' value='1'";
+    if (p.l1Auto) page += " checked";
+    page += "> Use schedule</label><div class='small'>Unchecked sets MAN mode.</div></div>";
+    page += "<div class='field'><label>Light 2 ON</label><input type='time' name='gp" + idx + "_l2_on' value='" + timeStr(p.l2On) + "'></div>";
+    page += "<div class='field'><label>Light 2 OFF</label><input type='time' name='gp" + idx + "_l2_off' value='" + timeStr(p.l2Off) + "'></div>";
+    page += "<div class='field'><label>Light 2 mode</label><label><input type='checkbox' name='gp" + idx + "_l2_auto' value='1'";
+    if (p.l2Auto) page += " checked";
+    page += "> Use schedule</label><div class='small'>Unchecked sets MAN mode.</div></div>";
+    page += "<div class='field'><label>Fan ON temp (°C)</label><input type='number' step='0.1' name='gp" + idx + "_fan_on' value='" + str(p.fanOn, 1) + "'></div>";
+    page += "<div class='field'><label>Fan OFF temp (°C)</label><input type='number' step='0.1' name='gp" + idx + "_fan_off' value='" + str(p.fanOff, 1) + "'></div>";
+    page += "<div class='field'><label>Fan ON humidity (%RH)</label><input type='number' step='1' name='gp" + idx + "_hum_on' value='" + str(p.humOn) + "'></div>";
+    page += "<div class='field'><label>Fan OFF humidity (%RH)</label><input type='number' step='1' name='gp" + idx + "_hum_off' value='" + str(p.humOff) + "'></div>";
+    page += "<div class='field'><label>Pump minimum OFF (s)</label><input type='number' step='1' name='gp" + idx + "_pump_off' value='" + str(p.pumpOff) + "'></div>";
+    page += "<div class='field'><label>Pump maximum ON (s)</label><input type='number' step='1' name='gp" + idx + "_pump_on' value='" + str(p.pumpOn) + "'></div>";
+    page += "</div>";
+    page += "</div>";
+  }
+  return page.size();
+}
+
+// ===== Typed templates =====
+
+struct TimeOfDay {
+  int minutes;
+};
+
+template <>
+struct HtmlFormat<TimeOfDay> {
+  template <typename Out>
+  static void put(Out& out, const TimeOfDay& t) {
+    const char buf[5] = { (char)('0' + t.minutes / 600), (char)('0' + t.minutes / 60 % 10), ':',
+                          (char)('0' + t.minutes % 60 / 10), (char)('0' + t.minutes % 10) };
+    out.write(buf, sizeof(buf));
+  }
+};
+
+static TimeOfDay tod(int mins) { return TimeOfDay{ mins }; }
+
+static size_t sSent = 0;
+
+// PageWriter without the server: full chunks are only counted
+struct ChunkSink {
+  char   chunk[1024];
+  size_t used;
+
+  ChunkSink() : used(0) {}
+  void write(const char* data, size_t len) {
+    while (len > 0) {
+      if (used == sizeof(chunk)) flush();
+      size_t n = sizeof(chunk) - used;
+      if (n > len) n = len;
+      memcpy(chunk + used, data, n);
+      used += n;
+      data += n;
+      len  -= n;
+    }
+  }
+  void flush() {
+    sSent += used;
+    used = 0;
+  }
+};
+
+static size_t renderTemplate() {
+  ChunkSink page;
+  sSent = 0;
+  for (size_t i = 0; i < kPresetCount; i++) {
+    const Preset& p = kPresets[i];
+    htmlWrite(page,
+      "<tr class='preset-row' data-preset-label='", htmlEsc(p.label), "'"
+      " data-l1-on='", tod(p.l1On), "'"
+      " data-l1-off='", tod(p.l1Off), "'"
+      " data-l2-on='", tod(p.l2On), "'"
+      " data-l2-off='", tod(p.l2Off), "'>"
+      "<td>", htmlEsc(p.label), "</td>"
+      "<td>", p.c1Dry, " / ", p.c1Wet, "</td>"
+      "<td>", p.c2Dry, " / ", p.c2Wet, "</td>"
+      "<td class='preset-schedules'>L1 ", tod(p.l1On), "–", tod(p.l1Off),
+      " · L2 ", tod(p.l2On), "–", tod(p.l2Off), "</td>"
+      "<td>", htmlFixed(p.fanOn, 1), " / ", htmlFixed(p.fanOff, 1), "</td>"
+      "<td>", p.humOn, " / ", p.humOff, "</td>"
+      "<td>", p.pumpOff, " / ", p.pumpOn, "</td>"
+      "<td><div class='automation-pills'>"
+      "<span class='mode-pill ", htmlIf(p.setsFan && p.autoFan, "mode-auto", "mode-manual"), "'>Fan: ",
+      htmlIf(p.setsFan, p.autoFan ? "AUTO" : "MAN", "—"), "</span>"
+      "<span class='mode-pill ", htmlIf(p.setsPump && p.autoPump, "mode-auto", "mode-manual"), "'>Pump: ",
+      htmlIf(p.setsPump, p.autoPump ? "AUTO" : "MAN", "—"), "</span>"
+      "</div></td></tr>");
+  }
+  for (size_t i = 1; i < kPresetCount; i++) {
+    const Preset& p = kPresets[i];
+    auto number = [&](const char* label, const char* key, int value) {
+      htmlWrite(page, "<div class='field'><label>", label, "</label><input type='number' step='1' name='gp", i, '_', key,
+                "' value='", value, "'></div>");
+    };
+    auto decimal = [&](const char* label, const char* key, float value) {
+      htmlWrite(page, "<div class='field'><label>", label, "</label><input type='number' step='0.1' name='gp", i, '_', key,
+                "' value='", htmlFixed(value, 1), "'></div>");
+    };
+    auto time = [&](const char* label, const char* key, int minutes) {
+      htmlWrite(page, "<div class='field'><label>", label, "</label><input type='time' name='gp", i, '_', key,
+                "' value='", tod(minutes), "'></div>");
+    };
+    htmlWrite(page,
+      "<div class='grow-card' data-profile-edit='", i, "'>"
+      "<div class='grow-card-head'>"
+      "<div><div class='eyebrow'>Preset</div><div class='grow-card-title'>", htmlEsc(p.label), "</div>"
+      "<div class='sub'>Update the values used when applying this preset.</div></div>"
+      "<div class='mode-pill-row'><span class='mode-pill mode-auto'>", htmlEsc(p.label), "</span></div>"
+      "</div>"
+      "<div class='form-grid'>"
+      "<div class='field'><label>Preset label</label><input type='text' name='gp", i, "_label' maxlength='24' value='",
+      htmlEsc(p.label), "'><div class='small'>Shown in selectors and dashboard.</div></div>");
+    number("Ch1 DRY (%)", "c1_dry", p.c1Dry);
+    number("Ch1 WET (%)", "c1_wet", p.c1Wet);
+    number("Ch2 DRY (%)", "c2_dry", p.c2Dry);
+    number("Ch2 WET (%)", "c2_wet", p.c2Wet);
+    time("Light 1 ON", "l1_on", p.l1On);
+    time("Light 1 OFF", "l1_off", p.l1Off);
+    htmlWrite(page, "<div class='field'><label>Light 1 mode</label><label><input type='checkbox' name='gp", i,
+              "_l1_auto' value='1'", htmlIf(p.l1Auto, " checked"),
+              "> Use schedule</label><div class='small'>Unchecked sets MAN mode.</div></div>");
+    time("Light 2 ON", "l2_on", p.l2On);
+    time("Light 2 OFF", "l2_off", p.l2Off);
+    htmlWrite(page, "<div class='field'><label>Light 2 mode</label><label><input type='checkbox' name='gp", i,
+              "_l2_auto' value='1'", htmlIf(p.l2Auto, " checked"),
+              "> Use schedule</label><div class='small'>Unchecked sets MAN mode.</div></div>");
+    decimal("Fan ON temp (°C)", "fan_on", p.fanOn);
+    decimal("Fan OFF temp (°C)", "fan_off", p.fanOff);
+    number("Fan ON humidity (%RH)", "hum_on", p.humOn);
+    number("Fan OFF humidity (%RH)", "hum_off", p.humOff);
+    number("Pump minimum OFF (s)", "pump_off", p.pumpOff);
+    number("Pump maximum ON (s)", "pump_on", p.pumpOn);
+    htmlWrite(page, "</div></div>");
+  }
+  page.flush();
+  return sSent;
+}
+
+template <typename Render>
+static void bench(const char* name, Render render) {
+  const int rounds = 2000;
+  size_t bytes = render();  // warm-up
+  sAllocs = sAllocBytes = 0;
+  const auto start = Clock::now();
+  for (int r = 0; r < rounds; ++r) bytes = render();
+  const double us = std::chrono::duration<double>(Clock::now() - start).count() * 1e6 / rounds;
+  printf("%-10s %8u %10.2f %12.1f %14.0f\n", name, (unsigned)bytes, us,
+         (double)sAllocs / rounds, (double)sAllocBytes / rounds);
+}
+
+int main() {
+  printf("%-10s %8s %10s %12s %14s\n", "renderer", "bytes", "us/page", "allocs/page", "alloc B/page");
+  bench("string", renderString);
+  bench("template", renderTemplate);
+  return 0;
+}
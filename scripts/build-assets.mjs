@@ -0,0 +1,43 @@
+#!/usr/bin/env node
+// Prepares the static assets in data/ for the LittleFS upload.
+//
+//   node scripts/build-assets.mjs          (or: npm run build:assets)
+//
+// Writes:
+//   <asset>.gz          gzip variants of the text assets; streamStaticFile()
+//                       serves them to clients that send
+//                       "Accept-Encoding: gzip" and the plain file to
+//                       everyone else, so both are uploaded.
+//   asset-manifest.txt  "<file> <hash>" per asset (first 16 hex digits of the
+//                       SHA-256 of the plain file). The firmware links
+//                       /app.<hash>.js etc. and serves those URLs as
+//                       immutable; the hash doubles as the ETag.
+//
+// Run this after editing app.js or app.css or replacing Chart.js or the
+// logo; test/staticAssetsRoutes.test.js fails while the output is out of
+// date. The output is deterministic (no file name or timestamp in the gzip
+// header).
+
+import { readFileSync, writeFileSync } from 'node:fs';
+import { createHash } from 'node:crypto';
+import { gzipSync, constants } from 'node:zlib';
+
+const GZIP_ASSETS = ['chart.umd.min.js', 'app.js', 'app.css'];
+const HASHED_ASSETS = ['chart.umd.min.js', 'app.js', 'app.css', 'logo-ezgrow.png'];
+
+const dataDir = new URL('../data/', import.meta.url);
+
+for (const name of GZIP_ASSETS){
+  const plain = readFileSync(new URL(name, dataDir));
+  const gz = gzipSync(plain, { level: constants.Z_BEST_COMPRESSION });
+  writeFileSync(new URL(`${name}.gz`, dataDir), gz);
+  const pct = (100 * gz.length / plain.length).toFixed(1);
+  console.log(`data/${name}.gz  ${plain.length} -> ${gz.length} bytes (${pct} %)`);
+}
+
+const manifest = HASHED_ASSETS.map(name => {
+  const hash = createHash('sha256').update(readFileSync(new URL(name, dataDir))).digest('hex').slice(0, 16);
+  return `${name} ${hash}\n`;
+}).join('');
+writeFileSync(new URL('asset-manifest.txt', dataDir), manifest);
+process.stdout.write(`data/asset-manifest.txt\n${manifest}`);
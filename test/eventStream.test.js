@@ -0,0 +1,246 @@
+import test from 'node:test';
+import { strict as assert } from 'node:assert';
+import { readFileSync } from 'node:fs';
+import { JSDOM } from 'jsdom';
+
+const statusPayload = {
+  time:"10:00:00",
+  time_synced:true,
+  timezone:"UTC",
+  timezone_iana:"Etc/UTC",
+  wifi:{ connected:false, mode:"AP" },
+  sensors:{ temp_c:22.3, hum_rh:55, soil1:30, soil2:40 },
+  chambers:[{ id:1, name:"Herbs" }, { id:2, name:"" }],
+  relays:{
+    light1:{ state:1, auto:1, schedule:"08:00–20:00" },
+    light2:{ state:0, auto:0, schedule:"20:00–06:00" },
+    fan:{ state:0, auto:1 },
+    pump:{ state:0, auto:1 }
+  }
+};
+
+class FakeEventSource {
+  constructor(url){
+    this.url = url;
+    this.readyState = 0;
+    this.listeners = {};
+    this.closed = false;
+    FakeEventSource.instances.push(this);
+  }
+  addEventListener(name, fn){
+    (this.listeners[name] ||= []).push(fn);
+  }
+  close(){
+    this.closed = true;
+    this.readyState = 2;
+  }
+  emit(name, data){
+    for (const fn of this.listeners[name] || []) fn({ data: data === undefined ? "" : JSON.stringify(data) });
+  }
+}
+FakeEventSource.instances = [];
+
+class FakeWebSocket {
+  constructor(url){
+    this.url = url;
+    this.readyState = 0;
+    this.listeners = {};
+    this.sent = [];
+    FakeWebSocket.instances.push(this);
+  }
+  addEventListener(name, fn){
+    (this.listeners[name] ||= []).push(fn);
+  }
+  send(text){
+    this.sent.push(JSON.parse(text));
+  }
+  close(){
+    this.readyState = 3;
+  }
+  emit(name, data){
+    for (const fn of this.listeners[name] || []) fn({ data: data === undefined ? "" : JSON.stringify(data) });
+  }
+}
+FakeWebSocket.instances = [];
+
+function setupDashboard({ withEventSource, withWebSocket = false, fetchImpl = null }){
+  const html = "<!doctype html><body data-page='dashboard'>" +
+    "<div id='v-temp'></div><div id='v-hum'></div><div id='v-s1'></div><div id='v-s2'></div>" +
+    "<span id='b-fan'></span><span id='m-fan'></span><div id='top-time'></div>" +
+    "<button id='tog-fan'></button>" +
+    "</body>";
+  const dom = new JSDOM(html, { url:"http://localhost" });
+  const { window } = dom;
+  const intervals = [];
+  const fetches = [];
+  window.requestAnimationFrame = cb => setTimeout(cb, 0);
+  window.setInterval = (fn, ms) => { intervals.push({ fn, ms }); return intervals.length; };
+  window.clearInterval = id => { if (intervals[id - 1]) intervals[id - 1].cleared = true; };
+  window.getComputedStyle = () => ({ getPropertyValue: () => "" });
+  window.fetch = async (url, opts) => {
+    fetches.push(String(url));
+    if (fetchImpl) return fetchImpl(String(url), opts || {});
+    if (String(url).startsWith('/api/status')) return { ok:true, json: async () => statusPayload };
+    return { ok:true, json: async () => ({}) };
+  };
+  window.confirm = () => true;
+  window.EventSource = withEventSource ? FakeEventSource : undefined;
+  window.WebSocket = withWebSocket ? FakeWebSocket : undefined;
+
+  globalThis.window = window;
+  globalThis.document = window.document;
+  globalThis.requestAnimationFrame = window.requestAnimationFrame;
+  globalThis.localStorage = window.localStorage;
+  globalThis.fetch = window.fetch;
+  globalThis.confirm = window.confirm;
+  globalThis.getComputedStyle = window.getComputedStyle;
+  globalThis.setInterval = window.setInterval;
+  globalThis.clearInterval = window.clearInterval;
+  globalThis.EventSource = window.EventSource;
+
+  const script = readFileSync(new URL('../data/app.js', import.meta.url), 'utf8');
+  window.eval(script);
+  window.document.dispatchEvent(new window.Event('DOMContentLoaded', { bubbles:true }));
+  return { dom, intervals, fetches };
+}
+
+const tick = () => new Promise(res => setTimeout(res, 10));
+const polling = intervals => intervals.some(i => i.ms === 2000 && !i.cleared);
+
+test('dashboard renders pushed events and does not poll while the stream is open', async () => {
+  FakeEventSource.instances = [];
+  const { dom, intervals, fetches } = setupDashboard({ withEventSource:true });
+  await tick();
+
+  assert.equal(FakeEventSource.instances.length, 1);
+  const es = FakeEventSource.instances[0];
+  assert.equal(es.url, "/api/events");
+  assert.equal(polling(intervals), false);
+
+  es.readyState = 1;
+  const before = fetches.filter(u => u.startsWith('/api/status')).length;
+  es.emit("open");
+  await tick();
+  assert.equal(fetches.filter(u => u.startsWith('/api/status')).length, before + 1);
+
+  const { document } = dom.window;
+  es.emit("sensors", { temp_c:24.56, hum_rh:61.4, soil1:33, soil2:12 });
+  assert.equal(document.querySelector('#v-temp').textContent, "24.6");
+  assert.equal(document.querySelector('#v-hum').textContent, "61");
+  assert.equal(document.querySelector('#v-s2').textContent, "12");
+
+  es.emit("relays", { fan:{ state:1, auto:0 } });
+  assert.equal(document.querySelector('#b-fan').textContent, "ON");
+  assert.equal(document.querySelector('#m-fan').textContent, "MAN");
+
+  // A config change refetches the full status once
+  es.emit("config", {});
+  await tick();
+  assert.equal(fetches.filter(u => u.startsWith('/api/status')).length, before + 2);
+});
+
+test('dashboard falls back to polling when the stream is refused', async () => {
+  FakeEventSource.instances = [];
+  const { intervals } = setupDashboard({ withEventSource:true });
+  await tick();
+
+  const es = FakeEventSource.instances[0];
+  es.readyState = 2;  // 503 from the device
+  es.emit("error");
+  assert.equal(polling(intervals), true);
+  assert.equal(es.closed, true);
+});
+
+test('dashboard polls when EventSource is unavailable', async () => {
+  const { intervals } = setupDashboard({ withEventSource:false });
+  await tick();
+  assert.equal(polling(intervals), true);
+});
+
+test('dashboard prefers the WebSocket and renders relay command acknowledgements', async () => {
+  FakeWebSocket.instances = [];
+  FakeEventSource.instances = [];
+  const { dom, intervals, fetches } = setupDashboard({ withEventSource:true, withWebSocket:true });
+  await tick();
+
+  assert.equal(FakeWebSocket.instances.length, 1);
+  assert.equal(FakeEventSource.instances.length, 0);
+  const ws = FakeWebSocket.instances[0];
+  assert.equal(ws.url, "ws://localhost/api/ws");
+  ws.readyState = 1;
+  ws.emit("open");
+  await tick();
+  assert.equal(polling(intervals), false);
+
+  const { document } = dom.window;
+  ws.emit("message", { type:"relays", id:5, data:{ fan:{ state:0, auto:0 } } });
+  assert.equal(document.querySelector('#m-fan').textContent, "MAN");
+
+  // The toggle goes over the socket and the ack is rendered without a refresh
+  const statusFetches = fetches.filter(u => u.startsWith('/api/status')).length;
+  document.querySelector('#tog-fan').click();
+  await tick();
+  assert.deepEqual(ws.sent, [{ op:"toggle", id:"fan", seq:1 }]);
+  assert.equal(document.querySelector('#tog-fan').disabled, true);
+  ws.emit("message", { type:"ack", data:{ seq:1, ok:true, changed:true, id:"fan", state:1, auto:0 } });
+  await tick();
+  assert.equal(document.querySelector('#b-fan').textContent, "ON");
+  assert.equal(document.querySelector('#tog-fan').disabled, false);
+  assert.equal(fetches.some(u => u.startsWith('/api/toggle')), false);
+  assert.equal(fetches.filter(u => u.startsWith('/api/status')).length, statusFetches);
+});
+
+test('dashboard uses the event stream when the WebSocket is refused', async () => {
+  FakeWebSocket.instances = [];
+  FakeEventSource.instances = [];
+  const { intervals } = setupDashboard({ withEventSource:true, withWebSocket:true });
+  await tick();
+
+  FakeWebSocket.instances[0].emit("close");
+  assert.equal(FakeEventSource.instances.length, 1);
+  assert.equal(FakeEventSource.instances[0].url, "/api/events");
+  assert.equal(polling(intervals), false);
+});
+
+test('polling without a stream waits on the device for the next status version', async () => {
+  let version = '"a1-1"';
+  const statusRequests = [];
+  const { dom, intervals } = setupDashboard({
+    withEventSource:false,
+    fetchImpl: async (url, opts) => {
+      if (!url.startsWith('/api/status')) return { ok:true, json: async () => ({}) };
+      const etag = opts.headers?.["If-None-Match"];
+      statusRequests.push({ url, etag });
+      // Like the device: only the versioned projection carries an ETag
+      const versioned = url.includes('fields=time,wifi,sensors,relays,chambers,chart_scales');
+      const headers = { get: name => name === "ETag" && versioned ? version : null };
+      if (etag === version) return { ok:false, status:304, statusText:"Not Modified", headers };
+      return { ok:true, status:200, headers, json: async () => ({ ...statusPayload, sensors:{ ...statusPayload.sensors, soil2:version.length } }) };
+    },
+  });
+  await tick();
+  const { document } = dom.window;
+  const poll = intervals.find(i => i.ms === 2000 && !i.cleared);
+  assert.ok(poll);
+  // Full status first (with RSSI and counters), then the live groups for their ETag
+  assert.equal(statusRequests.length, 1);
+  assert.doesNotMatch(statusRequests[0].url, /wait=|fields=/);
+  await poll.fn();
+  assert.match(statusRequests[1].url, /[?&]fields=time,wifi,sensors,relays,chambers,chart_scales\b/);
+  assert.doesNotMatch(statusRequests[1].url, /wait=/);
+
+  // Unchanged: the device answers 304 after the wait and nothing is re-rendered
+  document.querySelector('#v-s2').textContent = "kept";
+  await poll.fn();
+  assert.match(statusRequests[2].url, /[?&]wait=20000\b/);
+  assert.equal(statusRequests[2].etag, '"a1-1"');
+  assert.equal(document.querySelector('#v-s2').textContent, "kept");
+  assert.equal(document.body.classList.contains("stale"), false);
+
+  // Changed: the live groups and the new ETag for the next wait
+  version = '"a1-22"';
+  await poll.fn();
+  assert.equal(document.querySelector('#v-s2').textContent, String(version.length));
+  await poll.fn();
+  assert.equal(statusRequests[4].etag, '"a1-22"');
+});
@@ -0,0 +1,28 @@
+import { spawnSync } from 'node:child_process';
+import { mkdtempSync, rmSync } from 'node:fs';
+import { tmpdir } from 'node:os';
+import { join } from 'node:path';
+import { fileURLToPath } from 'node:url';
+
+export const repoRoot = fileURLToPath(new URL('../..', import.meta.url));
+export const cxx = process.env.CXX || 'c++';
+export const haveCompiler = spawnSync(cxx, ['--version']).status === 0;
+
+// Builds repo-relative C++ sources for the host and runs the binary inside a
+// scratch directory (its working directory, removed afterwards).
+// Returns { build, run } (spawnSync results).
+export function buildAndRun(name, sources, flags = []){
+  const dir = mkdtempSync(join(tmpdir(), `ezgrow-${name}-`));
+  try {
+    const bin = join(dir, name);
+    const build = spawnSync(cxx, [
+      '-std=c++11', '-O1', '-Wall', '-Wextra', `-I${repoRoot}`, ...flags,
+      ...sources.map(src => join(repoRoot, src)),
+      '-o', bin,
+    ], { encoding: 'utf8' });
+    if (build.status !== 0) return { build, run: null };
+    return { build, run: spawnSync(bin, [], { cwd: dir, encoding: 'utf8' }) };
+  } finally {
+    rmSync(dir, { recursive: true, force: true });
+  }
+}
@@ -0,0 +1,97 @@
+import test from 'node:test';
+import { readFileSync } from 'node:fs';
+import { strict as assert } from 'node:assert';
+
+const webUiSource = readFileSync(new URL('../WebUI.cpp', import.meta.url), 'utf8').replace(/\r\n/g, '\n');
+
+function handlerBody(name){
+  const start = webUiSource.indexOf(`static void ${name}() {`);
+  assert.notEqual(start, -1, `${name} not found`);
+  const end = webUiSource.indexOf('\n}\n', start);
+  return webUiSource.slice(start, end);
+}
+
+test('history API streams chunks instead of buffering the payload', () => {
+  const body = handlerBody('handleHistoryApi');
+  assert.doesNotMatch(body, /reserve\(\s*90000\s*\)/);
+  assert.match(body, /setContentLength\(CONTENT_LENGTH_UNKNOWN\)/);
+  assert.match(body, /HistoryChunkWriter out;/);
+  assert.match(body, /sendContent\(""\)/);
+});
+
+test('history chunks use a fixed-size buffer', () => {
+  assert.match(webUiSource, /static const size_t HISTORY_CHUNK_SIZE = \d+;/);
+  assert.match(webUiSource, /char\s+chunk\[HISTORY_CHUNK_SIZE\];/);
+  assert.match(webUiSource, /server\.sendContent\(chunk,\s*used\);/);
+});
+
+test('binary history route is registered next to the JSON feed', () => {
+  assert.match(webUiSource, /server\.on\("\/api\/history\.bin",\s*HTTP_GET,\s*handleHistoryBinApi\);/);
+  const body = handlerBody('handleHistoryBinApi');
+  assert.match(body, /setContentLength\(CONTENT_LENGTH_UNKNOWN\)/);
+  // One decimator pass writes each point as a single record
+  assert.equal((body.match(/HistoryDecimator /g) || []).length, 1);
+  assert.match(body, /putHistoryBinRecord\(out, s,/);
+});
+
+test('history handlers accept a point budget and downsample per series', () => {
+  assert.match(webUiSource, /server\.hasArg\("points"\)/);
+  assert.match(webUiSource, /server\.hasArg\("maxPoints"\)/);
+  assert.match(handlerBody('handleHistoryApi'), /HistoryDecimator picks\(window, maxPoints\);/);
+  assert.match(handlerBody('handleHistoryBinApi'), /HistoryDecimator picks\(window, maxPoints\);/);
+
+  // One pass over the bounds historyWindowFor() found, within the budget
+  const start = webUiSource.indexOf('class HistoryDecimator {');
+  const decimator = webUiSource.slice(start, webUiSource.indexOf('\n};\n', start));
+  assert.match(decimator, /_lo\(w\.first\), _hi\(w\.end\)/);
+  assert.match(decimator, /_buckets = \(maxPoints - 2\) \/ HISTORY_BUCKET_POINTS;/);
+  assert.match(webUiSource, /HISTORY_BUCKET_POINTS\s*=\s*HISTORY_SERIES_COUNT \+ 2;/);
+  assert.equal(decimator.match(/historySampleAt\(/g).length, 3);  // PHASE_ALL, scan() and the queued picks
+  assert.match(webUiSource, /if \(newer < w\.count\) w\.first = max\(w\.first, w\.count - \(size_t\)newer\);/);
+});
+
+test('history handlers pick a tier for the requested range', () => {
+  for (const name of ['handleHistoryApi', 'handleHistoryBinApi']){
+    const body = handlerBody(name);
+    assert.match(body, /historyRequestedTier\(requestedDays, maxPoints\)/);
+    assert.match(body, /historyWindowFor\(tier, requestedDays\)/);
+  }
+  assert.match(webUiSource, /server\.hasArg\("tier"\)/);
+  assert.doesNotMatch(webUiSource, /gHistoryBuf/);
+});
+
+test('CSV and NDJSON exports are pumped by the transfer pool, a row at a time', () => {
+  assert.match(webUiSource, /server\.on\("\/api\/history\.csv",\s*HTTP_GET,\s*handleHistoryCsvApi\);/);
+  assert.match(webUiSource, /server\.on\("\/api\/history\.ndjson",\s*HTTP_GET,\s*handleHistoryNdjsonApi\);/);
+
+  const start = webUiSource.indexOf('static void handleHistoryExport(bool csv) {');
+  assert.notEqual(start, -1);
+  const body = webUiSource.slice(start, webUiSource.indexOf('\n}\n', start));
+  assert.match(body, /sendStaticBody\(new HistoryExportSource\([\s\S]*HTTP_TRANSFER_UNTIL_END/);
+  // One export at a time, refused before any header goes out
+  assert.match(body, /if \(!reserveTransfer\(true\)\) return;\s*server\.sendHeader\("Cache-Control", "no-cache"\);/);
+  assert.match(webUiSource, /static const size_t HISTORY_EXPORT_MAX_ACTIVE = 1;/);
+  // The loop keeps running between slices: nothing is sent or serviced inline
+  assert.doesNotMatch(body, /updateControlLogic|sendContent|HistoryChunkWriter/);
+  assert.doesNotMatch(body, /String\s+\w+\s*=\s*""/);
+
+  const source = webUiSource.slice(webUiSource.indexOf('class HistoryExportSource : public HttpBodySource {'), start);
+  assert.match(source, /HistoryDecimator\s+_picks;/);
+  assert.match(source, /if \(!_picks\.next\(s, _withRange \? &range : nullptr\)\) return false;/);
+  assert.match(source, /sHistoryExports\+\+;/);
+  assert.match(source, /sHistoryExports--;/);
+});
+
+test('history stats route is served from the block summaries', () => {
+  assert.match(webUiSource, /server\.on\("\/api\/history\/stats",\s*HTTP_GET,\s*handleHistoryStatsApi\);/);
+  assert.match(handlerBody('handleHistoryStatsApi'), /historyRingStats\(from, to, stats\);/);
+});
+
+test('history ETag includes the since= cursor', () => {
+  const start = webUiSource.indexOf('static bool sendHistoryValidators(');
+  const body = webUiSource.slice(start, webUiSource.indexOf('\n}\n', start));
+  assert.match(body, /snprintf\(cursor, sizeof\(cursor\), "-s%lu"/);
+  assert.match(body, /\(unsigned\)maxPoints, cursor\);/);
+  // The cursor is applied the same way applyHistorySince() applies it
+  assert.match(body, /server\.hasArg\("boot"\)[\s\S]*== sHistoryBootId/);
+});
@@ -49,3 +49,152 @@ test('filterHistoryPoints falls back to sample count without timestamps', async
   assert.equal(filtered[0].soil1, 6);
   assert.equal(filtered[filtered.length - 1].soil1, 149);
 });
+
+test('decodeHistoryBinary reads the row-major history payload', async () => {
+  const app = await loadApp();
+  const count = 2;
+  const buffer = new ArrayBuffer(24 + count * 11);
+  const view = new DataView(buffer);
+  'EZHB'.split('').forEach((c, idx) => view.setUint8(idx, c.charCodeAt(0)));
+  view.setUint8(4, 2);
+  view.setUint8(5, 24);
+  view.setUint32(8, 11, true);
+  view.setUint32(12, 600, true);
+  let off = 24;
+  view.setUint32(off, 1710000000, true); view.setInt16(off + 4, -32768, true); view.setUint16(off + 6, 505, true);
+  view.setUint8(off + 8, 40); view.setUint8(off + 9, 55); view.setUint8(off + 10, 0x01); off += 11;
+  view.setUint32(off, 1710000600, true); view.setInt16(off + 4, 223, true); view.setUint16(off + 6, 0xFFFF, true);
+  view.setUint8(off + 8, 0xFF); view.setUint8(off + 9, 60); view.setUint8(off + 10, 0x02);
+
+  const cols = app.decodeHistoryBinary(buffer);
+  assert.equal(cols.count, 2);
+  assert.equal(cols.intervalSec, 600);
+  assert.deepEqual(cols.t, [1710000000, 1710000600]);
+  assert.deepEqual(cols.temp, [null, 22.3]);
+  assert.deepEqual(cols.hum, [50.5, null]);
+  assert.deepEqual(cols.soil1, [40, null]);
+  assert.deepEqual(cols.soil2, [55, 60]);
+
+  const result = app.prepareHistoryColumns(cols, 'UTC', ['Alpha', 'Beta']);
+  assert.deepEqual(result.light1, [1, 0]);
+  assert.deepEqual(result.light2, [0, 1]);
+  assert.equal(result.labels.length, 2);
+});
+
+test('decodeHistoryBinary rejects unknown payloads', async () => {
+  const app = await loadApp();
+  assert.equal(app.decodeHistoryBinary(new ArrayBuffer(8)), null);
+  assert.equal(app.decodeHistoryBinary(new ArrayBuffer(16)), null);
+
+  // A body that is not a whole number of records is rejected
+  const buffer = new ArrayBuffer(24 + 12);
+  const view = new DataView(buffer);
+  'EZHB'.split('').forEach((c, idx) => view.setUint8(idx, c.charCodeAt(0)));
+  view.setUint8(4, 2);
+  view.setUint8(5, 24);
+  view.setUint32(8, 11, true);
+  assert.equal(app.decodeHistoryBinary(buffer), null);
+});
+
+test('decodeHistoryBinary exposes the sequence cursor and reset flag', async () => {
+  const app = await loadApp();
+  const buffer = new ArrayBuffer(24 + 11);
+  const view = new DataView(buffer);
+  'EZHB'.split('').forEach((c, idx) => view.setUint8(idx, c.charCodeAt(0)));
+  view.setUint8(4, 2);
+  view.setUint8(5, 24);
+  view.setUint16(6, 0, true);
+  view.setUint32(8, 11, true);
+  view.setUint32(12, 600, true);
+  view.setUint32(16, 4242, true);
+  view.setUint32(20, 0xbeef, true);
+  view.setUint32(24, 1710000000, true);
+
+  const cols = app.decodeHistoryBinary(buffer);
+  assert.equal(cols.seq, 4242);
+  assert.equal(cols.boot, '0000beef');
+  assert.equal(cols.reset, false);
+  assert.deepEqual(cols.t, [1710000000]);
+});
+
+test('appendHistoryWindow appends in place and trims to the range', async () => {
+  const app = await loadApp();
+  const day = 24 * 60 * 60;
+  const now = 1_710_000_000;
+  const view = {
+    times: [now - 2 * day, now - day / 2],
+    labels: ['a', 'b'],
+    temps: [20, 21],
+    hums: [40, 41],
+    soil1: [30, 31],
+    soil2: [50, 51],
+  };
+  const temps = view.temps;
+
+  const dropped = app.appendHistoryWindow(view, {
+    times: [now], labels: ['c'], temps: [22], hums: [42], soil1: [32], soil2: [52],
+  }, 1);
+
+  assert.equal(dropped, 1);
+  assert.equal(view.temps, temps); // same array instance for Chart.js
+  assert.deepEqual(view.temps, [21, 22]);
+  assert.deepEqual(view.labels, ['b', 'c']);
+  assert.deepEqual(view.times, [now - day / 2, now]);
+});
+
+test('historyPointBudget follows the chart width', async () => {
+  const app = await loadApp();
+  assert.equal(app.historyPointBudget(null), 0);
+  assert.equal(app.historyPointBudget({ clientWidth: 0 }), 0);
+  assert.equal(app.historyPointBudget({ clientWidth: 320 }), 320 * Math.min(2, Math.max(1, window.devicePixelRatio || 1)));
+  assert.equal(app.historyPointBudget({ clientWidth: 10 }), 64);
+});
+
+test('decodeHistoryBinary reads hourly range fields and the tier', async () => {
+  const app = await loadApp();
+  const count = 1;
+  const buffer = new ArrayBuffer(24 + count * (11 + 14));
+  const view = new DataView(buffer);
+  'EZHB'.split('').forEach((c, idx) => view.setUint8(idx, c.charCodeAt(0)));
+  view.setUint8(4, 2);
+  view.setUint8(5, 24);
+  view.setUint16(6, 0x0202, true); // hourly tier, range fields
+  view.setUint32(8, 11 + 14, true);
+  view.setUint32(12, 3600, true);
+  let off = 24;
+  view.setUint32(off, 1710003600, true); off += 4;
+  view.setInt16(off, 215, true); off += 2;
+  view.setUint16(off, 480, true); off += 2;
+  view.setUint8(off++, 40); view.setUint8(off++, 0xFF); view.setUint8(off++, 0x01);
+  view.setInt16(off, 201, true); off += 2;
+  view.setInt16(off, 233, true); off += 2;
+  view.setUint16(off, 450, true); off += 2;
+  view.setUint16(off, 0xFFFF, true); off += 2;
+  [38, 42, 0xFF, 0xFF, 100, 25].forEach(v => view.setUint8(off++, v));
+
+  const cols = app.decodeHistoryBinary(buffer);
+  assert.equal(cols.tier, 'hourly');
+  assert.equal(cols.intervalSec, 3600);
+  assert.deepEqual(cols.temp, [21.5]);
+  assert.deepEqual(cols.tempMin, [20.1]);
+  assert.deepEqual(cols.tempMax, [23.3]);
+  assert.deepEqual(cols.humMin, [45]);
+  assert.deepEqual(cols.humMax, [null]);
+  assert.deepEqual(cols.soil1Min, [38]);
+  assert.deepEqual(cols.soil2Max, [null]);
+  assert.deepEqual(cols.l1Pct, [100]);
+  assert.deepEqual(cols.l2Pct, [25]);
+});
+
+test('appendHistoryWindow trims by the tier interval', async () => {
+  const app = await loadApp();
+  const hour = 60 * 60;
+  const times = Array.from({ length: 30 }, (_, i) => i * hour);
+  const view = { times: times.slice(), labels: times.map(String), temps: times.map(() => 20), intervalSec: hour };
+
+  const dropped = app.appendHistoryWindow(view, { times: [30 * hour], labels: ['30'], temps: [21] }, 1);
+
+  assert.equal(dropped, 7); // 24 hourly samples per day
+  assert.equal(view.times.length, 24);
+  assert.equal(view.times[view.times.length - 1], 30 * hour);
+});
@@ -0,0 +1,193 @@
+// Host-side checks for the flash wear ledger and write budget (see
+// FlashWear.h). Built and run by test/hostTests.test.js:
+//   c++ -std=c++11 -I. test/host/flashWear_test.cpp FlashWear.cpp
+#include "FlashWear.h"
+
+#include <stdio.h>
+
+static int sFailures = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      sFailures++;                                                     \
+    }                                                                  \
+  } while (0)
+
+static const uint32_t kBudget = 86400;  // one byte per second
+static const uint32_t kBoot   = 1000;
+
+static FlashWearCost costOf(uint32_t bytes, uint32_t erases) {
+  FlashWearCost c = {};
+  c.bytes  = bytes;
+  c.erases = erases;
+  return c;
+}
+
+static void testFsCostModel() {
+  // Appending to a 2896-byte file copies the partial block: one erase
+  FlashWearCost append = {};
+  flashWearAddFsWrite(append, 2896, 2896, 20);
+  CHECK(append.bytes == 2916);
+  CHECK(append.erases == 1);
+
+  // Crossing a block boundary while appending
+  FlashWearCost cross = {};
+  flashWearAddFsWrite(cross, 4090, 4090, 20);
+  CHECK(cross.bytes == 4110);
+  CHECK(cross.erases == 2);
+
+  // A write at the start of a block-aligned tail copies the rest of the file
+  FlashWearCost mid = {};
+  flashWearAddFsWrite(mid, 10 * 4096, 4 * 4096 + 100, 28);
+  CHECK(mid.bytes == 6 * 4096);
+  CHECK(mid.erases == 6);
+
+  // A header write at offset 0 rewrites the whole file
+  FlashWearCost header = {};
+  flashWearAddFsWrite(header, 245344, 32, 32);
+  CHECK(header.bytes == 245344);
+  CHECK(header.erases == (245344 + 4095) / 4096);
+
+  // New file
+  FlashWearCost fresh = {};
+  flashWearAddFsWrite(fresh, 0, 0, 16);
+  flashWearAddFsCommit(fresh);
+  CHECK(fresh.bytes == 16 + FLASH_WEAR_FS_COMMIT_BYTES);
+  CHECK(fresh.erases == 1);
+  CHECK(fresh.logBytes == FLASH_WEAR_FS_COMMIT_BYTES);
+}
+
+static void testNvsEntries() {
+  FlashWearCost c = {};
+  flashWearAddNvsPut(c);          // scalar: one entry
+  CHECK(c.bytes == 32);
+  flashWearAddNvsPut(c, 6);       // "hello" + NUL: header + one data entry
+  CHECK(c.bytes == 32 + 64);
+  flashWearAddNvsPut(c, 33);      // 33 bytes of data: header + two data entries
+  CHECK(c.bytes == 32 + 64 + 96);
+  CHECK(c.logBytes == c.bytes);
+  CHECK(c.erases == 0);
+
+  // Log bytes turn into one erase per 4 KB, carried across charges
+  flashWearReset(kBudget, kBoot);
+  FlashWearCost entry = {};
+  flashWearAddNvsPut(entry);
+  for (int i = 0; i < 127; ++i) flashWearCharge(FLASH_WEAR_CONFIG, entry);
+  CHECK(flashWearCounters(FLASH_WEAR_CONFIG).erases == 0);
+  flashWearCharge(FLASH_WEAR_CONFIG, entry);  // 128 * 32 = 4096
+  CHECK(flashWearCounters(FLASH_WEAR_CONFIG).erases == 1);
+  CHECK(flashWearCounters(FLASH_WEAR_CONFIG).writes == 128);
+  CHECK(flashWearCounters(FLASH_WEAR_CONFIG).bytes == 4096);
+  CHECK(flashWearPoolErases(FLASH_WEAR_POOL_NVS) == 1);
+  CHECK(flashWearPoolErases(FLASH_WEAR_POOL_FS) == 0);
+}
+
+static void testBudgetBucket() {
+  flashWearReset(kBudget, kBoot);
+  CHECK(flashWearTokens() == (int32_t)(kBudget / 4));  // starts full
+  CHECK(flashWearAllows(kBudget / 4));
+  CHECK(!flashWearAllows(kBudget / 4 + 1));
+
+  // Refill never exceeds a quarter of the daily budget
+  flashWearTick(kBoot + 3600);
+  CHECK(flashWearTokens() == (int32_t)(kBudget / 4));
+
+  // Spend it all, then it comes back at budget / day
+  flashWearCharge(FLASH_WEAR_HISTORY_HOURLY, costOf(kBudget / 4, 0));
+  CHECK(flashWearTokens() == 0);
+  CHECK(flashWearAllows(0));
+  CHECK(!flashWearAllows(1));
+  flashWearTick(kBoot + 3600 + 100);
+  CHECK(flashWearTokens() == 100);
+  CHECK(flashWearAllows(100));
+  CHECK(!flashWearAllows(101));
+
+  // Writes that cannot wait overdraw the bucket; deferrable ones then wait
+  flashWearCharge(FLASH_WEAR_CREDENTIALS, costOf(500, 0));
+  CHECK(flashWearTokens() == -400);
+  CHECK(!flashWearAllows(0));
+  flashWearDefer(FLASH_WEAR_CONFIG);
+  CHECK(flashWearCounters(FLASH_WEAR_CONFIG).deferred == 1);
+  flashWearTick(kBoot + 3600 + 500);
+  CHECK(flashWearAllows(0));
+
+  // Fractional refill accumulates instead of rounding away
+  flashWearReset(1000, kBoot);
+  flashWearCharge(FLASH_WEAR_CONFIG, costOf(250, 0));
+  for (uint32_t t = 1; t <= 864; ++t) flashWearTick(kBoot + t * 100);
+  CHECK(flashWearTokens() == 250);
+}
+
+static void testDayRollover() {
+  flashWearReset(kBudget, kBoot);
+  flashWearCharge(FLASH_WEAR_HISTORY_JOURNAL, costOf(300, 1));
+  CHECK(flashWearBytesToday() == 300);
+  CHECK(!flashWearTick(kBoot + 86399));
+  CHECK(flashWearTick(kBoot + 86400));
+  CHECK(flashWearBytesToday() == 0);
+  CHECK(flashWearBytesYesterday() == 300);
+  // A skipped day leaves nothing for yesterday
+  flashWearCharge(FLASH_WEAR_HISTORY_JOURNAL, costOf(7, 0));
+  CHECK(flashWearTick(kBoot + 3 * 86400));
+  CHECK(flashWearBytesYesterday() == 0);
+  // Counters since boot are untouched by the rollover
+  CHECK(flashWearCounters(FLASH_WEAR_HISTORY_JOURNAL).bytes == 307);
+}
+
+static void testLifetimeProjection() {
+  flashWearReset(kBudget, kBoot);
+  flashWearSetPoolSize(FLASH_WEAR_POOL_FS, 100 * 4096);  // 100 sectors
+  flashWearSetPoolSize(FLASH_WEAR_POOL_NVS, 5 * 4096);
+
+  CHECK(flashWearLifetimeDays(kBoot + 7200) == FLASH_WEAR_LIFETIME_UNKNOWN);  // nothing erased
+  flashWearCharge(FLASH_WEAR_HISTORY_HOURLY, costOf(0, 1000));
+  CHECK(flashWearLifetimeDays(FLASH_WEAR_POOL_FS, kBoot + 600) == FLASH_WEAR_LIFETIME_UNKNOWN);  // too early
+
+  // 1000 erases in a day on 100 sectors rated 100000 cycles: 10000 days left
+  const uint32_t day = kBoot + 86400;
+  CHECK(flashWearLifetimeDays(FLASH_WEAR_POOL_FS, day) == (100UL * FLASH_WEAR_ENDURANCE_CYCLES - 1000) / 1000);
+  CHECK(flashWearLifetimeDays(day) == flashWearLifetimeDays(FLASH_WEAR_POOL_FS, day));
+
+  // Wear from earlier boots shortens what is left
+  flashWearRestoreErases(FLASH_WEAR_POOL_FS, 100UL * FLASH_WEAR_ENDURANCE_CYCLES / 2);
+  CHECK(flashWearPoolErases(FLASH_WEAR_POOL_FS) == 100UL * FLASH_WEAR_ENDURANCE_CYCLES / 2 + 1000);
+  CHECK(flashWearLifetimeDays(FLASH_WEAR_POOL_FS, day) == (100UL * FLASH_WEAR_ENDURANCE_CYCLES / 2 - 1000) / 1000);
+  flashWearRestoreErases(FLASH_WEAR_POOL_FS, 100UL * FLASH_WEAR_ENDURANCE_CYCLES);
+  CHECK(flashWearLifetimeDays(FLASH_WEAR_POOL_FS, day) == 0);
+
+  // The shortest pool wins
+  flashWearRestoreErases(FLASH_WEAR_POOL_FS, 0);
+  flashWearCharge(FLASH_WEAR_CONFIG, costOf(0, 100));  // 5 sectors, 100 erases a day
+  CHECK(flashWearLifetimeDays(FLASH_WEAR_POOL_NVS, day) == (5UL * FLASH_WEAR_ENDURANCE_CYCLES - 100) / 100);
+  CHECK(flashWearLifetimeDays(day) == flashWearLifetimeDays(FLASH_WEAR_POOL_NVS, day));
+}
+
+static void testPoolMapping() {
+  flashWearReset(kBudget, kBoot);
+  flashWearSetPool(FLASH_WEAR_HISTORY_JOURNAL, FLASH_WEAR_POOL_PARTITION);
+  flashWearCharge(FLASH_WEAR_HISTORY_JOURNAL, costOf(36, 1));
+  CHECK(flashWearPoolErases(FLASH_WEAR_POOL_PARTITION) == 1);
+  CHECK(flashWearPoolErases(FLASH_WEAR_POOL_FS) == 0);
+  // A reset restores the default mapping
+  flashWearReset(kBudget, kBoot);
+  flashWearCharge(FLASH_WEAR_HISTORY_JOURNAL, costOf(36, 1));
+  CHECK(flashWearPoolErases(FLASH_WEAR_POOL_FS) == 1);
+}
+
+int main() {
+  testFsCostModel();
+  testNvsEntries();
+  testBudgetBucket();
+  testDayRollover();
+  testLifetimeProjection();
+  testPoolMapping();
+
+  if (sFailures) {
+    fprintf(stderr, "%d check(s) failed\n", sFailures);
+    return 1;
+  }
+  printf("flash wear: all checks passed\n");
+  return 0;
+}
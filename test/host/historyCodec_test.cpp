@@ -0,0 +1,176 @@
+// Host-side checks for the columnar history codec and the compressed
+// 10-minute ring (see HistoryCodec.h, HistoryBlocks.h).
+// Built and run by test/hostTests.test.js:
+//   c++ -std=c++11 -I. test/host/historyCodec_test.cpp HistoryCodec.cpp HistoryBlocks.cpp HistoryStats.cpp
+// and again with a small arena, where the ring drops its oldest blocks:
+//   c++ -std=c++11 -I. -DHISTORY_10MIN_ARENA_BYTES=3000 test/host/historyCodec_test.cpp HistoryCodec.cpp HistoryBlocks.cpp HistoryStats.cpp
+#include "HistoryBlocks.h"
+#include "HistoryCodec.h"
+#include "test/host/historySynth.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static int sFailures = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      sFailures++;                                                     \
+    }                                                                  \
+  } while (0)
+
+static bool sameSample(const HistorySample& a, const HistorySample& b) {
+  return a.timestamp == b.timestamp && a.temp == b.temp && a.hum == b.hum &&
+         a.soil1 == b.soil1 && a.soil2 == b.soil2 && a.relays == b.relays;
+}
+
+static void checkRoundTrip(const std::vector<HistorySample>& in) {
+  const size_t size = historyBlockEncode(in.data(), in.size(), nullptr, 0);
+  CHECK(size > 0);
+
+  std::vector<uint8_t> buf(size);
+  CHECK(historyBlockEncode(in.data(), in.size(), buf.data(), buf.size()) == size);
+  CHECK(historyBlockEncode(in.data(), in.size(), buf.data(), size - 1) == 0);
+  CHECK(historyBlockCount(buf.data(), buf.size()) == in.size());
+
+  std::vector<HistorySample> out(in.size());
+  CHECK(historyBlockDecode(buf.data(), buf.size(), out.data(), out.size()) == in.size());
+  for (size_t i = 0; i < in.size(); ++i) CHECK(sameSample(in[i], out[i]));
+
+  // Too small an output buffer is rejected rather than overrun
+  if (in.size() > 1) CHECK(historyBlockDecode(buf.data(), buf.size(), out.data(), in.size() - 1) == 0);
+}
+
+static void testRoundTrips() {
+  HistorySynth synth;
+  const size_t sizes[] = { 1, 2, 3, 144, 1000 };
+  for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); ++k) {
+    std::vector<HistorySample> in;
+    for (size_t i = 0; i < sizes[k]; ++i) in.push_back(synth.next());
+    checkRoundTrip(in);
+  }
+
+  std::vector<HistorySample> noisy;
+  for (size_t i = 0; i < 144; ++i) noisy.push_back(synth.noiseSample());
+  checkRoundTrip(noisy);
+
+  // Missing values, unknown time before NTP sync, extreme values
+  std::vector<HistorySample> edge(4);
+  memset(edge.data(), 0, edge.size() * sizeof(HistorySample));
+  edge[0].temp = HISTORY_SAMPLE_TEMP_NONE; edge[0].hum = HISTORY_SAMPLE_NONE;
+  edge[0].soil1 = HISTORY_SAMPLE_NONE; edge[0].soil2 = HISTORY_SAMPLE_NONE;
+  edge[1].timestamp = 1710000000UL; edge[1].temp = 32767; edge[1].relays = 0x0F;
+  edge[2].timestamp = 0xFFFFFFFFUL; edge[2].temp = -32767;
+  edge[3].timestamp = 5; edge[3].temp = 0;
+  checkRoundTrip(edge);
+
+  // Clock jumps between 0 (before NTP sync) and epoch values: the deltas and
+  // delta-of-deltas wrap in 32 bits
+  const uint32_t kJumps[] = { 0, 1710000000UL, 0, 0, 1710000000UL, 1710000600UL, 0, 0xFFFFFFFFUL, 0 };
+  std::vector<HistorySample> jumps(sizeof(kJumps) / sizeof(kJumps[0]));
+  memset(jumps.data(), 0, jumps.size() * sizeof(HistorySample));
+  for (size_t i = 0; i < jumps.size(); ++i) jumps[i].timestamp = kJumps[i];
+  checkRoundTrip(jumps);
+}
+
+// Every truncation of a valid block must be rejected without reading past it
+static void testTruncatedBlocks() {
+  HistorySynth synth;
+  std::vector<HistorySample> in;
+  for (size_t i = 0; i < 144; ++i) in.push_back(synth.next());
+  std::vector<uint8_t> buf(historyBlockEncode(in.data(), in.size(), nullptr, 0));
+  historyBlockEncode(in.data(), in.size(), buf.data(), buf.size());
+
+  std::vector<HistorySample> out(in.size());
+  for (size_t len = 0; len < buf.size(); ++len) {
+    std::vector<uint8_t> cut(buf.begin(), buf.begin() + len);
+    CHECK(historyBlockDecode(cut.data(), cut.size(), out.data(), out.size()) == 0);
+  }
+}
+
+static void testRealisticCompression() {
+  HistorySynth synth;
+  std::vector<HistorySample> in;
+  for (size_t i = 0; i < HISTORY_BLOCK_SAMPLES; ++i) in.push_back(synth.next());
+  const size_t size = historyBlockEncode(in.data(), in.size(), nullptr, 0);
+  // 30 days of sealed blocks must fit the default arena
+  CHECK(size * 30 <= 18432);
+}
+
+// The ring keeps the newest samples, in order, within its budgets
+static void testRing() {
+  historyRingClear();
+  HistorySynth synth;
+  std::vector<HistorySample> pushed;
+  const size_t total = HISTORY_10MIN_SLOTS * 2 + 77;
+  for (size_t i = 0; i < total; ++i) {
+    pushed.push_back(synth.next());
+    historyRingPush(pushed.back());
+  }
+
+  const size_t count = historyRingCount();
+  CHECK(count <= HISTORY_10MIN_SLOTS);
+  CHECK(count % HISTORY_BLOCK_SAMPLES == total % HISTORY_BLOCK_SAMPLES);
+  CHECK(historyRingArenaUsed() <= HISTORY_10MIN_ARENA_BYTES);
+#if HISTORY_10MIN_ARENA_BYTES >= 18432
+  CHECK(count >= 30 * HISTORY_BLOCK_SAMPLES);  // 30+ days at the default budget
+#endif
+
+  const size_t offset = total - count;
+  for (size_t i = 0; i < count; ++i) {
+    HistorySample s;
+    CHECK(historyRingRead(i, s));
+    CHECK(sameSample(s, pushed[offset + i]));
+  }
+  HistorySample s;
+  CHECK(!historyRingRead(count, s));
+
+  // Reads alternating between two blocks (LTTB look-ahead) stay correct
+  for (size_t i = 0; i + HISTORY_BLOCK_SAMPLES < count; i += 37) {
+    HistorySample a, b;
+    CHECK(historyRingRead(i, a) && historyRingRead(i + HISTORY_BLOCK_SAMPLES, b));
+    CHECK(sameSample(a, pushed[offset + i]));
+    CHECK(sameSample(b, pushed[offset + i + HISTORY_BLOCK_SAMPLES]));
+  }
+}
+
+// Incompressible data runs out of arena before the slot budget
+static void testRingArenaLimit() {
+  historyRingClear();
+  HistorySynth synth(99);
+  std::vector<HistorySample> pushed;
+  for (size_t i = 0; i < HISTORY_10MIN_SLOTS; ++i) {
+    pushed.push_back(synth.noiseSample());
+    historyRingPush(pushed.back());
+  }
+  const size_t count = historyRingCount();
+  CHECK(count > HISTORY_BLOCK_SAMPLES);
+  CHECK(historyRingArenaUsed() <= HISTORY_10MIN_ARENA_BYTES);
+
+  const size_t offset = pushed.size() - count;
+  for (size_t i = 0; i < count; ++i) {
+    HistorySample s;
+    CHECK(historyRingRead(i, s));
+    CHECK(sameSample(s, pushed[offset + i]));
+  }
+}
+
+int main() {
+  testRoundTrips();
+  testTruncatedBlocks();
+  testRealisticCompression();
+  testRing();
+  testRingArenaLimit();
+
+  if (sFailures) {
+    fprintf(stderr, "%d check(s) failed\n", sFailures);
+    return 1;
+  }
+  printf("history codec: all checks passed (%u samples in %u blocks, %u arena bytes)\n",
+         (unsigned)historyRingCount(), (unsigned)historyRingSealedBlocks(),
+         (unsigned)historyRingArenaUsed());
+  return 0;
+}
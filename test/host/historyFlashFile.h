@@ -0,0 +1,89 @@
+// File-backed stand-in for the "history" data partition. The image lives in
+// RAM (served as the memory-mapped view) and every erase/write goes through
+// to the file, so a test can reopen it like a reboot would. Writes follow
+// NOR rules (only 1 -> 0), and a write budget simulates power loss mid-write.
+// Shared by the host tests and scripts/bench-history-partition.cpp.
+#pragma once
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "HistoryPartitionRing.h"
+
+class HistoryFlashFile : public HistoryFlash {
+ public:
+  HistoryFlashFile(const char* path, size_t size, bool reset)
+    : _file(nullptr), _image(size, 0xFF), _budget((size_t)-1),
+      bytesWritten(0), sectorsErased(0) {
+    if (!reset) {
+      _file = fopen(path, "r+b");
+      if (_file && fread(_image.data(), 1, size, _file) != size) {
+        fclose(_file);
+        _file = nullptr;
+      }
+    }
+    if (!_file) {
+      _file = fopen(path, "w+b");
+      if (_file) fwrite(_image.data(), 1, size, _file);
+    }
+    if (_file) fflush(_file);
+  }
+
+  ~HistoryFlashFile() {
+    if (_file) fclose(_file);
+  }
+
+  bool ok() const { return _file != nullptr; }
+
+  // Bytes that may still reach the flash; the write in progress is cut there
+  void powerLossAfter(size_t bytes) { _budget = bytes; }
+
+  size_t size() const override { return _image.size(); }
+
+  bool read(size_t offset, void* out, size_t len) override {
+    if (offset + len > _image.size()) return false;
+    memcpy(out, &_image[offset], len);
+    return true;
+  }
+
+  bool write(size_t offset, const void* data, size_t len) override {
+    if (offset + len > _image.size()) return false;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const size_t n = len < _budget ? len : _budget;
+    for (size_t i = 0; i < n; ++i) _image[offset + i] &= p[i];
+    _budget -= (_budget == (size_t)-1) ? 0 : n;
+    bytesWritten += n;
+    sync(offset, n);
+    return n == len;
+  }
+
+  bool erase(size_t offset, size_t len) override {
+    if (offset % HISTORY_PARTITION_SECTOR_SIZE || len % HISTORY_PARTITION_SECTOR_SIZE ||
+        offset + len > _image.size()) {
+      return false;
+    }
+    if (_budget == 0) return false;
+    memset(&_image[offset], 0xFF, len);
+    sectorsErased += len / HISTORY_PARTITION_SECTOR_SIZE;
+    sync(offset, len);
+    return true;
+  }
+
+  const uint8_t* mapped() override { return _image.data(); }
+
+ private:
+  void sync(size_t offset, size_t len) {
+    if (!_file || len == 0) return;
+    fseek(_file, (long)offset, SEEK_SET);
+    fwrite(&_image[offset], 1, len, _file);
+    fflush(_file);
+  }
+
+  FILE*                _file;
+  std::vector<uint8_t> _image;
+  size_t               _budget;
+
+ public:
+  size_t bytesWritten;
+  size_t sectorsErased;
+};
@@ -0,0 +1,281 @@
+// Host-side checks for the hourly segment format and the version 2 ring file
+// it is migrated from (see HistoryHourlyFile.h). The firmware only reads
+// version 2 files, so the images are written here as the old firmware did.
+// Built and run by test/hostTests.test.js:
+//   c++ -std=c++11 -I. test/host/historyHourlyFile_test.cpp HistoryHourlyFile.cpp HistoryJournal.cpp
+#include "HistoryHourlyFile.h"
+#include "HistoryJournal.h"
+
+#include <algorithm>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static int sFailures = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      sFailures++;                                                     \
+    }                                                                  \
+  } while (0)
+
+static const size_t   kRecordSize = 26;
+static const uint32_t kCapacity   = 8;
+
+// Segment file: header, then appended slots; tearAt cuts the last append
+struct SegmentImage {
+  std::vector<uint8_t> bytes;
+
+  explicit SegmentImage(uint32_t id) : bytes(sizeof(HistoryHourlySegmentHeader)) {
+    HistoryHourlySegmentHeader hdr;
+    historyHourlySealSegmentHeader(hdr, id, kRecordSize);
+    memcpy(bytes.data(), &hdr, sizeof(hdr));
+  }
+
+  void append(uint32_t seq, uint8_t fill, size_t tearAt = (size_t)-1) {
+    uint8_t slot[34];
+    uint8_t record[kRecordSize];
+    memset(record, fill, sizeof(record));
+    const uint32_t crc = historyHourlySegmentSlotCrc(seq, record, kRecordSize);
+    memcpy(slot, &seq, sizeof(seq));
+    memcpy(slot + sizeof(seq), record, kRecordSize);
+    memcpy(slot + sizeof(seq) + kRecordSize, &crc, sizeof(crc));
+    bytes.insert(bytes.end(), slot, slot + std::min(tearAt, sizeof(slot)));
+  }
+
+  bool slotValid(size_t index, uint32_t* seqOut = nullptr) const {
+    const size_t off = historyHourlySegmentSlotOffset(index, kRecordSize);
+    if (off + historyHourlySegmentSlotSize(kRecordSize) > bytes.size()) return false;
+    uint32_t seq, crc;
+    memcpy(&seq, &bytes[off], sizeof(seq));
+    memcpy(&crc, &bytes[off + sizeof(seq) + kRecordSize], sizeof(crc));
+    if (seqOut) *seqOut = seq;
+    return historyHourlySegmentSlotValid(seq, &bytes[off + sizeof(seq)], kRecordSize, crc);
+  }
+
+  // As on boot: whole slots from the size, then only the last one checked
+  size_t records(bool& torn) const {
+    size_t slots = historyHourlySegmentSlots(bytes.size(), kRecordSize);
+    torn = historyHourlySegmentSlotOffset(slots, kRecordSize) != bytes.size();
+    while (slots > 0 && !slotValid(slots - 1)) {
+      slots--;
+      torn = true;
+    }
+    return slots;
+  }
+};
+
+static void sealRingHeader(HistoryHourlyFileHeader& hdr) {
+  hdr.magic   = HISTORY_HOURLY_MAGIC;
+  hdr.version = HISTORY_HOURLY_VERSION_V2;
+  hdr.crc     = historyJournalCrc32(&hdr, offsetof(HistoryHourlyFileHeader, crc));
+}
+
+// Minimal in-memory model of the version 2 file: append = write slot, then
+// the next generation into header copy (generation & 1)
+struct RingImage {
+  std::vector<uint8_t>    bytes;
+  HistoryHourlyFileHeader hdr = {};
+
+  RingImage() : bytes(historyHourlyFileSlotOffset(kCapacity, kRecordSize), 0) {
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.recordSize = kRecordSize;
+    hdr.capacity   = kCapacity;
+  }
+
+  // Applies an append; writesDone limits how many of the two writes land
+  // (2 = complete, 1 = header lost, 0 = nothing) and tearAt cuts the last
+  // write after that many bytes.
+  void append(uint8_t fill, int writesDone = 2, size_t tearAt = (size_t)-1) {
+    uint8_t slot[30];
+    memset(slot, fill, kRecordSize);
+    const uint32_t crc = historyHourlyFileRecordCrc(slot, kRecordSize);
+    memcpy(slot + kRecordSize, &crc, sizeof(crc));
+
+    HistoryHourlyFileHeader next = hdr;
+    next.head = (next.head + 1) % next.capacity;
+    if (next.count < next.capacity) next.count++;
+    next.seq++;
+    next.generation++;
+    sealRingHeader(next);
+
+    if (writesDone >= 1) {
+      const size_t n = (writesDone == 1) ? std::min(tearAt, sizeof(slot)) : sizeof(slot);
+      memcpy(&bytes[historyHourlyFileSlotOffset(hdr.head, kRecordSize)], slot, n);
+    }
+    if (writesDone >= 2) {
+      const size_t n = std::min(tearAt, sizeof(next));
+      memcpy(&bytes[(next.generation & 1U) * sizeof(next)], &next, n);
+      if (n == sizeof(next)) hdr = next;
+    }
+  }
+
+  int pick(HistoryHourlyFileHeader& out) const {
+    HistoryHourlyFileHeader copies[HISTORY_HOURLY_HEADER_COPIES];
+    memcpy(copies, bytes.data(), sizeof(copies));
+    const int i = historyHourlyFilePickHeader(copies, kRecordSize, kCapacity);
+    if (i >= 0) out = copies[i];
+    return i;
+  }
+
+  bool slotValid(size_t slot) const {
+    const uint8_t* p = &bytes[historyHourlyFileSlotOffset(slot, kRecordSize)];
+    uint32_t crc;
+    memcpy(&crc, p + kRecordSize, sizeof(crc));
+    return crc == historyHourlyFileRecordCrc(p, kRecordSize);
+  }
+};
+
+static void testEmptyFile() {
+  RingImage img;
+  HistoryHourlyFileHeader hdr = {};
+  CHECK(img.pick(hdr) == -1);
+}
+
+static void testCopiesAlternate() {
+  RingImage img;
+  HistoryHourlyFileHeader hdr = {};
+  img.append(1);
+  CHECK(img.pick(hdr) == 1 && hdr.generation == 1 && hdr.count == 1);
+  img.append(2);
+  CHECK(img.pick(hdr) == 0 && hdr.generation == 2 && hdr.count == 2);
+  for (int i = 0; i < 20; ++i) img.append((uint8_t)(3 + i));
+  CHECK(img.pick(hdr) >= 0 && hdr.count == kCapacity && hdr.seq == 22);
+  for (size_t s = 0; s < kCapacity; ++s) CHECK(img.slotValid(s));
+}
+
+// Power loss during the header write falls back to the previous generation
+static void testTornHeader() {
+  for (size_t cut = 0; cut < sizeof(HistoryHourlyFileHeader); ++cut) {
+    RingImage img;
+    for (int i = 0; i < 5; ++i) img.append((uint8_t)i);
+    img.append(99, 2, cut);
+
+    HistoryHourlyFileHeader hdr = {};
+    CHECK(img.pick(hdr) >= 0);
+    CHECK(hdr.generation == 5 && hdr.count == 5 && hdr.head == 5);
+  }
+}
+
+// Power loss while overwriting the oldest slot of a full ring: the header
+// still counts the slot, and its CRC marks it as missing
+static void testTornSlot() {
+  RingImage img;
+  for (uint32_t i = 0; i < kCapacity; ++i) img.append((uint8_t)i);
+  const uint32_t head = img.hdr.head;
+  img.append(0xAB, 1, 10);
+
+  HistoryHourlyFileHeader hdr = {};
+  CHECK(img.pick(hdr) >= 0 && hdr.generation == kCapacity && hdr.head == head);
+  CHECK(!img.slotValid(head));
+  for (size_t s = 0; s < kCapacity; ++s) {
+    if (s != head) CHECK(img.slotValid(s));
+  }
+}
+
+static void testGenerationWrap() {
+  HistoryHourlyFileHeader copies[2];
+  memset(copies, 0, sizeof(copies));
+  for (int i = 0; i < 2; ++i) {
+    copies[i].recordSize = kRecordSize;
+    copies[i].capacity   = kCapacity;
+  }
+  copies[1].generation = 0xFFFFFFFFUL;
+  copies[0].generation = 0;  // written after the wrap
+  sealRingHeader(copies[0]);
+  sealRingHeader(copies[1]);
+  CHECK(historyHourlyFilePickHeader(copies, kRecordSize, kCapacity) == 0);
+}
+
+static void testMismatchedLayout() {
+  RingImage img;
+  img.append(1);
+  img.append(2);
+  HistoryHourlyFileHeader copies[2];
+  memcpy(copies, img.bytes.data(), sizeof(copies));
+  CHECK(historyHourlyFilePickHeader(copies, kRecordSize, kCapacity + 1) == -1);
+  CHECK(historyHourlyFilePickHeader(copies, kRecordSize + 1, kCapacity) == -1);
+
+  copies[0].head = kCapacity;  // out of range even with a matching CRC
+  sealRingHeader(copies[0]);
+  CHECK(historyHourlyFilePickHeader(copies, kRecordSize, kCapacity) == 1);
+}
+
+static void testSegmentHeader() {
+  SegmentImage seg(7);
+  HistoryHourlySegmentHeader hdr;
+  memcpy(&hdr, seg.bytes.data(), sizeof(hdr));
+  CHECK(historyHourlySegmentHeaderValid(hdr, kRecordSize) && hdr.segment == 7);
+  CHECK(!historyHourlySegmentHeaderValid(hdr, kRecordSize + 1));
+  hdr.segment = 8;  // CRC no longer matches
+  CHECK(!historyHourlySegmentHeaderValid(hdr, kRecordSize));
+
+  // A version 2 ring file header is not a segment header
+  HistoryHourlyFileHeader ring = {};
+  ring.recordSize = kRecordSize;
+  ring.capacity   = kCapacity;
+  sealRingHeader(ring);
+  memcpy(&hdr, &ring, sizeof(hdr));
+  CHECK(!historyHourlySegmentHeaderValid(hdr, kRecordSize));
+}
+
+// Appends only extend the file: every earlier slot stays valid, and a torn
+// append is dropped at boot without losing the slots before it
+static void testSegmentTornAppend() {
+  for (size_t cut = 0; cut <= 34; ++cut) {
+    SegmentImage seg(1);
+    for (uint32_t seq = 1; seq <= 5; ++seq) seg.append(seq, (uint8_t)seq);
+    seg.append(6, 0xAB, cut);
+
+    bool torn = false;
+    const size_t n = seg.records(torn);
+    uint32_t last = 0;
+    CHECK(seg.slotValid(n - 1, &last));
+    if (cut == 34) {
+      CHECK(n == 6 && !torn && last == 6);
+    } else {
+      CHECK(n == 5 && last == 5);
+      CHECK(torn == (cut != 0));
+    }
+  }
+}
+
+// Zero-filled and erased slots never pass, and the sequence is covered by the CRC
+static void testSegmentSlotValidation() {
+  uint8_t record[kRecordSize];
+  memset(record, 0, sizeof(record));
+  CHECK(!historyHourlySegmentSlotValid(0, record, kRecordSize, historyHourlySegmentSlotCrc(0, record, kRecordSize)));
+  CHECK(!historyHourlySegmentSlotValid(0xFFFFFFFFUL, record, kRecordSize,
+                                       historyHourlySegmentSlotCrc(0xFFFFFFFFUL, record, kRecordSize)));
+  const uint32_t crc = historyHourlySegmentSlotCrc(42, record, kRecordSize);
+  CHECK(historyHourlySegmentSlotValid(42, record, kRecordSize, crc));
+  CHECK(!historyHourlySegmentSlotValid(43, record, kRecordSize, crc));
+
+  SegmentImage seg(1);
+  seg.append(1, 1);
+  seg.bytes.resize(seg.bytes.size() + historyHourlySegmentSlotSize(kRecordSize), 0);
+  bool torn = false;
+  CHECK(seg.records(torn) == 1 && torn);
+}
+
+int main() {
+  testSegmentHeader();
+  testSegmentTornAppend();
+  testSegmentSlotValidation();
+  testEmptyFile();
+  testCopiesAlternate();
+  testTornHeader();
+  testTornSlot();
+  testGenerationWrap();
+  testMismatchedLayout();
+
+  if (sFailures) {
+    fprintf(stderr, "%d check(s) failed\n", sFailures);
+    return 1;
+  }
+  printf("hourly file: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,181 @@
+// Host-side checks for the history journal format (see HistoryJournal.h).
+// Built and run by test/hostTests.test.js:
+//   c++ -std=c++11 -I. test/host/historyJournal_test.cpp HistoryJournal.cpp
+#include "HistoryJournal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static int sFailures = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      sFailures++;                                                     \
+    }                                                                  \
+  } while (0)
+
+static HistoryJournalRecord makeRecord(uint32_t seq) {
+  HistoryJournalRecord rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.seq = seq;
+  for (size_t i = 0; i < sizeof(rec.payload); ++i) rec.payload[i] = (uint8_t)(seq * 7 + i);
+  historyJournalSealRecord(rec);
+  return rec;
+}
+
+// Records of one segment as they would sit on flash after the header
+static std::vector<uint8_t> segmentImage(uint32_t firstSeq, uint32_t lastSeq) {
+  std::vector<uint8_t> out;
+  for (uint32_t seq = firstSeq; seq <= lastSeq; ++seq) {
+    const HistoryJournalRecord rec = makeRecord(seq);
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&rec);
+    out.insert(out.end(), p, p + sizeof(rec));
+  }
+  return out;
+}
+
+static void collect(const HistoryJournalRecord& rec, void* ctx) {
+  static_cast<std::vector<uint32_t>*>(ctx)->push_back(rec.seq);
+}
+
+static size_t scan(const std::vector<uint8_t>& data, size_t len, uint32_t& lastSeq,
+                   std::vector<uint32_t>& seen) {
+  return historyJournalScan(data.data(), len, lastSeq, collect, &seen);
+}
+
+static void testCrcVector() {
+  CHECK(historyJournalCrc32("123456789", 9) == 0xCBF43926UL);
+}
+
+static void testRecordLayout() {
+  CHECK(sizeof(HistoryJournalRecord) == 20);
+  CHECK(sizeof(HistoryJournalPayloadV1) == sizeof(((HistoryJournalRecord*)0)->payload));
+  CHECK(sizeof(HistoryJournalSegmentHeader) == 16);
+}
+
+static void testHeader() {
+  HistoryJournalSegmentHeader hdr;
+  historyJournalSealHeader(hdr, 42);
+  CHECK(historyJournalHeaderValid(hdr));
+
+  HistoryJournalSegmentHeader bad = hdr;
+  bad.segment = 43;
+  CHECK(!historyJournalHeaderValid(bad));
+
+  bad = hdr;
+  bad.recordSize = 12;
+  CHECK(!historyJournalHeaderValid(bad));
+
+  // Version 1 segments are still replayed (and migrated) on boot
+  HistoryJournalSegmentHeader v1 = hdr;
+  v1.version = HISTORY_JOURNAL_VERSION_V1;
+  v1.crc     = historyJournalCrc32(&v1, offsetof(HistoryJournalSegmentHeader, crc));
+  CHECK(historyJournalHeaderValid(v1));
+
+  bad = v1;
+  bad.version = 3;
+  bad.crc     = historyJournalCrc32(&bad, offsetof(HistoryJournalSegmentHeader, crc));
+  CHECK(!historyJournalHeaderValid(bad));
+}
+
+static void testRoundTrip() {
+  const std::vector<uint8_t> img = segmentImage(1, 10);
+  uint32_t lastSeq = 0;
+  std::vector<uint32_t> seen;
+  CHECK(scan(img, img.size(), lastSeq, seen) == img.size());
+  CHECK(seen.size() == 10);
+  CHECK(lastSeq == 10);
+}
+
+// Power loss at every byte of an append: only whole records survive
+static void testTruncatedTail() {
+  const std::vector<uint8_t> img = segmentImage(1, 6);
+  const size_t recSize = sizeof(HistoryJournalRecord);
+  for (size_t len = 0; len <= img.size(); ++len) {
+    uint32_t lastSeq = 0;
+    std::vector<uint32_t> seen;
+    const size_t used = scan(img, len, lastSeq, seen);
+    CHECK(used == (len / recSize) * recSize);
+    CHECK(seen.size() == len / recSize);
+    CHECK(lastSeq == len / recSize);
+  }
+}
+
+// A partially programmed record: the tail still reads as erased (0xFF) or
+// zero-filled flash, starting at every byte offset of the last record.
+static void testPartiallyProgrammedRecord() {
+  const size_t recSize = sizeof(HistoryJournalRecord);
+  const uint8_t fills[] = { 0xFF, 0x00 };
+  for (size_t f = 0; f < sizeof(fills); ++f) {
+    for (size_t cut = 0; cut < recSize; ++cut) {
+      std::vector<uint8_t> img = segmentImage(1, 5);
+      memset(img.data() + 4 * recSize + cut, fills[f], recSize - cut);
+      uint32_t lastSeq = 0;
+      std::vector<uint32_t> seen;
+      const size_t used = scan(img, img.size(), lastSeq, seen);
+      CHECK(used == 4 * recSize);
+      CHECK(seen.size() == 4);
+      CHECK(lastSeq == 4);
+    }
+  }
+}
+
+static void testBitFlipStopsReplay() {
+  const size_t recSize = sizeof(HistoryJournalRecord);
+  std::vector<uint8_t> img = segmentImage(1, 8);
+  img[2 * recSize + 9] ^= 0x10;
+  uint32_t lastSeq = 0;
+  std::vector<uint32_t> seen;
+  CHECK(scan(img, img.size(), lastSeq, seen) == 2 * recSize);
+  CHECK(seen.size() == 2);
+}
+
+// Replay continues in the next segment after a torn one, and records that
+// appear twice (older copy left next to a newer segment) are applied once.
+static void testReplayAcrossSegments() {
+  const size_t recSize = sizeof(HistoryJournalRecord);
+  std::vector<uint8_t> first  = segmentImage(1, 5);
+  std::vector<uint8_t> torn   = segmentImage(6, 9);
+  std::vector<uint8_t> second = segmentImage(8, 12);
+  memset(torn.data() + 3 * recSize + 7, 0xFF, recSize - 7);
+
+  uint32_t lastSeq = 0;
+  std::vector<uint32_t> seen;
+  CHECK(scan(first, first.size(), lastSeq, seen) == first.size());
+  CHECK(scan(torn, torn.size(), lastSeq, seen) == 3 * recSize);
+  CHECK(scan(second, second.size(), lastSeq, seen) == second.size());
+
+  CHECK(seen.size() == 12);
+  for (size_t i = 0; i < seen.size(); ++i) CHECK(seen[i] == i + 1);
+  CHECK(lastSeq == 12);
+}
+
+static void testErasedSlotIsNotARecord() {
+  HistoryJournalRecord rec;
+  memset(&rec, 0xFF, sizeof(rec));
+  CHECK(!historyJournalRecordValid(rec));
+  memset(&rec, 0x00, sizeof(rec));
+  CHECK(!historyJournalRecordValid(rec));
+}
+
+int main() {
+  testCrcVector();
+  testRecordLayout();
+  testHeader();
+  testRoundTrip();
+  testTruncatedTail();
+  testPartiallyProgrammedRecord();
+  testBitFlipStopsReplay();
+  testReplayAcrossSegments();
+  testErasedSlotIsNotARecord();
+
+  if (sFailures) {
+    fprintf(stderr, "%d check(s) failed\n", sFailures);
+    return 1;
+  }
+  printf("history journal: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,207 @@
+// Host-side checks for the raw partition journal (see HistoryPartitionRing.h)
+// against the file-backed flash stand-in. Built and run by
+// test/hostTests.test.js:
+//   c++ -std=c++11 -I. test/host/historyPartition_test.cpp HistoryPartitionRing.cpp HistoryJournal.cpp
+#include "HistoryPartitionRing.h"
+#include "test/host/historyFlashFile.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static int sFailures = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      sFailures++;                                                     \
+    }                                                                  \
+  } while (0)
+
+static const size_t kSectors = 8;
+static const size_t kSize    = kSectors * HISTORY_PARTITION_SECTOR_SIZE;
+static std::string  sPath;
+
+static HistoryJournalRecord makeRecord(uint32_t seq) {
+  HistoryJournalRecord rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.seq = seq;
+  for (size_t i = 0; i < sizeof(rec.payload); ++i) rec.payload[i] = (uint8_t)(seq * 13 + i);
+  historyJournalSealRecord(rec);
+  return rec;
+}
+
+static void collect(const HistoryJournalRecord& rec, void* ctx) {
+  static_cast<std::vector<uint32_t>*>(ctx)->push_back(rec.seq);
+}
+
+struct MountInfo {
+  size_t reads;
+  size_t headSlot;
+};
+
+// Probes of a mount that found the head by binary search (no linear scan)
+static const size_t kMaxMountReads = 2 * 4 + 2 + 8;
+
+// Simulates a reboot: reopen the image and mount a fresh ring
+static std::vector<uint32_t> remountAndReplay(MountInfo* info = nullptr) {
+  HistoryFlashFile flash(sPath.c_str(), kSize, false);
+  HistoryPartitionRing ring(flash);
+  CHECK(ring.mount());
+  if (info) {
+    info->reads    = ring.mountReads();
+    info->headSlot = ring.headSlot();
+  }
+  std::vector<uint32_t> seqs;
+  uint32_t lastSeq = 0;
+  ring.replay(lastSeq, collect, &seqs);
+  return seqs;
+}
+
+static bool contiguousUpTo(const std::vector<uint32_t>& seqs, uint32_t last) {
+  if (seqs.empty() || seqs.back() != last) return false;
+  for (size_t i = 1; i < seqs.size(); ++i) {
+    if (seqs[i] != seqs[i - 1] + 1) return false;
+  }
+  return true;
+}
+
+static void appendRange(uint32_t first, uint32_t last) {
+  HistoryFlashFile flash(sPath.c_str(), kSize, false);
+  HistoryPartitionRing ring(flash);
+  CHECK(ring.mount());
+  for (uint32_t seq = first; seq <= last; ++seq) CHECK(ring.append(makeRecord(seq)));
+}
+
+static void testEmptyPartition() {
+  HistoryFlashFile flash(sPath.c_str(), kSize, true);
+  HistoryPartitionRing ring(flash);
+  CHECK(ring.mount());
+  CHECK(ring.empty());
+  uint32_t lastSeq = 0;
+  CHECK(ring.replay(lastSeq, nullptr, nullptr) == 0);
+
+  HistoryFlashFile tiny(sPath.c_str(), HISTORY_PARTITION_SECTOR_SIZE, true);
+  HistoryPartitionRing small(tiny);
+  CHECK(!small.mount());
+}
+
+// Remount after every kind of fill level, including several laps
+static void testRemountKeepsNewestRecords() {
+  const size_t perSector = HISTORY_PARTITION_SECTOR_RECORDS;
+  const uint32_t counts[] = { 1, 2, (uint32_t)perSector - 1, (uint32_t)perSector, (uint32_t)perSector + 1,
+                              (uint32_t)(perSector * kSectors), (uint32_t)(perSector * kSectors + 5),
+                              (uint32_t)(perSector * kSectors * 3 + 77) };
+  for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+    { HistoryFlashFile reset(sPath.c_str(), kSize, true); }
+    appendRange(1, counts[c]);
+
+    MountInfo info;
+    const std::vector<uint32_t> seqs = remountAndReplay(&info);
+    CHECK(contiguousUpTo(seqs, counts[c]));
+    CHECK(seqs.size() >= std::min<size_t>(counts[c], (kSectors - 1) * perSector));
+    CHECK(info.reads <= kMaxMountReads);
+    CHECK(info.headSlot == (counts[c] - 1) % perSector + 1);
+
+    // Appending after the reboot continues in the right place
+    appendRange(counts[c] + 1, counts[c] + 3);
+    CHECK(contiguousUpTo(remountAndReplay(), counts[c] + 3));
+  }
+}
+
+// Power loss in the middle of a record: the torn slot is skipped
+static void testTornRecord() {
+  { HistoryFlashFile reset(sPath.c_str(), kSize, true); }
+  appendRange(1, 50);
+  {
+    HistoryFlashFile flash(sPath.c_str(), kSize, false);
+    HistoryPartitionRing ring(flash);
+    CHECK(ring.mount());
+    flash.powerLossAfter(7);
+    CHECK(!ring.append(makeRecord(51)));
+  }
+  CHECK(contiguousUpTo(remountAndReplay(), 50));
+  appendRange(51, 60);
+  CHECK(contiguousUpTo(remountAndReplay(), 60));
+}
+
+// Power loss while starting a sector (after the erase, during the header),
+// including the wrap from the last sector to sector 0
+static void testTornSectorStart() {
+  const size_t perSector = HISTORY_PARTITION_SECTOR_RECORDS;
+  const uint32_t fills[] = { (uint32_t)perSector * 2, (uint32_t)(perSector * kSectors) };
+  for (size_t f = 0; f < 2; ++f) {
+    for (size_t cut = 0; cut < sizeof(HistoryPartitionSectorHeader); cut += 5) {
+      { HistoryFlashFile reset(sPath.c_str(), kSize, true); }
+      appendRange(1, fills[f]);
+      {
+        HistoryFlashFile flash(sPath.c_str(), kSize, false);
+        HistoryPartitionRing ring(flash);
+        CHECK(ring.mount());
+        CHECK(ring.headSlot() == perSector);
+        flash.powerLossAfter(cut);
+        CHECK(!ring.append(makeRecord(fills[f] + 1)));
+      }
+      MountInfo info;
+      const std::vector<uint32_t> seqs = remountAndReplay(&info);
+      CHECK(contiguousUpTo(seqs, fills[f]));
+      CHECK(info.reads <= kMaxMountReads);
+      CHECK(info.headSlot == perSector);
+      appendRange(fills[f] + 1, fills[f] + 2);
+      CHECK(contiguousUpTo(remountAndReplay(), fills[f] + 2));
+    }
+  }
+}
+
+// A corrupt header inside the ring falls back to a linear scan
+static void testCorruptMiddleHeader() {
+  { HistoryFlashFile reset(sPath.c_str(), kSize, true); }
+  const uint32_t total = (uint32_t)(HISTORY_PARTITION_SECTOR_RECORDS * 5 + 10);
+  appendRange(1, total);
+  {
+    HistoryFlashFile flash(sPath.c_str(), kSize, false);
+    const uint8_t zero[4] = { 0, 0, 0, 0 };
+    CHECK(flash.write(2 * HISTORY_PARTITION_SECTOR_SIZE + 8, zero, sizeof(zero)));
+  }
+  const std::vector<uint32_t> seqs = remountAndReplay();
+  CHECK(!seqs.empty() && seqs.back() == total);
+  appendRange(total + 1, total + 1);
+  const std::vector<uint32_t> after = remountAndReplay();
+  CHECK(!after.empty() && after.back() == total + 1);
+}
+
+// Each sector is erased once per lap
+static void testWear() {
+  HistoryFlashFile flash(sPath.c_str(), kSize, true);
+  HistoryPartitionRing ring(flash);
+  CHECK(ring.mount());
+  const size_t laps = 3;
+  for (uint32_t seq = 1; seq <= HISTORY_PARTITION_SECTOR_RECORDS * kSectors * laps; ++seq) {
+    ring.append(makeRecord(seq));
+  }
+  CHECK(flash.sectorsErased == kSectors * laps);
+  CHECK(flash.bytesWritten == HISTORY_PARTITION_SECTOR_RECORDS * kSectors * laps * sizeof(HistoryJournalRecord) +
+                              kSectors * laps * sizeof(HistoryPartitionSectorHeader));
+}
+
+int main(int argc, char** argv) {
+  sPath = argc > 1 ? argv[1] : "historyPartition_test.img";
+
+  testEmptyPartition();
+  testRemountKeepsNewestRecords();
+  testTornRecord();
+  testTornSectorStart();
+  testCorruptMiddleHeader();
+  testWear();
+  remove(sPath.c_str());
+
+  if (sFailures) {
+    fprintf(stderr, "%d check(s) failed\n", sFailures);
+    return 1;
+  }
+  printf("history partition: all checks passed\n");
+  return 0;
+}
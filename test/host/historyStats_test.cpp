@@ -0,0 +1,132 @@
+// Host-side checks for the range-aggregate index of the 10-minute ring (see
+// HistoryStats.h). Built and run by test/hostTests.test.js:
+//   c++ -std=c++11 -I. test/host/historyStats_test.cpp HistoryStats.cpp HistoryBlocks.cpp HistoryCodec.cpp
+#include "HistoryBlocks.h"
+#include "HistoryStats.h"
+#include "test/host/historySynth.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int sFailures = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      sFailures++;                                                     \
+    }                                                                  \
+  } while (0)
+
+// Reference: linear scan over every sample in the ring
+static void scanStats(uint32_t from, uint32_t to, HistoryStats& out) {
+  historyStatsReset(out);
+  const size_t n = historyRingCount();
+  for (size_t i = 0; i < n; ++i) {
+    HistorySample s;
+    if (historyRingRead(i, s)) historyStatsAddSample(out, s, from, to);
+  }
+}
+
+static bool sameStats(const HistoryStats& a, const HistoryStats& b) {
+  if (a.firstTs != b.firstTs || a.lastTs != b.lastTs || a.samples != b.samples) return false;
+  for (int k = 0; k < HISTORY_STATS_SERIES_COUNT; ++k) {
+    const HistorySeriesStats& x = a.series[k];
+    const HistorySeriesStats& y = b.series[k];
+    if (x.count != y.count || x.sum != y.sum) return false;
+    if (x.count && (x.min != y.min || x.max != y.max)) return false;
+  }
+  return true;
+}
+
+static uint32_t sRng = 777;
+static uint32_t nextRandom() {
+  sRng ^= sRng << 13;
+  sRng ^= sRng >> 17;
+  sRng ^= sRng << 5;
+  return sRng;
+}
+
+static void checkRandomWindows(int windows) {
+  HistorySample first, last;
+  const size_t n = historyRingCount();
+  CHECK(n > 0 && historyRingRead(0, first) && historyRingRead(n - 1, last));
+  const uint32_t lo = first.timestamp - 3000, hi = last.timestamp + 3000;
+
+  for (int w = 0; w < windows; ++w) {
+    uint32_t from = lo + nextRandom() % (hi - lo);
+    uint32_t to   = lo + nextRandom() % (hi - lo);
+    if (from > to) { const uint32_t t = from; from = to; to = t; }
+
+    HistoryStats fast, slow;
+    historyRingStats(from, to, fast);
+    scanStats(from, to, slow);
+    CHECK(sameStats(fast, slow));
+    CHECK(fast.blocksScanned <= 2 || fast.samples == 0);
+  }
+}
+
+static void testEmptyRing() {
+  historyRingClear();
+  HistoryStats stats;
+  historyRingStats(0, 0xFFFFFFFFUL, stats);
+  CHECK(stats.samples == 0 && stats.series[HISTORY_STATS_TEMP].count == 0);
+}
+
+static void testWholeRingMergesSummaries() {
+  historyRingClear();
+  HistorySynth synth;
+  for (size_t i = 0; i < 10 * HISTORY_BLOCK_SAMPLES + 50; ++i) historyRingPush(synth.next());
+
+  HistoryStats fast, slow;
+  historyRingStats(0, 0xFFFFFFFFUL, fast);
+  scanStats(0, 0xFFFFFFFFUL, slow);
+  CHECK(sameStats(fast, slow));
+  CHECK(fast.samples == 10 * HISTORY_BLOCK_SAMPLES + 50);
+  CHECK(fast.blocksScanned == 0 && fast.blocksMerged == 11);
+}
+
+static void testMissingValuesAndUnknownTime() {
+  historyRingClear();
+  HistorySynth synth;
+  for (size_t i = 0; i < 3 * HISTORY_BLOCK_SAMPLES; ++i) {
+    HistorySample s = synth.next();
+    if (i % 5 == 0) s.hum = HISTORY_SAMPLE_NONE;
+    if (i % 7 == 0) s.soil2 = HISTORY_SAMPLE_NONE;
+    if (i < 20) s.timestamp = 0;  // before NTP sync
+    historyRingPush(s);
+  }
+  HistoryStats stats;
+  historyRingStats(0, 0xFFFFFFFFUL, stats);
+  CHECK(stats.samples == 3 * HISTORY_BLOCK_SAMPLES - 20);
+  CHECK(stats.series[HISTORY_STATS_HUM].count < stats.samples);
+  checkRandomWindows(200);
+}
+
+// The index follows the ring as blocks are evicted
+static void testAfterEviction() {
+  historyRingClear();
+  HistorySynth synth(4242);
+  for (size_t i = 0; i < HISTORY_10MIN_SLOTS + 3 * HISTORY_BLOCK_SAMPLES + 11; ++i) {
+    historyRingPush(synth.next());
+  }
+  checkRandomWindows(500);
+
+  historyRingClear();
+  for (size_t i = 0; i < HISTORY_10MIN_SLOTS; ++i) historyRingPush(synth.noiseSample());
+  checkRandomWindows(200);
+}
+
+int main() {
+  testEmptyRing();
+  testWholeRingMergesSummaries();
+  testMissingValuesAndUnknownTime();
+  testAfterEviction();
+
+  if (sFailures) {
+    fprintf(stderr, "%d check(s) failed\n", sFailures);
+    return 1;
+  }
+  printf("history stats: all checks passed\n");
+  return 0;
+}
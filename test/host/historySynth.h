@@ -0,0 +1,76 @@
+// Synthetic 10-minute history that behaves like a grow tent: diurnal
+// temperature swing with sensor noise, humidity following temperature,
+// soil moisture drying out between waterings, 18/6 light schedules and the
+// occasional missed reading or clock jitter. Shared by the host tests and
+// scripts/bench-history-codec.cpp.
+#pragma once
+#include <math.h>
+#include <stdint.h>
+
+#include "HistorySample.h"
+
+class HistorySynth {
+ public:
+  explicit HistorySynth(uint32_t seed = 12345, uint32_t start = 1710000000UL)
+    : _rng(seed), _t(start), _soil1(60), _soil2(55), _index(0) {}
+
+  HistorySample next() {
+    HistorySample s;
+    const double day   = (double)(_index % 144) / 144.0;
+    const double temp  = 24.0 + 3.5 * sin(2 * M_PI * (day - 0.25)) + noise(0.15);
+    const double hum   = 62.0 - 8.0 * sin(2 * M_PI * (day - 0.25)) + noise(1.0);
+
+    if (_index % 288 == 100) _soil1 = 68;   // watered every other day
+    if (_index % 432 == 250) _soil2 = 64;
+    if (_index % 9 == 0 && _soil1 > 20) _soil1--;
+    if (_index % 11 == 0 && _soil2 > 20) _soil2--;
+
+    s.timestamp = _t + (uint32_t)(next32() % 7 == 0 ? 1 : 0);
+    s.temp      = (int16_t)lround(temp * 100.0);
+    s.hum       = (uint8_t)lround(hum);
+    s.soil1     = (uint8_t)_soil1;
+    s.soil2     = (uint8_t)_soil2;
+    s.relays    = 0;
+    s.reserved  = 0;
+    if ((_index % 144) < 108) s.relays |= HISTORY_RELAY_LIGHT1;
+    if (((_index + 36) % 144) < 108) s.relays |= HISTORY_RELAY_LIGHT2;
+    if (temp > 26.5) s.relays |= HISTORY_RELAY_FAN;
+    if (next32() % 500 == 0) s.temp = HISTORY_SAMPLE_TEMP_NONE;  // sensor dropout
+
+    _t += 600;
+    _index++;
+    return s;
+  }
+
+  // Uncorrelated values (worst case for the codec)
+  HistorySample noiseSample() {
+    HistorySample s;
+    s.timestamp = _t + (next32() % 600);
+    s.temp      = (int16_t)(next32() & 0x7FFF);
+    s.hum       = (uint8_t)(next32() % 101);
+    s.soil1     = (uint8_t)(next32() % 101);
+    s.soil2     = (uint8_t)(next32() % 101);
+    s.relays    = (uint8_t)(next32() & 0x0F);
+    s.reserved  = 0;
+    _t += 600;
+    return s;
+  }
+
+ private:
+  uint32_t next32() {
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return _rng;
+  }
+
+  double noise(double amplitude) {
+    return amplitude * (((double)(next32() % 2001) / 1000.0) - 1.0);
+  }
+
+  uint32_t _rng;
+  uint32_t _t;
+  int      _soil1;
+  int      _soil2;
+  uint32_t _index;
+};
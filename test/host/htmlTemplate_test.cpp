@@ -0,0 +1,123 @@
+// Host-side checks for the typed HTML templates (see HtmlTemplate.h). Built
+// and run by test/hostTests.test.js:
+//   c++ -std=c++11 -I. test/host/htmlTemplate_test.cpp
+#include "HtmlTemplate.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+
+static int sFailures = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      sFailures++;                                                     \
+    }                                                                  \
+  } while (0)
+
+// Collects the output and counts write() calls
+struct Sink {
+  std::string text;
+  size_t      writes;
+
+  Sink() : writes(0) {}
+  void write(const char* data, size_t len) {
+    text.append(data, len);
+    writes++;
+  }
+};
+
+template <typename... Args>
+static std::string render(const Args&... args) {
+  Sink out;
+  htmlWrite(out, args...);
+  return out.text;
+}
+
+static void testLiterals() {
+  CHECK(render() == "");
+  CHECK(render("<p>", "a", "</p>") == "<p>a</p>");
+  CHECK(render("<p>" "joined at compile time" "</p>") == "<p>joined at compile time</p>");
+
+  // A literal is one write of its compile-time length, embedded NULs included
+  Sink out;
+  htmlWrite(out, "a\0b");
+  CHECK(out.writes == 1);
+  CHECK(out.text == std::string("a\0b", 3));
+
+  const char* label = "Light 1";
+  const char* none  = nullptr;
+  char buf[]        = "mutable";
+  CHECK(render(label, none, ' ', (char*)buf) == "Light 1 mutable");
+  CHECK(render(std::string("<raw>")) == "<raw>");  // String-like values are not escaped
+}
+
+static void testEscaping() {
+  CHECK(render(htmlEsc("Tom & <Jerry> \"quoted\" 'single'")) ==
+        "Tom &amp; &lt;Jerry&gt; &quot;quoted&quot; &#39;single&#39;");
+  CHECK(render(htmlEsc(std::string("plain"))) == "plain");
+  CHECK(render(htmlEsc("")) == "");
+  CHECK(render(htmlEsc((const char*)nullptr)) == "");
+  CHECK(render(htmlEsc("a<b", 2)) == "a&lt;");
+  CHECK(render("value='", htmlEsc("O'Brien"), "'") == "value='O&#39;Brien'");
+
+  // Plain runs go out in one write, not per character
+  Sink out;
+  htmlWrite(out, htmlEsc("abcdef&ghijkl"));
+  CHECK(out.writes == 3);
+}
+
+static void testNumbers() {
+  CHECK(render(0) == "0");
+  CHECK(render(42, ' ', -7) == "42 -7");
+  CHECK(render(INT_MIN) == "-2147483648");
+  CHECK(render(LONG_MIN) == std::to_string(LONG_MIN));
+  CHECK(render(ULONG_MAX) == std::to_string(ULONG_MAX));
+  CHECK(render((size_t)1440, (uint8_t)255, (int16_t)-300) == "1440255-300");
+
+  CHECK(render(htmlFixed(24.56f, 1)) == "24.6");
+  CHECK(render(htmlFixed(-0.04f, 1)) == "-0.0");
+  CHECK(render(htmlFixed(3.0f, 0)) == "3");
+  CHECK(render(htmlFixed(NAN, 1)) == "nan");
+}
+
+static void testBooleansAndChoices() {
+  CHECK(render(true, ",", false) == "true,false");
+  CHECK(render("<input", htmlIf(true, " checked"), ">") == "<input checked>");
+  CHECK(render("<input", htmlIf(false, " checked"), ">") == "<input>");
+  CHECK(render(htmlIf(false, "1", "0"), htmlIf(true, "1", "0")) == "01");
+}
+
+// A value type defined by the caller, as WebUI.cpp does for times of day
+struct Percent {
+  int value;
+};
+
+template <>
+struct HtmlFormat<Percent> {
+  template <typename Out>
+  static void put(Out& out, const Percent& p) { htmlWrite(out, p.value, "%"); }
+};
+
+static void testCustomFormat() {
+  Percent p = { 35 };
+  CHECK(render("soil ", p) == "soil 35%");
+}
+
+int main() {
+  testLiterals();
+  testEscaping();
+  testNumbers();
+  testBooleansAndChoices();
+  testCustomFormat();
+
+  if (sFailures) {
+    fprintf(stderr, "%d check(s) failed\n", sFailures);
+    return 1;
+  }
+  printf("html template: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,230 @@
+// Host-side checks for the Server-Sent Events fan-out (see HttpEvents.h).
+// Built and run by test/hostTests.test.js:
+//   c++ -std=c++11 -I. test/host/httpEvents_test.cpp HttpEvents.cpp HttpWebSocket.cpp HttpParser.cpp
+//
+// testIdleBandwidth() compares ten minutes of an idle dashboard on the
+// stream with the 2 s /api/status poll it replaces.
+#include "HttpEvents.h"
+#include "HttpWebSocket.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+static int sFailures = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      sFailures++;                                                     \
+    }                                                                  \
+  } while (0)
+
+// Socket that takes up to `room` bytes per write
+class FakeClient : public HttpBodySink {
+ public:
+  FakeClient(std::string* out, int* live) : room(1 << 20), gone(false), _out(out), _live(live) { (*_live)++; }
+  ~FakeClient() { (*_live)--; }
+
+  int write(const uint8_t* data, size_t len) override {
+    if (gone) return -1;
+    size_t n = len < room ? len : room;
+    _out->append(reinterpret_cast<const char*>(data), n);
+    return (int)n;
+  }
+
+  size_t room;
+  bool   gone;
+
+ private:
+  std::string* _out;
+  int*         _live;
+};
+
+static void publish(HttpEventStream& es, const char* event, const char* json) {
+  es.publish(event, json, strlen(json));
+}
+
+static void testFormatAndFanOut() {
+  HttpEventStream es;
+  std::string a, b;
+  int live = 0;
+  FakeClient* ca = new FakeClient(&a, &live);
+  FakeClient* cb = new FakeClient(&b, &live);
+
+  publish(es, "sensors", "{\"temp_c\":21.0}");  // nobody listening: only counted
+  CHECK(es.lastId() == 1);
+
+  CHECK(es.subscribe(ca, 0) == 0);
+  CHECK(es.subscribe(cb, 0) == 1);
+  std::string a3, b3;
+  int live3 = 0;
+  FakeClient* third = new FakeClient(&a3, &live3);
+  CHECK(es.clients() == HTTP_EVENT_CLIENTS);
+  CHECK(es.subscribe(third, 0) == -1);
+  CHECK(es.stats().refused == 1);
+  delete third;
+
+  publish(es, "sensors", "{\"temp_c\":21.5}");
+  publish(es, "relays", "{\"fan\":{\"state\":1,\"auto\":1}}");
+  es.pump(10);
+  const std::string expected =
+    "retry: 3000\n\n"
+    "id: 2\nevent: sensors\ndata: {\"temp_c\":21.5}\n\n"
+    "id: 3\nevent: relays\ndata: {\"fan\":{\"state\":1,\"auto\":1}}\n\n";
+  CHECK(a == expected);
+  CHECK(b == expected);
+  CHECK(es.stats().events == 3);
+  CHECK(es.stats().bytes == 2 * expected.size());
+
+  // Partial writes resume where they stopped
+  a.clear();
+  ca->room = 5;
+  publish(es, "config", "{}");
+  for (int i = 0; i < 10; ++i) es.pump(20);
+  CHECK(a == "id: 4\nevent: config\ndata: {}\n\n");
+
+  // A lost connection is dropped and its sink deleted
+  cb->gone = true;
+  publish(es, "config", "{}");
+  es.pump(30);
+  CHECK(es.clients() == 1);
+  CHECK(live == 1);
+  CHECK(es.stats().dropped == 1);
+
+  es.closeAll();
+  CHECK(live == 0);
+  CHECK(es.clients() == 0);
+}
+
+// A subscriber that stops reading is dropped once its queue is full
+static void testSlowSubscriber() {
+  HttpEventStream es;
+  std::string out;
+  int live = 0;
+  FakeClient* c = new FakeClient(&out, &live);
+  CHECK(es.subscribe(c, 0) >= 0);
+  c->room = 0;
+
+  const char json[] = "{\"temp_c\":21.5,\"hum_rh\":55,\"soil1\":40,\"soil2\":38}";
+  int published = 0;
+  while (es.clients() > 0 && published < 1000) {
+    publish(es, "sensors", json);
+    es.pump(0);
+    published++;
+  }
+  CHECK(es.clients() == 0);
+  CHECK(live == 0);
+  CHECK(published * (int)(sizeof(json) + 30) >= HTTP_EVENT_QUEUE_BYTES);
+  CHECK(published < 40);
+}
+
+static void testHeartbeat() {
+  HttpEventStream es;
+  std::string out;
+  int live = 0;
+  FakeClient* c = new FakeClient(&out, &live);
+  CHECK(es.subscribe(c, 1000) >= 0);
+  es.pump(1000);
+  out.clear();
+
+  es.pump(1000 + HTTP_EVENT_HEARTBEAT_MS - 1);
+  CHECK(out.empty());
+  es.pump(1000 + HTTP_EVENT_HEARTBEAT_MS);
+  CHECK(out == "event: ping\ndata: {}\n\n");
+  CHECK(es.stats().heartbeats == 1);
+
+  // Events reset the heartbeat timer
+  out.clear();
+  const uint32_t t = 1000 + 2 * HTTP_EVENT_HEARTBEAT_MS - 10;
+  publish(es, "sensors", "{}");
+  es.pump(t);
+  es.pump(t + HTTP_EVENT_HEARTBEAT_MS - 1);
+  CHECK(out.find("ping") == std::string::npos);
+  CHECK(es.stats().heartbeats == 1);
+}
+
+// WebSocket subscribers get the same events as text frames, plus their own
+// acknowledgements and control frames
+static void testWebSocketFraming() {
+  HttpEventStream es;
+  std::string ws, sse;
+  int live = 0;
+  const int slot = es.subscribe(new FakeClient(&ws, &live), 0, HTTP_EVENT_WEBSOCKET);
+  CHECK(slot == 0);
+  CHECK(es.subscribe(new FakeClient(&sse, &live), 0) == 1);
+  es.pump(0);
+  CHECK(ws.empty());  // no retry line
+  sse.clear();
+
+  publish(es, "relays", "{\"fan\":{\"state\":1}}");
+  CHECK(es.sendTo(slot, "ack", "{\"seq\":7,\"ok\":true}", 19));
+  es.pump(10);
+  const std::string event = "{\"type\":\"relays\",\"id\":1,\"data\":{\"fan\":{\"state\":1}}}";
+  const std::string ack   = "{\"type\":\"ack\",\"data\":{\"seq\":7,\"ok\":true}}";
+  CHECK(ws == std::string("\x81") + (char)event.size() + event + "\x81" + (char)ack.size() + ack);
+  CHECK(sse == "id: 1\nevent: relays\ndata: {\"fan\":{\"state\":1}}\n\n");
+
+  // Heartbeats are ping events, not ping frames
+  ws.clear();
+  es.pump(10 + HTTP_EVENT_HEARTBEAT_MS);
+  const std::string ping = "{\"type\":\"ping\",\"data\":{}}";
+  CHECK(ws == std::string("\x81") + (char)ping.size() + ping);
+
+  // Control frames are for WebSocket subscribers only
+  ws.clear();
+  const uint8_t code[] = { 0x03, 0xE8 };
+  CHECK(!es.sendFrame(1, HTTP_WS_CLOSE, code, sizeof(code)));
+  CHECK(es.sendFrame(slot, HTTP_WS_CLOSE, code, sizeof(code)));
+
+  // close() writes what is queued first, takes nothing more and is not a drop
+  es.close(slot);
+  CHECK(!es.active(slot));
+  CHECK(!es.sendTo(slot, "ack", "{}", 2));
+  publish(es, "config", "{}");
+  CHECK(es.clients() == 2);
+  es.pump(20);
+  CHECK(ws == "\x88\x02\x03\xE8");
+  CHECK(es.clients() == 1);
+  CHECK(live == 1);
+  CHECK(es.stats().dropped == 0);
+}
+
+// Ten idle minutes: sensors change every 30 s on average (rounded values),
+// the relays twice
+static void testIdleBandwidth() {
+  HttpEventStream es;
+  std::string out;
+  int live = 0;
+  CHECK(es.subscribe(new FakeClient(&out, &live), 0) >= 0);
+
+  const char sensors[] = "{\"temp_c\":21.5,\"hum_rh\":55,\"soil1\":40,\"soil2\":38}";
+  const char relays[]  = "{\"fan\":{\"state\":1,\"auto\":1}}";
+  const uint32_t kEndMs = 10 * 60 * 1000;
+  for (uint32_t now = 0; now < kEndMs; now += 20) {
+    if (now % 30000 == 0) es.publish("sensors", sensors, sizeof(sensors) - 1);
+    if (now % 300000 == 150000) es.publish("relays", relays, sizeof(relays) - 1);
+    es.pump(now);
+  }
+
+  const size_t kStatusBytes = 2300;  // /api/status body plus headers
+  const size_t polled = (kEndMs / 2000) * kStatusBytes;
+  CHECK(out.size() * 20 < polled);
+  printf("  10 idle minutes: %u bytes streamed, %u bytes polled\n", (unsigned)out.size(), (unsigned)polled);
+}
+
+int main() {
+  testFormatAndFanOut();
+  testSlowSubscriber();
+  testHeartbeat();
+  testWebSocketFraming();
+  testIdleBandwidth();
+
+  if (sFailures) {
+    fprintf(stderr, "%d check(s) failed\n", sFailures);
+    return 1;
+  }
+  printf("http events: all checks passed\n");
+  return 0;
+}
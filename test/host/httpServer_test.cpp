@@ -0,0 +1,310 @@
+// Host-side checks for the request parser and the keep-alive policy behind
+// HttpServer (see HttpParser.h, HttpKeepAlive.h). Built and run by
+// test/hostTests.test.js:
+//   c++ -std=c++11 -I. test/host/httpServer_test.cpp HttpParser.cpp HttpKeepAlive.cpp
+//
+// testDashboardPolling() replays ten minutes of the dashboard polling
+// /api/status every 2 s and checks that it costs one TCP handshake per
+// HTTP_KEEPALIVE_MAX_REQUESTS requests instead of one per request.
+#include "HttpKeepAlive.h"
+#include "HttpParser.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+static int sFailures = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      sFailures++;                                                     \
+    }                                                                  \
+  } while (0)
+
+static std::string str(const char* s, size_t len) {
+  return std::string(s, len);
+}
+
+static HttpParseStatus parse(const std::string& raw, HttpRequestHead& head) {
+  return httpParseRequestHead(raw.data(), raw.size(), head);
+}
+
+struct HeaderLog {
+  std::string names;
+  std::string auth;
+};
+
+static void logHeader(const char* name, size_t nameLen, const char* value, size_t valueLen, void* ctx) {
+  HeaderLog* log = static_cast<HeaderLog*>(ctx);
+  log->names += str(name, nameLen) + ";";
+  if (httpEqualsIgnoreCase(name, nameLen, "authorization")) log->auth = str(value, valueLen);
+}
+
+static void testRequestHead() {
+  HttpRequestHead head;
+  HeaderLog log;
+  const std::string get =
+    "GET /api/history?days=2&tier=raw HTTP/1.1\r\n"
+    "Host: ezgrow.local\r\n"
+    "Authorization:  Basic YWRtaW46c2VjcmV0 \r\n"
+    "\r\n";
+  CHECK(httpParseRequestHead(get.data(), get.size(), head, logHeader, &log) == HTTP_PARSE_DONE);
+  CHECK(str(head.method, head.methodLen) == "GET");
+  CHECK(str(head.path, head.pathLen) == "/api/history");
+  CHECK(str(head.query, head.queryLen) == "days=2&tier=raw");
+  CHECK(head.minorVersion == 1);
+  CHECK(head.keepAlive);
+  CHECK(head.contentLength == -1);
+  CHECK(head.headBytes == get.size());
+  CHECK(log.names == "Host;Authorization;");
+  CHECK(log.auth == "Basic YWRtaW46c2VjcmV0");
+
+  // Keep-alive rules per version
+  CHECK(parse("GET / HTTP/1.1\r\nConnection: close\r\n\r\n", head) == HTTP_PARSE_DONE && !head.keepAlive);
+  CHECK(parse("GET / HTTP/1.0\r\n\r\n", head) == HTTP_PARSE_DONE && !head.keepAlive);
+  CHECK(parse("GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n", head) == HTTP_PARSE_DONE && head.keepAlive);
+  CHECK(parse("GET / HTTP/1.1\r\nConnection: keep-alive, Upgrade\r\n\r\n", head) == HTTP_PARSE_DONE && head.keepAlive);
+
+  // Incomplete heads wait for more data, leading blank lines are skipped
+  CHECK(parse("GET / HTTP/1.1\r\nHost: x\r\n", head) == HTTP_PARSE_INCOMPLETE);
+  const std::string blankFirst = "\r\nGET /a HTTP/1.1\r\n\r\n";
+  CHECK(parse(blankFirst, head) == HTTP_PARSE_DONE);
+  CHECK(str(head.path, head.pathLen) == "/a");
+
+  // Bodies
+  CHECK(parse("POST /config HTTP/1.1\r\nContent-Length: 7\r\nExpect: 100-continue\r\n\r\n", head) == HTTP_PARSE_DONE);
+  CHECK(head.contentLength == 7 && head.expectContinue);
+  CHECK(parse("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", head) == HTTP_PARSE_DONE && head.chunkedBody);
+
+  // Malformed requests
+  CHECK(parse("GET /\r\n\r\n", head) == HTTP_PARSE_ERROR);
+  CHECK(parse("GET / HTTP/2.0\r\n\r\n", head) == HTTP_PARSE_ERROR);
+  CHECK(parse("GET nopath HTTP/1.1\r\n\r\n", head) == HTTP_PARSE_ERROR);
+  CHECK(parse("GET / HTTP/1.1\r\nNoColon\r\n\r\n", head) == HTTP_PARSE_ERROR);
+  CHECK(parse("POST / HTTP/1.1\r\nContent-Length: 12a\r\n\r\n", head) == HTTP_PARSE_ERROR);
+  CHECK(parse("POST / HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 4\r\n\r\n", head) == HTTP_PARSE_ERROR);
+  std::string huge = "GET / HTTP/1.1\r\nX: " + std::string(HTTP_MAX_HEAD_BYTES, 'a');
+  CHECK(parse(huge, head) == HTTP_PARSE_ERROR);
+}
+
+// Two requests arriving in one segment are parsed one after the other
+static void testPipelinedBuffer() {
+  const std::string raw =
+    "POST /api/grow/apply_all HTTP/1.1\r\nContent-Length: 9\r\n\r\nprofile=2"
+    "GET /api/status HTTP/1.1\r\n\r\n";
+  HttpReceiveBuffer rx(256);
+  size_t granted;
+  char* dst = rx.reserve(raw.size(), granted);
+  CHECK(dst && granted == raw.size());
+  memcpy(dst, raw.data(), granted);
+  rx.commit(granted);
+
+  HttpRequestHead head;
+  CHECK(httpParseRequestHead(rx.data(), rx.size(), head) == HTTP_PARSE_DONE);
+  CHECK(str(head.path, head.pathLen) == "/api/grow/apply_all");
+  CHECK(str(rx.data() + head.headBytes, (size_t)head.contentLength) == "profile=2");
+  rx.consume(head.headBytes + (size_t)head.contentLength);
+
+  CHECK(httpParseRequestHead(rx.data(), rx.size(), head) == HTTP_PARSE_DONE);
+  CHECK(str(head.path, head.pathLen) == "/api/status");
+  rx.consume(head.headBytes);
+  CHECK(rx.size() == 0);
+
+  // The buffer stops at its limit
+  CHECK(rx.reserve(300, granted) && granted == 256);
+  rx.commit(granted);
+  CHECK(rx.reserve(1, granted) == nullptr);
+  rx.clear();
+  CHECK(rx.size() == 0 && rx.data() == nullptr);
+}
+
+static void collectArg(const char* name, size_t nameLen, const char* value, size_t valueLen, void* ctx) {
+  std::string* out = static_cast<std::string*>(ctx);
+  char n[64], v[64];
+  *out += str(n, httpUrlDecode(name, nameLen, n)) + "=" + str(v, httpUrlDecode(value, valueLen, v)) + "|";
+}
+
+static void testDecoding() {
+  std::string args;
+  const char q[] = "ssid=My+Net&pass=a%26b%3D&flag&&x=%zz";
+  httpForEachArg(q, strlen(q), collectArg, &args);
+  CHECK(args == "ssid=My Net|pass=a&b=|flag=|x=%zz|");
+
+  char out[32];
+  const char b64[] = "YWRtaW46c2VjcmV0";  // admin:secret
+  size_t n = httpBase64Decode(b64, strlen(b64), out, sizeof(out));
+  CHECK(str(out, n) == "admin:secret");
+  CHECK(httpBase64Decode("YQ==", 4, out, sizeof(out)) == 1 && out[0] == 'a');
+  CHECK(httpBase64Decode("Y$==", 4, out, sizeof(out)) == 0);
+  CHECK(httpBase64Decode(b64, strlen(b64), out, 4) == 0);
+
+  CHECK(strcmp(httpReasonPhrase(304), "Not Modified") == 0);
+  CHECK(httpEqualsIgnoreCase("Content-Length", 14, "content-length"));
+  CHECK(!httpEqualsIgnoreCase("Content", 7, "content-length"));
+}
+
+static void testKeepAlivePolicy() {
+  HttpKeepAlive ka(5000, 3);
+
+  // Request limit: the third response closes the connection
+  int s = ka.open(0);
+  CHECK(s >= 0);
+  CHECK(ka.remaining(s) == 2);
+  for (int i = 0; i < 2; ++i) {
+    ka.beginRequest(s, 100 * i, false);
+    CHECK(ka.endRequest(s, 100 * i + 10, true, true));
+  }
+  CHECK(ka.remaining(s) == 0);
+  ka.beginRequest(s, 300, false);
+  CHECK(!ka.endRequest(s, 310, true, true));
+  CHECK(!ka.inUse(s));
+  CHECK(ka.stats().closed[HTTP_CLOSE_LIMIT] == 1);
+  CHECK(ka.stats().reused == 2);
+
+  // Idle timeout, not while a request is being handled
+  s = ka.open(1000);
+  CHECK(!ka.expired(s, 5999));
+  CHECK(ka.expired(s, 6000));
+  ka.beginRequest(s, 6000, false);
+  CHECK(!ka.expired(s, 20000));
+  CHECK(ka.endRequest(s, 20000, true, true));
+  ka.touch(s, 24000);
+  CHECK(!ka.expired(s, 28000));
+  ka.close(s, HTTP_CLOSE_IDLE);
+
+  // Client or response asks for close
+  s = ka.open(0);
+  ka.beginRequest(s, 0, false);
+  CHECK(!ka.endRequest(s, 1, false, true));
+  s = ka.open(0);
+  ka.beginRequest(s, 0, true);
+  CHECK(!ka.endRequest(s, 1, true, false));
+  CHECK(ka.stats().closed[HTTP_CLOSE_REQUESTED] == 2);
+  CHECK(ka.stats().pipelined == 1);
+  CHECK(ka.openCount() == 0);
+  CHECK(strcmp(httpCloseReasonName(HTTP_CLOSE_EVICTED), "evicted") == 0);
+}
+
+static void testEviction() {
+  HttpKeepAlive ka(5000, 100);
+  int slots[HTTP_SERVER_CONNECTIONS];
+  for (int i = 0; i < HTTP_SERVER_CONNECTIONS; ++i) {
+    slots[i] = ka.open(0);
+    CHECK(slots[i] >= 0);
+  }
+  CHECK(ka.open(0) == -1);
+  // Fresh connections that have not sent a request are not evicted
+  CHECK(ka.evictionCandidate() == -1);
+
+  for (int i = 0; i < HTTP_SERVER_CONNECTIONS; ++i) {
+    ka.beginRequest(slots[i], 100, false);
+    ka.endRequest(slots[i], 1000 - 100 * i, true, true);  // last slot idle longest
+  }
+  ka.beginRequest(slots[0], 1200, false);  // busy: not a candidate
+  CHECK(ka.evictionCandidate() == slots[HTTP_SERVER_CONNECTIONS - 1]);
+  ka.close(ka.evictionCandidate(), HTTP_CLOSE_EVICTED);
+  CHECK(ka.open(1300) == slots[HTTP_SERVER_CONNECTIONS - 1]);
+  CHECK(ka.stats().closed[HTTP_CLOSE_EVICTED] == 1);
+}
+
+// Long polls: a deferred request keeps its connection busy until it is
+// answered, and only HTTP_KEEPALIVE_MAX_DEFERRED wait at once
+static void testDeferredRequests() {
+  HttpKeepAlive ka(5000, 100);
+  const int a = ka.open(0);
+  const int b = ka.open(0);
+
+  CHECK(!ka.defer(a, 0, 1000));  // no request being handled
+  ka.beginRequest(a, 100, false);
+  CHECK(ka.defer(a, 100, 20000));
+  CHECK(ka.deferred(a));
+  CHECK(ka.deferredCount() == 1);
+
+  // Dispatched again before the deadline: keeps waiting, same deadline
+  CHECK(ka.defer(a, 5000, 60000));
+  CHECK(!ka.deferDue(a, 20099));
+  CHECK(ka.deferDue(a, 20100));
+  CHECK(!ka.defer(a, 20100, 20000));
+
+  // Not idle, not evicted while waiting
+  CHECK(!ka.expired(a, 20000));
+  CHECK(ka.evictionCandidate() != a);
+
+  // The limit leaves the other connections for everything else
+  ka.beginRequest(b, 200, false);
+  if (HTTP_KEEPALIVE_MAX_DEFERRED == 1) CHECK(!ka.defer(b, 200, 20000));
+  CHECK(ka.endRequest(b, 210, true, true));
+  CHECK(!ka.deferred(b));
+
+  CHECK(ka.endRequest(a, 20100, true, true));
+  CHECK(!ka.deferred(a));
+  CHECK(ka.deferredCount() == 0);
+  CHECK(ka.stats().requests == 2);
+  CHECK(ka.stats().deferred == 1);
+
+  // A waiting connection that closes stops counting
+  ka.beginRequest(a, 30000, false);
+  CHECK(ka.defer(a, 30000, 1000));
+  ka.close(a, HTTP_CLOSE_PEER);
+  CHECK(ka.deferredCount() == 0);
+  CHECK(!ka.deferred(a));
+}
+
+// Dashboard polling /api/status every 2 s for ten minutes, with a page
+// load (HTML, CSS, JS, logo, Chart.js) on a second connection at the start
+static void testDashboardPolling() {
+  HttpKeepAlive ka;
+  uint32_t now = 0;
+
+  int page = ka.open(now);
+  for (int i = 0; i < 5; ++i) {
+    ka.beginRequest(page, now, i > 0);
+    CHECK(ka.endRequest(page, now + 20, true, true));
+    now += 20;
+  }
+
+  int poll = ka.open(now);
+  const uint32_t kPollMs = 2000;
+  const uint32_t kEndMs  = 10 * 60 * 1000;
+  uint32_t handshakes = 2;
+  while (now < kEndMs) {
+    if (!ka.inUse(poll)) {
+      poll = ka.open(now);
+      handshakes++;
+    }
+    ka.beginRequest(poll, now, false);
+    ka.endRequest(poll, now + 15, true, true);
+    now += kPollMs;
+    if (ka.expired(page, now)) ka.close(page, HTTP_CLOSE_IDLE);
+    CHECK(!ka.expired(poll, now));
+  }
+
+  const HttpConnectionStats& st = ka.stats();
+  const uint32_t polls = kEndMs / kPollMs;
+  CHECK(st.requests == polls + 5);
+  CHECK(st.accepted == handshakes);
+  CHECK(handshakes == 2 + polls / HTTP_KEEPALIVE_MAX_REQUESTS - 1);
+  CHECK(st.closed[HTTP_CLOSE_IDLE] == 1);  // the page connection
+  CHECK(st.closed[HTTP_CLOSE_LIMIT] == polls / HTTP_KEEPALIVE_MAX_REQUESTS);
+  printf("  %u requests over %u connections (%u without keep-alive)\n",
+         (unsigned)st.requests, (unsigned)st.accepted, (unsigned)st.requests);
+}
+
+int main() {
+  testRequestHead();
+  testPipelinedBuffer();
+  testDecoding();
+  testKeepAlivePolicy();
+  testEviction();
+  testDeferredRequests();
+  testDashboardPolling();
+
+  if (sFailures) {
+    fprintf(stderr, "%d check(s) failed\n", sFailures);
+    return 1;
+  }
+  printf("http server: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,264 @@
+// Host-side checks and load test for the non-blocking transfer pool (see
+// HttpTransfers.h). Built and run by test/hostTests.test.js:
+//   c++ -std=c++11 -I. test/host/httpTransfers_test.cpp HttpTransfers.cpp
+//
+// The load test runs on a simulated clock: every loop iteration does 500 us
+// of sensor/control work and pumps the pool for HTTP_TRANSFER_PUMP_US, while
+// ten clients download a 68 KB asset over links that drain 25 KB/s behind a
+// 5.7 KB socket buffer (lwIP TCP_SND_BUF) and a dashboard polls the status
+// API, which must be answered while every slot is busy. Writes and file
+// reads advance the clock by their estimated cost on the ESP32.
+#include "HttpTransfers.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static int sFailures = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      sFailures++;                                                     \
+    }                                                                  \
+  } while (0)
+
+static const uint32_t HTTP_TRANSFER_PUMP_US = 2000;  // as in WebUI.cpp
+static const uint32_t kLoopWorkUs   = 500;
+static const uint32_t kControlMaxUs = 10000;         // control tick must not slip further
+static const size_t   kSocketBuffer = 5744;
+static const size_t   kAssetBytes   = 69557;         // chart.umd.min.js.gz
+
+static uint32_t sNowUs = 0;
+static uint32_t fakeMicros() { return sNowUs; }
+
+static uint8_t assetByte(size_t i) { return (uint8_t)(i * 31 + (i >> 8)); }
+
+// Socket of a client that drains bytesPerSec from a bounded send buffer
+class SlowClient : public HttpBodySink {
+ public:
+  SlowClient(uint32_t bytesPerSec, size_t* received, bool* ok)
+    : _rate(bytesPerSec), _buffered(0), _drainedAt(sNowUs), _received(received), _ok(ok), _open(true) {}
+
+  int write(const uint8_t* data, size_t len) override {
+    drain();
+    if (!_open) return -1;
+    size_t room = kSocketBuffer - _buffered;
+    size_t n = len < room ? len : room;
+    for (size_t i = 0; i < n; ++i) {
+      if (data[i] != assetByte(*_received + i)) *_ok = false;
+    }
+    _buffered  += n;
+    *_received += n;
+    sNowUs += 15 + (uint32_t)(n / 40);  // lwIP copy
+    return (int)n;
+  }
+
+  void hangUp() { _open = false; }
+
+ private:
+  void drain() {
+    uint64_t drained = (uint64_t)(sNowUs - _drainedAt) * _rate / 1000000ULL;
+    if (drained == 0) return;
+    _buffered  = drained >= _buffered ? 0 : _buffered - (size_t)drained;
+    _drainedAt = sNowUs;
+  }
+
+  uint32_t _rate;
+  size_t   _buffered;
+  uint32_t _drainedAt;
+  size_t*  _received;
+  bool*    _ok;
+  bool     _open;
+};
+
+// LittleFS file: about 0.3 ms per 1 KB read
+class AssetFile : public HttpBodySource {
+ public:
+  explicit AssetFile(size_t len, int* live) : _pos(0), _len(len), _live(live) { ++*_live; }
+  ~AssetFile() { --*_live; }
+  size_t read(uint8_t* buf, size_t len) override {
+    size_t n = _len - _pos < len ? _len - _pos : len;
+    for (size_t i = 0; i < n; ++i) buf[i] = assetByte(_pos + i);
+    _pos += n;
+    sNowUs += 60 + (uint32_t)(n / 4);
+    return n;
+  }
+
+ private:
+  size_t _pos;
+  size_t _len;
+  int*   _live;
+};
+
+static void testConcurrentClients() {
+  const size_t kClients = 10;
+  HttpTransferPool pool(fakeMicros);
+  std::vector<size_t> received(kClients, 0);
+  std::vector<uint32_t> retryAtUs(kClients, 0);
+  bool okFlags[kClients];
+  int  liveSources = 0;
+  for (size_t i = 0; i < kClients; ++i) okFlags[i] = true;
+
+  sNowUs = 0;
+  size_t   admitted   = 0;
+  size_t   busy       = 0;  // 503 + Retry-After answers
+  uint32_t lastTickUs = 0;
+  uint32_t maxGapUs   = 0;
+  uint32_t ticks      = 0;
+  uint32_t nextPollUs = 0;
+  size_t   polls      = 0;
+  size_t   pollsFull  = 0;  // answered while every slot was busy
+  uint32_t maxPollWaitUs = 0;
+  // All ten downloads arrive at once while a dashboard polls the status API
+  // every second. Like handleWebServer(), every loop takes the next request:
+  // an API answer is written inline, a download needs a slot and is refused
+  // with 503 + Retry-After (reserveTransfer()) while every slot is busy.
+  while ((admitted < kClients || pool.active() > 0) && sNowUs < 60000000UL) {
+    const uint32_t gap = sNowUs - lastTickUs;
+    if (ticks > 0 && gap > maxGapUs) maxGapUs = gap;
+    lastTickUs = sNowUs;
+    ticks++;
+    sNowUs += kLoopWorkUs;
+
+    if (sNowUs >= nextPollUs) {
+      const uint32_t waitUs = sNowUs - nextPollUs;
+      if (waitUs > maxPollWaitUs) maxPollWaitUs = waitUs;
+      if (pool.active() == HTTP_TRANSFER_SLOTS) pollsFull++;
+      sNowUs += 400;  // /api/status?fields=sensors,relays
+      polls++;
+      nextPollUs += 1000000;
+    }
+    for (size_t i = 0; i < kClients; ++i) {
+      if (retryAtUs[i] == UINT32_MAX || sNowUs < retryAtUs[i]) continue;
+      if (pool.active() < HTTP_TRANSFER_SLOTS) {
+        CHECK(pool.start(new SlowClient(25000, &received[i], &okFlags[i]),
+                         new AssetFile(kAssetBytes, &liveSources), kAssetBytes));
+        retryAtUs[i] = UINT32_MAX;
+        admitted++;
+      } else {
+        retryAtUs[i] = sNowUs + 2000000;  // HTTP_TRANSFER_RETRY_AFTER
+        busy++;
+      }
+      break;
+    }
+    pool.pump(HTTP_TRANSFER_PUMP_US);
+  }
+
+  for (size_t i = 0; i < kClients; ++i) {
+    CHECK(received[i] == kAssetBytes);
+    CHECK(okFlags[i]);
+  }
+  CHECK(pool.stats().completed == kClients);
+  CHECK(pool.stats().aborted == 0);
+  CHECK(pool.stats().peak == HTTP_TRANSFER_SLOTS);
+  CHECK(liveSources == 0);
+  CHECK(maxGapUs <= kControlMaxUs);
+  CHECK(busy > 0);
+  CHECK(pollsFull > 0);
+  CHECK(polls >= lastTickUs / 1000000);
+  CHECK(maxPollWaitUs <= kControlMaxUs);
+
+  // The same download written synchronously, as streamFile() did
+  sNowUs = 0;
+  size_t blockingReceived = 0;
+  bool   blockingOk = true;
+  SlowClient blocking(25000, &blockingReceived, &blockingOk);
+  AssetFile  file(kAssetBytes, &liveSources);
+  uint8_t buf[HTTP_TRANSFER_SLICE];
+  size_t n;
+  while ((n = file.read(buf, sizeof(buf))) > 0) {
+    size_t off = 0;
+    while (off < n) {
+      int w = blocking.write(buf + off, n - off);
+      if (w == 0) sNowUs += 1000;  // WiFiClient::write() waits in select()
+      off += (size_t)w;
+    }
+  }
+  CHECK(blockingReceived == kAssetBytes);
+
+  printf("10 clients x %u bytes: %.1f s total, %u loop ticks, longest control gap %.2f ms, "
+         "%u busy answers, %u status polls (%u with every slot busy, longest wait %.2f ms) "
+         "(one blocking download stalls the loop for %.2f s)\n",
+         (unsigned)kAssetBytes, lastTickUs / 1e6, (unsigned)ticks, maxGapUs / 1000.0, (unsigned)busy,
+         (unsigned)polls, (unsigned)pollsFull, maxPollWaitUs / 1000.0, sNowUs / 1e6);
+}
+
+static void testFailures() {
+  sNowUs = 0;
+  HttpTransferPool pool(fakeMicros);
+  int live = 0;
+
+  // A client that hangs up is dropped at its next write
+  size_t gotA = 0;
+  bool   okA  = true;
+  SlowClient* gone = new SlowClient(25000, &gotA, &okA);
+  CHECK(pool.start(gone, new AssetFile(kAssetBytes, &live), kAssetBytes));
+  pool.pump(HTTP_TRANSFER_PUMP_US);
+  gone->hangUp();
+  pool.pump(HTTP_TRANSFER_PUMP_US);
+  CHECK(pool.active() == 0);
+  CHECK(pool.stats().aborted == 1);
+
+  // A client that stops reading is dropped after HTTP_TRANSFER_STALL_MS
+  size_t gotB = 0;
+  bool   okB  = true;
+  CHECK(pool.start(new SlowClient(0, &gotB, &okB), new AssetFile(kAssetBytes, &live), kAssetBytes));
+  pool.pump(HTTP_TRANSFER_PUMP_US);
+  CHECK(gotB == kSocketBuffer);
+  sNowUs += HTTP_TRANSFER_STALL_MS * 1000UL - 1000;
+  pool.pump(HTTP_TRANSFER_PUMP_US);
+  CHECK(pool.active() == 1);
+  sNowUs += 2000;
+  pool.pump(HTTP_TRANSFER_PUMP_US);
+  CHECK(pool.active() == 0);
+  CHECK(pool.stats().aborted == 2);
+
+  // A file shorter than its Content-Length ends the connection
+  size_t gotC = 0;
+  bool   okC  = true;
+  CHECK(pool.start(new SlowClient(1000000, &gotC, &okC), new AssetFile(100, &live), 200));
+  for (int i = 0; i < 10 && pool.active(); ++i) pool.pump(HTTP_TRANSFER_PUMP_US);
+  CHECK(pool.active() == 0);
+  CHECK(pool.stats().aborted == 3);
+
+  // A body of unknown length completes when its source ends
+  size_t gotD = 0;
+  bool   okD  = true;
+  CHECK(pool.start(new SlowClient(1000000, &gotD, &okD), new AssetFile(3000, &live), HTTP_TRANSFER_UNTIL_END));
+  for (int i = 0; i < 10 && pool.active(); ++i) pool.pump(HTTP_TRANSFER_PUMP_US);
+  CHECK(pool.active() == 0);
+  CHECK(gotD == 3000 && okD);
+  CHECK(pool.stats().completed == 1);
+  CHECK(pool.stats().aborted == 3);
+
+  // Every slot busy: start() refuses and the caller keeps ownership
+  size_t got[HTTP_TRANSFER_SLOTS + 1] = {};
+  bool   ok[HTTP_TRANSFER_SLOTS + 1];
+  for (size_t i = 0; i < HTTP_TRANSFER_SLOTS; ++i) {
+    CHECK(pool.start(new SlowClient(0, &got[i], &ok[i]), new AssetFile(kAssetBytes, &live), kAssetBytes));
+  }
+  SlowClient extraSink(0, &got[HTTP_TRANSFER_SLOTS], &ok[HTTP_TRANSFER_SLOTS]);
+  AssetFile  extraFile(kAssetBytes, &live);
+  CHECK(!pool.start(&extraSink, &extraFile, kAssetBytes));
+  CHECK(pool.stats().refused == 1);
+
+  pool.abortAll();
+  CHECK(pool.active() == 0);
+  CHECK(live == 1);  // only extraFile
+  CHECK(pool.pump(HTTP_TRANSFER_PUMP_US) == 0);
+}
+
+int main() {
+  testConcurrentClients();
+  testFailures();
+
+  if (sFailures) {
+    fprintf(stderr, "%d check(s) failed\n", sFailures);
+    return 1;
+  }
+  printf("http transfers: all checks passed\n");
+  return 0;
+}
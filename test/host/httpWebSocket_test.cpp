@@ -0,0 +1,173 @@
+// Host-side checks for the WebSocket framing, handshake and command fields
+// (see HttpWebSocket.h). Built and run by test/hostTests.test.js:
+//   c++ -std=c++11 -I. test/host/httpWebSocket_test.cpp HttpWebSocket.cpp HttpParser.cpp HttpEvents.cpp
+//
+// testCommandRoundTrip() follows a toggle from the client's masked frame to
+// the acknowledgement on the wire: both happen in one loop() pass, where
+// polling confirmed a toggle only with the next /api/status (up to 2 s).
+#include "HttpEvents.h"
+#include "HttpWebSocket.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+static int sFailures = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      sFailures++;                                                     \
+    }                                                                  \
+  } while (0)
+
+class StringSink : public HttpBodySink {
+ public:
+  explicit StringSink(std::string* out) : _out(out) {}
+  int write(const uint8_t* data, size_t len) override {
+    _out->append(reinterpret_cast<const char*>(data), len);
+    return (int)len;
+  }
+
+ private:
+  std::string* _out;
+};
+
+// A frame as a browser sends it: FIN, masked
+static std::string clientFrame(uint8_t opcode, const std::string& payload) {
+  static const uint8_t kMask[4] = { 0x37, 0xFA, 0x21, 0x3D };
+  std::string f;
+  f += (char)(0x80 | opcode);
+  if (payload.size() < 126) {
+    f += (char)(0x80 | payload.size());
+  } else {
+    f += (char)(0x80 | 126);
+    f += (char)(payload.size() >> 8);
+    f += (char)(payload.size() & 0xFF);
+  }
+  f.append(reinterpret_cast<const char*>(kMask), 4);
+  for (size_t i = 0; i < payload.size(); ++i) f += (char)(payload[i] ^ kMask[i & 3]);
+  return f;
+}
+
+static std::string hex(const uint8_t* d, size_t n) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string s;
+  for (size_t i = 0; i < n; ++i) {
+    s += kDigits[d[i] >> 4];
+    s += kDigits[d[i] & 15];
+  }
+  return s;
+}
+
+static void testHandshake() {
+  uint8_t digest[20];
+  httpSha1(reinterpret_cast<const uint8_t*>("abc"), 3, digest);
+  CHECK(hex(digest, 20) == "a9993e364706816aba3e25717850c26c9cd0d89d");
+  const char* twoBlocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  httpSha1(reinterpret_cast<const uint8_t*>(twoBlocks), strlen(twoBlocks), digest);
+  CHECK(hex(digest, 20) == "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+  httpSha1(reinterpret_cast<const uint8_t*>(""), 0, digest);
+  CHECK(hex(digest, 20) == "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+
+  // RFC 6455 section 1.3
+  char accept[29];
+  httpWsAcceptKey("dGhlIHNhbXBsZSBub25jZQ==", 24, accept);
+  CHECK(strcmp(accept, "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") == 0);
+}
+
+static void testParseFrames() {
+  std::string buf = clientFrame(HTTP_WS_TEXT, "{\"op\":\"toggle\"}");
+  HttpWsFrame frame;
+  uint8_t* p = reinterpret_cast<uint8_t*>(&buf[0]);
+
+  // Incomplete until the last byte is in
+  for (size_t n = 0; n < buf.size(); ++n) CHECK(httpWsParseFrame(p, n, frame) == 0);
+  CHECK(httpWsParseFrame(p, buf.size(), frame) == (long)buf.size());
+  CHECK(frame.opcode == HTTP_WS_TEXT);
+  CHECK(std::string(reinterpret_cast<char*>(frame.payload), frame.len) == "{\"op\":\"toggle\"}");
+
+  // 16-bit length
+  std::string big = clientFrame(HTTP_WS_TEXT, std::string(200, 'x'));
+  CHECK(httpWsParseFrame(reinterpret_cast<uint8_t*>(&big[0]), big.size(), frame) == (long)big.size());
+  CHECK(frame.len == 200);
+
+  // Refused: unmasked, fragmented, reserved bits, oversized, long control frames
+  std::string unmasked = clientFrame(HTTP_WS_TEXT, "hi");
+  unmasked[1] &= 0x7F;
+  CHECK(httpWsParseFrame(reinterpret_cast<uint8_t*>(&unmasked[0]), unmasked.size(), frame) == -1);
+  std::string fragment = clientFrame(HTTP_WS_TEXT, "hi");
+  fragment[0] &= 0x7F;
+  CHECK(httpWsParseFrame(reinterpret_cast<uint8_t*>(&fragment[0]), fragment.size(), frame) == -1);
+  std::string reserved = clientFrame(HTTP_WS_TEXT, "hi");
+  reserved[0] |= 0x40;
+  CHECK(httpWsParseFrame(reinterpret_cast<uint8_t*>(&reserved[0]), reserved.size(), frame) == -1);
+  std::string tooBig = clientFrame(HTTP_WS_TEXT, std::string(HTTP_WS_MAX_MESSAGE + 1, 'x'));
+  CHECK(httpWsParseFrame(reinterpret_cast<uint8_t*>(&tooBig[0]), 4, frame) == -1);
+  std::string longPing = clientFrame(HTTP_WS_PING, std::string(126, 'x'));
+  CHECK(httpWsParseFrame(reinterpret_cast<uint8_t*>(&longPing[0]), longPing.size(), frame) == -1);
+
+  // Server headers
+  uint8_t head[4];
+  CHECK(httpWsFrameHeader(head, HTTP_WS_TEXT, 125) == 2);
+  CHECK(head[0] == 0x81 && head[1] == 125);
+  CHECK(httpWsFrameHeader(head, HTTP_WS_CLOSE, 300) == 4);
+  CHECK(head[0] == 0x88 && head[1] == 126 && head[2] == 1 && head[3] == 44);
+}
+
+static void testJsonFields() {
+  const char* msg = "{ \"op\" : \"mode\", \"id\":\"fan\", \"note\":\"id \\\"x\\\"\", \"auto\":true, \"seq\":-42 }";
+  const size_t len = strlen(msg);
+  char out[12];
+  long v = 0;
+  CHECK(httpJsonFindString(msg, len, "op", out, sizeof(out)) && strcmp(out, "mode") == 0);
+  CHECK(httpJsonFindString(msg, len, "id", out, sizeof(out)) && strcmp(out, "fan") == 0);
+  CHECK(httpJsonFindString(msg, len, "note", out, sizeof(out)) && strcmp(out, "id \"x\"") == 0);
+  CHECK(httpJsonFindInt(msg, len, "auto", v) && v == 1);
+  CHECK(httpJsonFindInt(msg, len, "seq", v) && v == -42);
+
+  CHECK(!httpJsonFindString(msg, len, "missing", out, sizeof(out)));
+  CHECK(!httpJsonFindString(msg, len, "seq", out, sizeof(out)));  // not a string
+  CHECK(!httpJsonFindInt(msg, len, "op", v));
+  CHECK(!httpJsonFindString(msg, len, "op", out, 4));              // does not fit
+  CHECK(!httpJsonFindString("{\"op\":\"mo", 9, "op", out, sizeof(out)));
+}
+
+static void testCommandRoundTrip() {
+  HttpEventStream es;
+  std::string wire;
+  const int slot = es.subscribe(new StringSink(&wire), 0, HTTP_EVENT_WEBSOCKET);
+  CHECK(slot >= 0);
+
+  // What WebUI.cpp does with a text frame within one loop() pass
+  std::string in = clientFrame(HTTP_WS_TEXT, "{\"op\":\"toggle\",\"id\":\"fan\",\"seq\":7}");
+  HttpWsFrame frame;
+  CHECK(httpWsParseFrame(reinterpret_cast<uint8_t*>(&in[0]), in.size(), frame) > 0);
+  const char* cmd = reinterpret_cast<const char*>(frame.payload);
+  char op[12], id[12];
+  long seq = 0;
+  CHECK(httpJsonFindString(cmd, frame.len, "op", op, sizeof(op)) && strcmp(op, "toggle") == 0);
+  CHECK(httpJsonFindString(cmd, frame.len, "id", id, sizeof(id)) && strcmp(id, "fan") == 0);
+  CHECK(httpJsonFindInt(cmd, frame.len, "seq", seq) && seq == 7);
+
+  const char ack[] = "{\"seq\":7,\"ok\":true,\"changed\":true,\"id\":\"fan\",\"state\":1,\"auto\":0}";
+  CHECK(es.sendTo(slot, "ack", ack, sizeof(ack) - 1));
+  es.pump(0);
+  const std::string text = std::string("{\"type\":\"ack\",\"data\":") + ack + "}";
+  CHECK(wire == std::string("\x81") + (char)text.size() + text);
+}
+
+int main() {
+  testHandshake();
+  testParseFrames();
+  testJsonFields();
+  testCommandRoundTrip();
+
+  if (sFailures) {
+    fprintf(stderr, "%d check(s) failed\n", sFailures);
+    return 1;
+  }
+  printf("http websocket: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,221 @@
+// Host-side checks for the streaming JSON writer (see JsonWriter.h). Built
+// and run by test/hostTests.test.js:
+//   c++ -std=c++11 -I. test/host/jsonWriter_test.cpp
+//
+// testStatusWithoutAllocation() renders a /api/status-sized document through
+// a 256-byte chunk buffer, as JsonResponse does in WebUI.cpp, under a
+// counting operator new and expects zero allocations; the String-based
+// handler it replaces made dozens per request.
+#include "JsonWriter.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <string>
+
+static int sFailures = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      sFailures++;                                                     \
+    }                                                                  \
+  } while (0)
+
+static size_t sAllocs = 0;
+
+void* operator new(size_t n) {
+  sAllocs++;
+  if (void* p = malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+struct Sink {
+  std::string text;
+  void write(const char* data, size_t len) { text.append(data, len); }
+};
+
+// Fixed chunk flushed into a preallocated "socket"
+struct ChunkOut {
+  char   chunk[256];
+  size_t used;
+  char   wire[8192];
+  size_t sent;
+  size_t flushes;
+
+  ChunkOut() : used(0), sent(0), flushes(0) {}
+
+  void write(const char* data, size_t len) {
+    while (len > 0) {
+      if (used == sizeof(chunk)) flush();
+      size_t n = sizeof(chunk) - used;
+      if (n > len) n = len;
+      memcpy(chunk + used, data, n);
+      used += n;
+      data += n;
+      len  -= n;
+    }
+  }
+
+  void flush() {
+    if (used == 0 || sent + used > sizeof(wire)) return;
+    memcpy(wire + sent, chunk, used);
+    sent += used;
+    used = 0;
+    flushes++;
+  }
+};
+
+static std::string fixedText(float v, uint8_t decimals) {
+  Sink s;
+  JsonWriter<Sink> json(s);
+  json.value(jsonFixed(v, decimals));
+  return s.text;
+}
+
+static void testStructure() {
+  Sink s;
+  JsonWriter<Sink> json(s);
+  json.beginObject();
+  json.field("ok", true);
+  json.key("list").beginArray().value(1).value("two").null().beginObject().endObject().beginArray().endArray().endArray();
+  json.key("nested").beginObject().field("a", 0).key("b").beginObject().field("c", false).endObject().endObject();
+  json.field("raw", jsonRaw("{\"x\":1}", 7));
+  json.field("name", std::string("Herbs"));
+  json.field("none", (const char*)nullptr);
+  json.endObject();
+  CHECK(s.text == "{\"ok\":true,\"list\":[1,\"two\",null,{},[]],\"nested\":{\"a\":0,\"b\":{\"c\":false}},"
+                  "\"raw\":{\"x\":1},\"name\":\"Herbs\",\"none\":null}");
+  CHECK(json.depth() == 0);
+}
+
+static void testEscaping() {
+  Sink s;
+  JsonWriter<Sink> json(s);
+  json.value("say \"hi\" \\ tab\there\nnew\r\x01\x1f 08:00\xe2\x80\x93" "20:00");
+  CHECK(s.text == "\"say \\\"hi\\\" \\\\ tab\\there\\nnew\\r\\u0001\\u001f 08:00\xe2\x80\x93" "20:00\"");
+
+  // Pieces of one string value
+  Sink p;
+  JsonWriter<Sink> parts(p);
+  parts.beginString().part("08:00").part("\xe2\x80\x93").part("20:00 \"x\"", 9).endString();
+  CHECK(p.text == "\"08:00\xe2\x80\x93" "20:00 \\\"x\\\"\"");
+}
+
+static void testNumbers() {
+  Sink s;
+  JsonWriter<Sink> json(s);
+  json.beginArray();
+  json.value(0).value(-7).value(INT_MIN).value(LLONG_MIN).value(ULLONG_MAX).value((unsigned)UINT_MAX);
+  json.value((uint8_t)200).value((int16_t)-300).value((size_t)42);
+  json.endArray();
+  CHECK(s.text == "[0,-7,-2147483648,-9223372036854775808,18446744073709551615,4294967295,200,-300,42]");
+
+  CHECK(fixedText(21.5f, 1) == "21.5");
+  CHECK(fixedText(55.4f, 0) == "55");
+  CHECK(fixedText(-3.04f, 1) == "-3.0");
+  CHECK(fixedText(0.05f, 2) == "0.05");
+  CHECK(fixedText(7.0f, 3) == "7.000");
+  CHECK(fixedText(NAN, 1) == "null");
+  CHECK(fixedText(INFINITY, 1) == "null");
+  CHECK(fixedText(1e16f, 1) == "null");
+
+  // Same digits as printf away from exact ties
+  int mismatches = 0;
+  for (int i = 0; i < 20000; ++i) {
+    const float v = -60.0f + i * 0.00731f;
+    for (uint8_t d = 0; d <= 3; ++d) {
+      char expected[32];
+      snprintf(expected, sizeof(expected), "%.*f", (int)d, (double)v);
+      const double scaled = fabs((double)v) * pow(10.0, d);
+      if (fabs(scaled - floor(scaled) - 0.5) < 1e-6) continue;
+      if (fixedText(v, d) != expected) mismatches++;
+    }
+  }
+  CHECK(mismatches == 0);
+}
+
+template <typename Out>
+static void writeStatus(JsonWriter<Out>& json, const std::string& ssid) {
+  json.beginObject();
+  json.field("time", "12:34:56");
+  json.field("time_synced", true);
+  json.field("timezone", "CET/CEST");
+  json.key("wifi").beginObject().field("connected", true).field("mode", "STA")
+      .field("ssid", ssid).field("rssi", -61).field("ip", "192.168.1.40").endObject();
+  json.key("sensors").beginObject().field("temp_c", jsonFixed(21.53f, 1)).field("hum_rh", jsonFixed(NAN, 0))
+      .field("soil1", 41).field("soil2", 38).endObject();
+  json.key("chambers").beginArray();
+  for (int i = 0; i < 2; ++i) {
+    json.beginObject().field("id", i + 1).field("name", i ? "Chamber \"2\"" : "Herbs")
+        .field("soil_dry_threshold", 30).field("profile_label", "Tomatoes - fruiting").endObject();
+  }
+  json.endArray();
+  json.key("flash").beginObject();
+  for (int p = 0; p < 8; ++p) {
+    json.key(p % 2 ? "nvs" : "littlefs").beginObject().field("size", 0x160000UL)
+        .field("erases", (unsigned long long)123456789012ULL).field("lifetime_days", (const char*)nullptr).endObject();
+  }
+  json.endObject();
+  json.key("http").beginObject();
+  for (int r = 0; r < 40; ++r) json.field("counter", (unsigned long)(r * 1009));
+  json.endObject();
+  json.endObject();
+}
+
+static void testStatusWithoutAllocation() {
+  const std::string ssid = "greenhouse-wifi";
+  Sink reference;
+  JsonWriter<Sink> refJson(reference);
+  writeStatus(refJson, ssid);
+
+  static ChunkOut out;
+  sAllocs = 0;
+  {
+    JsonWriter<ChunkOut> json(out);
+    writeStatus(json, ssid);
+    out.flush();
+  }
+  const size_t allocs = sAllocs;
+  CHECK(allocs == 0);
+  CHECK(out.flushes > 3);
+  CHECK(std::string(out.wire, out.sent) == reference.text);
+  CHECK(reference.text.find("\"hum_rh\":null") != std::string::npos);
+  printf("  status-sized document: %u bytes, %u flushes, %u allocations\n",
+         (unsigned)out.sent, (unsigned)out.flushes, (unsigned)allocs);
+}
+
+static void testJsonBuffer() {
+  char buf[16];
+  JsonBuffer b(buf, sizeof(buf));
+  JsonWriter<JsonBuffer> json(b);
+  json.beginObject().field("seq", 7).endObject();
+  CHECK(std::string(b.data(), b.size()) == "{\"seq\":7}");
+  CHECK(!b.overflow());
+  json.field("more", "data that does not fit");
+  CHECK(b.overflow());
+  CHECK(b.size() == sizeof(buf));
+}
+
+int main() {
+  testStructure();
+  testEscaping();
+  testNumbers();
+  testStatusWithoutAllocation();
+  testJsonBuffer();
+
+  if (sFailures) {
+    fprintf(stderr, "%d check(s) failed\n", sFailures);
+    return 1;
+  }
+  printf("json writer: all checks passed\n");
+  return 0;
+}
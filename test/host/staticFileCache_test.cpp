@@ -0,0 +1,187 @@
+// Host-side checks for the static file LRU cache (see StaticFileCache.h).
+// Built and run by test/hostTests.test.js:
+//   c++ -std=c++11 -I. test/host/staticFileCache_test.cpp StaticFileCache.cpp
+#include "StaticFileCache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int sFailures = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      sFailures++;                                                     \
+    }                                                                  \
+  } while (0)
+
+// Counting allocator that can be told to fail
+static int  sLive      = 0;
+static bool sAllocFail = false;
+
+static void* countingAlloc(size_t n) {
+  if (sAllocFail) return nullptr;
+  sLive++;
+  return malloc(n);
+}
+
+static void countingFree(void* p) {
+  sLive--;
+  free(p);
+}
+
+static bool put(StaticFileCache& cache, const char* key, size_t len, char fill, uint32_t stamp = 0) {
+  uint8_t* buf = cache.insert(key, len, stamp);
+  if (!buf) return false;
+  memset(buf, fill, len);
+  return true;
+}
+
+static void testHitsAndMisses() {
+  StaticFileCache cache(1000, 500, countingAlloc, countingFree);
+  CHECK(cache.get("/app.js.gz") == nullptr);
+  CHECK(put(cache, "/app.js.gz", 300, 'a', 42));
+
+  const StaticCacheEntry* e = cache.get("/app.js.gz");
+  CHECK(e != nullptr);
+  CHECK(e && e->len == 300 && e->stamp == 42 && e->data[0] == 'a' && e->data[299] == 'a');
+  CHECK(cache.get("/app.js") == nullptr);  // other representation
+
+  CHECK(cache.stats().hits == 1);
+  CHECK(cache.stats().misses == 2);
+  CHECK(cache.stats().inserts == 1);
+  CHECK(cache.bytes() == 300);
+  CHECK(cache.entries() == 1);
+}
+
+static void testLruEviction() {
+  StaticFileCache cache(1000, 500, countingAlloc, countingFree);
+  CHECK(put(cache, "/a", 400, 'a'));
+  CHECK(put(cache, "/b", 400, 'b'));
+  CHECK(cache.get("/a") != nullptr);  // /b is now least recently used
+
+  CHECK(put(cache, "/c", 400, 'c'));
+  CHECK(cache.get("/b") == nullptr);
+  CHECK(cache.get("/a") != nullptr);
+  CHECK(cache.get("/c") != nullptr);
+  CHECK(cache.bytes() == 800);
+  CHECK(cache.stats().evictions == 1);
+
+  // A body that needs two evictions
+  CHECK(put(cache, "/d", 500, 'd'));
+  CHECK(cache.bytes() <= cache.budget());
+  CHECK(cache.get("/d") != nullptr);
+
+  // Slot limit: many small entries keep only the newest STATIC_CACHE_SLOTS
+  StaticFileCache small(100000, 100, countingAlloc, countingFree);
+  char key[16];
+  for (int i = 0; i < (int)STATIC_CACHE_SLOTS + 3; ++i) {
+    snprintf(key, sizeof(key), "/f%d", i);
+    CHECK(put(small, key, 10, 'x'));
+  }
+  CHECK(small.entries() == STATIC_CACHE_SLOTS);
+  CHECK(small.get("/f0") == nullptr);
+  snprintf(key, sizeof(key), "/f%d", (int)STATIC_CACHE_SLOTS + 2);
+  CHECK(small.get(key) != nullptr);
+}
+
+static void testRejects() {
+  StaticFileCache cache(1000, 500, countingAlloc, countingFree);
+  CHECK(put(cache, "/small", 100, 's'));
+  CHECK(!put(cache, "/chart.umd.min.js.gz", 501, 'c'));  // over the per-file limit
+  CHECK(cache.get("/small") != nullptr);                 // nothing evicted for it
+  CHECK(!put(cache, "/empty", 0, 'e'));
+  CHECK(!put(cache, "/a/very/long/path/that/does/not/fit/the/key.js", 10, 'k'));
+
+  sAllocFail = true;
+  CHECK(!put(cache, "/nomem", 10, 'n'));
+  sAllocFail = false;
+  CHECK(cache.stats().rejected == 4);
+
+  // The per-file limit never exceeds the budget
+  StaticFileCache tight(200, 500, countingAlloc, countingFree);
+  CHECK(tight.maxFileBytes() == 200);
+  CHECK(!put(tight, "/x", 201, 'x'));
+}
+
+static void testReplaceAndRemove() {
+  StaticFileCache cache(1000, 500, countingAlloc, countingFree);
+  CHECK(put(cache, "/app.css.gz", 200, '1', 1));
+  CHECK(put(cache, "/app.css.gz", 300, '2', 2));
+  CHECK(cache.entries() == 1);
+  CHECK(cache.bytes() == 300);
+  const StaticCacheEntry* e = cache.get("/app.css.gz");
+  CHECK(e && e->stamp == 2 && e->data[0] == '2');
+
+  cache.remove("/app.css.gz");
+  CHECK(cache.get("/app.css.gz") == nullptr);
+  CHECK(cache.bytes() == 0);
+}
+
+static void testGeneration() {
+  StaticFileCache cache(1000, 500, countingAlloc, countingFree);
+  CHECK(cache.setGeneration(7));  // first generation, nothing to drop
+  CHECK(cache.stats().invalidations == 0);
+  CHECK(put(cache, "/app.js.gz", 100, 'a'));
+  CHECK(put(cache, "/logo-ezgrow.png", 100, 'l'));
+
+  CHECK(!cache.setGeneration(7));
+  CHECK(cache.entries() == 2);
+
+  CHECK(cache.setGeneration(8));  // new filesystem image
+  CHECK(cache.entries() == 0);
+  CHECK(cache.bytes() == 0);
+  CHECK(cache.get("/app.js.gz") == nullptr);
+  CHECK(cache.stats().invalidations == 1);
+}
+
+static void testPins() {
+  StaticFileCache cache(1000, 500, countingAlloc, countingFree);
+  CHECK(put(cache, "/app.js.gz", 400, 'a'));
+  CHECK(put(cache, "/app.css.gz", 400, 'c'));
+  const StaticCacheEntry* js = cache.get("/app.js.gz");
+  cache.pin(js);
+  cache.get("/app.css.gz");  // /app.js.gz is now least recently used, but pinned
+
+  CHECK(put(cache, "/logo-ezgrow.png", 400, 'l'));
+  CHECK(cache.get("/app.js.gz") == js);
+  CHECK(cache.get("/app.css.gz") == nullptr);
+
+  // Nothing left to evict while the rest is pinned
+  const StaticCacheEntry* logo = cache.get("/logo-ezgrow.png");
+  cache.pin(logo);
+  CHECK(!put(cache, "/other", 400, 'o'));
+
+  // A pinned entry outlives a generation change until it is unpinned
+  CHECK(cache.setGeneration(3));
+  CHECK(cache.get("/app.js.gz") == nullptr);
+  CHECK(js->data[0] == 'a' && js->data[399] == 'a');
+  CHECK(cache.bytes() == 800);
+  CHECK(put(cache, "/app.js.gz", 100, 'n'));  // new body next to the old one
+  CHECK(cache.get("/app.js.gz") != js);
+
+  cache.unpin(js);
+  cache.unpin(logo);
+  CHECK(cache.bytes() == 100);
+  CHECK(cache.entries() == 1);
+  cache.unpin(logo);  // unbalanced unpin is ignored
+}
+
+int main() {
+  testHitsAndMisses();
+  testLruEviction();
+  testRejects();
+  testReplaceAndRemove();
+  testGeneration();
+  testPins();
+  CHECK(sLive == 0);  // every body freed by the destructors
+
+  if (sFailures) {
+    fprintf(stderr, "%d check(s) failed\n", sFailures);
+    return 1;
+  }
+  printf("static file cache: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,45 @@
+import test from 'node:test';
+import { strict as assert } from 'node:assert';
+import { readdirSync, readFileSync } from 'node:fs';
+import { join } from 'node:path';
+import { buildAndRun, cxx, haveCompiler, repoRoot } from './helpers/hostBuild.js';
+
+// Builds and runs every test/host/*_test.cpp. Each file's leading comment
+// lists its build lines ("//   c++ -std=c++11 -I. <sources>"); a file with
+// several lines, such as one per -D option, is built once per line.
+const skip = !haveCompiler && `${cxx} not found`;
+const hostDir = join(repoRoot, 'test/host');
+
+function buildLines(file){
+  const lines = [];
+  for (const line of readFileSync(join(hostDir, file), 'utf8').split(/\r?\n/)){
+    if (!line.startsWith('//')) break;
+    const m = /^\/\/\s+c\+\+\s+(.*)$/.exec(line);
+    if (!m) continue;
+    const args = m[1].trim().split(/\s+/).filter(arg => !arg.startsWith('-std=') && arg !== '-I.');
+    lines.push({
+      flags: args.filter(arg => arg.startsWith('-')),
+      sources: args.filter(arg => !arg.startsWith('-')),
+    });
+  }
+  return lines;
+}
+
+for (const file of readdirSync(hostDir).filter(f => f.endsWith('_test.cpp')).sort()){
+  const name = file.replace(/\.cpp$/, '');
+  const lines = buildLines(file);
+
+  test(`${name} lists its build line`, () => {
+    assert.ok(lines.length > 0, `no "//   c++ ..." line in test/host/${file}`);
+    for (const { sources } of lines) assert.equal(sources[0], `test/host/${file}`);
+  });
+
+  lines.forEach(({ flags, sources }, i) => {
+    const title = [name, ...flags].join(' ');
+    test(`${title} (host build)`, { skip }, () => {
+      const { build, run } = buildAndRun(i ? `${name}_${i}` : name, sources, flags);
+      assert.equal(build.status, 0, build.stderr);
+      assert.equal(run.status, 0, run.stderr);
+    });
+  });
+}
@@ -0,0 +1,47 @@
+import test from 'node:test';
+import { readFileSync } from 'node:fs';
+import { strict as assert } from 'node:assert';
+
+const webUiSource = readFileSync(new URL('../WebUI.cpp', import.meta.url), 'utf8').replace(/\r\n/g, '\n');
+
+function handlerBody(name){
+  const start = webUiSource.indexOf(`static void ${name}() {`);
+  assert.notEqual(start, -1, `${name} not found`);
+  const end = webUiSource.indexOf('\n}\n', start);
+  return webUiSource.slice(start, end);
+}
+
+const PAGE_HANDLERS = ['handleRoot', 'handleConfigGet', 'handleWifiConfigGet', 'handleWifiConfigPost'];
+
+test('HTML pages stream through the page writer instead of a page-sized String', () => {
+  for (const name of PAGE_HANDLERS){
+    const body = handlerBody(name);
+    assert.match(body, /PageWriter page;/, name);
+    assert.match(body, /endPage\(page\);/, name);
+    assert.doesNotMatch(body, /\.reserve\(/, name);
+    assert.doesNotMatch(body, /server\.send\(200, "text\/html", page\)/, name);
+  }
+  assert.match(webUiSource, /static void beginPage\(PageWriter& page,/);
+  assert.match(webUiSource, /static void appendWifiConfigSection\(PageWriter& page,/);
+});
+
+test('page writer sends fixed-size chunks with chunked encoding', () => {
+  assert.match(webUiSource, /static const size_t PAGE_CHUNK_SIZE = \d+;/);
+  assert.match(webUiSource, /char\s+_chunk\[PAGE_CHUNK_SIZE\];/);
+  assert.match(webUiSource, /server\.sendContent\(_chunk, _used\);/);
+});
+
+test('page handlers escape values in place instead of concatenating temporaries', () => {
+  for (const name of PAGE_HANDLERS){
+    assert.doesNotMatch(handlerBody(name), /"\s*\+\s*htmlEscape\(/, name);
+  }
+  assert.doesNotMatch(webUiSource, /static String htmlEscape\(/);
+});
+
+test('Wi-Fi scan starts only after the rendered part of the page has been flushed', () => {
+  const start = webUiSource.indexOf('static void appendWifiConfigSection(PageWriter& page) {');
+  assert.notEqual(start, -1);
+  const body = webUiSource.slice(start, webUiSource.indexOf('\n}\n', start));
+  assert.match(body, /page\.flush\(\);\s*int n = WiFi\.scanNetworks\(\);/);
+  assert.doesNotMatch(handlerBody('handleConfigGet'), /scanNetworks/);
+});
@@ -1,5 +1,7 @@
 import test from 'node:test';
-import { readFileSync } from 'node:fs';
+import { existsSync, readFileSync } from 'node:fs';
+import { createHash } from 'node:crypto';
+import { gunzipSync } from 'node:zlib';
 import { strict as assert } from 'node:assert';
 
 const webUiSource = readFileSync(new URL('../WebUI.cpp', import.meta.url), 'utf8');
@@ -18,3 +20,99 @@ test('registers logo route in static assets block', () => {
   );
   assert.match(webUiSource, pattern);
 });
+
+const dataDir = new URL('../data/', import.meta.url);
+
+function staticRoutes(){
+  const handlers = new Map();
+  for (const m of webUiSource.matchAll(/static void (\w+)\(\)\s*\{[^}]*?streamStaticFile\("([^"]+)",\s*"([^"]+)"\);/gs)){
+    handlers.set(m[1], { path: m[2], type: m[3] });
+  }
+  const routes = [];
+  for (const m of webUiSource.matchAll(/server\.on\("([^"]+)",\s*HTTP_GET,\s*(\w+)\);/g)){
+    if (handlers.has(m[2])) routes.push({ uri: m[1], handler: m[2], ...handlers.get(m[2]) });
+  }
+  return routes;
+}
+
+test('static asset routes resolve to files in data/', () => {
+  const routes = staticRoutes();
+  for (const uri of ['/chart.umd.min.js', '/app.js', '/app.css', '/logo-ezgrow.png']){
+    assert.ok(routes.some(r => r.uri === uri), `${uri} is not routed to streamStaticFile`);
+  }
+  for (const route of routes){
+    assert.equal(route.path, route.uri, `${route.handler} serves ${route.path} for ${route.uri}`);
+    assert.ok(existsSync(new URL(route.path.slice(1), dataDir)), `data${route.path} is missing`);
+  }
+});
+
+test('gzip variants exist and match the plain assets', () => {
+  for (const name of ['chart.umd.min.js', 'app.js', 'app.css']){
+    const gzUrl = new URL(`${name}.gz`, dataDir);
+    assert.ok(existsSync(gzUrl), `data/${name}.gz is missing (run node scripts/build-assets.mjs)`);
+    const plain = readFileSync(new URL(name, dataDir));
+    assert.ok(gunzipSync(readFileSync(gzUrl)).equals(plain),
+      `data/${name}.gz is out of date (run node scripts/build-assets.mjs)`);
+  }
+});
+
+test('streamStaticFile prefers the .gz variant when the client accepts gzip', () => {
+  const body = webUiSource.match(/static void streamStaticFile\([^)]*\)\s*\{([\s\S]*?)\n\}/)[1];
+  assert.match(body, /server\.sendHeader\("Vary", "Accept-Encoding"\);/);
+  assert.match(body, /if \(clientAcceptsGzip\(\)\) \{\s*String gz = file \+ "\.gz";[\s\S]*if \(gzip\) file = gz;/);
+  assert.match(body, /sStaticCache\.get\(file\.c_str\(\)\)[\s\S]*f = LittleFS\.open\(file, "r"\);/);
+  assert.match(webUiSource, /kCollectedHeaders\[\] = \{[^}]*"Accept-Encoding"[^}]*\}/);
+});
+
+test('asset manifest lists the current content hashes', () => {
+  const manifestUrl = new URL('asset-manifest.txt', dataDir);
+  assert.ok(existsSync(manifestUrl), 'data/asset-manifest.txt is missing (run node scripts/build-assets.mjs)');
+  const entries = new Map(readFileSync(manifestUrl, 'utf8').trim().split('\n').map(line => line.split(' ')));
+  for (const route of staticRoutes()){
+    const name = route.path.slice(1);
+    const hash = createHash('sha256').update(readFileSync(new URL(name, dataDir))).digest('hex').slice(0, 16);
+    assert.equal(entries.get(name), hash, `data/asset-manifest.txt is out of date for ${name} (run node scripts/build-assets.mjs)`);
+  }
+});
+
+test('pages link fingerprinted asset URLs', () => {
+  const begin = webUiSource.match(/static void beginPage\([^)]*\)\s*\{([\s\S]*?)\n\}/)[1];
+  for (const path of ['/logo-ezgrow.png', '/app.css', '/chart.umd.min.js', '/app.js']){
+    assert.ok(begin.includes(`staticAssetUrl("${path}")`), `beginPage() links ${path} directly`);
+    assert.ok(!begin.includes(`'${path}'`), `beginPage() links ${path} directly`);
+  }
+});
+
+test('fingerprinted URLs are routed and cached as immutable', () => {
+  for (const route of staticRoutes()){
+    const pattern = new RegExp(String.raw`server\.on\(staticAssetUrl\("${route.path.replace(/\./g, '\\.')}"\),\s*HTTP_GET,\s*${route.handler}\);`);
+    assert.match(webUiSource, pattern);
+  }
+  const body = webUiSource.match(/static void streamStaticFile\([^)]*\)\s*\{([\s\S]*?)\n\}/)[1];
+  assert.match(body, /server\.sendHeader\("ETag", etag\);/);
+  assert.match(body, /server\.uri\(\) == asset->url\)\s*\?\s*"public, max-age=31536000, immutable"\s*:\s*"no-cache"/);
+  assert.match(body, /If-None-Match[\s\S]*server\.send\(304,/);
+});
+
+test('small assets are cached in RAM and counted in /api/status', () => {
+  const body = webUiSource.match(/static void streamStaticFile\([^)]*\)\s*\{([\s\S]*?)\n\}/)[1];
+  assert.match(body, /sStaticCache\.insert\(file\.c_str\(\), size, mtime\)/);
+  assert.match(body, /sendStaticBody\(new CachedBodySource\(cached\), size, contentType, gzip\);/);
+  assert.match(webUiSource, /static StaticFileCache sStaticCache\(STATIC_CACHE_BUDGET_BYTES, STATIC_CACHE_MAX_FILE_BYTES, staticCacheAlloc\);/);
+  assert.match(webUiSource, /sStaticCache\.setGeneration\(generation\);/);
+  assert.match(webUiSource, /writeStaticCacheJson\(json\);/);
+});
+
+test('static asset bodies are pumped from handleWebServer() instead of streamed inline', () => {
+  const body = webUiSource.match(/static void streamStaticFile\([^)]*\)\s*\{([\s\S]*?)\n\}/)[1];
+  assert.doesNotMatch(body, /server\.streamFile\(/);
+  assert.match(body, /sendStaticBody\(new FileBodySource\(f\), size, contentType, gzip\);/);
+  assert.match(webUiSource, /if \(sTransfers\.start\(sink, source, len\)\) return;/);
+  const loop = webUiSource.match(/void handleWebServer\(\)\s*\{([\s\S]*?)\n\}/)[1];
+  assert.match(loop, /\n\s*server\.handleClient\(\);\s*sTransfers\.pump\(HTTP_TRANSFER_PUMP_US\);/);
+  // A full pool refuses the body, not the request
+  assert.match(body, /if \(!notModified && !reserveTransfer\(false\)\)/);
+  assert.ok(body.indexOf('reserveTransfer(false)') < body.indexOf('server.sendHeader("ETag", etag);'));
+  const reserve = webUiSource.match(/static bool reserveTransfer\(bool historyExport\) \{([\s\S]*?)\n\}/)[1];
+  assert.match(reserve, /server\.sendHeader\("Retry-After", HTTP_TRANSFER_RETRY_AFTER\);\s*server\.send\(503,/);
+});
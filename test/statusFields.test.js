@@ -0,0 +1,59 @@
+import test from 'node:test';
+import { readFileSync } from 'node:fs';
+import { strict as assert } from 'node:assert';
+
+const webUiSource = readFileSync(new URL('../WebUI.cpp', import.meta.url), 'utf8').replace(/\r\n/g, '\n');
+
+function handlerBody(name){
+  const start = webUiSource.indexOf(`static void ${name}() {`);
+  assert.notEqual(start, -1, `${name} not found`);
+  const end = webUiSource.indexOf('\n}\n', start);
+  return webUiSource.slice(start, end);
+}
+
+test('every /api/status group has a fields= name and is only built when requested', () => {
+  const enumBody = webUiSource.match(/enum StatusField : uint16_t \{([\s\S]*?)\};/)[1];
+  const bits = [...enumBody.matchAll(/(STATUS_[A-Z_]+)\s*=\s*1 << \d+/g)].map(m => m[1]);
+  assert.equal(bits.length, 11);
+
+  const table = webUiSource.match(/kStatusFields\[\] = \{([\s\S]*?)\n\};/)[1];
+  const named = [...table.matchAll(/\{ "([a-z_]+)",\s*(STATUS_[A-Z_]+) \}/g)];
+  assert.deepEqual(named.map(m => m[2]).sort(), [...bits].sort());
+  for (const [, name, bit] of named){
+    assert.equal(bit, `STATUS_${name.toUpperCase()}`);
+  }
+
+  const body = handlerBody('handleStatusApi');
+  for (const bit of bits){
+    assert.match(body, new RegExp(`if \\(fields & ${bit}\\)`), `${bit} is not gated`);
+  }
+  // Nothing is formatted outside the gates
+  assert.doesNotMatch(body, /greenhouseGetTime|WiFi\.status\(\)/);
+});
+
+test('/api/status ETag covers the projection', () => {
+  const body = handlerBody('handleStatusApi');
+  assert.match(body, /parseStatusFields\(server\.arg\("fields"\)\.c_str\(\), fields\)/);
+  assert.match(body, /\(unsigned long\)sStatusGen, \(unsigned\)fields, compact \? "c" : ""\);/);
+});
+
+test('/api/status is only validated and parked for versioned groups', () => {
+  const versioned = webUiSource.match(/STATUS_VERSIONED\s*=\s*([^;]*?)\n\};/)[1].match(/STATUS_[A-Z_]+/g);
+  assert.deepEqual(versioned.sort(), ['STATUS_CHAMBERS', 'STATUS_CHART_SCALES', 'STATUS_RELAYS', 'STATUS_SENSORS', 'STATUS_TIME', 'STATUS_WIFI']);
+
+  const body = handlerBody('handleStatusApi');
+  const gated = body.slice(body.indexOf('if ((fields & ~STATUS_VERSIONED) == 0) {'));
+  assert.notEqual(gated.length, body.length);
+  const block = gated.slice(0, gated.indexOf('\n  }\n'));
+  for (const call of ['server.sendHeader("ETag", etag)', 'server.send(304,', 'server.deferRequest(']){
+    assert.ok(block.includes(call), `${call} outside the versioned branch`);
+  }
+  // The dashboard long-polls only those groups
+  const appJs = readFileSync(new URL('../data/app.js', import.meta.url), 'utf8');
+  assert.match(appJs, /const liveStatusFields = "time,wifi,sensors,relays,chambers,chart_scales";/);
+
+  // Time sync and the Wi-Fi connection move the generation
+  const track = webUiSource.match(/static void trackStatusGeneration\(\) \{([\s\S]*?)\n\}/)[1];
+  assert.match(track, /timeSynced != sStatusSeen\.timeSynced/);
+  assert.match(track, /wifiMode != sStatusSeen\.wifiMode \|\| wifiIp != sStatusSeen\.wifiIp/);
+});
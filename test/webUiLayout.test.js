@@ -7,7 +7,7 @@ const appCss = readFileSync(new URL('../data/app.css', import.meta.url), 'utf8')
 
 test('includes favicon link after title block', () => {
   const pattern = new RegExp(
-    String.raw`page \+= "<title>";\s*page \+= title;\s*page \+= "<\/title>";\s*page \+= "<link rel='icon' href='\/logo-ezgrow\.png' type='image\/png'>";`,
+    String.raw`page \+= "<title>";\s*page \+= title;\s*page \+= "<\/title>";\s*page \+= "<link rel='icon' href='";\s*page \+= staticAssetUrl\("\/logo-ezgrow\.png"\);\s*page \+= "' type='image\/png'>";`,
     's'
   );
   assert.match(webUiSource, pattern);
@@ -15,7 +15,7 @@ test('includes favicon link after title block', () => {
 
 test('renders brand with logo only', () => {
   const pattern = new RegExp(
-    String.raw`page \+= "<div class='brand'><img src='\/logo-ezgrow\.png' class='brand-logo' alt='EZgrow logo'><\/div>";`
+    String.raw`page \+= "<div class='brand'><img src='";\s*page \+= staticAssetUrl\("\/logo-ezgrow\.png"\);\s*page \+= "' class='brand-logo' alt='EZgrow logo'><\/div>";`
   );
   assert.match(webUiSource, pattern);
 });